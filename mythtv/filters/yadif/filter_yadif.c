@@ -31,7 +31,6 @@
 
 #include <string.h>
 #include <math.h>
-#include <pthread.h>
 
 #include "filter.h"
 #include "mythframe.h"
@@ -52,26 +51,10 @@
 
 static void* (*fast_memcpy)(void * to, const void * from, size_t len);
 
-struct DeintThread
-{
-    int       ready;
-    pthread_t id;
-    int       exists;
-};
-
 typedef struct ThisFilter
 {
     VideoFilter vf;
 
-    struct DeintThread *threads;
-    VideoFrame *frame;
-    int         field;
-    int         ready;
-    int         kill_threads;
-    int         actual_threads;
-    int         requested_threads;
-    pthread_mutex_t mutex;
-
     long long last_framenr;
 
     uint8_t *ref[4][3];
@@ -445,22 +428,13 @@ static void filter_line_c(struct ThisFilter *p, uint8_t *dst,
 }
 
 static void filter_func(struct ThisFilter *p, uint8_t *dst, int dst_offsets[3],
-                        int dst_stride[3], int width, int height, int parity,
-                        int tff, int this_slice, int total_slices)
+                        int dst_stride[3], int width, int parity,
+                        int tff, int starth, int endh)
 {
-    if (total_slices < 1)
-        return;
-
     int y, i;
     uint8_t nr_p, nr_c;
     nr_c = p->got_frames[1] ? 1: 2;
     nr_p = p->got_frames[0] ? 0: nr_c;
-    int slice_height = height / total_slices;
-    slice_height     = (slice_height >> 1) << 1;
-    int starth       = slice_height * this_slice;
-    int endh         = starth + slice_height;
-    if ((this_slice + 1) >= total_slices)
-        endh = height;
 
     for (i = 0; i < 3; i++)
     {
@@ -493,9 +467,12 @@ static void filter_func(struct ThisFilter *p, uint8_t *dst, int dst_offsets[3],
 #endif
 }
 
-static int YadifDeint (VideoFilter * f, VideoFrame * frame, int field)
+/* Stores the new frame as reference, all bands read from the references
+ * only, so they can safely be deinterlaced in place concurrently. */
+static int YadifPrepare (VideoFilter * f, VideoFrame * frame, int field)
 {
     ThisFilter *filter = (ThisFilter *) f;
+    (void) field;
 
     AllocFilter(filter, frame->width, frame->height);
 
@@ -507,49 +484,36 @@ static int YadifDeint (VideoFilter * f, VideoFrame * frame, int field)
                   frame->pitches, frame->width, frame->height);
     }
 
-    if (filter->actual_threads < 1)
-    {
-        filter_func(
-            filter, frame->buf, frame->offsets, frame->pitches,
-            frame->width, frame->height, field, frame->top_field_first,
-            0, 1);
-    }
-    else
-    {
-        int i;
-        for (i = 0; i < filter->actual_threads; i++)
-            filter->threads[i].ready = 1;
-        filter->field = field;
-        filter->frame = frame;
-        filter->ready = filter->actual_threads;
-        i = 0;
-        while (filter->ready > 0 && i < 1000)
-        {
-            usleep(1000);
-            i++;
-        }
-    }
-
     filter->last_framenr = frame->frameNumber;
 
     return 0;
 }
 
+static int YadifDeintBand (VideoFilter * f, VideoFrame * frame, int field,
+                           int first_row, int last_row)
+{
+    ThisFilter *filter = (ThisFilter *) f;
+
+    filter_func(
+        filter, frame->buf, frame->offsets, frame->pitches,
+        frame->width, field, frame->top_field_first,
+        first_row, last_row);
+
+    return 0;
+}
+
+static int YadifDeint (VideoFilter * f, VideoFrame * frame, int field)
+{
+    YadifPrepare(f, frame, field);
+    return YadifDeintBand(f, frame, field, 0, frame->height);
+}
+
 
 static void CleanupYadifDeintFilter (VideoFilter * filter)
 {
     int i;
     ThisFilter* f = (ThisFilter*)filter;
 
-    if (f->threads != NULL)
-    {
-        f->kill_threads = 1;
-        for (i = 0; i < f->requested_threads; i++)
-            if (f->threads[i].exists)
-                pthread_join(f->threads[i].id, NULL);
-        free(f->threads);
-    }
-
     for (i = 0; i < 3*3; i++)
     {
         uint8_t **p= &f->ref[i%3][i/3];
@@ -558,38 +522,6 @@ static void CleanupYadifDeintFilter (VideoFilter * filter)
     }
 }
 
-static void *YadifThread(void *args)
-{
-    ThisFilter *filter = (ThisFilter*)args;
-
-    pthread_mutex_lock(&(filter->mutex));
-    int num = filter->actual_threads;
-    filter->actual_threads = num + 1;
-    pthread_mutex_unlock(&(filter->mutex));
-
-    while (!filter->kill_threads)
-    {
-        usleep(1000);
-        if (filter->ready &&
-            filter->frame != NULL &&
-            filter->threads[num].ready)
-        {
-            filter_func(
-                filter, filter->frame->buf, filter->frame->offsets,
-                filter->frame->pitches, filter->frame->width,
-                filter->frame->height, filter->field,
-                filter->frame->top_field_first, num, filter->actual_threads);
-
-            pthread_mutex_lock(&(filter->mutex));
-            filter->ready = filter->ready - 1;
-            filter->threads[num].ready = 0;
-            pthread_mutex_unlock(&(filter->mutex));
-        }
-    }
-    pthread_exit(NULL);
-    return NULL;
-}
-
 static VideoFilter * YadifDeintFilter(VideoFrameType inpixfmt,
                                       VideoFrameType outpixfmt,
                                       int *width, int *height, char *options,
@@ -598,6 +530,7 @@ static VideoFilter * YadifDeintFilter(VideoFrameType inpixfmt,
     ThisFilter *filter;
     (void) height;
     (void) options;
+    (void) threads; /* threaded in bands by the FilterChain */
 
     fprintf(stderr, "YadifDeint: In-Pixformat = %d Out-Pixformat=%d\n",
             inpixfmt, outpixfmt);
@@ -643,72 +576,10 @@ static VideoFilter * YadifDeintFilter(VideoFrameType inpixfmt,
 
     filter->vf.filter = &YadifDeint;
     filter->vf.cleanup = &CleanupYadifDeintFilter;
-
-    filter->frame = NULL;
-    filter->field = 0;
-    filter->ready = 0;
-    filter->kill_threads = 0;
-    filter->actual_threads  = 0;
-    filter->requested_threads  = threads;
-    filter->threads = NULL;
-
-    if (filter->requested_threads > 1)
-    {
-        filter->threads = (struct DeintThread *) calloc(threads,
-                          sizeof(struct DeintThread));
-        if (filter->threads == NULL)
-        {
-            printf("YadifDeint: failed to allocate memory for threads - "
-                   "falling back to existing, single thread.\n");
-            filter->requested_threads = 1;
-        }
-    }
-
-    if (filter->requested_threads > 1)
-    {
-        pthread_mutex_init(&(filter->mutex), NULL);
-        int success = 0;
-        for (int i = 0; i < filter->requested_threads; i++)
-        {
-            if (pthread_create(&(filter->threads[i].id), NULL,
-                               YadifThread, (void*)filter) != 0)
-                filter->threads[i].exists = 0;
-            else
-            {
-                success++;
-                filter->threads[i].exists = 1;
-            }
-        }
-
-        if (success < filter->requested_threads)
-        {
-            printf("YadifDeint: only created %d of %d threads - "
-                   "falling back to existing, single thread.\n"
-                   , success, filter->requested_threads);
-        }
-        else
-        {
-            int timeout = 0;
-            while (filter->actual_threads != filter->requested_threads)
-            {
-                timeout++;
-                if (timeout > 5000)
-                {
-                    printf("YadifDeint: waited too long for threads to start."
-                           "- continuing.\n");
-                    break;
-                }
-                usleep(1000);
-            }
-            printf("yadifdeint: Created %d threads (%d requested)\n",
-                   filter->actual_threads, filter->requested_threads);
-        }
-    }
-
-    if (filter->actual_threads < 1 )
-    {
-        printf("YadifDeint: Using existing thread.\n");
-    }
+    filter->vf.prepare = &YadifPrepare;
+    filter->vf.filter_band = &YadifDeintBand;
+    filter->vf.band_border = 0;
+    filter->last_framenr = -1;
 
     return (VideoFilter *) filter;
 }
@@ -728,7 +599,8 @@ const FilterInfo filter_table[] =
             "combines data from several fields to "
             "deinterlace with less motion blur",
             .formats=    FmtList,
-            .libname=    NULL
+            .libname=    NULL,
+            .flags=      FILTER_FLAG_BANDS
     },
     {
             .filter_init= &YadifDeintFilter,
@@ -737,7 +609,8 @@ const FilterInfo filter_table[] =
             "combines data from several fields to "
             "deinterlace with less motion blur",
             .formats=    FmtList,
-            .libname=    NULL
+            .libname=    NULL,
+            .flags=      FILTER_FLAG_BANDS
     },
     FILT_NULL
 };
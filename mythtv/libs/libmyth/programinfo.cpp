@@ -3236,6 +3236,22 @@ TranscodingStatus ProgramInfo::QueryTranscodeStatus(void) const
     return TRANSCODING_NOT_TRANSCODED;
 }
 
+/// \brief Returns the "commflagged" field in "recorded" table.
+CommFlagStatus ProgramInfo::QueryCommFlagStatus(void) const
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    query.prepare("SELECT commflagged FROM recorded"
+                 " WHERE chanid = :CHANID"
+                 " AND starttime = :STARTTIME ;");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":STARTTIME", recstartts);
+
+    if (query.exec() && query.next())
+        return (CommFlagStatus) query.value(0).toUInt();
+    return COMM_FLAG_NOT_FLAGGED;
+}
+
 /** \brief Set "transcoded" field in "recorded" table to "trans".
  *  \note Also sets the FL_TRANSCODED flag if the status is
  *        TRASCODING_COMPLETE and clears it otherwise.
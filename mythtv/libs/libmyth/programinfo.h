@@ -566,6 +566,7 @@ class MPUBLIC ProgramInfo
     bool        QueryIsDeleteCandidate(bool one_player_allowed = false) const;
     AutoExpireType QueryAutoExpire(void) const;
     TranscodingStatus QueryTranscodeStatus(void) const;
+    CommFlagStatus QueryCommFlagStatus(void) const;
     bool        QueryTuningInfo(QString &channum, QString &input) const;
     QString     QueryInputDisplayName(void) const;
     uint        QueryAverageWidth(void) const;
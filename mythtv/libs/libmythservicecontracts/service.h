@@ -22,6 +22,8 @@
 
 #include "serviceexp.h"
 
+class Serializer;
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -36,6 +38,11 @@
 //    Defaults to "BOTH", available values:
 //          "GET", "POST" or "BOTH"
 //
+//  * When m_pStreamSerializer is set, a method returning a large list may
+//    write its result through it (see Serializer::BeginStream) and return
+//    NULL instead of building the whole data contract.  It is NULL when
+//    called from scripts or when the client can't take a streamed reply.
+//
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
@@ -65,6 +72,8 @@ class SERVICE_PUBLIC Service : public QObject
     public:
 
         QList<QString> m_parsedParams; // lowercased
+
+        Serializer    *m_pStreamSerializer;
 };
 
 //////////////////////////////////////////////////////////////////////////////
@@ -73,12 +82,14 @@ class SERVICE_PUBLIC Service : public QObject
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 Q_DECLARE_METATYPE( QFileInfo )
-inline Service::Service(QObject *parent) : QObject(parent)
+inline Service::Service(QObject *parent) : QObject(parent),
+    m_pStreamSerializer(NULL)
 {
     qRegisterMetaType< QFileInfo >();
 }
 #else
-inline Service::Service(QObject *parent) : QObject(parent) {}
+inline Service::Service(QObject *parent) : QObject(parent),
+    m_pStreamSerializer(NULL) {}
 #endif
 
 //////////////////////////////////////////////////////////////////////////////
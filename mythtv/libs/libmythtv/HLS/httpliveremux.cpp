@@ -0,0 +1,281 @@
+/*  -*- Mode: c++ -*-
+ *
+ *   Class HTTPLiveRemux
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QTextStream>
+
+#include "mythlogging.h"
+#include "HLS/httpliveremux.h"
+
+#define LOC QString("HLSRemux(%1): ").arg(m_mediaURL)
+
+/** \param mediaURL    URL of the recording, which every segment is a byte
+ *                     range of.
+ *  \param segmentSize Minimum segment length in seconds. Segments end on
+ *                     the first keyframe after it.
+ */
+HTTPLiveRemux::HTTPLiveRemux(const QString &mediaURL, uint segmentSize)
+  : m_mediaURL(mediaURL),
+    m_segmentSize(segmentSize ? segmentSize : 6),
+    m_frameRate(0.0),
+    m_fileSize(0),
+    m_finished(false),
+    m_maxPart(0)
+{
+    m_open.offset   = 0;
+    m_open.length   = 0;
+    m_open.duration = 0;
+}
+
+/** \brief Sets the keyframe index of the recording
+ *
+ *  \param positions Byte offset of each keyframe, by frame number
+ *                   (MARK_GOP_BYFRAME)
+ *  \param durations Time of each keyframe in ms, by frame number
+ *                   (MARK_DURATION_MS). Where it is missing the duration
+ *                   of a GOP is worked out from frameRate.
+ */
+void HTTPLiveRemux::SetKeyframes(const frm_pos_map_t &positions,
+                                 const frm_pos_map_t &durations,
+                                 double frameRate)
+{
+    m_positions = positions;
+    m_durations = durations;
+    m_frameRate = (frameRate > 0.0) ? frameRate : 29.97;
+
+    Build();
+}
+
+/** \brief Sets how much of the recording can be read
+ *
+ *  \param fileSize Bytes of the recording on disk. Keyframes past it are
+ *                  still in the recorder's buffers and not listed yet.
+ *  \param finished Whether the recording has ended, in which case the last
+ *                  GOP runs to the end of the file and the playlist ends.
+ */
+void HTTPLiveRemux::SetEnd(int64_t fileSize, bool finished)
+{
+    m_fileSize = fileSize;
+    m_finished = finished;
+
+    Build();
+}
+
+void HTTPLiveRemux::Build(void)
+{
+    m_segments.clear();
+    m_open.parts.clear();
+    m_open.offset   = 0;
+    m_open.length   = 0;
+    m_open.duration = 0;
+    m_maxPart       = 0;
+
+    // Every complete GOP, from its keyframe to the next one. The first one
+    // starts at the beginning of the file so the PAT and PMT are included.
+    QVector<Part> gops;
+    gops.reserve(m_positions.size());
+
+    frm_pos_map_t::const_iterator it = m_positions.begin();
+    while (it != m_positions.end())
+    {
+        frm_pos_map_t::const_iterator next = it + 1;
+
+        Part gop;
+        gop.offset = gops.isEmpty() ? 0 : *it;
+
+        int64_t end;
+        if (next != m_positions.end())
+            end = *next;
+        else if (m_finished)
+            end = m_fileSize;
+        else
+            break;              // Still being recorded
+
+        if (end > m_fileSize)
+            break;              // Not written to disk yet
+
+        if (next != m_positions.end() &&
+            m_durations.contains(it.key()) && m_durations.contains(next.key()))
+        {
+            gop.duration = m_durations[next.key()] - m_durations[it.key()];
+        }
+        else if (next != m_positions.end())
+        {
+            gop.duration = (int64_t)((next.key() - it.key()) * 1000.0 /
+                                     m_frameRate);
+        }
+        else
+        {
+            // The last GOP of a finished recording, assume it is as long
+            // as the one before it
+            gop.duration = gops.isEmpty() ? 1000 : gops.last().duration;
+        }
+
+        gop.length = end - gop.offset;
+
+        if (gop.length > 0 && gop.duration > 0)
+            gops.append(gop);
+
+        it = next;
+    }
+
+    // Group the GOPs into segments of at least m_segmentSize seconds
+    Segment segment = m_open;
+    for (int i = 0; i < gops.size(); ++i)
+    {
+        const Part &gop = gops[i];
+
+        if (segment.parts.isEmpty())
+        {
+            segment.offset   = gop.offset;
+            segment.length   = 0;
+            segment.duration = 0;
+        }
+
+        segment.parts.append(gop);
+        segment.length   += gop.length;
+        segment.duration += gop.duration;
+        m_maxPart = qMax(m_maxPart, gop.duration);
+
+        if (segment.duration >= m_segmentSize * 1000)
+        {
+            m_segments.append(segment);
+            segment.parts.clear();
+        }
+    }
+
+    if (!segment.parts.isEmpty())
+    {
+        if (m_finished)
+            m_segments.append(segment);
+        else
+            m_open = segment;
+    }
+
+    LOG(VB_PLAYBACK, LOG_DEBUG, LOC +
+        QString("%1 keyframes, %2 segments, %3 parts in the open segment")
+            .arg(m_positions.size()).arg(m_segments.size())
+            .arg(m_open.parts.size()));
+}
+
+/** \brief Whether the playlist lists segment msn, or part part of it
+ *
+ *  Used for blocking playlist reloads; a part of -1 asks for the whole
+ *  segment.
+ */
+bool HTTPLiveRemux::HasPart(int msn, int part) const
+{
+    if (msn < m_segments.size())
+        return true;
+
+    if (part < 0 || msn > m_segments.size())
+        return false;
+
+    return part < m_open.parts.size();
+}
+
+uint HTTPLiveRemux::GetTargetDuration(void) const
+{
+    int64_t longest = 0;
+    for (int i = 0; i < m_segments.size(); ++i)
+        longest = qMax(longest, m_segments[i].duration);
+
+    if (!longest)
+        return m_segmentSize;
+
+    return (uint)((longest + 999) / 1000);
+}
+
+/** \brief Returns the media playlist
+ *
+ *  \param lowLatency List the GOPs of the last segments and of the segment
+ *                    being recorded as partial segments.
+ */
+QString HTTPLiveRemux::GetPlaylist(bool lowLatency) const
+{
+    QString playlist;
+    QTextStream os(&playlist);
+
+    os.setRealNumberNotation(QTextStream::FixedNotation);
+    os.setRealNumberPrecision(3);
+
+    // Partial segments only make sense while recording
+    lowLatency = lowLatency && !m_finished;
+
+    double partTarget = m_maxPart ? m_maxPart / 1000.0 : 1.0;
+
+    os << "#EXTM3U\n"
+       << "#EXT-X-VERSION:" << (lowLatency ? 6 : 4) << "\n"
+       << "#EXT-X-TARGETDURATION:" << GetTargetDuration() << "\n"
+       << "#EXT-X-MEDIA-SEQUENCE:0\n"
+       << "#EXT-X-PLAYLIST-TYPE:" << (m_finished ? "VOD" : "EVENT") << "\n"
+       << "#EXT-X-INDEPENDENT-SEGMENTS\n";
+
+    if (lowLatency)
+    {
+        os << "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK="
+           << partTarget * 3 << "\n"
+           << "#EXT-X-PART-INF:PART-TARGET=" << partTarget << "\n";
+    }
+
+    // Parts only need listing for the last few segments
+    int firstParts = m_segments.size() - 3;
+
+    for (int i = 0; i < m_segments.size(); ++i)
+    {
+        const Segment &segment = m_segments[i];
+
+        if (lowLatency && i >= firstParts)
+        {
+            for (int j = 0; j < segment.parts.size(); ++j)
+            {
+                const Part &part = segment.parts[j];
+                os << "#EXT-X-PART:DURATION=" << part.duration / 1000.0
+                   << ",URI=\"" << m_mediaURL << "\",BYTERANGE=\""
+                   << part.length << "@" << part.offset
+                   << "\",INDEPENDENT=YES\n";
+            }
+        }
+
+        os << "#EXTINF:" << segment.duration / 1000.0 << ",\n"
+           << "#EXT-X-BYTERANGE:" << segment.length << "@" << segment.offset
+           << "\n"
+           << m_mediaURL << "\n";
+    }
+
+    if (lowLatency)
+    {
+        for (int j = 0; j < m_open.parts.size(); ++j)
+        {
+            const Part &part = m_open.parts[j];
+            os << "#EXT-X-PART:DURATION=" << part.duration / 1000.0
+               << ",URI=\"" << m_mediaURL << "\",BYTERANGE=\""
+               << part.length << "@" << part.offset
+               << "\",INDEPENDENT=YES\n";
+        }
+    }
+
+    if (m_finished)
+        os << "#EXT-X-ENDLIST\n";
+
+    os.flush();
+
+    return playlist;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
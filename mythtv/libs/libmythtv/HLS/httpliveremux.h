@@ -0,0 +1,70 @@
+#ifndef HTTPLIVEREMUX_H
+#define HTTPLIVEREMUX_H
+
+#include <QString>
+#include <QVector>
+
+#include "mythtvexp.h"
+#include "programtypes.h"
+
+/** \class HTTPLiveRemux
+ *  \brief Builds byte-range HTTP Live Streaming playlists for a recording
+ *
+ *  Transport stream recordings can be played over HLS as they are: every
+ *  segment is a byte range of the recording, starting on a keyframe taken
+ *  from the recorder's keyframe position map. Nothing is copied or encoded,
+ *  and the playlist of a recording in progress grows with the file.
+ *
+ *  Each GOP is also a partial segment (EXT-X-PART), so a low-latency client
+ *  can start playback on the last complete GOP of a live recording instead
+ *  of waiting for a whole segment to be written.
+ */
+class MTV_PUBLIC HTTPLiveRemux
+{
+  public:
+    HTTPLiveRemux(const QString &mediaURL, uint segmentSize = 6);
+
+    void    SetKeyframes(const frm_pos_map_t &positions,
+                         const frm_pos_map_t &durations, double frameRate);
+    void    SetEnd(int64_t fileSize, bool finished);
+
+    bool    IsEmpty(void) const { return m_segments.isEmpty(); }
+    bool    HasPart(int msn, int part) const;
+    uint    GetTargetDuration(void) const;
+
+    QString GetPlaylist(bool lowLatency) const;
+
+  private:
+    typedef struct part
+    {
+        int64_t offset;
+        int64_t length;
+        int64_t duration;   // ms
+    } Part;
+
+    typedef struct segment
+    {
+        int64_t       offset;
+        int64_t       length;
+        int64_t       duration;   // ms
+        QVector<Part> parts;
+    } Segment;
+
+    void    Build(void);
+
+    QString             m_mediaURL;
+    uint                m_segmentSize;
+    frm_pos_map_t       m_positions;
+    frm_pos_map_t       m_durations;
+    double              m_frameRate;
+    int64_t             m_fileSize;
+    bool                m_finished;
+
+    QVector<Segment>    m_segments;     // Complete segments
+    Segment             m_open;         // Parts of the segment being written
+    int64_t             m_maxPart;      // ms
+};
+
+#endif
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -29,7 +29,11 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRunnable>
+#include <QStringList>
 #include <QUrl>
 
 #include "mythcorecontext.h"
@@ -63,8 +67,8 @@ class HTTPLiveStreamThread : public QRunnable
      *  \param eventName Optional System Event name for this command
      */
 
-    explicit HTTPLiveStreamThread(int streamid)
-      : m_streamID(streamid) {}
+    HTTPLiveStreamThread(int streamid, const QList<int> &renditions)
+      : m_streamID(streamid), m_renditions(renditions) {}
 
     /** \fn HTTPLiveStreamThread::run()
      *  \brief Runs mythtranscode for the given HTTP Live Stream ID
@@ -77,7 +81,18 @@ class HTTPLiveStreamThread : public QRunnable
 
         QString command = GetAppBinDir() +
             QString("mythtranscode --hls --hlsstreamid %1")
-                    .arg(m_streamID) + logPropagateArgs;
+                    .arg(m_streamID);
+
+        if (!m_renditions.isEmpty())
+        {
+            QStringList ids;
+            for (int i = 0; i < m_renditions.size(); ++i)
+                ids << QString::number(m_renditions[i]);
+
+            command += QString(" --hlsrenditions %1").arg(ids.join(","));
+        }
+
+        command += logPropagateArgs;
 
         uint result = myth_system(command, flags);
 
@@ -88,14 +103,128 @@ class HTTPLiveStreamThread : public QRunnable
     }
 
   private:
-    int m_streamID;
+    int        m_streamID;
+    QList<int> m_renditions;
 };
 
+// How far, in percent, a request may be from a rung and still be snapped
+// to it
+#define LADDER_WIDTH_TOLERANCE   10
+#define LADDER_BITRATE_TOLERANCE 25
+
+/** \brief One rung of the HTTP Live Stream bitrate ladder
+ */
+typedef struct HTTPLiveStreamRung
+{
+    uint16_t width;
+    uint32_t bitrate;
+} HTTPLiveStreamRung;
+
+/** \brief Reads the bitrate ladder from the HTTPLiveStreamLadder setting
+ *
+ *  The setting is a comma separated list of "width:kbps" rungs. The rungs
+ *  are returned widest first; an empty setting disables the ladder.
+ */
+static QList<HTTPLiveStreamRung> GetLadder(void)
+{
+    QList<HTTPLiveStreamRung> ladder;
+
+    QStringList rungs = gCoreContext->GetSetting("HTTPLiveStreamLadder",
+        "1280:2000,960:1200,640:800,480:400").split(",", QString::SkipEmptyParts);
+
+    for (int i = 0; i < rungs.size(); ++i)
+    {
+        bool widthOk = false;
+        bool bitrateOk = false;
+
+        HTTPLiveStreamRung rung;
+        rung.width   = rungs[i].section(':', 0, 0).trimmed().toUInt(&widthOk);
+        rung.bitrate = rungs[i].section(':', 1, 1).trimmed().toUInt(&bitrateOk)
+                       * 1000;
+
+        if (!widthOk || !bitrateOk || !rung.width || !rung.bitrate)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, SLOC +
+                QString("Ignoring invalid HTTPLiveStreamLadder rung '%1'")
+                    .arg(rungs[i]));
+            continue;
+        }
+
+        int pos = 0;
+        while (pos < ladder.size() && ladder[pos].width > rung.width)
+            ++pos;
+        ladder.insert(pos, rung);
+    }
+
+    return ladder;
+}
+
+/** \brief A ladder queued by this process, and the renditions its
+ *         transcode will encode
+ */
+typedef struct HTTPLiveStreamLadder
+{
+    QList<int> renditions;
+    bool       launched;
+} HTTPLiveStreamLadder;
+
+/// Serialises looking up and creating ladders, so two requests for the
+/// same source can't each create (and transcode) their own
+static QMutex s_ladderLock;
+/// The ladders not yet finished, by the stream id of their main stream
+static QMap<int, HTTPLiveStreamLadder> s_ladders;
+
+static HTTPLiveStreamStatus GetStreamStatus(int streamid)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(
+        "SELECT status FROM livestream "
+        "WHERE id = :STREAMID; ");
+    query.bindValue(":STREAMID", streamid);
+
+    if (!query.exec() || !query.next())
+        return kHLSStatusUndefined;
+
+    return (HTTPLiveStreamStatus)query.value(0).toInt();
+}
+
+/** \brief Finds the ladder that encodes the given stream
+ *
+ *  Ladders whose transcode has finished, or never ran, are forgotten on
+ *  the way. Must be called with s_ladderLock held.
+ *
+ *  \return The stream id of the ladder's main stream, or -1.
+ */
+static int FindLadder(int streamid)
+{
+    int mainid = -1;
+
+    QMap<int, HTTPLiveStreamLadder>::iterator it = s_ladders.begin();
+    while (it != s_ladders.end())
+    {
+        HTTPLiveStreamStatus status = GetStreamStatus(it.key());
+        if ((status == kHLSStatusUndefined) ||
+            (status >= kHLSStatusCompleted))
+        {
+            it = s_ladders.erase(it);
+            continue;
+        }
+
+        if ((it.key() == streamid) || it->renditions.contains(streamid))
+            mainid = it.key();
+
+        ++it;
+    }
+
+    return mainid;
+}
+
 
 HTTPLiveStream::HTTPLiveStream(QString srcFile, uint16_t width, uint16_t height,
                                uint32_t bitrate, uint32_t abitrate,
                                uint16_t maxSegments, uint16_t segmentSize,
-                               uint32_t aobitrate, int32_t srate)
+                               uint32_t aobitrate, int32_t srate,
+                               bool useLadder)
   : m_writing(false),
     m_streamid(-1),              m_sourceFile(srcFile),
     m_sourceWidth(0),            m_sourceHeight(0),
@@ -126,6 +255,67 @@ HTTPLiveStream::HTTPLiveStream(QString srcFile, uint16_t width, uint16_t height,
     if (m_audioOnlyBitrate == 0)
         m_audioOnlyBitrate = 64000;
 
+    // Snap a request that is close to one of the ladder's rungs to it, so
+    // that clients asking for slightly different sizes or bitrates share
+    // one stream (and one transcode) instead of each starting their own.
+    // Any other request is encoded exactly as asked, with the rungs that
+    // are narrower than it below it.
+    QList<HTTPLiveStreamRung> ladder;
+    int next = 0;
+
+    if (useLadder)
+        ladder = GetLadder();
+
+    if (!ladder.isEmpty())
+    {
+        uint16_t width = m_width ? m_width : (uint16_t)(m_height * 16 / 9);
+
+        int rung = -1;
+        int bestDiff = 0;
+        for (int i = 0; i < ladder.size(); ++i)
+        {
+            int widthDiff = qAbs((int)ladder[i].width - (int)width);
+            qint64 bitrateDiff = qAbs((qint64)ladder[i].bitrate - m_bitrate);
+
+            if ((widthDiff * 100 > width * LADDER_WIDTH_TOLERANCE) ||
+                (bitrate && (bitrateDiff * 100 >
+                             (qint64)bitrate * LADDER_BITRATE_TOLERANCE)))
+                continue;
+
+            if ((rung == -1) || (widthDiff < bestDiff))
+            {
+                rung = i;
+                bestDiff = widthDiff;
+            }
+        }
+
+        if (rung != -1)
+        {
+            // Keep the requested shape, the transcoder works out the
+            // height from the source's aspect ratio when none was asked for.
+            uint16_t height = 0;
+            if (m_width && m_height)
+                height = ((ladder[rung].width * m_height / m_width) + 1) & ~1;
+
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Requested %1x%2 at %3 kbps, using the ladder's "
+                        "%4x%5 at %6 kbps")
+                    .arg(m_width).arg(m_height).arg(m_bitrate / 1000)
+                    .arg(ladder[rung].width).arg(height)
+                    .arg(ladder[rung].bitrate / 1000));
+
+            m_width   = ladder[rung].width;
+            m_height  = height;
+            m_bitrate = ladder[rung].bitrate;
+            next      = rung + 1;
+        }
+        else
+        {
+            while ((next < ladder.size()) && (ladder[next].width >= width))
+                ++next;
+        }
+    }
+
     m_sourceHost = gCoreContext->GetHostName();
 
     QFileInfo finfo(m_sourceFile);
@@ -149,7 +339,47 @@ HTTPLiveStream::HTTPLiveStream(QString srcFile, uint16_t width, uint16_t height,
         return;
     }
 
+    // The renditions are created with useLadder false, so they don't
+    // take the lock again
+    QMutexLocker locker(useLadder ? &s_ladderLock : NULL);
+
     AddStream();
+
+    // The lower rungs are encoded by the same transcode as this stream,
+    // from the same decode, and listed in its meta playlist so players can
+    // switch between them. A stream that is already running keeps the
+    // renditions it was started with, and one that is already part of a
+    // queued ladder is left to that ladder's transcode.
+    if (ladder.isEmpty() || (m_streamid == -1) ||
+        (m_status != kHLSStatusQueued))
+        return;
+
+    int mainid = FindLadder(m_streamid);
+    if (mainid == m_streamid)
+        m_renditions = s_ladders[mainid].renditions;
+    if (mainid != -1)
+        return;
+
+    for (int rung = next; rung < ladder.size(); ++rung)
+    {
+        HTTPLiveStream rendition(m_sourceFile, ladder[rung].width, 0,
+                                 ladder[rung].bitrate, m_audioBitrate,
+                                 m_maxSegments, m_segmentSize,
+                                 m_audioOnlyBitrate, m_sampleRate, false);
+
+        int streamid = rendition.GetStreamID();
+        if ((streamid != -1) && (streamid != m_streamid) &&
+            (rendition.m_status == kHLSStatusQueued) &&
+            (FindLadder(streamid) == -1))
+            m_renditions << streamid;
+    }
+
+    if (!m_renditions.isEmpty())
+    {
+        HTTPLiveStreamLadder &entry = s_ladders[m_streamid];
+        entry.renditions = m_renditions;
+        entry.launched   = false;
+    }
 }
 
 HTTPLiveStream::HTTPLiveStream(int streamid)
@@ -229,7 +459,7 @@ int HTTPLiveStream::AddStream(void)
     // jobs
     MSqlQuery query(MSqlQuery::InitCon());
     query.prepare(
-        "SELECT id FROM livestream "
+        "SELECT id, status FROM livestream "
         "WHERE "
         "(width = :WIDTH OR height = :HEIGHT) AND bitrate = :BITRATE AND "
         "audioonlybitrate = :AUDIOONLYBITRATE AND samplerate = :SAMPLERATE AND "
@@ -303,6 +533,9 @@ int HTTPLiveStream::AddStream(void)
         }
     }
 
+    else
+        m_status = (HTTPLiveStreamStatus)query.value(1).toInt();
+
     m_streamid = query.value(0).toUInt();
 
     return m_streamid;
@@ -396,7 +629,13 @@ QString HTTPLiveStream::GetMetaPlaylistName(void) const
     return outFile;
 }
 
-bool HTTPLiveStream::WriteMetaPlaylist(void)
+/** \brief Writes the meta playlist of the stream
+ *
+ *  \param renditions Other renditions of the same source to offer as
+ *                    variants of this stream.
+ */
+bool HTTPLiveStream::WriteMetaPlaylist(
+    const QList<HTTPLiveStream *> &renditions)
 {
     if (m_streamid == -1)
         return false;
@@ -419,6 +658,21 @@ bool HTTPLiveStream::WriteMetaPlaylist(void)
         ).arg((int)((m_bitrate + m_audioBitrate) * 1.1))
          .arg(m_outFileEncoded).toLatin1());
 
+    for (int i = 0; i < renditions.size(); ++i)
+    {
+        const HTTPLiveStream *rendition = renditions[i];
+
+        if (rendition == this || rendition->m_streamid == -1)
+            continue;
+
+        file.write(QString(
+            "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%1,RESOLUTION=%2x%3\n"
+            "%4.m3u8\n"
+            ).arg((int)((rendition->m_bitrate + rendition->m_audioBitrate) * 1.1))
+             .arg(rendition->m_width).arg(rendition->m_height)
+             .arg(rendition->m_outFileEncoded).toLatin1());
+    }
+
     if (m_audioOnlyBitrate)
     {
         file.write(QString(
@@ -770,6 +1024,18 @@ void HTTPLiveStream::SetOutputVars(void)
         m_httpPrefixRel = "";
 }
 
+/** \brief Stops writing the audio-only playlists of this stream
+ *
+ *  Used when the transcode doesn't produce the audio-only stream, so the
+ *  playlists don't list segments that will never exist.
+ */
+void HTTPLiveStream::DisableAudioOnly(void)
+{
+    m_audioOnlyBitrate = 0;
+    m_audioOutFile.clear();
+    m_audioOutFileEncoded.clear();
+}
+
 HTTPLiveStreamStatus HTTPLiveStream::GetDBStatus(void) const
 {
     if (m_streamid == -1)
@@ -819,13 +1085,40 @@ bool HTTPLiveStream::CheckStop(void)
 
 DTC::LiveStreamInfo *HTTPLiveStream::StartStream(void)
 {
-    if (GetDBStatus() != kHLSStatusQueued)
-        return GetLiveStreamInfo();
+    {
+        QMutexLocker locker(&s_ladderLock);
+
+        if (GetDBStatus() != kHLSStatusQueued)
+            return GetLiveStreamInfo();
+
+        // A rung of a ladder is encoded by the ladder's transcode, which
+        // is started once, whichever of its streams is asked for first
+        int streamid = GetStreamID();
+        QList<int> renditions = m_renditions;
+
+        int mainid = FindLadder(streamid);
+        if (mainid != -1)
+        {
+            HTTPLiveStreamLadder &entry = s_ladders[mainid];
+            if (entry.launched)
+                streamid = -1;
+            else
+            {
+                entry.launched = true;
+                streamid = mainid;
+                renditions = entry.renditions;
+            }
+        }
+
+        if (streamid != -1)
+        {
+            HTTPLiveStreamThread *streamThread =
+                new HTTPLiveStreamThread(streamid, renditions);
+            MThreadPool::globalInstance()->startReserved(streamThread,
+                                                         "HTTPLiveStream");
+        }
+    }
 
-    HTTPLiveStreamThread *streamThread =
-        new HTTPLiveStreamThread(GetStreamID());
-    MThreadPool::globalInstance()->startReserved(streamThread,
-                                                 "HTTPLiveStream");
     MythTimer statusTimer;
     int       delay = 250000;
     statusTimer.start();
@@ -2,6 +2,7 @@
 #define HTTPLIVESTREAM_H
 
 #include <QString>
+#include <QList>
 
 #include "datacontracts/liveStreamInfoList.h"
 
@@ -25,7 +26,8 @@ class MTV_PUBLIC HTTPLiveStream
     HTTPLiveStream(QString srcFile, uint16_t width = 640, uint16_t height = 480,
                    uint32_t bitrate = 800000, uint32_t abitrate = 64000,
                    uint16_t maxSegments = 0, uint16_t segmentSize = 10,
-                   uint32_t aobitrate = 32000, int32_t srate = -1);
+                   uint32_t aobitrate = 32000, int32_t srate = -1,
+                   bool useLadder = true);
     explicit HTTPLiveStream(int streamid);
    ~HTTPLiveStream();
 
@@ -40,6 +42,7 @@ class MTV_PUBLIC HTTPLiveStream
     uint32_t GetAudioOnlyBitrate(void) const { return m_audioOnlyBitrate; }
     uint16_t GetMaxSegments(void) const { return m_maxSegments; }
     QString  GetSourceFile(void) const { return m_sourceFile; }
+    QList<int> GetRenditions(void) const { return m_renditions; }
     QString  GetHTMLPageName(void) const;
     QString  GetMetaPlaylistName(void) const;
     QString  GetPlaylistName(bool audioOnly = false) const;
@@ -50,6 +53,7 @@ class MTV_PUBLIC HTTPLiveStream
         bool audioOnly = false, bool encoded = false) const;
 
     void SetOutputVars(void);
+    void DisableAudioOnly(void);
 
     HTTPLiveStreamStatus GetDBStatus(void) const;
 
@@ -57,7 +61,8 @@ class MTV_PUBLIC HTTPLiveStream
     bool     AddSegment(void);
 
     bool WriteHTML(void);
-    bool WriteMetaPlaylist(void);
+    bool WriteMetaPlaylist(
+        const QList<HTTPLiveStream *> &renditions = QList<HTTPLiveStream *>());
     bool WritePlaylist(bool audioOnly = false, bool writeEndTag = false);
 
     bool SaveSegmentInfo(void);
@@ -115,6 +120,8 @@ class MTV_PUBLIC HTTPLiveStream
     QString     m_statusMessage;
 
     HTTPLiveStreamStatus m_status;
+
+    QList<int>  m_renditions;
 };
 
 #endif
@@ -396,6 +396,8 @@ AvFormatDecoder::AvFormatDecoder(MythPlayer *parent,
       playerFlags(flags),
       video_codec_id(kCodec_NONE),
       maxkeyframedist(-1),
+      max_decode_threads(1),
+      threading_play_mode(kDecodePlayNormal),
       // Closed Caption & Teletext decoders
       ignore_scte(0),
       invert_scte_field(0),
@@ -804,6 +806,11 @@ void AvFormatDecoder::SeekReset(long long newKey, uint skipFrames,
         }
         if (private_dec)
             private_dec->Reset();
+
+        // The codec holds no reference frames now, so this is the
+        // cheapest point to switch threading for a new play mode.
+        if (threading_play_mode != decodePlayMode)
+            UpdateDecodeThreading();
     }
 
     // Discard all the queued up decoded frames
@@ -2474,12 +2481,22 @@ int AvFormatDecoder::ScanStreams(bool novideo)
             if (FlagIsSet(kDecodeSingleThreaded))
                 thread_count = 1;
 
+            max_decode_threads = HAVE_THREADS ? thread_count : 1;
+            threading_play_mode = decodePlayMode;
+            threading = DecoderThreadPolicy::Choose(
+                codec ? codec : codec1, width, height, threading_play_mode,
+                max_decode_threads);
+
             LOG(VB_PLAYBACK, LOG_INFO, LOC +
-                QString("Using %1 CPUs for decoding")
-                .arg(HAVE_THREADS ? thread_count : 1));
+                QString("Using up to %1 CPUs for decoding, %2")
+                .arg(max_decode_threads).arg(threading.toString()));
 
             if (HAVE_THREADS)
-                enc->thread_count = thread_count;
+            {
+                enc->thread_count = threading.thread_count;
+                if (threading.thread_type)
+                    enc->thread_type = threading.thread_type;
+            }
 
             InitVideoCodec(ic->streams[selTrack], enc, true);
 
@@ -2592,6 +2609,75 @@ bool AvFormatDecoder::OpenAVCodec(AVCodecContext *avctx, const AVCodec *codec)
     }
 }
 
+/** \fn AvFormatDecoder::SetTrickPlay(bool)
+ *  \brief Makes libavcodec drop non-keyframes while in trick play, so
+ *         that anything read past the keyframe is not decoded.
+ */
+void AvFormatDecoder::SetTrickPlay(bool enable)
+{
+    DecoderBase::SetTrickPlay(enable);
+
+    int index = selectedTrack[kTrackTypeVideo].av_stream_index;
+    if (!ic || index < 0)
+        return;
+
+    QMutexLocker locker(avcodeclock);
+    AVCodecContext *enc = ic->streams[index]->codec;
+    if (enc)
+        enc->skip_frame = enable ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+}
+
+/** \fn AvFormatDecoder::UpdateDecodeThreading(void)
+ *  \brief Re-opens the video codec when the current play mode calls for
+ *         different threading, e.g. slice-only threading while scrubbing.
+ *
+ *  libavcodec only honours thread_count and thread_type when a codec
+ *  is opened, so this must only be called right after the codec has
+ *  been flushed.
+ */
+void AvFormatDecoder::UpdateDecodeThreading(void)
+{
+    threading_play_mode = decodePlayMode;
+
+    int index = selectedTrack[kTrackTypeVideo].av_stream_index;
+    if (!HAVE_THREADS || !ic || index < 0 || max_decode_threads <= 1 ||
+        private_dec || !codec_is_std(video_codec_id))
+    {
+        return;
+    }
+
+    AVCodecContext *enc = ic->streams[index]->codec;
+    if (!enc || !enc->codec)
+        return;
+
+    QSize dim = get_video_dim(*enc);
+    DecoderThreadSettings wanted = DecoderThreadPolicy::Choose(
+        enc->codec, max(dim.width(), 16), max(dim.height(), 16),
+        threading_play_mode, max_decode_threads);
+    if (wanted == threading)
+        return;
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+        QString("Switching decoder threading from %1 to %2")
+        .arg(threading.toString()).arg(wanted.toString()));
+
+    QMutexLocker locker(avcodeclock);
+    const AVCodec *codec = enc->codec;
+    avcodec_close(enc);
+    enc->thread_count = wanted.thread_count;
+    if (wanted.thread_type)
+        enc->thread_type = wanted.thread_type;
+    if (!OpenAVCodec(enc, codec))
+    {
+        // Fall back to a single thread rather than losing video.
+        enc->thread_count = 1;
+        wanted = DecoderThreadSettings();
+        if (!OpenAVCodec(enc, codec))
+            return;
+    }
+    threading = wanted;
+}
+
 void AvFormatDecoder::UpdateFramesPlayed(void)
 {
     return DecoderBase::UpdateFramesPlayed();
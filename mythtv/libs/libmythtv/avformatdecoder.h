@@ -18,6 +18,7 @@
 #include "vbilut.h"
 #include "H264Parser.h"
 #include "videodisplayprofile.h"
+#include "decoderthreadpolicy.h"
 #include "mythplayer.h"
 
 extern "C" {
@@ -165,6 +166,7 @@ class AvFormatDecoder : public DecoderBase
     virtual void SetIdrOnlyKeyframes(bool value) {
         m_h264_parser->use_I_forKeyframes(!value);
     }
+    virtual void SetTrickPlay(bool enable);
 
     virtual int64_t NormalizeVideoTimecode(int64_t timecode);
     virtual int64_t NormalizeVideoTimecode(AVStream *st, int64_t timecode);
@@ -258,6 +260,7 @@ class AvFormatDecoder : public DecoderBase
     float normalized_fps(AVStream *stream, AVCodecContext *enc);
     void av_update_stream_timings_video(AVFormatContext *ic);
     bool OpenAVCodec(AVCodecContext *avctx, const AVCodec *codec);
+    void UpdateDecodeThreading(void);
 
     virtual void UpdateFramesPlayed(void);
     virtual bool DoRewindSeek(long long desiredFrame);
@@ -331,6 +334,12 @@ class AvFormatDecoder : public DecoderBase
 
     int maxkeyframedist;
 
+    /// Thread limit from the video display profile, 1 if threading is
+    /// not allowed for the selected decoder
+    uint                  max_decode_threads;
+    DecodePlayMode        threading_play_mode;
+    DecoderThreadSettings threading;
+
     // Caption/Subtitle/Teletext decoders
     uint             ignore_scte;
     uint             invert_scte_field;
@@ -255,11 +255,13 @@ int AVFormatWriter::WriteVideoFrame(VideoFrame *frame)
     av_init_packet(&pkt);
     pkt.data = NULL;
     pkt.size = 0;
-    {
-        QMutexLocker locker(avcodeclock);
-        ret = avcodec_encode_video2(m_videoStream->codec, &pkt,
-                                    m_picture, &got_pkt);
-    }
+
+    // The codec contexts belong to this writer and are only used from
+    // the caller's thread, so encoding does not need avcodeclock; taking
+    // it would keep the decoder (which holds it while decoding) and the
+    // encoder from running at the same time.
+    ret = avcodec_encode_video2(m_videoStream->codec, &pkt,
+                                m_picture, &got_pkt);
 
     if (ret < 0)
     {
@@ -368,11 +370,8 @@ int AVFormatWriter::WriteAudioFrame(unsigned char *buf, int fnum, long long &tim
 
     m_bufferedAudioFrameTimes.push_back(timecode);
 
-    {
-        QMutexLocker locker(avcodeclock);
-        ret = avcodec_encode_audio2(m_audioStream->codec, &pkt,
-                                    m_audPicture, &got_packet);
-    }
+    ret = avcodec_encode_audio2(m_audioStream->codec, &pkt,
+                                m_audPicture, &got_packet);
 
     if (ret < 0)
     {
@@ -1,5 +1,6 @@
 
 #include <algorithm>
+#include <cstdlib>
 using namespace std;
 
 #include "mythconfig.h"
@@ -35,7 +36,9 @@ DecoderBase::DecoderBase(MythPlayer *parent, const ProgramInfo &pginfo)
       m_positionMapLock(QMutex::Recursive),
       dontSyncPositionMap(false),
 
-      seeksnap(UINT64_MAX), livetv(false), watchingrecording(false),
+      seeksnap(UINT64_MAX), decodePlayMode(kDecodePlayNormal),
+      trickPlay(0), trickPlayFrame(0), trickPlayKey(-1),
+      livetv(false), watchingrecording(false),
 
       hasKeyFrameAdjustTable(false), lowbuffers(false),
       getrawframes(false), getrawvideo(false),
@@ -828,6 +831,114 @@ bool DecoderBase::DoFastForward(long long desiredFrame, bool discardFrames)
     return true;
 }
 
+/** \fn DecoderBase::CanTrickPlay(int) const
+ *  \brief Returns true if fast forward/rewind by step frames per displayed
+ *         frame can be done by decoding keyframes only.
+ *
+ *  This needs a position map, and is only worth it when each step
+ *  crosses at least one keyframe, otherwise most displayed frames
+ *  would repeat the previous keyframe.
+ */
+bool DecoderBase::CanTrickPlay(int step) const
+{
+    if (!ringBuffer || ringBuffer->IsDisc() || keyframedist <= 0)
+        return false;
+    if (abs(step) < keyframedist)
+        return false;
+    return GetPositionMapSize() > 1;
+}
+
+void DecoderBase::SetTrickPlay(bool enable)
+{
+    if (enable == (bool)trickPlay.loadAcquire())
+        return;
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+        QString("%1 keyframe-only trick play at frame %2")
+            .arg(enable ? "Starting" : "Stopping").arg(framesPlayed));
+
+    trickPlayFrame = framesPlayed;
+    trickPlayKey   = -1;
+    trickPlay.storeRelease(enable ? 1 : 0);
+}
+
+/** \fn DecoderBase::DoTrickPlayStep(int)
+ *  \brief Advances the trick play position by step frames and seeks
+ *         straight to the keyframe nearest to it.
+ *
+ *   Unlike DoFastForward() and DoRewind() no frames between keyframes
+ *   are decoded, the caller is expected to decode exactly one frame
+ *   after this returns. The unrounded position is kept separately so
+ *   that the average speed matches the requested one even though each
+ *   step is rounded to a keyframe.
+ *
+ *   Since the decoder is left just after a fully decoded keyframe,
+ *   normal decoding can resume from here without another seek.
+ *
+ *  \param step frames to advance, negative when rewinding.
+ *  \return false if there is no further keyframe in the position map
+ *          in that direction, in which case nothing was done.
+ */
+bool DecoderBase::DoTrickPlayStep(int step)
+{
+    if (!trickPlay.loadAcquire() || !ringBuffer)
+        return false;
+
+    long long target = max(trickPlayFrame + step, 0LL);
+    if (ConditionallyUpdatePosMap(target) < target)
+        return false;
+
+    int pre_idx, post_idx;
+    FindPosition(target, hasKeyFrameAdjustTable, pre_idx, post_idx);
+
+    PosMapEntry e;
+    {
+        QMutexLocker locker(&m_positionMapLock);
+        int size = m_positionMap.size();
+        if (!size)
+            return false;
+
+        int idx = pre_idx;
+        if (GetKey(m_positionMap[post_idx]) - target <
+            target - GetKey(m_positionMap[pre_idx]))
+        {
+            idx = post_idx;
+        }
+
+        // Always make progress in the direction of play
+        if (trickPlayKey >= 0)
+        {
+            while (step > 0 && idx + 1 < size &&
+                   GetKey(m_positionMap[idx]) <= trickPlayKey)
+            {
+                idx++;
+            }
+            while (step < 0 && idx > 0 &&
+                   GetKey(m_positionMap[idx]) >= trickPlayKey)
+            {
+                idx--;
+            }
+        }
+
+        e = m_positionMap[idx];
+    }
+
+    long long key = GetKey(e);
+    if (e.pos < 0 || key == trickPlayKey)
+        return false;
+
+    trickPlayFrame = target;
+    trickPlayKey   = key;
+
+    ringBuffer->Seek(e.pos, SEEK_SET);
+    lastKey      = key;
+    framesPlayed = key;
+    framesRead   = key;
+    SeekReset(lastKey, 0, true, false);
+
+    return true;
+}
+
 /** \fn DecoderBase::DoFastForwardSeek(long long,bool&)
  *  \brief Seeks to the keyframe just before the desiredFrame if exact
  *         seeks  is enabled, or the frame just after it if exact seeks
@@ -4,6 +4,8 @@
 #include <stdint.h>
 
 #include <vector>
+
+#include <QAtomicInt>
 using namespace std;
 
 #include "ringbuffer.h"
@@ -51,6 +53,14 @@ typedef enum DecodeTypes
     kDecodeAV      = 0x03,
 } DecodeType;
 
+/// Play modes the decoder tunes itself for, see DecoderThreadPolicy
+typedef enum DecodePlayModes
+{
+    kDecodePlayNormal = 0,
+    kDecodePlayFFRew,      // Fast forward or rewind, seeks on every frame
+    kDecodePlayEdit,       // Cutlist editor, scrubbing
+} DecodePlayMode;
+
 typedef enum AudioTrackType
 {
     kAudioTypeNormal = 0,
@@ -143,6 +153,9 @@ class DecoderBase
     void SetSeekSnap(uint64_t snap)  { seeksnap = snap; }
     uint64_t GetSeekSnap(void) const { return seeksnap;  }
     void SetLiveTVMode(bool live)  { livetv = live;      }
+    /// Takes effect on the next flushing seek
+    void SetDecodePlayMode(DecodePlayMode mode) { decodePlayMode = mode; }
+    DecodePlayMode GetDecodePlayMode(void) const { return decodePlayMode; }
 
     // Must be done while player is paused.
     void SetProgramInfo(const ProgramInfo &pginfo);
@@ -166,6 +179,13 @@ class DecoderBase
     virtual bool DoFastForward(long long desiredFrame, bool doflush = true);
     virtual void SetIdrOnlyKeyframes(bool /*value*/) { }
 
+    // Keyframe-only trick play, must be called from the decoder thread
+    bool CanTrickPlay(int step) const;
+    virtual void SetTrickPlay(bool enable);
+    /// Safe to call from any thread, e.g. the UI thread changing speed
+    bool IsTrickPlaying(void) const { return trickPlay.loadAcquire(); }
+    bool DoTrickPlayStep(int step);
+
     static uint64_t
         TranslatePositionAbsToRel(const frm_dir_map_t &deleteMap,
                                   uint64_t absPosition,
@@ -334,6 +354,11 @@ class DecoderBase
     mutable QDateTime m_lastPositionMapUpdate; // guarded by m_positionMapLock
 
     uint64_t seeksnap;
+    DecodePlayMode decodePlayMode;
+
+    QAtomicInt trickPlay;     ///< written by the decoder thread only
+    long long trickPlayFrame; ///< unrounded trick play position
+    long long trickPlayKey;   ///< keyframe last decoded in trick play
     bool livetv;
     bool watchingrecording;
 
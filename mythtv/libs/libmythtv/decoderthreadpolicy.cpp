@@ -0,0 +1,64 @@
+#include <algorithm>
+using namespace std;
+
+#include "decoderthreadpolicy.h"
+
+QString DecoderThreadSettings::toString(void) const
+{
+    QString type;
+    if (thread_count <= 1)
+        type = "none";
+    else if (thread_type & FF_THREAD_FRAME)
+        type = (thread_type & FF_THREAD_SLICE) ? "frame+slice" : "frame";
+    else if (thread_type & FF_THREAD_SLICE)
+        type = "slice";
+    else
+        type = "none";
+    return QString("%1 thread(s), %2 threading").arg(thread_count).arg(type);
+}
+
+/** \fn DecoderThreadPolicy::ThreadsForSize(uint, uint, bool)
+ *  \brief Returns the number of threads worth using for a frame size.
+ *
+ *  With low_latency set the numbers assume slice threading, where
+ *  broadcast streams rarely carry more than a handful of slices per
+ *  picture, so adding threads beyond that only adds overhead.
+ */
+uint DecoderThreadPolicy::ThreadsForSize(uint width, uint height,
+                                         bool low_latency)
+{
+    uint pixels = width * height;
+
+    if (pixels <= 720 * 576)
+        return 2;
+    if (pixels <= 1280 * 720)
+        return low_latency ? 2 : 4;
+    if (pixels <= 1920 * 1088)
+        return low_latency ? 4 : 6;
+    return low_latency ? 8 : 16;
+}
+
+DecoderThreadSettings DecoderThreadPolicy::Choose(const AVCodec *codec,
+                                                  uint width, uint height,
+                                                  DecodePlayMode mode,
+                                                  uint max_threads)
+{
+    if (!codec || max_threads <= 1)
+        return DecoderThreadSettings();
+
+    bool frame_ok = codec->capabilities & AV_CODEC_CAP_FRAME_THREADS;
+    bool slice_ok = codec->capabilities & AV_CODEC_CAP_SLICE_THREADS;
+    bool low_latency = (kDecodePlayNormal != mode);
+
+    if (low_latency)
+        frame_ok = false;
+
+    if (!frame_ok && !slice_ok)
+        return DecoderThreadSettings();
+
+    int count = min(max_threads, ThreadsForSize(width, height, low_latency));
+    int type  = (frame_ok ? FF_THREAD_FRAME : 0) |
+                (slice_ok ? FF_THREAD_SLICE : 0);
+
+    return DecoderThreadSettings(max(count, 1), type);
+}
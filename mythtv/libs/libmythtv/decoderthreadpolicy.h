@@ -0,0 +1,61 @@
+#ifndef DECODERTHREADPOLICY_H
+#define DECODERTHREADPOLICY_H
+
+#include <QString>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include "decoderbase.h"
+
+/** \class DecoderThreadSettings
+ *  \brief The libavcodec threading configuration chosen for a video stream.
+ */
+class DecoderThreadSettings
+{
+  public:
+    DecoderThreadSettings() : thread_count(1), thread_type(0) {}
+    DecoderThreadSettings(int count, int type) :
+        thread_count(count), thread_type(type) {}
+
+    bool operator==(const DecoderThreadSettings &o) const
+    {
+        return ((thread_count == o.thread_count) &&
+                (thread_type  == o.thread_type));
+    }
+    bool operator!=(const DecoderThreadSettings &o) const
+        { return !(*this == o); }
+
+    QString toString(void) const;
+
+    int thread_count;
+    int thread_type; ///< FF_THREAD_FRAME and/or FF_THREAD_SLICE
+};
+
+/** \class DecoderThreadPolicy
+ *  \brief Picks software decoder threading from codec, resolution and
+ *         the current play mode.
+ *
+ *  Frame threading gives the best throughput but delays every decoded
+ *  frame by (thread_count - 1) frames and needs that many frames of
+ *  reference state to refill after a flush.  That is fine for normal
+ *  playback, but while fast forwarding, rewinding or scrubbing in the
+ *  cutlist editor every seek pays that latency, so those modes use
+ *  slice threading only.  Small frames do not split usefully across
+ *  many threads, so the thread count is scaled by frame size and
+ *  capped by the video display profile's maximum CPU setting.
+ */
+class DecoderThreadPolicy
+{
+  public:
+    static DecoderThreadSettings Choose(const AVCodec *codec,
+                                        uint width, uint height,
+                                        DecodePlayMode mode,
+                                        uint max_threads);
+
+  private:
+    static uint ThreadsForSize(uint width, uint height, bool low_latency);
+};
+
+#endif // DECODERTHREADPOLICY_H
@@ -1,5 +1,6 @@
 // C++ headers
 #include <algorithm>
+#include <climits>
 
 // MythTV headers
 #include "eitfixup.h"
@@ -44,6 +45,196 @@ const QString shortEp = "(\\d+)\\s*(?:/|of)\\s*(\\d+)";
 const QString shortContext =
         QString("(?:^|\\.)(\\s*\\(*\\s*%1[\\s)]*(?:[).:]|$))").arg(shortEp);
 
+/*------------------------------------------------------------------------
+ * Literal prefilter for the fixup regular expressions
+ *------------------------------------------------------------------------*/
+
+static QStringList literals_alternation(const QString &pattern, int &pos);
+
+/// Skips a quantifier at \a pos, returns the minimum repeat count (1 if none)
+static int literals_quantifier(const QString &pattern, int &pos, bool &found)
+{
+    found = false;
+    if (pos >= pattern.length())
+        return 1;
+
+    int min = 1;
+    QChar c = pattern[pos];
+    if (c == '?' || c == '*')
+    {
+        min = 0;
+        ++pos;
+    }
+    else if (c == '+')
+    {
+        ++pos;
+    }
+    else if (c == '{')
+    {
+        int end = pattern.indexOf('}', pos);
+        if (end < 0)
+            return 1;
+        min = pattern.mid(pos + 1, end - pos - 1).section(',', 0, 0).toInt();
+        pos = end + 1;
+    }
+    else
+    {
+        return 1;
+    }
+
+    found = true;
+    if (pos < pattern.length() && pattern[pos] == '?')
+        ++pos;
+    return min;
+}
+
+/// True if literal set \a a is a better prefilter than \a b
+static bool literals_better(const QStringList &a, const QStringList &b)
+{
+    if (a.isEmpty())
+        return false;
+    if (b.isEmpty())
+        return true;
+
+    int mina = INT_MAX, minb = INT_MAX;
+    for (int i = 0; i < a.size(); ++i)
+        mina = std::min(mina, a[i].length());
+    for (int i = 0; i < b.size(); ++i)
+        minb = std::min(minb, b[i].length());
+
+    return (mina > minb) || (mina == minb && a.size() < b.size());
+}
+
+/** Scans one branch of an alternation, up to an unmatched '|' or ')'.
+ *  Every run of plain characters and every group that has to match is a
+ *  candidate, the one with the longest shortest literal is returned.
+ */
+static QStringList literals_sequence(const QString &pattern, int &pos)
+{
+    QStringList best;
+    QString run;
+    bool quantified;
+
+    while (pos < pattern.length() &&
+           pattern[pos] != '|' && pattern[pos] != ')')
+    {
+        QChar c = pattern[pos];
+
+        if (c == '(')
+        {
+            bool zeroWidth = false;
+            ++pos;
+            if (pattern.mid(pos, 2) == "?:")
+            {
+                pos += 2;
+            }
+            else if (pattern.mid(pos, 2) == "?=" || pattern.mid(pos, 2) == "?!")
+            {
+                zeroWidth = true;
+                pos += 2;
+            }
+            QStringList group = literals_alternation(pattern, pos);
+            if (pos < pattern.length())
+                ++pos; // ')'
+
+            if (!run.isEmpty() && literals_better(QStringList(run), best))
+                best = QStringList(run);
+            run.clear();
+
+            int min = literals_quantifier(pattern, pos, quantified);
+            if (!zeroWidth && min > 0 && literals_better(group, best))
+                best = group;
+            continue;
+        }
+
+        bool literal = true;
+        if (c == '[')
+        {
+            // Character class, skip to its end
+            ++pos;
+            if (pos < pattern.length() && pattern[pos] == '^')
+                ++pos;
+            if (pos < pattern.length() && pattern[pos] == ']')
+                ++pos;
+            while (pos < pattern.length() && pattern[pos] != ']')
+                pos += (pattern[pos] == '\\') ? 2 : 1;
+            ++pos;
+            literal = false;
+        }
+        else if (c == '\\')
+        {
+            pos += 2;
+            if (pos > pattern.length())
+                break;
+            c = pattern[pos - 1];
+            if (c == 'n')
+                c = '\n';
+            else if (c == 't')
+                c = '\t';
+            else if (c == 'r')
+                c = '\r';
+            else if (c.isLetterOrNumber())
+                literal = false; // \s, \d, \b, back references...
+        }
+        else
+        {
+            ++pos;
+            literal = !(c == '.' || c == '^' || c == '$' ||
+                        c == '?' || c == '*' || c == '+' || c == '{');
+        }
+
+        int min = literals_quantifier(pattern, pos, quantified);
+        if (literal && min > 0)
+            run += c;
+        if (!literal || quantified)
+        {
+            if (!run.isEmpty() && literals_better(QStringList(run), best))
+                best = QStringList(run);
+            run.clear();
+        }
+    }
+
+    if (!run.isEmpty() && literals_better(QStringList(run), best))
+        best = QStringList(run);
+
+    return best;
+}
+
+/// Scans the branches of an alternation, all of them need a literal
+static QStringList literals_alternation(const QString &pattern, int &pos)
+{
+    QStringList literals;
+    bool complete = true;
+
+    while (true)
+    {
+        QStringList branch = literals_sequence(pattern, pos);
+        if (branch.isEmpty())
+            complete = false;
+        literals += branch;
+
+        if (pos >= pattern.length() || pattern[pos] != '|')
+            break;
+        ++pos;
+    }
+
+    if (!complete)
+        literals.clear();
+    literals.removeDuplicates();
+    return literals;
+}
+
+EITRegExp::EITRegExp(const QString &pattern, Qt::CaseSensitivity cs)
+    : QRegExp(pattern, cs)
+{
+    int pos = 0;
+    m_literals = literals_alternation(pattern, pos);
+
+    // An unbalanced ')' means the pattern was not understood
+    if (pos < pattern.length())
+        m_literals.clear();
+}
+
 
 EITFixUp::EITFixUp()
     : m_bellYear("[\\(]{1}[0-9]{4}[\\)]{1}"),
@@ -195,6 +386,10 @@ EITFixUp::EITFixUp()
       m_AUFreeviewY("(.*) \\(([12][0-9][0-9][0-9])\\)$"),
       m_AUFreeviewYC("(.*) \\(([12][0-9][0-9][0-9])\\) \\((.+)\\)$"),
       m_AUFreeviewSYC("(.*) \\((.+)\\) \\(([12][0-9][0-9][0-9])\\) \\((.+)\\)$"),
+      m_AUNineRating("\\((G|PG|M|MA)\\)"),
+      m_AUSevenYear("(\\d{4})$"),
+      m_AUSevenAdvisories("(\\([A-Z,]+\\))$"),
+      m_AUSevenRating("(C|G|PG|M|MA)$"),
       m_HTML("</?EM>", Qt::CaseInsensitive),
       m_grReplay("\\([ΕE]\\)"),
       m_grDescriptionFinale("\\s*Τελευταίο\\sΕπεισόδιο\\.\\s*"),
@@ -240,6 +435,7 @@ EITFixUp::EITFixUp()
       m_grCategSciFi("(?:\\W)?(επιστ(.|ημονικ[ηή]ς)\\s?φαντασ[ιί]ας)(?:\\W)?",Qt::CaseInsensitive),
       m_grCategHealth("(?:\\W)?(υγε[ιί]α|υγειιν|ιατρικ|διατροφ)(?:\\W)?",Qt::CaseInsensitive),
       m_grCategSpecial("(?:\\W)?(αφι[εέ]ρωμα)(?:\\W)?",Qt::CaseInsensitive),
+      m_grMovie("\\bταιν[ιί]α\\b",Qt::CaseInsensitive),
       m_unitymediaImdbrating("\\s*IMDb Rating: (\\d\\.\\d)\\s?/10$")
 {
 }
@@ -502,7 +698,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // See if a year is present as (xxxx)
-    position = event.description.indexOf(m_bellYear);
+    position = m_bellYear.IndexIn(event.description);
     if (position != -1 && !event.category.isEmpty())
     {
         tmp = "";
@@ -541,7 +737,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Check for (Stereo) in the decription and set the <audio> tags
-    position = event.description.indexOf(m_Stereo);
+    position = m_Stereo.IndexIn(event.description);
     if (position != -1)
     {
         event.audioProps |= AUD_STEREO;
@@ -549,7 +745,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Check for "title (All Day, HD)" in the title
-    position = event.title.indexOf(m_bellPPVTitleAllDayHD);
+    position = m_bellPPVTitleAllDayHD.IndexIn(event.title);
     if (position != -1)
     {
         event.title = event.title.replace(m_bellPPVTitleAllDayHD, "");
@@ -557,14 +753,14 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
      }
 
     // Check for "title (All Day)" in the title
-    position = event.title.indexOf(m_bellPPVTitleAllDay);
+    position = m_bellPPVTitleAllDay.IndexIn(event.title);
     if (position != -1)
     {
         event.title = event.title.replace(m_bellPPVTitleAllDay, "");
     }
 
     // Check for "HD - title" in the title
-    position = event.title.indexOf(m_bellPPVTitleHD);
+    position = m_bellPPVTitleHD.IndexIn(event.title);
     if (position != -1)
     {
         event.title = event.title.replace(m_bellPPVTitleHD, "");
@@ -588,7 +784,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Check for HD at the end of the title
-    position = event.title.indexOf(m_dishPPVTitleHD);
+    position = m_dishPPVTitleHD.IndexIn(event.title);
     if (position != -1)
     {
         event.title = event.title.replace(m_dishPPVTitleHD, "");
@@ -613,14 +809,14 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Remove any trailing colon in title
-    position = event.title.indexOf(m_dishPPVTitleColon);
+    position = m_dishPPVTitleColon.IndexIn(event.title);
     if (position != -1)
     {
         event.title = event.title.replace(m_dishPPVTitleColon, "");
     }
 
     // Remove New at the end of the description
-    position = event.description.indexOf(m_dishDescriptionNew);
+    position = m_dishDescriptionNew.IndexIn(event.description);
     if (position != -1)
     {
         event.previouslyshown = false;
@@ -628,7 +824,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Remove Series Finale at the end of the desciption
-    position = event.description.indexOf(m_dishDescriptionFinale);
+    position = m_dishDescriptionFinale.IndexIn(event.description);
     if (position != -1)
     {
         event.previouslyshown = false;
@@ -636,7 +832,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Remove Series Finale at the end of the desciption
-    position = event.description.indexOf(m_dishDescriptionFinale2);
+    position = m_dishDescriptionFinale2.IndexIn(event.description);
     if (position != -1)
     {
         event.previouslyshown = false;
@@ -644,7 +840,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Remove Series Premiere at the end of the description
-    position = event.description.indexOf(m_dishDescriptionPremiere);
+    position = m_dishDescriptionPremiere.IndexIn(event.description);
     if (position != -1)
     {
         event.previouslyshown = false;
@@ -652,7 +848,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Remove Series Premiere at the end of the description
-    position = event.description.indexOf(m_dishDescriptionPremiere2);
+    position = m_dishDescriptionPremiere2.IndexIn(event.description);
     if (position != -1)
     {
         event.previouslyshown = false;
@@ -660,7 +856,7 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Remove Dish's PPV code at the end of the description
-    QRegExp ppvcode = m_dishPPVCode;
+    EITRegExp ppvcode = m_dishPPVCode;
     ppvcode.setCaseSensitivity(Qt::CaseInsensitive);
     position = event.description.indexOf(ppvcode);
     if (position != -1)
@@ -669,35 +865,35 @@ void EITFixUp::FixBellExpressVu(DBEventEIT &event) const
     }
 
     // Remove trailing garbage
-    position = event.description.indexOf(m_dishPPVSpacePerenEnd);
+    position = m_dishPPVSpacePerenEnd.IndexIn(event.description);
     if (position != -1)
     {
         event.description = event.description.replace(m_dishPPVSpacePerenEnd, "");
     }
 
     // Check for subtitle "All Day (... Eastern)" in the subtitle
-    position = event.subtitle.indexOf(m_bellPPVSubtitleAllDay);
+    position = m_bellPPVSubtitleAllDay.IndexIn(event.subtitle);
     if (position != -1)
     {
         event.subtitle = event.subtitle.replace(m_bellPPVSubtitleAllDay, "");
     }
 
     // Check for description "(... Eastern)" in the description
-    position = event.description.indexOf(m_bellPPVDescriptionAllDay);
+    position = m_bellPPVDescriptionAllDay.IndexIn(event.description);
     if (position != -1)
     {
         event.description = event.description.replace(m_bellPPVDescriptionAllDay, "");
     }
 
     // Check for description "(... ET)" in the description
-    position = event.description.indexOf(m_bellPPVDescriptionAllDay2);
+    position = m_bellPPVDescriptionAllDay2.IndexIn(event.description);
     if (position != -1)
     {
         event.description = event.description.replace(m_bellPPVDescriptionAllDay2, "");
     }
 
     // Check for description "(nnnnn)" in the description
-    position = event.description.indexOf(m_bellPPVDescriptionEventId);
+    position = m_bellPPVDescriptionEventId.IndexIn(event.description);
     if (position != -1)
     {
         event.description = event.description.replace(m_bellPPVDescriptionEventId, "");
@@ -775,7 +971,7 @@ void EITFixUp::SetUKSubtitle(DBEventEIT &event) const
              fColon = true;
          }
     }
-    QRegExp tmpQuotedSubtitle = m_ukQuotedSubtitle;
+    EITRegExp tmpQuotedSubtitle = m_ukQuotedSubtitle;
     if (tmpQuotedSubtitle.indexIn(event.description) != -1)
     {
         event.subtitle = tmpQuotedSubtitle.cap(1);
@@ -846,29 +1042,29 @@ void EITFixUp::FixUK(DBEventEIT &event) const
     bool isMovie = event.category.startsWith("Movie",Qt::CaseInsensitive) ||
                    event.category.startsWith("Film",Qt::CaseInsensitive);
     // BBC three case (could add another record here ?)
-    event.description = event.description.remove(m_ukThen);
-    event.description = event.description.remove(m_ukNew);
-    event.title = event.title.remove(m_ukNewTitle);
+    m_ukThen.RemoveFrom(event.description);
+    m_ukNew.RemoveFrom(event.description);
+    m_ukNewTitle.RemoveFrom(event.title);
 
     // Removal of Class TV, CBBC and CBeebies etc..
-    event.title = event.title.remove(m_ukTitleRemove);
-    event.description = event.description.remove(m_ukDescriptionRemove);
+    m_ukTitleRemove.RemoveFrom(event.title);
+    m_ukDescriptionRemove.RemoveFrom(event.description);
 
     // Removal of BBC FOUR and BBC THREE
-    event.description = event.description.remove(m_ukBBC34);
+    m_ukBBC34.RemoveFrom(event.description);
 
     // BBC 7 [Rpt of ...] case.
-    event.description = event.description.remove(m_ukBBC7rpt);
+    m_ukBBC7rpt.RemoveFrom(event.description);
 
     // "All New To 4Music!
-    event.description = event.description.remove(m_ukAllNew);
+    m_ukAllNew.RemoveFrom(event.description);
 
     // Removal of 'Also in HD' text
- 	event.description = event.description.remove(m_ukAlsoInHD);
+    m_ukAlsoInHD.RemoveFrom(event.description);
 
     // Remove [AD,S] etc.
     bool    ccMatched = false;
-    QRegExp tmpCC = m_ukCC;
+    EITRegExp tmpCC = m_ukCC;
     position1 = 0;
     while ((position1 = tmpCC.indexIn(event.description, position1)) != -1)
     {
@@ -897,7 +1093,7 @@ void EITFixUp::FixUK(DBEventEIT &event) const
     // Work out the season and episode numbers (if any)
     // Matching pattern "Season 2 Episode|Ep 3 of 14|3/14" etc
     bool    series  = false;
-    QRegExp tmpSeries = m_ukSeries;
+    EITRegExp tmpSeries = m_ukSeries;
     if ((position1 = tmpSeries.indexIn(event.title)) != -1
             || (position2 = tmpSeries.indexIn(event.description)) != -1)
     {
@@ -960,7 +1156,7 @@ void EITFixUp::FixUK(DBEventEIT &event) const
 
     // Multi-part episodes, or films (e.g. ITV film split by news)
     // Matches Part 1, Pt 1/2, Part 1 of 2 etc.
-    QRegExp tmpPart = m_ukPart;
+    EITRegExp tmpPart = m_ukPart;
     if ((position1 = tmpPart.indexIn(event.title)) != -1)
     {
         event.partnumber = tmpPart.cap(1).toUInt();
@@ -991,7 +1187,7 @@ void EITFixUp::FixUK(DBEventEIT &event) const
         }
     }
 
-    QRegExp tmpStarring = m_ukStarring;
+    EITRegExp tmpStarring = m_ukStarring;
     if (tmpStarring.indexIn(event.description) != -1)
     {
         // if we match this we've captured 2 actors and an (optional) airdate
@@ -1009,18 +1205,18 @@ void EITFixUp::FixUK(DBEventEIT &event) const
         }
     }
 
-    QRegExp tmp24ep = m_uk24ep;
+    EITRegExp tmp24ep = m_uk24ep;
     if (!event.title.startsWith("CSI:") && !event.title.startsWith("CD:") &&
         !event.title.contains(m_ukLaONoSplit) &&
         !event.title.startsWith("Mission: Impossible"))
     {
-        if (((position1=event.title.indexOf(m_ukDoubleDotEnd)) != -1) &&
-            ((position2=event.description.indexOf(m_ukDoubleDotStart)) != -1))
+        if (((position1=m_ukDoubleDotEnd.IndexIn(event.title)) != -1) &&
+            ((position2=m_ukDoubleDotStart.IndexIn(event.description)) != -1))
         {
             QString strPart=event.title.remove(m_ukDoubleDotEnd)+" ";
             strFull = strPart + event.description.remove(m_ukDoubleDotStart);
             if (isMovie &&
-                ((position1 = strFull.indexOf(m_ukCEPQ,strPart.length())) != -1))
+                ((position1 = m_ukCEPQ.IndexIn(strFull, strPart.length())) != -1))
             {
                  if (strFull[position1] == '!' || strFull[position1] == '?'
                   || (position1>2 && strFull[position1] == '.' && strFull[position1-2] == '.'))
@@ -1029,7 +1225,7 @@ void EITFixUp::FixUK(DBEventEIT &event) const
                  event.description = strFull.mid(position1 + 1);
                  event.description.remove(m_ukSpaceStart);
             }
-            else if ((position1 = strFull.indexOf(m_ukCEPQ)) != -1)
+            else if ((position1 = m_ukCEPQ.IndexIn(strFull)) != -1)
             {
                  if (strFull[position1] == '!' || strFull[position1] == '?'
                   || (position1>2 && strFull[position1] == '.' && strFull[position1-2] == '.'))
@@ -1039,7 +1235,7 @@ void EITFixUp::FixUK(DBEventEIT &event) const
                  event.description.remove(m_ukSpaceStart);
                  SetUKSubtitle(event);
             }
-            if ((position1 = strFull.indexOf(m_ukYear)) != -1)
+            if ((position1 = m_ukYear.IndexIn(strFull)) != -1)
             {
                 // Looks like they are using the airdate as a delimiter
                 if ((uint)position1 < SUBTITLE_MAX_LEN)
@@ -1057,14 +1253,14 @@ void EITFixUp::FixUK(DBEventEIT &event) const
                                 tmp24ep.cap(0).length() - 2);
             event.description = event.description.remove(tmp24ep.cap(0));
         }
-        else if ((position1 = event.description.indexOf(m_ukTime)) == -1)
+        else if ((position1 = m_ukTime.IndexIn(event.description)) == -1)
         {
-            if (!isMovie && (event.title.indexOf(m_ukYearColon) < 0))
+            if (!isMovie && (m_ukYearColon.IndexIn(event.title) < 0))
             {
                 if (((position1 = event.title.indexOf(":")) != -1) &&
                     (event.description.indexOf(":") < 0 ))
                 {
-                    if (event.title.mid(position1+1).indexOf(m_ukCompleteDots)==0)
+                    if (m_ukCompleteDots.IndexIn(event.title.mid(position1+1))==0)
                     {
                         SetUKSubtitle(event);
                         QString strTmp = event.title.mid(position1+1);
@@ -1086,9 +1282,9 @@ void EITFixUp::FixUK(DBEventEIT &event) const
     if (!isMovie && event.subtitle.isEmpty() &&
         !event.title.startsWith("The X-Files"))
     {
-        if ((position1=event.description.indexOf(m_ukTime)) != -1)
+        if ((position1=m_ukTime.IndexIn(event.description)) != -1)
         {
-            position2 = event.description.indexOf(m_ukColonPeriod);
+            position2 = m_ukColonPeriod.IndexIn(event.description);
             if ((position2>=0) && (position2 < (position1-2)))
                 SetUKSubtitle(event);
         }
@@ -1106,7 +1302,7 @@ void EITFixUp::FixUK(DBEventEIT &event) const
     }
 
     // Work out the year (if any)
-    QRegExp tmpUKYear = m_ukYear;
+    EITRegExp tmpUKYear = m_ukYear;
     if ((position1 = tmpUKYear.indexIn(event.description)) != -1)
     {
         QString stmp = event.description;
@@ -1122,7 +1318,7 @@ void EITFixUp::FixUK(DBEventEIT &event) const
     }
 
     // Trim leading/trailing '.'
-    event.subtitle.remove(m_ukDotSpaceStart);
+    m_ukDotSpaceStart.RemoveFrom(event.subtitle);
     if (event.subtitle.lastIndexOf("..") != (((int)event.subtitle.length())-2))
         event.subtitle.remove(m_ukDotEnd);
 
@@ -1167,8 +1363,8 @@ void EITFixUp::FixComHem(DBEventEIT &event, bool process_subtitle) const
     bool isSeries = false;
     // Try to find episode numbers
     int pos;
-    QRegExp tmpSeries1 = m_comHemSeries1;
-    QRegExp tmpSeries2 = m_comHemSeries2;
+    EITRegExp tmpSeries1 = m_comHemSeries1;
+    EITRegExp tmpSeries2 = m_comHemSeries2;
     if ((pos = tmpSeries2.indexIn(event.title)) != -1)
     {
         QStringList list = tmpSeries2.capturedTexts();
@@ -1206,7 +1402,7 @@ void EITFixUp::FixComHem(DBEventEIT &event, bool process_subtitle) const
     }
 
     // Move subtitle info from title to subtitle
-    QRegExp tmpTSub = m_comHemTSub;
+    EITRegExp tmpTSub = m_comHemTSub;
     if (tmpTSub.indexIn(event.title) != -1)
     {
         event.subtitle = tmpTSub.cap(1);
@@ -1219,7 +1415,7 @@ void EITFixUp::FixComHem(DBEventEIT &event, bool process_subtitle) const
 
     // Try to find country category, year and possibly other information
     // from the begining of the description
-    QRegExp tmpCountry = m_comHemCountry;
+    EITRegExp tmpCountry = m_comHemCountry;
     pos = tmpCountry.indexIn(event.description);
     if (pos != -1)
     {
@@ -1285,15 +1481,15 @@ void EITFixUp::FixComHem(DBEventEIT &event, bool process_subtitle) const
         event.categoryType = ProgramInfo::kCategorySeries;
 
     // Look for additional persons in the description
-    QRegExp tmpPersons = m_comHemPersons;
+    EITRegExp tmpPersons = m_comHemPersons;
     while(pos = tmpPersons.indexIn(event.description),pos!=-1)
     {
         DBPerson::Role role;
         QStringList list = tmpPersons.capturedTexts();
 
-        QRegExp tmpDirector = m_comHemDirector;
-        QRegExp tmpActor = m_comHemActor;
-        QRegExp tmpHost = m_comHemHost;
+        EITRegExp tmpDirector = m_comHemDirector;
+        EITRegExp tmpActor = m_comHemActor;
+        EITRegExp tmpHost = m_comHemHost;
         if (tmpDirector.indexIn(list[1])!=-1)
         {
             role = DBPerson::kDirector;
@@ -1328,7 +1524,7 @@ void EITFixUp::FixComHem(DBEventEIT &event, bool process_subtitle) const
     // shorter than 55 characters or we risk picking up the wrong thing.
     if (process_subtitle)
     {
-        int pos = event.description.indexOf(m_comHemSub);
+        int pos = m_comHemSub.IndexIn(event.description);
         bool pvalid = pos != -1 && pos <= 55;
         if (pvalid && (event.description.length() - (pos + 2)) > 0)
         {
@@ -1339,14 +1535,14 @@ void EITFixUp::FixComHem(DBEventEIT &event, bool process_subtitle) const
     }
 
     // Teletext subtitles?
-    int position = event.description.indexOf(m_comHemTT);
+    int position = m_comHemTT.IndexIn(event.description);
     if (position != -1)
     {
         event.subtitleType |= SUB_NORMAL;
     }
 
     // Try to findout if this is a rerun and if so the date.
-    QRegExp tmpRerun1 = m_comHemRerun1;
+    EITRegExp tmpRerun1 = m_comHemRerun1;
     if (tmpRerun1.indexIn(event.description) == -1)
         return;
 
@@ -1366,7 +1562,7 @@ void EITFixUp::FixComHem(DBEventEIT &event, bool process_subtitle) const
     }
 
     // Rerun with day, month and possibly year specified
-    QRegExp tmpRerun2 = m_comHemRerun2;
+    EITRegExp tmpRerun2 = m_comHemRerun2;
     if (tmpRerun2.indexIn(list[1]) != -1)
     {
         QStringList datelist = tmpRerun2.capturedTexts();
@@ -1437,7 +1633,7 @@ void EITFixUp::FixAUDescription(DBEventEIT &event) const
  */
 void EITFixUp::FixAUNine(DBEventEIT &event) const
 {
-    QRegExp rating("\\((G|PG|M|MA)\\)");
+    EITRegExp rating = m_AUNineRating;
     if (rating.indexIn(event.description) == 0)
     {
       EventRating prograting;
@@ -1473,7 +1669,7 @@ void EITFixUp::FixAUSeven(DBEventEIT &event) const
         event.previouslyshown = true;
         event.description.resize(event.description.size()-4);
     }
-    QRegExp year("(\\d{4})$");
+    EITRegExp year = m_AUSevenYear;
     if (year.indexIn(event.description) != -1)
     {
         event.airdate = year.cap(3).toUInt();
@@ -1485,13 +1681,13 @@ void EITFixUp::FixAUSeven(DBEventEIT &event) const
       event.description.resize(event.description.size()-3);
     }
     QString advisories;//store the advisories to append later
-    QRegExp adv("(\\([A-Z,]+\\))$");
+    EITRegExp adv = m_AUSevenAdvisories;
     if (adv.indexIn(event.description) != -1)
     {
         advisories = adv.cap(1);
         event.description.resize(event.description.size()-(adv.matchedLength()+1));
     }
-    QRegExp rating("(C|G|PG|M|MA)$");
+    EITRegExp rating = m_AUSevenRating;
     if (rating.indexIn(event.description) != -1)
     {
         EventRating prograting;
@@ -1604,7 +1800,7 @@ void EITFixUp::FixMCA(DBEventEIT &event) const
     }
 
     // Close captioned?
-    position = event.description.indexOf(m_mcaCC);
+    position = m_mcaCC.IndexIn(event.description);
     if (position > 0)
     {
         event.subtitleType |= SUB_HARDHEAR;
@@ -1612,7 +1808,7 @@ void EITFixUp::FixMCA(DBEventEIT &event) const
     }
 
     // Dolby Digital 5.1?
-    position = event.description.indexOf(m_mcaDD);
+    position = m_mcaDD.IndexIn(event.description);
     if ((position > 0) && (position > (int) (event.description.length() - 7)))
     {
         event.audioProps |= AUD_DOLBY;
@@ -1620,7 +1816,7 @@ void EITFixUp::FixMCA(DBEventEIT &event) const
     }
 
     // Remove bouquet tags
-    event.description.replace(m_mcaAvail, "");
+    m_mcaAvail.RemoveFrom(event.description);
 
     // Try to find year and director from the end of the description
     bool isMovie = false;
@@ -1682,7 +1878,7 @@ void EITFixUp::FixRTL(DBEventEIT &event) const
         return;
 
     // Repeat
-    QRegExp tmpExpRepeat = m_RTLrepeat;
+    EITRegExp tmpExpRepeat = m_RTLrepeat;
     if ((pos = tmpExpRepeat.indexIn(event.description)) != -1)
     {
         // remove '.' if it matches at the beginning of the description
@@ -1690,16 +1886,16 @@ void EITFixUp::FixRTL(DBEventEIT &event) const
         event.description = event.description.remove(pos, length).trimmed();
     }
 
-    QRegExp tmpExp1 = m_RTLSubtitle;
-    QRegExp tmpExpSubtitle1 = m_RTLSubtitle1;
+    EITRegExp tmpExp1 = m_RTLSubtitle;
+    EITRegExp tmpExpSubtitle1 = m_RTLSubtitle1;
     tmpExpSubtitle1.setMinimal(true);
-    QRegExp tmpExpSubtitle2 = m_RTLSubtitle2;
-    QRegExp tmpExpSubtitle3 = m_RTLSubtitle3;
-    QRegExp tmpExpSubtitle4 = m_RTLSubtitle4;
-    QRegExp tmpExpSubtitle5 = m_RTLSubtitle5;
+    EITRegExp tmpExpSubtitle2 = m_RTLSubtitle2;
+    EITRegExp tmpExpSubtitle3 = m_RTLSubtitle3;
+    EITRegExp tmpExpSubtitle4 = m_RTLSubtitle4;
+    EITRegExp tmpExpSubtitle5 = m_RTLSubtitle5;
     tmpExpSubtitle5.setMinimal(true);
-    QRegExp tmpExpEpisodeNo1 = m_RTLEpisodeNo1;
-    QRegExp tmpExpEpisodeNo2 = m_RTLEpisodeNo2;
+    EITRegExp tmpExpEpisodeNo1 = m_RTLEpisodeNo1;
+    EITRegExp tmpExpEpisodeNo2 = m_RTLEpisodeNo2;
 
     // subtitle with episode number: "Folge *: 'subtitle'. description
     if (tmpExpSubtitle1.indexIn(event.description) != -1)
@@ -1895,7 +2091,7 @@ void EITFixUp::FixDisneyChannel(DBEventEIT &event) const
 **/
 void EITFixUp::FixATV(DBEventEIT &event) const
 {
-    event.subtitle.replace(m_ATVSubtitle, "");
+    m_ATVSubtitle.RemoveFrom(event.subtitle);
 }
 
 
@@ -1904,14 +2100,14 @@ void EITFixUp::FixATV(DBEventEIT &event) const
  */
 void EITFixUp::FixFI(DBEventEIT &event) const
 {
-    int position = event.description.indexOf(m_fiRerun);
+    int position = m_fiRerun.IndexIn(event.description);
     if (position != -1)
     {
         event.previouslyshown = true;
         event.description = event.description.replace(m_fiRerun, "");
     }
 
-    position = event.description.indexOf(m_fiRerun2);
+    position = m_fiRerun2.IndexIn(event.description);
     if (position != -1)
     {
         event.previouslyshown = true;
@@ -1919,7 +2115,7 @@ void EITFixUp::FixFI(DBEventEIT &event) const
     }
 
     // Check for (Stereo) in the decription and set the <audio> tags
-    position = event.description.indexOf(m_Stereo);
+    position = m_Stereo.IndexIn(event.description);
     if (position != -1)
     {
         event.audioProps |= AUD_STEREO;
@@ -1935,9 +2131,9 @@ void EITFixUp::FixPremiere(DBEventEIT &event) const
 {
     QString country = "";
 
-    QRegExp tmplength =  m_dePremiereLength;
-    QRegExp tmpairdate =  m_dePremiereAirdate;
-    QRegExp tmpcredits =  m_dePremiereCredits;
+    EITRegExp tmplength =  m_dePremiereLength;
+    EITRegExp tmpairdate =  m_dePremiereAirdate;
+    EITRegExp tmpcredits =  m_dePremiereCredits;
 
     event.description = event.description.replace(tmplength, "");
 
@@ -1966,7 +2162,7 @@ void EITFixUp::FixPremiere(DBEventEIT &event) const
     event.description = event.description.replace("\u000A", " ");
 
     // move the original titel from the title to subtitle
-    QRegExp tmpOTitle = m_dePremiereOTitle;
+    EITRegExp tmpOTitle = m_dePremiereOTitle;
     if (tmpOTitle.indexIn(event.title) != -1)
     {
         event.subtitle = QString("%1, %2").arg(tmpOTitle.cap(1)).arg(country);
@@ -1974,7 +2170,7 @@ void EITFixUp::FixPremiere(DBEventEIT &event) const
     }
 
     // Find infos about season and episode number
-    QRegExp tmpSeasonEpisode =  m_deSkyDescriptionSeasonEpisode;
+    EITRegExp tmpSeasonEpisode =  m_deSkyDescriptionSeasonEpisode;
     if (tmpSeasonEpisode.indexIn(event.description) != -1)
     {
         event.season = tmpSeasonEpisode.cap(1).trimmed().toUInt();
@@ -2084,40 +2280,40 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     }
 
     // Get stereo info
-    if (fullinfo.indexOf(m_Stereo) != -1)
+    if (m_Stereo.IndexIn(fullinfo) != -1)
     {
         event.audioProps |= AUD_STEREO;
         fullinfo = fullinfo.replace(m_Stereo, ".");
     }
 
     //Get widescreen info
-    if (fullinfo.indexOf(m_nlWide) != -1)
+    if (m_nlWide.IndexIn(fullinfo) != -1)
     {
         fullinfo = fullinfo.replace("breedbeeld", ".");
     }
 
     // Get repeat info
-    if (fullinfo.indexOf(m_nlRepeat) != -1)
+    if (m_nlRepeat.IndexIn(fullinfo) != -1)
     {
         fullinfo = fullinfo.replace("herh.", ".");
     }
 
     // Get teletext subtitle info
-    if (fullinfo.indexOf(m_nlTxt) != -1)
+    if (m_nlTxt.IndexIn(fullinfo) != -1)
     {
         event.subtitleType |= SUB_NORMAL;
         fullinfo = fullinfo.replace("txt", ".");
     }
 
     // Get HDTV information
-    if (event.title.indexOf(m_nlHD) != -1)
+    if (m_nlHD.IndexIn(event.title) != -1)
     {
         event.videoProps |= VID_HDTV;
         event.title = event.title.replace(m_nlHD, "");
     }
 
     // Try to make subtitle from Afl.:
-    QRegExp tmpSub = m_nlSub;
+    EITRegExp tmpSub = m_nlSub;
     QString tmpSubString;
     if (tmpSub.indexIn(fullinfo) != -1)
     {
@@ -2128,7 +2324,7 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     }
 
     // Try to make subtitle from " "
-    QRegExp tmpSub2 = m_nlSub2;
+    EITRegExp tmpSub2 = m_nlSub2;
     //QString tmpSubString2;
     if (tmpSub2.indexIn(fullinfo) != -1)
     {
@@ -2152,7 +2348,7 @@ void EITFixUp::FixNL(DBEventEIT &event) const
 
 
     // Get the actors
-    QRegExp tmpActors = m_nlActors;
+    EITRegExp tmpActors = m_nlActors;
     if (tmpActors.indexIn(fullinfo) != -1)
     {
         QString tmpActorsString = tmpActors.cap(0);
@@ -2167,7 +2363,7 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     }
 
     // Try to find presenter
-    QRegExp tmpPres = m_nlPres;
+    EITRegExp tmpPres = m_nlPres;
     if (tmpPres.indexIn(fullinfo) != -1)
     {
         QString tmpPresString = tmpPres.cap(0);
@@ -2182,8 +2378,8 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     }
 
     // Try to find year
-    QRegExp tmpYear1 = m_nlYear1;
-    QRegExp tmpYear2 = m_nlYear2;
+    EITRegExp tmpYear1 = m_nlYear1;
+    EITRegExp tmpYear2 = m_nlYear2;
     if (tmpYear1.indexIn(fullinfo) != -1)
     {
         bool ok;
@@ -2201,28 +2397,28 @@ void EITFixUp::FixNL(DBEventEIT &event) const
     }
 
     // Try to find director
-    QRegExp tmpDirector = m_nlDirector;
+    EITRegExp tmpDirector = m_nlDirector;
     QString tmpDirectorString;
-    if (fullinfo.indexOf(m_nlDirector) != -1)
+    if (m_nlDirector.IndexIn(fullinfo) != -1)
     {
         tmpDirectorString = tmpDirector.cap(0);
         event.AddPerson(DBPerson::kDirector, tmpDirectorString);
     }
 
     // Strip leftovers
-    if (fullinfo.indexOf(m_nlRub) != -1)
+    if (m_nlRub.IndexIn(fullinfo) != -1)
     {
         fullinfo = fullinfo.replace(m_nlRub, "");
     }
 
     // Strip category info from description
-    if (fullinfo.indexOf(m_nlCat) != -1)
+    if (m_nlCat.IndexIn(fullinfo) != -1)
     {
         fullinfo = fullinfo.replace(m_nlCat, "");
     }
 
     // Remove omroep from title
-    if (event.title.indexOf(m_nlOmroep) != -1)
+    if (m_nlOmroep.IndexIn(event.title) != -1)
     {
         event.title = event.title.replace(m_nlOmroep, "");
     }
@@ -2253,21 +2449,21 @@ void EITFixUp::FixCategory(DBEventEIT &event) const
 void EITFixUp::FixNO(DBEventEIT &event) const
 {
     // Check for "title (R)" in the title
-    int position = event.title.indexOf(m_noRerun);
+    int position = m_noRerun.IndexIn(event.title);
     if (position != -1)
     {
       event.previouslyshown = true;
       event.title = event.title.replace(m_noRerun, "");
     }
     // Check for "subtitle (HD)" in the subtitle
-    position = event.subtitle.indexOf(m_noHD);
+    position = m_noHD.IndexIn(event.subtitle);
     if (position != -1)
     {
       event.videoProps |= VID_HDTV;
       event.subtitle = event.subtitle.replace(m_noHD, "");
     }
    // Check for "description (HD)" in the description
-    position = event.description.indexOf(m_noHD);
+    position = m_noHD.IndexIn(event.description);
     if (position != -1)
     {
       event.videoProps |= VID_HDTV;
@@ -2282,13 +2478,13 @@ void EITFixUp::FixNRK_DVBT(DBEventEIT &event) const
 {
     QRegExp    tmpExp1;
     // Check for "title (R)" in the title
-    if (event.title.indexOf(m_noRerun) != -1)
+    if (m_noRerun.IndexIn(event.title) != -1)
     {
       event.previouslyshown = true;
       event.title = event.title.replace(m_noRerun, "");
     }
     // Check for "(R)" in the description
-    if (event.description.indexOf(m_noRerun) != -1)
+    if (m_noRerun.IndexIn(event.description) != -1)
     {
       event.previouslyshown = true;
     }
@@ -2410,25 +2606,25 @@ void EITFixUp::FixDK(DBEventEIT &event) const
         QString features = tmpRegEx.cap(1);
         event.description = event.description.replace(tmpRegEx, "");
         // 16:9
-        if (features.indexOf(m_dkWidescreen) !=  -1)
+        if (m_dkWidescreen.IndexIn(features) !=  -1)
             event.videoProps |= VID_WIDESCREEN;
         // HDTV
-        if (features.indexOf(m_dkHD) !=  -1)
+        if (m_dkHD.IndexIn(features) !=  -1)
             event.videoProps |= VID_HDTV;
         // Dolby Digital surround
-        if (features.indexOf(m_dkDolby) !=  -1)
+        if (m_dkDolby.IndexIn(features) !=  -1)
             event.audioProps |= AUD_DOLBY;
         // surround
-        if (features.indexOf(m_dkSurround) !=  -1)
+        if (m_dkSurround.IndexIn(features) !=  -1)
             event.audioProps |= AUD_SURROUND;
         // stereo
-        if (features.indexOf(m_dkStereo) !=  -1)
+        if (m_dkStereo.IndexIn(features) !=  -1)
             event.audioProps |= AUD_STEREO;
         // (G)
-        if (features.indexOf(m_dkReplay) !=  -1)
+        if (m_dkReplay.IndexIn(features) !=  -1)
             event.previouslyshown = true;
         // TTV
-        if (features.indexOf(m_dkTxt) !=  -1)
+        if (m_dkTxt.IndexIn(features) !=  -1)
             event.subtitleType |= SUB_NORMAL;
     }
 
@@ -2530,7 +2726,7 @@ void EITFixUp::FixDK(DBEventEIT &event) const
 void EITFixUp::FixStripHTML(DBEventEIT &event) const
 {
     LOG(VB_EIT, LOG_INFO, QString("Applying html strip to %1").arg(event.title));
-    event.title.remove(m_HTML);
+    m_HTML.RemoveFrom(event.title);
 }
 
 // Moves the subtitle field into the description since it's just used
@@ -2565,7 +2761,7 @@ void EITFixUp::FixGreekEIT(DBEventEIT &event) const
     }
 
     // Greek not previously Shown
-    position = event.title.indexOf(m_grNotPreviouslyShown);
+    position = m_grNotPreviouslyShown.IndexIn(event.title);
     if (position != -1)
     {
         event.previouslyshown = false;
@@ -2723,7 +2919,7 @@ void EITFixUp::FixGreekEIT(DBEventEIT &event) const
     // Work out the season and episode numbers (if any)
     // Matching pattern "Επεισ[όο]διο:?|Επ 3 από 14|3/14" etc
     bool    series  = false;
-    QRegExp tmpSeries = m_grSeason;
+    EITRegExp tmpSeries = m_grSeason;
     // cap(2) is the season for ΑΒΓΔ
     // cap(3) is the season for 1234
     int position1 = tmpSeries.indexIn(event.title);
@@ -2759,7 +2955,7 @@ void EITFixUp::FixGreekEIT(DBEventEIT &event) const
             event.description.replace(tmpSeries.cap(0),"");
     }
 
-    QRegExp tmpEpisode = m_grlongEp;
+    EITRegExp tmpEpisode = m_grlongEp;
     //tmpEpisode.setMinimal(true);
     // cap(1) is the Episode No.
     if ((position1 = tmpEpisode.indexIn(event.title)) != -1
@@ -2820,8 +3016,7 @@ void EITFixUp::FixGreekEIT(DBEventEIT &event) const
         event.subtitle = tmpRegEx.cap(1).trimmed();
         event.description.replace(tmpRegEx, "");
     }
-    QRegExp m_grMovie("\\bταιν[ιί]α\\b",Qt::CaseInsensitive);
-    bool isMovie = (event.description.indexOf(m_grMovie) !=-1) ;
+    bool isMovie = (m_grMovie.IndexIn(event.description) !=-1) ;
     if (isMovie)
     {
         event.categoryType = ProgramInfo::kCategoryMovie;
@@ -2840,103 +3035,64 @@ void EITFixUp::FixGreekEIT(DBEventEIT &event) const
 
 void EITFixUp::FixGreekCategories(DBEventEIT &event) const
 {
-    if (event.description.indexOf(m_grCategComedy) != -1)
-    {
-        event.category = "Κωμωδία";
-    }
-    else if (event.description.indexOf(m_grCategTeleMag) != -1)
-    {
-        event.category = "Τηλεπεριοδικό";
-    }
-    else if (event.description.indexOf(m_grCategNature) != -1)
-    {
-        event.category = "Επιστήμη/Φύση";
-    }
-    else if (event.description.indexOf(m_grCategHealth) != -1)
-    {
-        event.category = "Υγεία";
-    }
-    else if (event.description.indexOf(m_grCategReality) != -1)
-    {
-        event.category = "Ριάλιτι";
-    }
-    else if (event.description.indexOf(m_grCategDrama) != -1)
-    {
-        event.category = "Κοινωνικό";
-    }
-    else if (event.description.indexOf(m_grCategChildren) != -1)
-    {
-        event.category = "Παιδικό";
-    }
-    else if (event.description.indexOf(m_grCategSciFi) != -1)
-    {
-        event.category = "Επιστ.Φαντασίας";
-    }
-    else if ((event.description.indexOf(m_grCategFantasy) != -1)
-             && (event.description.indexOf(m_grCategMystery) != -1))
-    {
-        event.category = "Φαντασίας/Μυστηρίου";
-    }
-    else if (event.description.indexOf(m_grCategMystery) != -1)
-    {
-        event.category = "Μυστηρίου";
-    }
-    else if (event.description.indexOf(m_grCategFantasy) != -1)
-    {
-        event.category = "Φαντασίας";
-    }
-    else if (event.description.indexOf(m_grCategHistory) != -1)
-    {
-        event.category = "Ιστορικό";
-    }
-    else if (event.description.indexOf(m_grCategTeleShop) != -1
-            || event.title.indexOf(m_grCategTeleShop) != -1)
-    {
-        event.category = "Τηλεπωλήσεις";
-    }
-    else if (event.description.indexOf(m_grCategFood) != -1)
-    {
-        event.category = "Γαστρονομία";
-    }
-    else if (event.description.indexOf(m_grCategGameShow) != -1
-             || event.title.indexOf(m_grCategGameShow) != -1)
-    {
-        event.category = "Τηλεπαιχνίδι";
-    }
-    else if (event.description.indexOf(m_grCategBiography) != -1)
-    {
-        event.category = "Βιογραφία";
-    }
-    else if (event.title.indexOf(m_grCategNews) != -1)
-    {
-        event.category = "Ειδήσεις";
-    }
-    else if (event.description.indexOf(m_grCategSports) != -1)
-    {
-        event.category = "Αθλητικά";
-    }
-    else if (event.description.indexOf(m_grCategMusic) != -1
-            || event.title.indexOf(m_grCategMusic) != -1)
-    {
-        event.category = "Μουσική";
-    }
-    else if (event.description.indexOf(m_grCategDocumentary) != -1)
-    {
-        event.category = "Ντοκιμαντέρ";
-    }
-    else if (event.description.indexOf(m_grCategReligion) != -1)
-    {
-        event.category = "Θρησκεία";
-    }
-    else if (event.description.indexOf(m_grCategCulture) != -1)
-    {
-        event.category = "Τέχνες/Πολιτισμός";
-    }
-    else if (event.description.indexOf(m_grCategSpecial) != -1)
-    {
-        event.category = "Αφιέρωμα";
-    }
+    // In order of precedence, the first matching rule sets the category.
+    // kGrTitle rules also look in the title, kGrTitleOnly rules only there.
+    enum { kGrDescription = 0, kGrTitle = 1, kGrTitleOnly = 2 };
+    static const struct
+    {
+        const EITRegExp EITFixUp::*regexp;
+        const EITRegExp EITFixUp::*also;   // must match too, if set
+        int                         where;
+        const char                 *category;
+    } rules[] =
+    {
+        { &EITFixUp::m_grCategComedy,      NULL, kGrDescription, "Κωμωδία"           },
+        { &EITFixUp::m_grCategTeleMag,     NULL, kGrDescription, "Τηλεπεριοδικό"     },
+        { &EITFixUp::m_grCategNature,      NULL, kGrDescription, "Επιστήμη/Φύση"     },
+        { &EITFixUp::m_grCategHealth,      NULL, kGrDescription, "Υγεία"             },
+        { &EITFixUp::m_grCategReality,     NULL, kGrDescription, "Ριάλιτι"           },
+        { &EITFixUp::m_grCategDrama,       NULL, kGrDescription, "Κοινωνικό"         },
+        { &EITFixUp::m_grCategChildren,    NULL, kGrDescription, "Παιδικό"           },
+        { &EITFixUp::m_grCategSciFi,       NULL, kGrDescription, "Επιστ.Φαντασίας"   },
+        { &EITFixUp::m_grCategFantasy,
+          &EITFixUp::m_grCategMystery,           kGrDescription, "Φαντασίας/Μυστηρίου" },
+        { &EITFixUp::m_grCategMystery,     NULL, kGrDescription, "Μυστηρίου"         },
+        { &EITFixUp::m_grCategFantasy,     NULL, kGrDescription, "Φαντασίας"         },
+        { &EITFixUp::m_grCategHistory,     NULL, kGrDescription, "Ιστορικό"          },
+        { &EITFixUp::m_grCategTeleShop,    NULL, kGrTitle,       "Τηλεπωλήσεις"      },
+        { &EITFixUp::m_grCategFood,        NULL, kGrDescription, "Γαστρονομία"       },
+        { &EITFixUp::m_grCategGameShow,    NULL, kGrTitle,       "Τηλεπαιχνίδι"      },
+        { &EITFixUp::m_grCategBiography,   NULL, kGrDescription, "Βιογραφία"         },
+        { &EITFixUp::m_grCategNews,        NULL, kGrTitleOnly,   "Ειδήσεις"          },
+        { &EITFixUp::m_grCategSports,      NULL, kGrDescription, "Αθλητικά"          },
+        { &EITFixUp::m_grCategMusic,       NULL, kGrTitle,       "Μουσική"           },
+        { &EITFixUp::m_grCategDocumentary, NULL, kGrDescription, "Ντοκιμαντέρ"       },
+        { &EITFixUp::m_grCategReligion,    NULL, kGrDescription, "Θρησκεία"          },
+        { &EITFixUp::m_grCategCulture,     NULL, kGrDescription, "Τέχνες/Πολιτισμός" },
+        { &EITFixUp::m_grCategSpecial,     NULL, kGrDescription, "Αφιέρωμα"          },
+    };
+
+    for (uint i = 0; i < sizeof(rules) / sizeof(rules[0]); ++i)
+    {
+        const EITRegExp &regexp = this->*rules[i].regexp;
+        bool match;
+
+        if (rules[i].where == kGrTitleOnly)
+            match = regexp.IndexIn(event.title) != -1;
+        else
+            match = regexp.IndexIn(event.description) != -1 ||
+                (rules[i].where == kGrTitle &&
+                 regexp.IndexIn(event.title) != -1);
+
+        if (match && rules[i].also)
+            match = (this->*rules[i].also).IndexIn(event.description) != -1;
 
+        if (match)
+        {
+            event.category = QString::fromUtf8(rules[i].category);
+            return;
+        }
+    }
 }
 
 void EITFixUp::FixUnitymedia(DBEventEIT &event) const
@@ -2997,7 +3153,7 @@ void EITFixUp::FixUnitymedia(DBEventEIT &event) const
     }
 
     // handle star rating in the description
-    QRegExp tmp = m_unitymediaImdbrating;
+    EITRegExp tmp = m_unitymediaImdbrating;
     if (event.description.indexOf (tmp) != -1)
     {
         float stars = tmp.cap(1).toFloat();
@@ -31,6 +31,9 @@ static uint get_chan_id_from_db_dvb(uint sourceid,  uint serviceid,
 static uint get_chan_id_from_db_dtv(uint sourceid,
                                     uint programnumber, uint tunedchanid);
 static void init_fixup(FixupMap &fix);
+static uint update_channel_db(MSqlQuery &query, uint chanid,
+                              const QList<DBEventEIT*> &events,
+                              uint &unchanged);
 
 #define LOC QString("EITHelper: ")
 
@@ -61,46 +64,82 @@ uint EITHelper::GetListSize(void) const
 /** \fn EITHelper::ProcessEvents(void)
  *  \brief Inserts events in EIT list.
  *
+ *  The events are fixed up and grouped by channel, the changes of the
+ *  whole chunk are then written to the DB in a single transaction.
+ *  Events that are already stored unchanged are dropped.
+ *
  *  \return Returns number of events inserted into DB.
  */
 uint EITHelper::ProcessEvents(void)
 {
     QMutexLocker locker(&eitList_lock);
-    uint insertCount = 0;
 
     if (db_events.empty())
         return 0;
 
-    MSqlQuery query(MSqlQuery::InitCon());
+    QMap<uint, QList<DBEventEIT*> > chunk;
     for (uint i = 0; (i < kChunkSize) && (db_events.size() > 0); i++)
     {
         DBEventEIT *event = db_events.dequeue();
         eitList_lock.unlock();
 
         eitfixup->Fix(*event);
-
-        insertCount += event->UpdateDB(query, 1000);
+        chunk[event->chanid].push_back(event);
         maxStarttime = max (maxStarttime, event->starttime);
 
-        delete event;
         eitList_lock.lock();
     }
+    eitList_lock.unlock();
+
+    uint insertCount = 0;
+    uint unchangedCount = 0;
+
+    // The transaction only batches the writes into one commit, it is not
+    // an atomicity guarantee: the tables are MyISAM, so every row is kept
+    // as soon as it is written. Without one the events are still written.
+    MSqlQuery query(MSqlQuery::InitCon());
+    bool transaction = query.exec("START TRANSACTION");
+    if (!transaction)
+        MythDB::DBError("EITHelper::ProcessEvents start", query);
+
+    QMap<uint, QList<DBEventEIT*> >::iterator it = chunk.begin();
+    for (; it != chunk.end(); ++it)
+    {
+        insertCount += update_channel_db(query, it.key(), *it, unchangedCount);
+
+        while (!(*it).empty())
+            delete (*it).takeFirst();
+    }
+
+    if (transaction && !query.exec("COMMIT"))
+        MythDB::DBError("EITHelper::ProcessEvents commit", query);
+
+    eitList_lock.lock();
 
     if (!insertCount)
+    {
+        if (unchangedCount)
+        {
+            LOG(VB_EIT, LOG_DEBUG, LOC + QString("Skipped %1 unchanged events")
+                .arg(unchangedCount));
+        }
         return 0;
+    }
 
     if (incomplete_events.size() || unmatched_etts.size())
     {
         LOG(VB_EIT, LOG_INFO,
             LOC + QString("Added %1 events -- complete(%2) "
-                          "incomplete(%3) unmatched(%4)")
+                          "incomplete(%3) unmatched(%4) unchanged(%5)")
                 .arg(insertCount).arg(db_events.size())
-                .arg(incomplete_events.size()).arg(unmatched_etts.size()));
+                .arg(incomplete_events.size()).arg(unmatched_etts.size())
+                .arg(unchangedCount));
     }
     else
     {
         LOG(VB_EIT, LOG_INFO,
-            LOC + QString("Added %1 events").arg(insertCount));
+            LOC + QString("Added %1 events -- unchanged(%2)")
+                .arg(insertCount).arg(unchangedCount));
     }
 
     return insertCount;
@@ -1052,6 +1091,62 @@ static uint get_chan_id_from_db_dtv(uint sourceid, uint serviceid,
     return useOnAirGuide ? chanid : 0;
 }
 
+/** \fn update_channel_db(MSqlQuery&, uint, const QList<DBEventEIT*>&, uint&)
+ *  \brief Writes the events of one channel to the DB, in queue order.
+ *
+ *  The programs stored for the time span of all the events are read once.
+ *  Events identical to one of them, credits, ratings and genres included,
+ *  are dropped without writing to the DB,
+ *  the others go through DBEventEIT::UpdateDB(). The stored programs such
+ *  an update may have moved or replaced are forgotten, so later events
+ *  overlapping them are compared against the DB again.
+ *
+ *  \return Returns number of events inserted into DB.
+ */
+static uint update_channel_db(MSqlQuery &query, uint chanid,
+                              const QList<DBEventEIT*> &events,
+                              uint &unchanged)
+{
+    if (events.empty())
+        return 0;
+
+    QDateTime start = events[0]->starttime;
+    QDateTime end   = events[0]->endtime;
+    for (int i = 1; i < events.size(); i++)
+    {
+        start = min(start, events[i]->starttime);
+        end   = max(end,   events[i]->endtime);
+    }
+
+    vector<DBEvent> stored;
+    DBEvent::GetOverlappingPrograms(query, chanid, start, end, stored);
+
+    uint count = 0;
+    for (int i = 0; i < events.size(); i++)
+    {
+        const DBEventEIT *event = events[i];
+
+        if (event->IsUnchanged(query, chanid, stored))
+        {
+            unchanged++;
+            continue;
+        }
+
+        count += event->UpdateDB(query, 1000);
+
+        vector<DBEvent>::iterator it = stored.begin();
+        while (it != stored.end())
+        {
+            if (it->IsOverlapping(event->starttime, event->endtime))
+                it = stored.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    return count;
+}
+
 static void init_fixup(FixupMap &fix)
 {
     ///////////////////////////////////////////////////////////////////////////
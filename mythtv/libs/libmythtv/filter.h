@@ -23,6 +23,10 @@ typedef struct VideoFilter_ VideoFilter;
 
 typedef VideoFilter*(*init_filter)(int, int, int *, int *, char *, int);
 
+/* FilterInfo flags */
+/* The filter fills in the band members of VideoFilter, see below */
+#define FILTER_FLAG_BANDS 0x0001
+
 typedef struct FilterInfo_
 {
     init_filter filter_init;
@@ -30,6 +34,7 @@ typedef struct FilterInfo_
     char *descript;
     FmtConv *formats;
     char *libname;
+    int flags;
 } FilterInfo;
 
 struct VideoFilter_
@@ -42,9 +47,27 @@ struct VideoFilter_
     VideoFrameType outpixfmt;
     char *opts;
     FilterInfo *info;
+
+    /* Band processing, only looked at when the FilterInfo has
+     * FILTER_FLAG_BANDS set, as older filters leave these uninitialised.
+     *
+     * prepare (may be NULL) is called once per frame on the calling
+     * thread, then filter_band is called concurrently for horizontal
+     * bands [first_row, last_row) of the luma plane covering the frame.
+     * Bands start on a multiple of 4 rows so field parity and 4:2:0
+     * chroma rows line up. filter_band must only write rows inside its
+     * band. band_border is how many rows above and below the band it
+     * reads; rows it reads outside the band must not be rows it, or
+     * another band, writes in place, i.e. such filters read from their
+     * own reference copies. Bands are never made shorter than
+     * 4 * band_border rows. */
+    int (*prepare)(struct VideoFilter_ *, VideoFrame *, int);
+    int (*filter_band)(struct VideoFilter_ *, VideoFrame *, int,
+                       int first_row, int last_row);
+    int band_border;
 };
 
-#define FILT_NULL {NULL,NULL,NULL,NULL,NULL}
+#define FILT_NULL {NULL,NULL,NULL,NULL,NULL,0}
 
 #ifdef TIME_FILTER
 
@@ -1,6 +1,9 @@
 // POSIX headers
 #include <stdlib.h>
 
+// C++ headers
+#include <algorithm>
+
 #ifndef _WIN32 // dlfcn for mingw defined in compat.h
 #include <dlfcn.h> // needed for dlopen(), dlerror(), dlsym(), and dlclose()
 #else
@@ -10,14 +13,87 @@
 // Qt headers
 #include <QDir>
 #include <QStringList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QRunnable>
+#include <QThread>
 
 // MythTV headers
 #include "mythcontext.h"
 #include "filtermanager.h"
 #include "mythdirs.h"
+#include "mthreadpool.h"
 
 #define LOC QString("FilterManager: ")
 
+/// Shared by all filter chains, so the number of band worker threads
+/// does not grow with the number of players and filters.
+static MThreadPool *band_pool(void)
+{
+    static QMutex lock;
+    static MThreadPool *pool = NULL;
+
+    QMutexLocker locker(&lock);
+    if (!pool)
+    {
+        pool = new MThreadPool("FilterBandPool");
+        pool->setMaxThreadCount(max(QThread::idealThreadCount(), 2));
+    }
+    return pool;
+}
+
+/// Counts down as the bands of one frame complete
+class BandCounter
+{
+  public:
+    explicit BandCounter(int count) : m_count(count) { }
+
+    void Done(void)
+    {
+        QMutexLocker locker(&m_lock);
+        if (--m_count <= 0)
+            m_wait.wakeAll();
+    }
+
+    void Wait(void)
+    {
+        QMutexLocker locker(&m_lock);
+        while (m_count > 0)
+            m_wait.wait(&m_lock);
+    }
+
+  private:
+    QMutex         m_lock;
+    QWaitCondition m_wait;
+    int            m_count;
+};
+
+class FilterBandTask : public QRunnable
+{
+  public:
+    FilterBandTask(VideoFilter *filter, VideoFrame *frame, int field,
+                   int first_row, int last_row, BandCounter *counter) :
+        m_filter(filter), m_frame(frame), m_field(field),
+        m_first_row(first_row), m_last_row(last_row), m_counter(counter)
+    {
+    }
+
+    virtual void run(void)
+    {
+        m_filter->filter_band(m_filter, m_frame, m_field,
+                              m_first_row, m_last_row);
+        m_counter->Done();
+    }
+
+  private:
+    VideoFilter *m_filter;
+    VideoFrame  *m_frame;
+    int          m_field;
+    int          m_first_row;
+    int          m_last_row;
+    BandCounter *m_counter;
+};
+
 static const char *FmtToString(VideoFrameType ft)
 {
     switch(ft)
@@ -58,9 +134,58 @@ void FilterChain::ProcessFrame(VideoFrame *frame, FrameScanType scan)
     if (!frame)
         return;
 
+    int field = (kScan_Intr2ndField == scan);
     vector<VideoFilter*>::iterator it = filters.begin();
     for (; it != filters.end(); ++it)
-        (*it)->filter(*it, frame, kScan_Intr2ndField == scan);
+    {
+        VideoFilter *filter = *it;
+        if (max_threads > 1 && filter->info &&
+            (filter->info->flags & FILTER_FLAG_BANDS) && filter->filter_band)
+        {
+            ProcessBands(filter, frame, field);
+        }
+        else
+        {
+            filter->filter(filter, frame, field);
+        }
+    }
+}
+
+/** \fn FilterChain::ProcessBands(VideoFilter*, VideoFrame*, int)
+ *  \brief Runs a band capable filter over horizontal bands of the frame
+ *         on the shared band thread pool.
+ *
+ *  The calling thread does the last band itself rather than sitting
+ *  idle, and returns once every band is done.
+ */
+void FilterChain::ProcessBands(VideoFilter *filter, VideoFrame *frame,
+                               int field)
+{
+    int min_height = max(16, 4 * filter->band_border);
+    int bands = min(max_threads, frame->height / min_height);
+    if (bands < 2)
+    {
+        filter->filter(filter, frame, field);
+        return;
+    }
+
+    if (filter->prepare && filter->prepare(filter, frame, field) < 0)
+        return;
+
+    int band_height = (frame->height / bands) & ~3;
+    BandCounter counter(bands - 1);
+    MThreadPool *pool = band_pool();
+    for (int i = 0; i < bands - 1; i++)
+    {
+        pool->start(new FilterBandTask(filter, frame, field,
+                                       i * band_height,
+                                       (i + 1) * band_height, &counter),
+                    "FilterBand");
+    }
+
+    filter->filter_band(filter, frame, field,
+                        (bands - 1) * band_height, frame->height);
+    counter.Wait();
 }
 
 FilterManager::FilterManager()
@@ -164,6 +289,7 @@ bool FilterManager::LoadFilterLib(const QString &path)
         newFilter->filter_init = NULL;
         newFilter->name     = strdup(filtInfo->name);
         newFilter->descript = strdup(filtInfo->descript);
+        newFilter->flags    = filtInfo->flags;
 
         int i = 0;
         for (; filtInfo->formats[i].in != FMT_NONE; i++);
@@ -204,7 +330,7 @@ FilterChain *FilterManager::LoadFilters(QString Filters,
         return NULL;
 
     vector<const FilterInfo*> FiltInfoChain;
-    FilterChain *FiltChain = new FilterChain;
+    FilterChain *FiltChain = new FilterChain(max_threads);
     vector<FmtConv*> FmtList;
     const FilterInfo *FI;
     const FilterInfo *FI2;
@@ -382,11 +508,15 @@ FilterChain *FilterManager::LoadFilters(QString Filters,
 
     for (i = 0; i < FiltInfoChain.size(); i++)
     {
+        // Band capable filters are threaded by the FilterChain,
+        // so they should not start threads of their own.
+        int filt_threads = (FiltInfoChain[i]->flags & FILTER_FLAG_BANDS) ?
+            1 : max_threads;
         QByteArray tmp = OptsList[i].toLocal8Bit();
         NewFilt = LoadFilter(FiltInfoChain[i], FmtList[i]->in,
                              FmtList[i]->out, postfilt_width,
                              postfilt_height, tmp.constData(),
-                             max_threads);
+                             filt_threads);
 
         if (!NewFilt)
         {
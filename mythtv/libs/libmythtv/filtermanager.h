@@ -20,7 +20,7 @@ typedef map<QString,FilterInfo*> filter_map_t;
 class FilterChain
 {
   public:
-    FilterChain() { }
+    explicit FilterChain(int threads = 1) : max_threads(threads) { }
     virtual ~FilterChain();
 
     void ProcessFrame(VideoFrame *Frame, FrameScanType scan = kScan_Ignore);
@@ -28,7 +28,10 @@ class FilterChain
     void Append(VideoFilter *f) { filters.push_back(f); }
 
   private:
+    void ProcessBands(VideoFilter *filter, VideoFrame *frame, int field);
+
     vector<VideoFilter*> filters;
+    int max_threads;
 };
 
 class FilterManager
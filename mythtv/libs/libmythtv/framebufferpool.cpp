@@ -0,0 +1,250 @@
+// C headers
+#include <cstdlib>
+#include <stdint.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// MythTV headers
+#include "framebufferpool.h"
+#include "mythlogging.h"
+
+#define LOC QString("FrameBufferPool: ")
+
+static const size_t kSmallAlign = 64;
+static const size_t kHugeAlign  = 2 * 1024 * 1024;
+
+/// Enough idle memory for about ten 1080p buffers to survive a round
+/// trip through SD, the rest are reallocated.
+static const size_t kDefaultMaxIdle = 32 * 1024 * 1024;
+
+/** \fn FrameBufferPool::GetPool(void)
+ *  \brief Returns the process wide pool.
+ *
+ *  The pool is deliberately never destroyed, so that frames released by
+ *  other static objects during exit still have somewhere to go.
+ */
+FrameBufferPool *FrameBufferPool::GetPool(void)
+{
+    static FrameBufferPool *pool = new FrameBufferPool();
+    return pool;
+}
+
+FrameBufferPool::FrameBufferPool() :
+    m_idleBytes(0), m_maxIdle(kDefaultMaxIdle), m_usedBytes(0),
+    m_users(0), m_hits(0), m_misses(0)
+{
+}
+
+/** \fn FrameBufferPool::SizeClass(size_t)
+ *  \brief Rounds a size up to one of eight classes per power of two.
+ *
+ *  This wastes at most 12.5% and lets 1920x1080 and 1920x1088 frames,
+ *  or the small differences in padding between video outputs, share
+ *  buffers.
+ */
+size_t FrameBufferPool::SizeClass(size_t size)
+{
+    if (size <= 4096)
+        return (size + kSmallAlign - 1) & ~(kSmallAlign - 1);
+
+    size_t top = 4096;
+    while ((top << 1) < size)
+        top <<= 1;
+    size_t step = top >> 3;
+    return (size + step - 1) & ~(step - 1);
+}
+
+unsigned char *FrameBufferPool::Allocate(size_t size_class)
+{
+    size_t align = (size_class >= kHugeAlign) ? kHugeAlign : kSmallAlign;
+    void *raw = malloc(size_class + align);
+    if (!raw)
+        return NULL;
+
+    unsigned char *buf = (unsigned char*)
+        (((uintptr_t)raw + align - 1) & ~(uintptr_t)(align - 1));
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (align == kHugeAlign)
+        madvise(buf, size_class & ~(kHugeAlign - 1), MADV_HUGEPAGE);
+#endif
+
+    m_blocks.insert(buf, Block(raw, size_class));
+    return buf;
+}
+
+void FrameBufferPool::Free(unsigned char *buf)
+{
+    QHash<unsigned char*, Block>::iterator it = m_blocks.find(buf);
+    if (it == m_blocks.end())
+        return;
+    free(it->raw);
+    m_blocks.erase(it);
+}
+
+/** \fn FrameBufferPool::Acquire(uint)
+ *  \brief Returns a 64 byte aligned buffer of at least size bytes.
+ *
+ *  The contents are undefined.  The buffer must be given back with
+ *  Release(), never with av_free() or free().
+ */
+unsigned char *FrameBufferPool::Acquire(uint size)
+{
+    if (!size)
+        return NULL;
+
+    size_t size_class = SizeClass(size);
+
+    QMutexLocker locker(&m_lock);
+
+    QMap<size_t, QList<unsigned char*> >::iterator it =
+        m_idle.find(size_class);
+    if (it != m_idle.end() && !it->isEmpty())
+    {
+        unsigned char *buf = it->takeLast();
+        if (it->isEmpty())
+            m_idle.erase(it);
+        m_idleLRU.removeOne(buf);
+        m_idleBytes -= size_class;
+        m_usedBytes += size_class;
+        m_hits++;
+        return buf;
+    }
+
+    unsigned char *buf = Allocate(size_class);
+    if (!buf)
+    {
+        // Give back what we are holding on to and try once more
+        TrimLocked(0);
+        buf = Allocate(size_class);
+    }
+    if (!buf)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to allocate %1 bytes").arg(size_class));
+        return NULL;
+    }
+
+    m_usedBytes += size_class;
+    m_misses++;
+    return buf;
+}
+
+/** \fn FrameBufferPool::Release(void*)
+ *  \brief Returns a buffer obtained from Acquire() to the pool.
+ */
+void FrameBufferPool::Release(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    unsigned char *buf = (unsigned char*)ptr;
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<unsigned char*, Block>::const_iterator it = m_blocks.find(buf);
+    if (it == m_blocks.end())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "Release() called on a buffer the pool does not own");
+        return;
+    }
+
+    size_t size_class = it->size;
+    m_usedBytes -= size_class;
+
+    // Nobody is left to reuse it
+    if (!m_users)
+    {
+        Free(buf);
+        return;
+    }
+
+    m_idle[size_class].push_back(buf);
+    m_idleLRU.push_back(buf);
+    m_idleBytes += size_class;
+
+    if (m_idleBytes > m_maxIdle)
+        TrimLocked(m_maxIdle);
+}
+
+/** \fn FrameBufferPool::AddUser(void)
+ *  \brief Registers a long lived user of the pool, such as a VideoBuffers.
+ *
+ *  Idle buffers are only kept while there is at least one user to reuse
+ *  them, so every AddUser() must be paired with a RemoveUser().
+ */
+void FrameBufferPool::AddUser(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_users++;
+}
+
+/** \fn FrameBufferPool::RemoveUser(void)
+ *  \brief Unregisters a user, freeing all idle buffers when it was the last.
+ */
+void FrameBufferPool::RemoveUser(void)
+{
+    QMutexLocker locker(&m_lock);
+    if (!m_users)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "RemoveUser() called without a matching AddUser()");
+        return;
+    }
+
+    if (--m_users)
+        return;
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+        QString("Last user gone, freeing %1 KiB of idle buffers")
+        .arg(m_idleBytes / 1024));
+    TrimLocked(0);
+}
+
+/// Sets the most idle memory kept for reuse, trimming if needed.
+void FrameBufferPool::SetMaxIdle(size_t bytes)
+{
+    QMutexLocker locker(&m_lock);
+    m_maxIdle = bytes;
+    TrimLocked(m_maxIdle);
+}
+
+/// Frees idle buffers, oldest first, until at most max_idle bytes remain.
+void FrameBufferPool::Trim(size_t max_idle)
+{
+    QMutexLocker locker(&m_lock);
+    TrimLocked(max_idle);
+}
+
+void FrameBufferPool::TrimLocked(size_t max_idle)
+{
+    while (m_idleBytes > max_idle && !m_idleLRU.isEmpty())
+    {
+        unsigned char *buf = m_idleLRU.takeFirst();
+        size_t size_class = m_blocks.value(buf).size;
+
+        QMap<size_t, QList<unsigned char*> >::iterator it =
+            m_idle.find(size_class);
+        if (it != m_idle.end())
+        {
+            it->removeOne(buf);
+            if (it->isEmpty())
+                m_idle.erase(it);
+        }
+
+        m_idleBytes -= size_class;
+        Free(buf);
+    }
+}
+
+QString FrameBufferPool::GetStatus(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return QString("%1 MiB in use, %2 MiB idle in %3 size classes, "
+                   "%4 users, %5 reused, %6 allocated")
+        .arg(m_usedBytes / (1024 * 1024))
+        .arg(m_idleBytes / (1024 * 1024))
+        .arg(m_idle.size()).arg(m_users).arg(m_hits).arg(m_misses);
+}
@@ -0,0 +1,73 @@
+// -*- Mode: c++ -*-
+
+#ifndef FRAMEBUFFERPOOL_H
+#define FRAMEBUFFERPOOL_H
+
+#include <QMutex>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMap>
+
+#include "mythtvexp.h"
+
+/** \class FrameBufferPool
+ *  \brief Process wide pool of aligned buffers for video frames.
+ *
+ *  VideoBuffers are torn down and rebuilt on every resolution or aspect
+ *  change, which on a LiveTV channel change or an SD/HD ad break means
+ *  freeing and reallocating dozens of multi-megabyte frames.  Buffers
+ *  handed back to the pool are kept in size classes (eight per power of
+ *  two) and reused by the next request that fits, so flipping between
+ *  the same few resolutions stops touching the allocator.
+ *
+ *  Every buffer is 64 byte aligned; buffers of 2 MiB or more are
+ *  aligned to 2 MiB and, on Linux, marked as transparent huge page
+ *  candidates.  Idle memory is capped, least recently released first,
+ *  and is freed altogether once the last user (see AddUser()) is gone.
+ */
+class MTV_PUBLIC FrameBufferPool
+{
+  public:
+    static FrameBufferPool *GetPool(void);
+
+    unsigned char *Acquire(uint size);
+    void Release(void *buf);
+
+    void AddUser(void);
+    void RemoveUser(void);
+
+    void SetMaxIdle(size_t bytes);
+    void Trim(size_t max_idle);
+    QString GetStatus(void) const;
+
+  private:
+    FrameBufferPool();
+
+    static size_t SizeClass(size_t size);
+    unsigned char *Allocate(size_t size_class);
+    void Free(unsigned char *buf);
+    void TrimLocked(size_t max_idle);
+
+    class Block
+    {
+      public:
+        Block() : raw(NULL), size(0) {}
+        Block(void *r, size_t s) : raw(r), size(s) {}
+        void   *raw;  ///< pointer returned by malloc
+        size_t  size; ///< size class of the buffer
+    };
+
+    mutable QMutex                          m_lock;
+    QHash<unsigned char*, Block>            m_blocks;   ///< all buffers
+    QMap<size_t, QList<unsigned char*> >    m_idle;     ///< by size class
+    QList<unsigned char*>                   m_idleLRU;  ///< oldest first
+    size_t                                  m_idleBytes;
+    size_t                                  m_maxIdle;
+    size_t                                  m_usedBytes;
+    uint                                    m_users;
+    uint                                    m_hits;
+    uint                                    m_misses;
+};
+
+#endif // FRAMEBUFFERPOOL_H
@@ -110,7 +110,7 @@ QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
 
 # Headers needed by frontend & backend
 HEADERS += filter.h                 format.h
-HEADERS += mythframe.h
+HEADERS += mythframe.h              framebufferpool.h
 
 # Misc. needed by backend/frontend
 HEADERS += mythtvexp.h
@@ -171,6 +171,7 @@ SOURCES += ringbuffer.cpp           fileringBuffer.cpp
 SOURCES += streamingringbuffer.cpp  metadataimagehelper.cpp
 SOURCES += icringbuffer.cpp
 SOURCES += mythframe.cpp            mythavutil.cpp
+SOURCES += framebufferpool.cpp
 SOURCES += recordingfile.cpp
 
 # DiSEqC
@@ -312,6 +313,8 @@ HEADERS += HLS/httplivestreambuffer.h
 SOURCES += HLS/httplivestreambuffer.cpp
 HEADERS += HLS/m3u.h
 SOURCES += HLS/m3u.cpp
+HEADERS += HLS/httpliveremux.h
+SOURCES += HLS/httpliveremux.cpp
 using_libcrypto:DEFINES += USING_LIBCRYPTO
 using_libcrypto:LIBS    += -lcrypto
 
@@ -350,10 +353,10 @@ using_frontend {
     # A/V decoders
     HEADERS += decoderbase.h
     HEADERS += nuppeldecoder.h          avformatdecoder.h
-    HEADERS += privatedecoder.h
+    HEADERS += privatedecoder.h         decoderthreadpolicy.h
     SOURCES += decoderbase.cpp
     SOURCES += nuppeldecoder.cpp        avformatdecoder.cpp
-    SOURCES += privatedecoder.cpp
+    SOURCES += privatedecoder.cpp       decoderthreadpolicy.cpp
 
     using_crystalhd {
         DEFINES += USING_CRYSTALHD
@@ -601,9 +604,11 @@ using_backend {
     HEADERS += recorders/recorderbase.h
     HEADERS += recorders/DeviceReadBuffer.h
     HEADERS += recorders/dtvrecorder.h
+    HEADERS += recorders/commflagtap.h
     SOURCES += recorders/recorderbase.cpp
     SOURCES += recorders/DeviceReadBuffer.cpp
     SOURCES += recorders/dtvrecorder.cpp
+    SOURCES += recorders/commflagtap.cpp
 
     # Import recorder
     HEADERS += recorders/importrecorder.h
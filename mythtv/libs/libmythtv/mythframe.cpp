@@ -32,6 +32,7 @@
 
 extern "C" {
 #include "libavcodec/avcodec.h"
+#include "libavutil/cpu.h"
 }
 
 #ifndef __MAX
@@ -41,116 +42,35 @@ extern "C" {
 #   define __MIN(a, b)   ( ((a) < (b)) ? (a) : (b) )
 #endif
 
-#if ARCH_X86
-
-static int has_sse2     = -1;
-static int has_sse3     = -1;
-static int has_ssse3    = -1;
-static int has_sse4     = -1;
-
-#if defined _WIN32 && !defined __MINGW32__
-//  Windows
-#define cpuid    __cpuid
-
-#else
-inline void cpuid(int CPUInfo[4],int InfoType)
+static inline int cpu_flags(void)
 {
-    __asm__ __volatile__ (
-    // pic requires to save ebx/rbx
-#if ARCH_X86_32
-    "push       %%ebx\n"
-#endif
-    "cpuid\n"
-    "movl %%ebx ,%[ebx]\n"
-#if ARCH_X86_32
-    "pop        %%ebx\n"
-#endif
-    :"=a" (CPUInfo[0]),
-    [ebx] "=r"(CPUInfo[1]),
-    "=c" (CPUInfo[2]),
-    "=d" (CPUInfo[3])
-    :"a" (InfoType)
-    );
+    static int flags = -1;
+    if (flags == -1)
+        flags = av_get_cpu_flags();
+    return flags;
 }
-#endif
 
-static inline bool sse2_check()
-{
-    if (has_sse2 != -1)
-    {
-        return has_sse2;
-    }
-
-    int info[4];
-    cpuid(info, 0);
-    int nIds = info[0];
-
-    //  Detect Features
-    if (nIds >= 0x00000001)
-    {
-        cpuid(info,0x00000001);
-        has_sse2  = (info[3] & ((int)1 << 26)) != 0;
-        has_sse3  = (info[2] & ((int)1 <<  0)) != 0;
-        has_ssse3 = (info[2] & ((int)1 <<  9)) != 0;
-        has_sse4  = (info[2] & ((int)1 << 19)) != 0;
-    }
-    else
-    {
-        has_sse2  = 0;
-        has_sse3  = 0;
-        has_ssse3 = 0;
-        has_sse4  = 0;
-    }
-    return has_sse2;
-}
-
-static inline bool sse3_check()
-{
-    if (has_sse3 != -1)
-    {
-        return has_sse3;
-    }
-
-    sse2_check();
-
-    return has_sse3;
-}
+#if ARCH_X86
 
-static inline bool ssse3_check()
+static inline bool sse2_check()
 {
-    if (has_ssse3 != -1)
-    {
-        return has_ssse3;
-    }
-
-    sse2_check();
-
-    return has_ssse3;
+    return cpu_flags() & AV_CPU_FLAG_SSE2;
 }
 
 static inline bool sse4_check()
 {
-    if (has_sse4 != -1)
-    {
-        return has_sse4;
-    }
-
-    sse2_check();
-
-    return has_sse4;
+    return cpu_flags() & AV_CPU_FLAG_SSE4;
 }
 
 static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
                                    uint8_t* dstv, int dstv_pitch,
                                    const uint8_t* src, int src_pitch,
-                                   int width, int height)
+                                   int width, int height, bool ssse3)
 {
     const uint8_t shuffle[] = { 0, 2, 4, 6, 8, 10, 12, 14,
                                 1, 3, 5, 7, 9, 11, 13, 15 };
     const uint8_t mask[] = { 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00,
                              0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00 };
-    const bool sse3 = sse3_check();
-    const bool ssse3 = ssse3_check();
 
     asm volatile ("mfence");
 
@@ -182,7 +102,7 @@ static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
 
         if (((uintptr_t)src & 0xf) == 0)
         {
-            if (sse3 && ssse3)
+            if (ssse3)
             {
                 for (; x < (width & ~31); x += 32)
                 {
@@ -226,7 +146,7 @@ static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
         }
         else
         {
-            if (sse3 && ssse3)
+            if (ssse3)
             {
                 for (; x < (width & ~31); x += 32)
                 {
@@ -284,6 +204,101 @@ static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
 #undef LOAD64U
 #undef LOAD64A
 }
+
+static void SSE2_splitplanes(uint8_t* dstu, int dstu_pitch,
+                             uint8_t* dstv, int dstv_pitch,
+                             const uint8_t* src, int src_pitch,
+                             int width, int height)
+{
+    SSE_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
+                    src, src_pitch, width, height, false);
+}
+
+static void SSSE3_splitplanes(uint8_t* dstu, int dstu_pitch,
+                              uint8_t* dstv, int dstv_pitch,
+                              const uint8_t* src, int src_pitch,
+                              int width, int height)
+{
+    SSE_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
+                    src, src_pitch, width, height, true);
+}
+
+#if HAVE_AVX2_INLINE
+static void AVX2_copyplane(uint8_t* dst, int dst_pitch,
+                           const uint8_t* src, int src_pitch,
+                           int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+        for (; x < (width & ~127); x += 128)
+        {
+            asm volatile (
+                "vmovdqu   0(%[src]), %%ymm0\n"
+                "vmovdqu  32(%[src]), %%ymm1\n"
+                "vmovdqu  64(%[src]), %%ymm2\n"
+                "vmovdqu  96(%[src]), %%ymm3\n"
+                "vmovdqu  %%ymm0,   0(%[dst])\n"
+                "vmovdqu  %%ymm1,  32(%[dst])\n"
+                "vmovdqu  %%ymm2,  64(%[dst])\n"
+                "vmovdqu  %%ymm3,  96(%[dst])\n"
+                : : [dst]"r"(&dst[x]), [src]"r"(&src[x]) : "memory", "xmm0", "xmm1", "xmm2", "xmm3");
+        }
+        if (x < width)
+            memcpy(&dst[x], &src[x], width - x);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    // avoid the AVX to SSE transition penalty in whatever runs next
+    asm volatile ("vzeroupper");
+}
+
+static void AVX2_splitplanes(uint8_t* dstu, int dstu_pitch,
+                             uint8_t* dstv, int dstv_pitch,
+                             const uint8_t* src, int src_pitch,
+                             int width, int height)
+{
+    // pshufb works within each 128 bit lane, so the mask is repeated
+    const uint8_t shuffle[] = { 0, 2, 4, 6, 8, 10, 12, 14,
+                                1, 3, 5, 7, 9, 11, 13, 15,
+                                0, 2, 4, 6, 8, 10, 12, 14,
+                                1, 3, 5, 7, 9, 11, 13, 15 };
+
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+        for (; x < (width & ~31); x += 32)
+        {
+            // After the shuffle each lane holds 8 U then 8 V bytes,
+            // vpermq gathers the U and V halves of both lanes, then
+            // vperm2i128 combines the two registers into 32 U and 32 V.
+            asm volatile (
+                "vmovdqu    (%[shuffle]), %%ymm7\n"
+                "vmovdqu   0(%[src]), %%ymm0\n"
+                "vmovdqu  32(%[src]), %%ymm1\n"
+                "vpshufb   %%ymm7, %%ymm0, %%ymm0\n"
+                "vpshufb   %%ymm7, %%ymm1, %%ymm1\n"
+                "vpermq    $0xd8, %%ymm0, %%ymm0\n"
+                "vpermq    $0xd8, %%ymm1, %%ymm1\n"
+                "vperm2i128 $0x20, %%ymm1, %%ymm0, %%ymm2\n"
+                "vperm2i128 $0x31, %%ymm1, %%ymm0, %%ymm3\n"
+                "vmovdqu   %%ymm2, (%[dst1])\n"
+                "vmovdqu   %%ymm3, (%[dst2])\n"
+                : : [dst1]"r"(&dstu[x]), [dst2]"r"(&dstv[x]), [src]"r"(&src[2*x]), [shuffle]"r"(shuffle) : "memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm7");
+        }
+
+        for (; x < width; x++)
+        {
+            dstu[x] = src[2*x+0];
+            dstv[x] = src[2*x+1];
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+    asm volatile ("vzeroupper");
+}
+#endif /* HAVE_AVX2_INLINE */
 #endif /* ARCH_X86 */
 
 static inline void copyplane(uint8_t* dst, int dst_pitch,
@@ -316,6 +331,57 @@ static void splitplanes(uint8_t* dstu, int dstu_pitch,
     }
 }
 
+// Ordered from slowest to fastest, the first entry must need no CPU flags
+static const FrameCopyKernels kernel_list[] =
+{
+    { "C",      0,                  copyplane,      splitplanes       },
+#if ARCH_X86
+    { "SSE2",   AV_CPU_FLAG_SSE2,   copyplane,      SSE2_splitplanes  },
+    { "SSSE3",  AV_CPU_FLAG_SSSE3,  copyplane,      SSSE3_splitplanes },
+#if HAVE_AVX2_INLINE
+    { "AVX2",   AV_CPU_FLAG_AVX2,   AVX2_copyplane, AVX2_splitplanes  },
+#endif
+#endif
+};
+
+/**
+ * \fn framecopy_kernel_list
+ * Returns all frame copy kernels compiled in, slowest first, whether or
+ * not this CPU supports them. Check cpu_flags before calling one.
+ */
+const FrameCopyKernels *framecopy_kernel_list(int *count)
+{
+    *count = sizeof(kernel_list) / sizeof(kernel_list[0]);
+    return kernel_list;
+}
+
+/**
+ * \fn framecopy_kernels
+ * Returns the fastest frame copy kernels this CPU supports. The choice
+ * is made once, at the first call.
+ */
+const FrameCopyKernels *framecopy_kernels(void)
+{
+    static const FrameCopyKernels *best = NULL;
+    if (best)
+        return best;
+
+    const FrameCopyKernels *found = &kernel_list[0];
+    int count = sizeof(kernel_list) / sizeof(kernel_list[0]);
+    for (int i = 1; i < count; i++)
+    {
+        if ((cpu_flags() & kernel_list[i].cpu_flags) ==
+            kernel_list[i].cpu_flags)
+        {
+            found = &kernel_list[i];
+        }
+    }
+    LOG(VB_PLAYBACK, LOG_INFO,
+        QString("Using %1 frame copy kernels").arg(found->name));
+    best = found;
+    return best;
+}
+
 void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
 {
     VideoFrameType codec = dst->codec;
@@ -337,24 +403,15 @@ void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
         if (src->codec == FMT_NV12 &&
             height == dheight && width == dwidth)
         {
-            copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                      src->buf + src->offsets[0], src->pitches[0],
-                      width, height);
-#if ARCH_X86
-            if (useSSE && sse2_check())
-            {
-                SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                dst->buf + dst->offsets[2], dst->pitches[2],
-                                src->buf + src->offsets[1], src->pitches[1],
-                                (width+1) / 2, (height+1) / 2);
-                asm volatile ("emms");
-                return;
-            }
-#endif
-            splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                        dst->buf + dst->offsets[2], dst->pitches[2],
-                        src->buf + src->offsets[1], src->pitches[1],
-                        (width+1) / 2, (height+1) / 2);
+            const FrameCopyKernels *k =
+                useSSE ? framecopy_kernels() : &kernel_list[0];
+            k->copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                         src->buf + src->offsets[0], src->pitches[0],
+                         width, height);
+            k->splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                           dst->buf + dst->offsets[2], dst->pitches[2],
+                           src->buf + src->offsets[1], src->pitches[1],
+                           (width+1) / 2, (height+1) / 2);
             return;
         }
 
@@ -566,8 +623,8 @@ static void SSE_splitplanes(uint8_t *dstu, int dstu_pitch,
                      2*width, hblock);
 
         /* Copy from our cache to the destination */
-        SSE_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
-                        cache, w16, width, hblock);
+        framecopy_kernels()->splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
+                                         cache, w16, width, hblock);
 
         /* */
         src  += src_pitch  * hblock;
@@ -615,6 +672,8 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
     int width   = src->width;
     int height  = src->height;
 
+    const FrameCopyKernels *k = framecopy_kernels();
+
     if (src->codec == FMT_NV12)
     {
 #if ARCH_X86
@@ -643,13 +702,13 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
                     // if shorter, use it in the future
                     long duration = timer->nsecsElapsed();
                     timer->restart();
-                    copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                              src->buf + src->offsets[0], src->pitches[0],
-                              width, height);
-                    SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                    dst->buf + dst->offsets[2], dst->pitches[2],
-                                    src->buf + src->offsets[1], src->pitches[1],
-                                    (width+1) / 2, (height+1) / 2);
+                    k->copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                                 src->buf + src->offsets[0], src->pitches[0],
+                                 width, height);
+                    k->splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                                   dst->buf + dst->offsets[2], dst->pitches[2],
+                                   src->buf + src->offsets[1], src->pitches[1],
+                                   (width+1) / 2, (height+1) / 2);
                     m_uswc = timer->nsecsElapsed() < duration;
                     if (m_uswc == 0)
                     {
@@ -660,25 +719,25 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
             }
             else
             {
-                copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                          src->buf + src->offsets[0], src->pitches[0],
-                          width, height);
-                SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                dst->buf + dst->offsets[2], dst->pitches[2],
-                                src->buf + src->offsets[1], src->pitches[1],
-                                (width+1) / 2, (height+1) / 2);
+                k->copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                             src->buf + src->offsets[0], src->pitches[0],
+                             width, height);
+                k->splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                               dst->buf + dst->offsets[2], dst->pitches[2],
+                               src->buf + src->offsets[1], src->pitches[1],
+                               (width+1) / 2, (height+1) / 2);
             }
             asm volatile ("emms");
             return;
         }
 #endif
-        copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
-                  src->buf + src->offsets[0], src->pitches[0],
-                  width, height);
-        splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                    dst->buf + dst->offsets[2], dst->pitches[2],
-                    src->buf + src->offsets[1], src->pitches[1],
-                    (width+1) / 2, (height+1) / 2);
+        k->copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                     src->buf + src->offsets[0], src->pitches[0],
+                     width, height);
+        k->splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
+                       dst->buf + dst->offsets[2], dst->pitches[2],
+                       src->buf + src->offsets[1], src->pitches[1],
+                       (width+1) / 2, (height+1) / 2);
         return;
     }
 
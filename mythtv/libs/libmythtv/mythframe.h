@@ -90,6 +90,26 @@ private:
 void MTV_PUBLIC framecopy(VideoFrame *dst, const VideoFrame *src,
                           bool useSSE = true);
 
+/// A set of plane copy routines for one instruction set
+typedef struct FrameCopyKernels_
+{
+    const char *name;
+    int         cpu_flags; ///< AV_CPU_FLAG_* needed to use these
+
+    /// Copies a width x height plane
+    void (*copyplane)(uint8_t *dst, int dst_pitch,
+                      const uint8_t *src, int src_pitch,
+                      int width, int height);
+    /// Splits an interleaved (NV12) chroma plane, width is in pairs
+    void (*splitplanes)(uint8_t *dstu, int dstu_pitch,
+                        uint8_t *dstv, int dstv_pitch,
+                        const uint8_t *src, int src_pitch,
+                        int width, int height);
+} FrameCopyKernels;
+
+MTV_PUBLIC const FrameCopyKernels *framecopy_kernels(void);
+MTV_PUBLIC const FrameCopyKernels *framecopy_kernel_list(int *count);
+
 static inline void init(VideoFrame *vf, VideoFrameType _codec,
                         unsigned char *_buf, int _width, int _height, int _size,
                         const int *p = 0,
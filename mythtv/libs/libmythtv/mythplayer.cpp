@@ -3450,6 +3450,16 @@ bool MythPlayer::DecoderGetFrameFFREW(void)
     if (!decoder)
         return false;
 
+    // At high speeds show keyframes only, seeking straight to each one
+    // rather than decoding the frames in between and dropping them.
+    if (!deleteMap.IsEditing() && decoder->CanTrickPlay(ffrew_skip))
+    {
+        decoder->SetTrickPlay(true);
+        if (decoder->DoTrickPlayStep(ffrew_skip))
+            return decoder->GetFrame(kDecodeVideo);
+    }
+    decoder->SetTrickPlay(false);
+
     if (ffrew_skip > 0)
     {
         long long delta = decoder->GetFramesRead() - framesPlayed;
@@ -3521,7 +3531,10 @@ bool MythPlayer::DecoderGetFrame(DecodeType decodetype, bool unsafe)
     }
 
     if (ffrew_skip == 1 || decodeOneFrame)
+    {
+        decoder->SetTrickPlay(false);
         ret = decoder->GetFrame(decodetype);
+    }
     else if (ffrew_skip != 0)
         ret = DecoderGetFrameFFREW();
     decoder_change_lock.unlock();
@@ -3759,6 +3772,26 @@ bool MythPlayer::UpdateFFRewSkip(void)
     return skip_changed;
 }
 
+/** \fn MythPlayer::UpdateDecodePlayMode(void)
+ *  \brief Tells the decoder whether we are playing normally, fast
+ *         forwarding/rewinding or editing, so it can tune its threading.
+ *
+ *  While paused the previous mode is kept so pausing does not cause
+ *  the decoder to be reconfigured.
+ */
+void MythPlayer::UpdateDecodePlayMode(void)
+{
+    if (!decoder)
+        return;
+
+    if (deleteMap.IsEditing())
+        decoder->SetDecodePlayMode(kDecodePlayEdit);
+    else if (ffrew_skip == 1)
+        decoder->SetDecodePlayMode(kDecodePlayNormal);
+    else if (ffrew_skip != 0)
+        decoder->SetDecodePlayMode(kDecodePlayFFRew);
+}
+
 void MythPlayer::ChangeSpeed(void)
 {
     float last_speed = play_speed;
@@ -3766,13 +3799,25 @@ void MythPlayer::ChangeSpeed(void)
     normal_speed = next_normal_speed;
 
     bool skip_changed = UpdateFFRewSkip();
+    UpdateDecodePlayMode();
     videosync->setFrameInterval(frame_interval);
 
     if (skip_changed && videoOutput)
     {
         videoOutput->SetPrebuffering(ffrew_skip == 1);
+        // Returning to normal play from keyframe trick play needs no
+        // seek, the decoder is already positioned after a keyframe. The
+        // audio, A/V sync and trackers still need the reset a seek does.
+        bool resume = (ffrew_skip == 1) && decoder &&
+                      decoder->IsTrickPlaying() && !fftime && !rewindtime;
         if (play_speed != 0.0f && !(last_speed == 0.0f && ffrew_skip == 1))
-            DoJumpToFrame(framesPlayed + fftime - rewindtime, kInaccuracyFull);
+        {
+            if (resume)
+                ClearAfterSeek(false);
+            else
+                DoJumpToFrame(framesPlayed + fftime - rewindtime,
+                              kInaccuracyFull);
+        }
     }
 
     LOG(VB_PLAYBACK, LOG_INFO, LOC + "Play speed: " +
@@ -4170,6 +4215,7 @@ bool MythPlayer::EnableEdit(void)
     speedBeforeEdit = play_speed;
     pausedBeforeEdit = Pause();
     deleteMap.SetEditing(true);
+    UpdateDecodePlayMode();
     osd->DialogQuit();
     ResetCaptions();
     osd->HideAll();
@@ -4207,6 +4253,7 @@ void MythPlayer::DisableEdit(int howToSave)
         return;
 
     deleteMap.SetEditing(false, osd);
+    UpdateDecodePlayMode();
     if (howToSave == 0)
         deleteMap.LoadMap();
     // Unconditionally save to remove temporary marks from the DB.
@@ -4673,7 +4720,11 @@ void MythPlayer::SeekForScreenGrab(uint64_t &number, uint64_t frameNum,
     }
 
     DiscardVideoFrame(videoOutput->GetLastDecodedFrame());
-    DoJumpToFrame(number, kInaccuracyNone);
+
+    // A preview of a bookmark or a picked frame doesn't need the exact
+    // frame, so land on the nearest keyframe in the position map rather
+    // than decoding up to it. An absolute request gets the frame it named.
+    DoJumpToFrame(number, absolute ? kInaccuracyNone : kInaccuracyFull);
 }
 
 /** \fn MythPlayer::GetRawVideoFrame(long long)
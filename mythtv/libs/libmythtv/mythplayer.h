@@ -228,6 +228,7 @@ class MTV_PUBLIC MythPlayer
     bool    IsMuted(void)                     { return audio.IsMuted(); }
     bool    PlayerControlsVolume(void) const  { return audio.ControlsVolume(); }
     bool    UsingNullVideo(void) const { return FlagIsSet(kVideoIsNull); }
+    bool    IsDecodingLowRes(void) const { return FlagIsSet(kDecodeLowRes); }
     bool    HasTVChainNext(void) const;
     bool    CanSupportDoubleRate(void);
     bool    GetScreenShot(int width = 0, int height = 0, QString filename = "");
@@ -590,6 +591,7 @@ class MTV_PUBLIC MythPlayer
 
     // These actually execute commands requested by public members
     bool UpdateFFRewSkip(void);
+    void UpdateDecodePlayMode(void);
     virtual void ChangeSpeed(void);
     // The "inaccuracy" argument is generally one of the kInaccuracy* values.
     bool DoFastForward(uint64_t frames, double inaccuracy);
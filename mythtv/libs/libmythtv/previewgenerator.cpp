@@ -207,6 +207,12 @@ bool PreviewGenerator::Run(void)
     QTime tm = QTime::currentTime();
     bool ok = false;
     QString command = GetAppBinDir() + "mythpreviewgen";
+
+    // Decoding here saves starting a process, and a database connection,
+    // for every preview
+    if (!!(m_mode & kInProcess) && !!(m_mode & kLocal) && IsLocal())
+        return RunReal();
+
     bool local_ok = ((IsLocal() || !!(m_mode & kForceLocal)) &&
                      (!!(m_mode & kLocal)) &&
                      QFileInfo(command).isExecutable());
@@ -44,6 +44,8 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
         kLocalAndRemote = 0x3,
         kForceLocal     = 0x5,
         kModeMask       = 0x7,
+        kInProcess      = 0x8, ///< Decode local previews in this process
+                               ///< rather than running mythpreviewgen
     } Mode;
 
   public:
@@ -7,6 +7,7 @@ using std::max;
 
 // QT
 #include <QCoreApplication>
+#include <QFile>
 #include <QFileInfo>
 
 // libmythbase
@@ -24,6 +25,9 @@ using std::max;
 
 #define LOC QString("PreviewQueue: ")
 
+// Previews remembered as being on disk
+#define PREVIEW_INDEX_SIZE 2048
+
 PreviewGeneratorQueue *PreviewGeneratorQueue::s_pgq = NULL;
 
 void PreviewGeneratorQueue::CreatePreviewGeneratorQueue(
@@ -46,6 +50,7 @@ PreviewGeneratorQueue::PreviewGeneratorQueue(
     uint maxAttempts, uint minBlockSeconds) :
     MThread("PreviewGeneratorQueue"),
     m_mode(mode),
+    m_index(PREVIEW_INDEX_SIZE),
     m_running(0), m_maxThreads(2),
     m_maxAttempts(maxAttempts), m_minBlockSeconds(minBlockSeconds)
 {
@@ -53,8 +58,23 @@ PreviewGeneratorQueue::PreviewGeneratorQueue(
     {
         int idealThreads = QThread::idealThreadCount();
         m_maxThreads = (idealThreads >= 1) ? idealThreads * 2 : 2;
+
+        int threads = gCoreContext->GetNumSetting("PreviewGeneratorThreads", 0);
+        if (threads > 0)
+            m_maxThreads = threads;
+
+        if (gCoreContext->GetNumSetting("PreviewGeneratorInProcess", 0))
+        {
+            m_mode = (PreviewGenerator::Mode)
+                (m_mode | PreviewGenerator::kInProcess);
+        }
     }
 
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Generating up to %1 previews at once%2")
+            .arg(m_maxThreads)
+            .arg((m_mode & PreviewGenerator::kInProcess) ? ", in process" : ""));
+
     moveToThread(qthread());
     start();
 }
@@ -163,6 +183,7 @@ bool PreviewGeneratorQueue::event(QEvent *e)
         QString msg        = me->ExtraData(2);
         QString datetime   = me->ExtraData(3);
         QString token      = me->ExtraData(4);
+        QString key;
 
         {
             QMutexLocker locker(&m_lock);
@@ -190,6 +211,7 @@ bool PreviewGeneratorQueue::event(QEvent *e)
                 (*it).attempts      = 0;
                 (*it).lastBlockTime = 0;
                 (*it).blockRetryUntil = QDateTime();
+                key = *kit;
             }
             else
             {
@@ -227,6 +249,9 @@ bool PreviewGeneratorQueue::event(QEvent *e)
             m_running = (m_running > 0) ? m_running - 1 : 0;
         }
 
+        if (!key.isEmpty())
+            IndexPreview(key, filename, MythDate::fromString(datetime));
+
         UpdatePreviewGeneratorThreads();
 
         return true;
@@ -274,14 +299,38 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
         return QString();
     }
 
+    QDateTime bookmark_ts = pginfo.GetBookmarkUpdate();
+    QDateTime cmp_ts;
+    if (bookmark_ts.isValid())
+        cmp_ts = bookmark_ts;
+    else if (MythDate::current() >= pginfo.GetRecordingEndTime())
+        cmp_ts = pginfo.GetLastModifiedTime();
+    else
+        cmp_ts = pginfo.GetRecordingStartTime();
+
+    bool is_special = !outputfile.isEmpty() || time >= 0 ||
+        size.width() || size.height();
+
+    // A default preview made since the recording last changed is sent
+    // straight from the index, without asking the backend. Special
+    // previews are always made afresh, as they were before the index.
+    if (!is_special)
+    {
+        QDateTime indexed_ts;
+        QString indexed = GetIndexedPreview(key, cmp_ts, indexed_ts);
+        if (!indexed.isEmpty())
+        {
+            SendEvent(pginfo, "PREVIEW_SUCCESS", indexed, token, "On Disk",
+                      indexed_ts);
+            return indexed;
+        }
+    }
+
     QString filename = (outputfile.isEmpty()) ?
         pginfo.GetPathname() + ".png" : outputfile;
     QString ret_file = filename;
     QString ret;
 
-    bool is_special = !outputfile.isEmpty() || time >= 0 ||
-        size.width() || size.height();
-
     bool needs_gen = true;
     if (!is_special)
     {
@@ -290,15 +339,6 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
         bool locally_accessible = false;
         bool bookmark_updated = false;
 
-        QDateTime bookmark_ts = pginfo.GetBookmarkUpdate();
-        QDateTime cmp_ts;
-        if (bookmark_ts.isValid())
-            cmp_ts = bookmark_ts;
-        else if (MythDate::current() >= pginfo.GetRecordingEndTime())
-            cmp_ts = pginfo.GetLastModifiedTime();
-        else
-            cmp_ts = pginfo.GetRecordingStartTime();
-
         if (streaming)
         {
             ret_file = QString("%1/cache/remotecache/%2")
@@ -416,6 +456,7 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
     {
         QString msg = "On Disk";
         QDateTime dt = QFileInfo(ret).lastModified();
+        IndexPreview(key, ret, dt);
         SendEvent(pginfo, "PREVIEW_SUCCESS", ret, token, msg, dt);
     }
     else
@@ -463,7 +504,7 @@ void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
 {
     QMutexLocker locker(&m_lock);
     QStringList &q = m_queue;
-    if (!q.empty() && (m_running < m_maxThreads))
+    while (!q.empty() && (m_running < m_maxThreads))
     {
         QString fn = q.back();
         q.pop_back();
@@ -530,6 +571,87 @@ bool PreviewGeneratorQueue::IsGeneratingPreview(const QString &key) const
     return (*it).gen;
 }
 
+/** \brief Returns the preview made for this key, if it was made after
+ *         cmp_ts.
+ *
+ *  A local preview that has been deleted since it was indexed is dropped
+ *  from the index. Previews on the backend are not checked, as that would
+ *  cost the round trip the index saves.
+ */
+QString PreviewGeneratorQueue::GetIndexedPreview(
+    const QString &key, const QDateTime &cmp_ts, QDateTime &dt)
+{
+    QString filename;
+    {
+        QMutexLocker locker(&m_lock);
+
+        PreviewIndexEntry *entry = m_index.object(key);
+        if (!entry || (cmp_ts.isValid() && entry->lastModified <= cmp_ts))
+            return QString();
+
+        filename = entry->filename;
+        dt = entry->lastModified;
+    }
+
+    if (filename.startsWith("/") && !QFile::exists(filename))
+    {
+        QMutexLocker locker(&m_lock);
+
+        PreviewIndexEntry *entry = m_index.object(key);
+        if (entry && entry->filename == filename)
+        {
+            m_index.remove(key);
+            m_indexKeyByFile.remove(filename);
+        }
+        return QString();
+    }
+
+    return filename;
+}
+
+/** \brief Remembers that the preview for key is in filename, made at dt.
+ *
+ *  Any other preview indexed in the same file has been overwritten, so it
+ *  is forgotten.
+ */
+void PreviewGeneratorQueue::IndexPreview(
+    const QString &key, const QString &filename, const QDateTime &dt)
+{
+    if (filename.isEmpty() || !dt.isValid())
+        return;
+
+    QMutexLocker locker(&m_lock);
+
+    QString oldkey = m_indexKeyByFile.value(filename);
+    if (!oldkey.isEmpty() && oldkey != key)
+    {
+        PreviewIndexEntry *entry = m_index.object(oldkey);
+        if (entry && entry->filename == filename)
+            m_index.remove(oldkey);
+    }
+
+    PreviewIndexEntry *entry = m_index.object(key);
+    if (entry && entry->filename != filename)
+        m_indexKeyByFile.remove(entry->filename);
+
+    // The cache drops entries on its own, so now and then forget the
+    // files whose key is no longer indexed
+    if (m_indexKeyByFile.size() >= 2 * PREVIEW_INDEX_SIZE)
+    {
+        QHash<QString,QString>::iterator it = m_indexKeyByFile.begin();
+        while (it != m_indexKeyByFile.end())
+        {
+            if (m_index.contains(*it))
+                ++it;
+            else
+                it = m_indexKeyByFile.erase(it);
+        }
+    }
+
+    m_index.insert(key, new PreviewIndexEntry(filename, dt));
+    m_indexKeyByFile[filename] = key;
+}
+
 /** \fn PreviewGeneratorQueue::IncPreviewGeneratorAttempts(const QString&)
  *  \brief Increments and returns number of times we have
  *         started a PreviewGenerator to create this file.
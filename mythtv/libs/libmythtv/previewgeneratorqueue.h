@@ -4,6 +4,8 @@
 
 #include <QStringList>
 #include <QDateTime>
+#include <QCache>
+#include <QHash>
 #include <QMutex>
 #include <QMap>
 #include <QSet>
@@ -30,6 +32,17 @@ class PreviewGenState
 };
 typedef QMap<QString,PreviewGenState> PreviewMap;
 
+/// A preview known to be on disk, and when it was made
+class PreviewIndexEntry
+{
+  public:
+    PreviewIndexEntry(const QString &fn, const QDateTime &dt) :
+        filename(fn), lastModified(dt) {}
+    QString   filename;
+    QDateTime lastModified;
+};
+typedef QCache<QString,PreviewIndexEntry> PreviewIndex;
+
 class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
 {
     Q_OBJECT
@@ -66,6 +79,10 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     void IncPreviewGeneratorPriority(const QString &key, QString token);
     void UpdatePreviewGeneratorThreads(void);
     bool IsGeneratingPreview(const QString &key) const;
+    QString GetIndexedPreview(const QString &key, const QDateTime &cmp_ts,
+                              QDateTime &dt);
+    void IndexPreview(const QString &key, const QString &filename,
+                      const QDateTime &dt);
     uint IncPreviewGeneratorAttempts(const QString &key);
     void ClearPreviewGeneratorAttempts(const QString &key);
 
@@ -87,6 +104,9 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     PreviewMap             m_previewMap;
     QMap<QString,QString>  m_tokenToKeyMap;
     QStringList            m_queue;
+    PreviewIndex           m_index;
+    /// The key indexed for each file, to forget overwritten previews
+    QHash<QString,QString> m_indexKeyByFile;
     uint                   m_running;
     uint                   m_maxThreads;
     uint                   m_maxAttempts;
@@ -242,6 +242,157 @@ bool DBEvent::HasTimeConflict(const DBEvent &o) const
             (o.endtime <= endtime     && starttime   < o.endtime));
 }
 
+// True if this program overlaps the time span, in any of the ways that
+// GetOverlappingPrograms() looks for.
+bool DBEvent::IsOverlapping(const QDateTime &start, const QDateTime &end) const
+{
+    return ((starttime >= start && starttime <  end) ||
+            (endtime   >  start && endtime   <= end) ||
+            (starttime <  start && endtime   >  end));
+}
+
+// True if the one program out of "programs" that overlaps with our
+// program has the same times and program data, and our credits, ratings
+// and genres are all stored for it, so that UpdateDB() would leave the
+// database as it is.
+bool DBEvent::IsUnchanged(MSqlQuery &query, uint chanid,
+                          const vector<DBEvent> &programs) const
+{
+    const DBEvent *match = NULL;
+    for (uint i = 0; i < programs.size(); i++)
+    {
+        if (!programs[i].IsOverlapping(starttime, endtime))
+            continue;
+        if (match)
+            return false; // something has to be moved out of the way
+        match = &programs[i];
+    }
+
+    if (!match)
+        return false;
+
+    const DBEvent &p = *match;
+    bool same = p.starttime       == starttime       &&
+                p.endtime         == endtime         &&
+                p.title           == title           &&
+                p.subtitle        == subtitle        &&
+                p.description     == description     &&
+                p.category        == category        &&
+                p.categoryType    == categoryType    &&
+                p.subtitleType    == subtitleType    &&
+                p.audioProps      == audioProps      &&
+                p.videoProps      == videoProps      &&
+                qAbs(p.stars - stars) < 0.001f       &&
+                p.seriesId        == seriesId        &&
+                p.programId       == programId       &&
+                p.inetref         == inetref         &&
+                p.partnumber      == partnumber      &&
+                p.parttotal       == parttotal       &&
+                p.syndicatedepisodenumber == syndicatedepisodenumber &&
+                p.airdate         == airdate         &&
+                p.originalairdate == originalairdate &&
+                p.previouslyshown == previouslyshown &&
+                p.listingsource   == listingsource   &&
+                p.season          == season          &&
+                p.episode         == episode         &&
+                p.totalepisodes   == totalepisodes;
+
+    return same && HasStoredExtras(query, chanid);
+}
+
+// True if our credits, ratings and genres are all stored already for the
+// program at our start time. UpdateDB() only ever adds these, so anything
+// else stored for the program doesn't matter.
+bool DBEvent::HasStoredExtras(MSqlQuery &query, uint chanid) const
+{
+    if (credits && !credits->empty())
+    {
+        query.prepare(
+            "SELECT credits.role, people.name "
+            "FROM credits, people "
+            "WHERE credits.person    = people.person AND "
+            "      credits.chanid    = :CHANID       AND "
+            "      credits.starttime = :STARTTIME");
+        query.bindValue(":CHANID",    chanid);
+        query.bindValue(":STARTTIME", starttime);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("HasStoredExtras credits", query);
+            return false;
+        }
+
+        QStringList stored;
+        while (query.next())
+            stored << query.value(0).toString() + '\t' +
+                      query.value(1).toString();
+
+        for (uint i = 0; i < credits->size(); i++)
+        {
+            const DBPerson &person = (*credits)[i];
+            if (!stored.contains(person.GetRole() + '\t' + person.GetName()))
+                return false;
+        }
+    }
+
+    if (!ratings.empty())
+    {
+        query.prepare(
+            "SELECT system, rating "
+            "FROM programrating "
+            "WHERE chanid    = :CHANID AND "
+            "      starttime = :STARTTIME");
+        query.bindValue(":CHANID",    chanid);
+        query.bindValue(":STARTTIME", starttime);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("HasStoredExtras ratings", query);
+            return false;
+        }
+
+        QStringList stored;
+        while (query.next())
+            stored << query.value(0).toString() + '\t' +
+                      query.value(1).toString();
+
+        QList<EventRating>::const_iterator it = ratings.begin();
+        for (; it != ratings.end(); ++it)
+        {
+            if (!stored.contains((*it).system + '\t' + (*it).rating))
+                return false;
+        }
+    }
+
+    if (!genres.empty())
+    {
+        query.prepare(
+            "SELECT genre "
+            "FROM programgenres "
+            "WHERE chanid    = :CHANID AND "
+            "      starttime = :STARTTIME "
+            "ORDER BY relevance");
+        query.bindValue(":CHANID",    chanid);
+        query.bindValue(":STARTTIME", starttime);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("HasStoredExtras genres", query);
+            return false;
+        }
+
+        QStringList stored;
+        while (query.next())
+            stored << query.value(0).toString();
+
+        // add_genres() stores no more than 36 genres, one per relevance
+        if (stored != genres.mid(0, 36))
+            return false;
+    }
+
+    return true;
+}
+
 // Processing new EIT entry starts here
 uint DBEvent::UpdateDB(
     MSqlQuery &query, uint chanid, int match_threshold) const
@@ -349,6 +500,14 @@ uint DBEvent::UpdateDB(
 //
 uint DBEvent::GetOverlappingPrograms(
     MSqlQuery &query, uint chanid, vector<DBEvent> &programs) const
+{
+    return GetOverlappingPrograms(query, chanid, starttime, endtime, programs);
+}
+
+// Get all programs in the database that overlap with the time span.
+uint DBEvent::GetOverlappingPrograms(
+    MSqlQuery &query, uint chanid, const QDateTime &start,
+    const QDateTime &end, vector<DBEvent> &programs)
 {
     uint count = 0;
     query.prepare(
@@ -371,12 +530,12 @@ uint DBEvent::GetOverlappingPrograms(
         "        ( endtime   >  :STIME2 AND endtime   <= :ETIME2 ) OR "
         "        ( starttime <  :STIME3 AND endtime   >  :ETIME3 ) )");
     query.bindValue(":CHANID", chanid);
-    query.bindValue(":STIME1", starttime);
-    query.bindValue(":ETIME1", endtime);
-    query.bindValue(":STIME2", starttime);
-    query.bindValue(":ETIME2", endtime);
-    query.bindValue(":STIME3", starttime);
-    query.bindValue(":ETIME3", endtime);
+    query.bindValue(":STIME1", start);
+    query.bindValue(":ETIME1", end);
+    query.bindValue(":STIME2", start);
+    query.bindValue(":ETIME2", end);
+    query.bindValue(":STIME3", start);
+    query.bindValue(":ETIME3", end);
 
     if (!query.exec())
     {
@@ -1379,57 +1538,64 @@ void ProgramData::HandlePrograms(
 {
     uint unchanged = 0, updated = 0;
 
-    MSqlQuery query(MSqlQuery::InitCon());
-
-    QMap<QString, QList<ProgInfo> >::const_iterator mapiter;
+    QMap<QString, QList<ProgInfo> >::iterator mapiter;
     for (mapiter = proglist.begin(); mapiter != proglist.end(); ++mapiter)
-    {
-        if (mapiter.key().isEmpty())
-            continue;
+        HandlePrograms(sourceid, mapiter.key(), *mapiter, unchanged, updated);
 
-        query.prepare(
-            "SELECT chanid "
-            "FROM channel "
-            "WHERE sourceid = :ID AND "
-            "      xmltvid  = :XMLTVID");
-        query.bindValue(":ID",      sourceid);
-        query.bindValue(":XMLTVID", mapiter.key());
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Updated programs: %1 Unchanged programs: %2")
+                .arg(updated) .arg(unchanged));
+}
 
-        if (!query.exec())
-        {
-            MythDB::DBError("ProgramData::HandlePrograms", query);
-            continue;
-        }
+// Stores the programs of one XMLTV channel, so that callers can hand over
+// the listings a channel at a time instead of holding the whole file.
+// Adds to the updated and unchanged program counts.
+void ProgramData::HandlePrograms(
+    uint sourceid, const QString &xmltvid, QList<ProgInfo> &list,
+    uint &unchanged, uint &updated)
+{
+    if (xmltvid.isEmpty() || list.isEmpty())
+        return;
 
-        vector<uint> chanids;
-        while (query.next())
-            chanids.push_back(query.value(0).toUInt());
+    MSqlQuery query(MSqlQuery::InitCon());
 
-        if (chanids.empty())
-        {
-            LOG(VB_GENERAL, LOG_NOTICE,
-                QString("Unknown xmltv channel identifier: %1"
-                        " - Skipping channel.").arg(mapiter.key()));
-            continue;
-        }
+    query.prepare(
+        "SELECT chanid "
+        "FROM channel "
+        "WHERE sourceid = :ID AND "
+        "      xmltvid  = :XMLTVID");
+    query.bindValue(":ID",      sourceid);
+    query.bindValue(":XMLTVID", xmltvid);
 
-        QList<ProgInfo> &list = proglist[mapiter.key()];
-        QList<ProgInfo*> sortlist;
-        QList<ProgInfo>::iterator it = list.begin();
-        for (; it != list.end(); ++it)
-            sortlist.push_back(&(*it));
+    if (!query.exec())
+    {
+        MythDB::DBError("ProgramData::HandlePrograms", query);
+        return;
+    }
 
-        FixProgramList(sortlist);
+    vector<uint> chanids;
+    while (query.next())
+        chanids.push_back(query.value(0).toUInt());
 
-        for (uint i = 0; i < chanids.size(); ++i)
-        {
-            HandlePrograms(query, chanids[i], sortlist, unchanged, updated);
-        }
+    if (chanids.empty())
+    {
+        LOG(VB_GENERAL, LOG_NOTICE,
+            QString("Unknown xmltv channel identifier: %1"
+                    " - Skipping channel.").arg(xmltvid));
+        return;
     }
 
-    LOG(VB_GENERAL, LOG_INFO,
-        QString("Updated programs: %1 Unchanged programs: %2")
-                .arg(updated) .arg(unchanged));
+    QList<ProgInfo*> sortlist;
+    QList<ProgInfo>::iterator it = list.begin();
+    for (; it != list.end(); ++it)
+        sortlist.push_back(&(*it));
+
+    FixProgramList(sortlist);
+
+    for (uint i = 0; i < chanids.size(); ++i)
+    {
+        HandlePrograms(query, chanids[i], sortlist, unchanged, updated);
+    }
 }
 
 void ProgramData::HandlePrograms(MSqlQuery             &query,
@@ -47,6 +47,7 @@ class MTV_PUBLIC DBPerson
     DBPerson(const QString &_role, const QString &_name);
 
     QString GetRole(void) const;
+    QString GetName(void) const { return name; }
 
     uint InsertDB(MSqlQuery &query, uint chanid,
                   const QDateTime &starttime) const;
@@ -142,6 +143,13 @@ class MTV_PUBLIC DBEvent
 
     bool HasCredits(void) const { return credits; }
     bool HasTimeConflict(const DBEvent &other) const;
+    bool IsOverlapping(const QDateTime &start, const QDateTime &end) const;
+    bool IsUnchanged(MSqlQuery&, uint chanid,
+                     const vector<DBEvent> &programs) const;
+
+    static uint GetOverlappingPrograms(
+        MSqlQuery&, uint chanid, const QDateTime &start,
+        const QDateTime &end, vector<DBEvent> &programs);
 
     DBEvent &operator=(const DBEvent&);
 
@@ -156,6 +164,7 @@ class MTV_PUBLIC DBEvent
         MSqlQuery&, uint chanid, const DBEvent &match) const;
     bool MoveOutOfTheWayDB(
         MSqlQuery&, uint chanid, const DBEvent &nonmatch) const;
+    bool HasStoredExtras(MSqlQuery&, uint chanid) const;
     virtual uint InsertDB(MSqlQuery&, uint chanid) const;
     virtual void Squeeze(void);
 
@@ -278,6 +287,9 @@ class MTV_PUBLIC ProgramData
   public:
     static void HandlePrograms(uint sourceid,
                                QMap<QString, QList<ProgInfo> > &proglist);
+    static void HandlePrograms(uint sourceid, const QString &xmltvid,
+                               QList<ProgInfo> &proglist,
+                               uint &unchanged, uint &updated);
 
     static int  fix_end_times(void);
     static bool ClearDataByChannel(
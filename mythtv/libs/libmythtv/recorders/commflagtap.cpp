@@ -0,0 +1,726 @@
+// -*- Mode: c++ -*-
+/**
+ *  CommFlagTap -- blank frame commercial detection while recording
+ *  Distributed as part of MythTV under GPL v2 and later.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavutil/pixdesc.h"
+}
+
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "commflagtap.h"
+#include "mpegtables.h"
+#include "tspacket.h"
+
+#define LOC QString("CommFlagTap[0x%1]: ").arg(m_pid, 0, 16)
+
+/// Most transport stream data we keep waiting for the decoder, about
+/// half a minute of a full rate ATSC multiplex.
+const uint CommFlagTap::kMaxPendingBytes = 64 * 1024 * 1024;
+
+/// How long Finish() waits for the queue to be decoded, in milliseconds
+const uint CommFlagTap::kFinishTimeout = 10 * 1000;
+
+/// Same limit as mythcommflag's MAX_BLANK_FRAMES
+static const long long kMaxBlankFrames = 180;
+
+/// Packets decoded between looks at whether the tap was given up
+static const uint kAbortCheckPackets = 4096;
+
+/// A jump in pts bigger than this is a discontinuity, not a gap
+static const int64_t kMaxPtsJump = 10 * 90000;
+
+/** \fn CommFlagTap::Create(uint, uint)
+ *  \brief Returns a running tap for a video PID, or NULL if the stream
+ *         type is not one we can decode.
+ */
+CommFlagTap *CommFlagTap::Create(uint pid, uint stream_type)
+{
+    int codec_id;
+    switch (stream_type)
+    {
+        case StreamID::MPEG1Video:
+        case StreamID::MPEG2Video:
+            codec_id = AV_CODEC_ID_MPEG2VIDEO;
+            break;
+        case StreamID::MPEG4Video:
+            codec_id = AV_CODEC_ID_MPEG4;
+            break;
+        case StreamID::H264Video:
+            codec_id = AV_CODEC_ID_H264;
+            break;
+        case StreamID::H265Video:
+            codec_id = AV_CODEC_ID_HEVC;
+            break;
+        default:
+            LOG(VB_RECORD, LOG_INFO, QString("CommFlagTap: Can not flag "
+                "stream type %1").arg(StreamID::toString(stream_type)));
+            return NULL;
+    }
+
+    CommFlagTap *tap = new CommFlagTap(pid, codec_id);
+    tap->start();
+    return tap;
+}
+
+CommFlagTap::CommFlagTap(uint pid, int codec_id) :
+    MThread("CommFlagTap"),
+    m_pid(pid),                 m_codecId(codec_id),
+    m_finishing(false),         m_failed(false),
+    m_ctx(NULL),                m_parser(NULL),
+    m_frame(NULL),              m_inPES(false),
+    m_pesHeaderLeft(0),         m_pesPts(AV_NOPTS_VALUE),
+    m_pesDts(AV_NOPTS_VALUE),   m_framesDecoded(0),
+    m_firstPts(AV_NOPTS_VALUE), m_lastPts(AV_NOPTS_VALUE),
+    m_ptsOffset(0),             m_decoderFps(0.0)
+{
+    m_blankFrameMaxDiff =
+        gCoreContext->GetNumSetting("CommDetectBlankFrameMaxDiff", 25);
+    m_darkBrightness =
+        gCoreContext->GetNumSetting("CommDetectDarkBrightness", 80);
+    m_dimBrightness =
+        gCoreContext->GetNumSetting("CommDetectDimBrightness", 120);
+    m_borderSetting =
+        gCoreContext->GetNumSetting("CommDetectBorder", 20);
+    m_aggressive =
+        gCoreContext->GetNumSetting("AggressiveCommDetect", 1);
+}
+
+CommFlagTap::~CommFlagTap()
+{
+    m_lock.lock();
+    m_failed = true;
+    m_finishing = true;
+    m_wait.wakeAll();
+    m_lock.unlock();
+
+    wait();
+}
+
+/** \fn CommFlagTap::AddTSPackets(const unsigned char*, uint)
+ *  \brief Queues the video packets among \a size bytes of whole
+ *         transport stream packets.
+ *
+ *  Called from the recorder thread for everything it writes, so this
+ *  only copies; if the queue grows past kMaxPendingBytes the tap fails.
+ */
+void CommFlagTap::AddTSPackets(const unsigned char *buf, uint size)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_failed || m_finishing)
+        return;
+
+    bool added = false;
+    for (uint i = 0; i + TSPacket::kSize <= size; i += TSPacket::kSize)
+    {
+        const TSPacket *tspacket =
+            reinterpret_cast<const TSPacket*>(buf + i);
+        if (tspacket->PID() != m_pid)
+            continue;
+        m_pending.append(reinterpret_cast<const char*>(buf + i),
+                         TSPacket::kSize);
+        added = true;
+    }
+
+    if ((uint)m_pending.size() > kMaxPendingBytes)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC + "Decoding can not keep up with "
+            "the recording, leaving commercial flagging to the job queue.");
+        m_pending.clear();
+        m_failed = true;
+        m_wait.wakeAll();
+    }
+    else if (added)
+    {
+        m_wait.wakeAll();
+    }
+}
+
+/** \fn CommFlagTap::Finish(frm_dir_map_t&, double)
+ *  \brief Waits for the tap's thread to decode what is still queued and
+ *         returns the commercial breaks.
+ *
+ *  This is called from the recorder thread, so it waits at most
+ *  kFinishTimeout; if the queue is not decoded by then the tap fails.
+ *
+ *  \param fps Frame rate of the recording; if this is zero the frame
+ *             rate the decoder found is used.
+ *  \return false if the tap failed and \a breaks should not be used.
+ */
+bool CommFlagTap::Finish(frm_dir_map_t &breaks, double fps)
+{
+    m_lock.lock();
+    m_finishing = true;
+    m_wait.wakeAll();
+    m_lock.unlock();
+
+    breaks.clear();
+
+    if (!wait(kFinishTimeout))
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC + "Decoding did not finish in "
+            "time, leaving commercial flagging to the job queue.");
+        m_lock.lock();
+        m_failed = true;
+        m_lock.unlock();
+        return false;
+    }
+
+    QMutexLocker locker(&m_lock);
+    if (m_failed)
+        return false;
+
+    if (fps <= 0.0)
+        fps = m_decoderFps;
+    if (fps <= 0.0 || fps > 121.0)
+        fps = 29.97;
+
+    // The recorder numbers frames from its first keyframe, at the
+    // recording's frame rate, so place the blank frames by their time
+    m_blankFrames.clear();
+    for (int i = 0; i < m_blankTimes.size(); i++)
+    {
+        long long frame = llround(m_blankTimes[i] * fps / 90000.0);
+        m_blankFrames[frame] = MARK_BLANK_FRAME;
+    }
+
+    BuildBreaks(breaks, fps);
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC +
+        QString("%1 frames, %2 blank, %3 break marks at %4 fps")
+            .arg(m_framesDecoded).arg(m_blankFrames.size())
+            .arg(breaks.size()).arg(fps));
+
+    return true;
+}
+
+void CommFlagTap::run(void)
+{
+    RunProlog();
+
+    bool ok = OpenDecoder();
+
+    QMutexLocker locker(&m_lock);
+    if (!ok)
+        m_failed = true;
+
+    while (!m_failed)
+    {
+        if (m_pending.isEmpty())
+        {
+            if (m_finishing)
+                break;
+            m_wait.wait(&m_lock);
+            continue;
+        }
+
+        QByteArray packets;
+        packets.swap(m_pending);
+        locker.unlock();
+
+        ProcessTSPackets(packets);
+
+        locker.relock();
+    }
+
+    bool flush = !m_failed;
+    locker.unlock();
+
+    if (flush)
+    {
+        // Get the last frame out of the parser, then out of the decoder
+        ParseES(NULL, 0, AV_NOPTS_VALUE, AV_NOPTS_VALUE);
+        DecodeFrame(NULL, 0, AV_NOPTS_VALUE, AV_NOPTS_VALUE);
+    }
+
+    if (m_ctx && m_ctx->framerate.num && m_ctx->framerate.den)
+        m_decoderFps = av_q2d(m_ctx->framerate);
+
+    CloseDecoder();
+
+    RunEpilog();
+}
+
+bool CommFlagTap::OpenDecoder(void)
+{
+    AVCodec *codec = avcodec_find_decoder((AVCodecID)m_codecId);
+    if (!codec)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No decoder for " +
+            avcodec_get_name((AVCodecID)m_codecId));
+        return false;
+    }
+
+    m_ctx = avcodec_alloc_context3(codec);
+    m_parser = av_parser_init(m_codecId);
+    m_frame = av_frame_alloc();
+    if (!m_ctx || !m_parser || !m_frame)
+        return false;
+
+    // Same shortcuts mythcommflag asks of AvFormatDecoder; blank frame
+    // detection only samples the luma plane.
+    m_ctx->thread_count = 1;
+    if (AV_CODEC_ID_MPEG2VIDEO == m_codecId && codec->max_lowres >= 2)
+        m_ctx->lowres = 2;
+    else if (AV_CODEC_ID_H264 == m_codecId)
+    {
+        m_ctx->flags &= ~CODEC_FLAG_LOOP_FILTER;
+        m_ctx->skip_loop_filter = AVDISCARD_ALL;
+    }
+
+    QMutexLocker locker(avcodeclock);
+    if (avcodec_open2(m_ctx, codec, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not open decoder");
+        return false;
+    }
+
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("Flagging %1 video")
+        .arg(codec->name));
+
+    return true;
+}
+
+void CommFlagTap::CloseDecoder(void)
+{
+    if (m_parser)
+    {
+        av_parser_close(m_parser);
+        m_parser = NULL;
+    }
+
+    if (m_ctx)
+    {
+        QMutexLocker locker(avcodeclock);
+        avcodec_free_context(&m_ctx);
+    }
+
+    av_frame_free(&m_frame);
+}
+
+static int64_t pes_timestamp(const unsigned char *p)
+{
+    return ((int64_t)(p[0] & 0x0e) << 29) | ((int64_t)p[1] << 22) |
+           ((int64_t)(p[2] & 0xfe) << 14) | ((int64_t)p[3] << 7) |
+           ((int64_t)(p[4] & 0xfe) >> 1);
+}
+
+/// Strips the TS and PES headers and passes the elementary stream on,
+/// along with the timestamps of each PES packet
+void CommFlagTap::ProcessTSPackets(const QByteArray &packets)
+{
+    const unsigned char *buf =
+        reinterpret_cast<const unsigned char*>(packets.constData());
+    const uint size = packets.size();
+
+    for (uint i = 0; i + TSPacket::kSize <= size; i += TSPacket::kSize)
+    {
+        // The queue can be large, stop early if the tap was given up
+        if (!((i / TSPacket::kSize + 1) % kAbortCheckPackets))
+        {
+            QMutexLocker locker(&m_lock);
+            if (m_failed)
+                return;
+        }
+
+        const TSPacket *tspacket =
+            reinterpret_cast<const TSPacket*>(buf + i);
+
+        if (tspacket->TransportError() || tspacket->Scrambled() ||
+            !tspacket->HasPayload())
+            continue;
+
+        uint offset = tspacket->AFCOffset();
+        if (offset >= TSPacket::kSize)
+            continue;
+
+        const unsigned char *payload = tspacket->data() + offset;
+        uint len = TSPacket::kSize - offset;
+
+        if (tspacket->PayloadStart())
+        {
+            // PES header: start code, stream id, length, two flag bytes
+            // and the length of the optional fields that follow.
+            m_inPES = (len >= 9) && !payload[0] && !payload[1] &&
+                      (payload[2] == 0x01);
+            if (!m_inPES)
+                continue;
+            m_pesHeaderLeft = 9 + payload[8];
+
+            m_pesPts = m_pesDts = AV_NOPTS_VALUE;
+            if ((payload[7] & 0x80) && (len >= 14) && (payload[8] >= 5))
+                m_pesPts = pes_timestamp(payload + 9);
+            if ((payload[7] & 0xc0) == 0xc0 && (len >= 19) &&
+                (payload[8] >= 10))
+                m_pesDts = pes_timestamp(payload + 14);
+        }
+        else if (!m_inPES)
+            continue;
+
+        uint skip = min(m_pesHeaderLeft, len);
+        m_pesHeaderLeft -= skip;
+        if (skip < len)
+        {
+            // The timestamps belong to the first data of the PES packet
+            ParseES(payload + skip, len - skip, m_pesPts, m_pesDts);
+            m_pesPts = m_pesDts = AV_NOPTS_VALUE;
+        }
+    }
+}
+
+void CommFlagTap::ParseES(const unsigned char *buf, int size,
+                          int64_t pts, int64_t dts)
+{
+    do
+    {
+        uint8_t *out = NULL;
+        int out_size = 0;
+        int used = av_parser_parse2(m_parser, m_ctx, &out, &out_size,
+                                    buf, size, pts, dts, 0);
+        if (used < 0)
+            return;
+        buf += used;
+        size -= used;
+        pts = dts = AV_NOPTS_VALUE;
+
+        if (out_size > 0)
+            DecodeFrame(out, out_size, m_parser->pts, m_parser->dts);
+    } while (size > 0);
+}
+
+/// Decodes one coded frame, or with \a buf NULL drains the decoder
+void CommFlagTap::DecodeFrame(const unsigned char *buf, int size,
+                              int64_t pts, int64_t dts)
+{
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = const_cast<uint8_t*>(buf);
+    pkt.size = size;
+    pkt.pts  = pts;
+    pkt.dts  = dts;
+
+    int got_picture;
+    do
+    {
+        got_picture = 0;
+        if (avcodec_decode_video2(m_ctx, m_frame, &got_picture, &pkt) < 0)
+            return; // damaged stream, the decoder will resync
+        if (got_picture)
+        {
+            AnalyzeFrame(m_frame);
+            av_frame_unref(m_frame);
+        }
+    } while (!buf && got_picture);
+}
+
+/** \fn CommFlagTap::AnalyzeFrame(const AVFrame*)
+ *  \brief Samples the luma plane and records the frame if it is blank.
+ *
+ *  This is the blank frame test from ClassicCommDetector::ProcessFrame()
+ *  with the same border, sample spacing and brightness thresholds.
+ */
+void CommFlagTap::AnalyzeFrame(const AVFrame *frame)
+{
+    m_framesDecoded++;
+
+    const int64_t frame_time = FrameTime(frame);
+    if (frame_time < 0)
+        return;
+
+    const AVPixFmtDescriptor *desc =
+        av_pix_fmt_desc_get((AVPixelFormat)frame->format);
+    if (!desc || desc->comp[0].depth != 8 ||
+        (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL |
+                        AV_PIX_FMT_FLAG_HWACCEL)))
+        return;
+
+    const int width  = frame->width;
+    const int height = frame->height;
+    const int border = m_borderSetting * height / 720;
+    int spacing_x, spacing_y;
+
+    if ((width * height) > 1000000)
+        spacing_x = spacing_y = 10;
+    else if ((width * height) > 800000)
+        spacing_x = spacing_y = 8;
+    else if ((width * height) > 400000)
+        spacing_x = spacing_y = 6;
+    else if ((width * height) > 300000)
+        spacing_x = 6, spacing_y = 4;
+    else
+        spacing_x = spacing_y = 4;
+
+    int max = 0;
+    int min = 255;
+    long long total = 0;
+    int checked = 0;
+
+    for (int y = border; y < (height - border); y += spacing_y)
+    {
+        const unsigned char *row = frame->data[0] + y * frame->linesize[0];
+        for (int x = border; x < (width - border); x += spacing_x)
+        {
+            int pixel = row[x];
+            total += pixel;
+            if (pixel < min)
+                min = pixel;
+            if (pixel > max)
+                max = pixel;
+            checked++;
+        }
+    }
+
+    if (!checked)
+        return;
+
+    int avg = total / checked;
+    int dim_average = min + 10;
+    bool blank = false;
+
+    // Is the frame really dark
+    if (((max - min) <= m_blankFrameMaxDiff) && (max < m_dimBrightness))
+        blank = true;
+
+    // Are we non-strict and the frame is blank
+    if (!m_aggressive && ((max - min) <= m_blankFrameMaxDiff))
+        blank = true;
+
+    // Are we non-strict and the frame is dark
+    //                   OR the frame is dim and has a low avg brightness
+    if (!m_aggressive &&
+        ((max < m_darkBrightness) ||
+         ((max < m_dimBrightness) && (avg < dim_average))))
+        blank = true;
+
+    if (blank)
+        m_blankTimes.push_back(frame_time);
+}
+
+/** \fn CommFlagTap::FrameTime(const AVFrame*)
+ *  \brief Returns the time of a frame in 90kHz ticks from the first one.
+ *
+ *  Frames the decoder drops or can not decode leave a gap here, so they
+ *  do not move the frames after them. Wraps of the 33 bit pts are undone,
+ *  and a jump of more than kMaxPtsJump is taken to be a discontinuity in
+ *  the broadcast and closed up. Returns -1 for frames without a time and
+ *  frames shown before the first one, such as leading B frames.
+ */
+int64_t CommFlagTap::FrameTime(const AVFrame *frame)
+{
+    int64_t pts = av_frame_get_best_effort_timestamp(frame);
+    if (pts == AV_NOPTS_VALUE)
+        return -1;
+
+    pts += m_ptsOffset;
+
+    if (m_lastPts != AV_NOPTS_VALUE)
+    {
+        int64_t delta = pts - m_lastPts;
+        if (delta < -(1LL << 32))
+        {
+            m_ptsOffset += 1LL << 33;
+            pts += 1LL << 33;
+        }
+        else if (delta > kMaxPtsJump || delta < -kMaxPtsJump)
+        {
+            double fps = (m_ctx->framerate.num && m_ctx->framerate.den) ?
+                av_q2d(m_ctx->framerate) : 29.97;
+            int64_t frame_ticks = llround(90000.0 / fps);
+            m_ptsOffset -= delta - frame_ticks;
+            pts -= delta - frame_ticks;
+        }
+    }
+
+    if (m_firstPts == AV_NOPTS_VALUE)
+        m_firstPts = pts;
+
+    // B frames are reordered, keep the latest time to measure jumps from
+    if (m_lastPts == AV_NOPTS_VALUE || pts > m_lastPts)
+        m_lastPts = pts;
+
+    return (pts >= m_firstPts) ? pts - m_firstPts : -1;
+}
+
+static bool is_spot_gap(int gap_length, double fps, bool aggressive)
+{
+    // Usual spot lengths in seconds, and how many frames off they may be
+    static const int spots[]   = {  5, 10, 15, 20, 30, 40, 45, 60, 90, 120 };
+    static const int strict[]  = {  5,  7, 10, 11, 12,  1,  1, 15, 10,  10 };
+    static const int relaxed[] = { 11, 13, 16, 17, 18,  3,  3, 20, 20,  20 };
+    const int *slack = aggressive ? strict : relaxed;
+
+    for (uint i = 0; i < sizeof(spots) / sizeof(spots[0]); i++)
+    {
+        if (abs((int)(gap_length - (spots[i] * fps))) < slack[i])
+            return true;
+    }
+    return false;
+}
+
+/** \fn CommFlagTap::BuildBreaks(frm_dir_map_t&, double) const
+ *  \brief Turns the blank frames into commercial breaks.
+ *
+ *  A port of ClassicCommDetector::BuildBlankFrameCommList() and
+ *  MergeBlankCommList(): gaps between blank frames that match usual
+ *  spot lengths become commercials, commercials less than 15 seconds
+ *  apart are merged and shows shorter than 35 seconds between two
+ *  breaks are taken into the breaks.
+ */
+void CommFlagTap::BuildBreaks(frm_dir_map_t &breaks, double fps) const
+{
+    vector<long long> bframes;
+    vector<long long> c_start;
+    vector<long long> c_end;
+
+    frm_dir_map_t::const_iterator bit = m_blankFrames.begin();
+    for (; bit != m_blankFrames.end(); ++bit)
+        bframes.push_back(bit.key());
+
+    const int frames = bframes.size();
+
+    // detect individual commercials from blank frames
+    // commercial end is set to frame right before ending blank frame to
+    //    account for instances with only a single blank frame between comms.
+    for (int i = 0; i < frames; i++)
+    {
+        for (int x = i + 1; x < frames; x++)
+        {
+            int gap_length = bframes[x] - bframes[i];
+            if (is_spot_gap(gap_length, fps, m_aggressive))
+            {
+                c_start.push_back(bframes[i]);
+                c_end.push_back(bframes[x] - 1);
+                i = x - 1;
+                x = frames;
+            }
+
+            if (!m_aggressive &&
+                ((abs((int)(gap_length - (30 * fps))) < (int)(fps * 0.85)) ||
+                 (abs((int)(gap_length - (60 * fps))) < (int)(fps * 0.95)) ||
+                 (abs((int)(gap_length - (90 * fps))) < (int)(fps * 1.05)) ||
+                 (abs((int)(gap_length - (120 * fps))) < (int)(fps * 1.15))) &&
+                ((x + 2) < frames) &&
+                ((i + 2) < frames) &&
+                ((bframes[i] + 1) == bframes[i+1]) &&
+                ((bframes[x] + 1) == bframes[x+1]))
+            {
+                c_start.push_back(bframes[i]);
+                c_end.push_back(bframes[x]);
+                i = x;
+                x = frames;
+            }
+        }
+    }
+
+    const int commercials = c_start.size();
+    if (!commercials)
+        return;
+
+    int i = 0;
+
+    // don't allow single commercial at head
+    // of show unless followed by another
+    if ((commercials > 1) &&
+        (c_end[0] < (33 * fps)) &&
+        (c_start[1] > (c_end[0] + 40 * fps)))
+        i = 1;
+
+    // eliminate any blank frames at end of commercials
+    frm_dir_map_t comms;
+    bool first_comm = true;
+    for (; i < (commercials - 1); i++)
+    {
+        long long r = c_start[i];
+        long long adjustment = 0;
+
+        if ((r < (30 * fps)) && first_comm)
+            r = 1;
+
+        comms[r] = MARK_COMM_START;
+
+        r = c_end[i];
+        int x;
+        for (x = 0; x < (frames - 1); x++)
+            if (bframes[x] == r)
+                break;
+        while ((x < (frames - 1)) &&
+               ((bframes[x] + 1) == bframes[x+1]) &&
+               (bframes[x+1] < c_start[i+1]))
+        {
+            r++;
+            x++;
+        }
+
+        while (m_blankFrames.contains(r + 1) && (c_start[i+1] != (r + 1)))
+        {
+            r++;
+            adjustment++;
+        }
+
+        adjustment /= 2;
+        if (adjustment > kMaxBlankFrames)
+            adjustment = kMaxBlankFrames;
+        r -= adjustment;
+        comms[r] = MARK_COMM_END;
+        first_comm = false;
+    }
+
+    comms[c_start[i]] = MARK_COMM_START;
+    comms[c_end[i]] = MARK_COMM_END;
+
+    // if next commercial starts less than 15*fps frames away then merge
+    breaks = comms;
+    frm_dir_map_t::const_iterator it = comms.begin();
+    frm_dir_map_t::const_iterator prev = it;
+    for (++it; it != comms.end(); ++it, ++prev)
+    {
+        if ((((prev.key() + 1) == it.key()) ||
+             ((prev.key() + (15 * fps)) > it.key())) &&
+            (*prev == MARK_COMM_END) &&
+            (*it == MARK_COMM_START))
+        {
+            breaks.remove(prev.key());
+            breaks.remove(it.key());
+        }
+    }
+
+    if (breaks.size() < 2)
+        return;
+
+    // make temp copy of commercial break list
+    QMap<long long, long long> tmpMap;
+    it = breaks.begin();
+    prev = it;
+    ++it;
+    tmpMap[prev.key()] = it.key();
+    for (; it != breaks.end(); ++it, ++prev)
+    {
+        if ((*prev == MARK_COMM_START) && (*it == MARK_COMM_END))
+            tmpMap[prev.key()] = it.key();
+    }
+
+    // if we find any segments less than 35 seconds between commercial
+    // breaks include those segments in the commercial break.
+    QMap<long long, long long>::const_iterator tmp_it = tmpMap.begin();
+    QMap<long long, long long>::const_iterator tmp_prev = tmp_it;
+    for (++tmp_it; tmp_it != tmpMap.end(); ++tmp_it, ++tmp_prev)
+    {
+        if (((*tmp_prev + (35 * fps)) > tmp_it.key()) &&
+            ((*tmp_prev - tmp_prev.key()) > (35 * fps)) &&
+            ((*tmp_it - tmp_it.key()) > (35 * fps)))
+        {
+            breaks.remove(*tmp_prev);
+            breaks.remove(tmp_it.key());
+        }
+    }
+}
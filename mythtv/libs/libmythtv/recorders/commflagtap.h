@@ -0,0 +1,107 @@
+// -*- Mode: c++ -*-
+/**
+ *  CommFlagTap -- blank frame commercial detection while recording
+ *  Distributed as part of MythTV under GPL v2 and later.
+ */
+
+#ifndef COMMFLAGTAP_H
+#define COMMFLAGTAP_H
+
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+
+#include "programtypes.h"
+#include "mthread.h"
+
+struct AVCodecContext;
+struct AVCodecParserContext;
+struct AVFrame;
+
+/** \class CommFlagTap
+ *  \brief Looks for commercial breaks in the video a DTVRecorder writes.
+ *
+ *  The recorder hands over every transport stream packet it writes;
+ *  packets of the video PID are queued and decoded at reduced resolution
+ *  on a thread of our own. Each frame is classified as blank or not the
+ *  way ClassicCommDetector does it. Frames are placed by their pts, so
+ *  frames the decoder drops do not shift the ones after them. When the
+ *  recording is finished the blank frames are turned into a commercial
+ *  break list with the same heuristics as mythcommflag's blank frame
+ *  method.
+ *
+ *  If the decoder falls too far behind the recorder, or has not caught
+ *  up soon after the recording ends, the tap gives up and the recording
+ *  is left for the regular commercial flagging job.
+ */
+class CommFlagTap : protected MThread
+{
+  public:
+    static CommFlagTap *Create(uint pid, uint stream_type);
+    ~CommFlagTap();
+
+    uint GetPID(void) const { return m_pid; }
+
+    void AddTSPackets(const unsigned char *buf, uint size);
+    bool Finish(frm_dir_map_t &breaks, double fps);
+
+  protected:
+    CommFlagTap(uint pid, int codec_id);
+    virtual void run(void); // MThread
+
+  private:
+    bool OpenDecoder(void);
+    void CloseDecoder(void);
+    void ProcessTSPackets(const QByteArray &packets);
+    void ParseES(const unsigned char *buf, int size, int64_t pts, int64_t dts);
+    void DecodeFrame(const unsigned char *buf, int size,
+                     int64_t pts, int64_t dts);
+    void AnalyzeFrame(const AVFrame *frame);
+    int64_t FrameTime(const AVFrame *frame);
+    void BuildBreaks(frm_dir_map_t &breaks, double fps) const;
+
+  private:
+    uint                  m_pid;
+    int                   m_codecId;
+
+    // settings, same as ClassicCommDetector's
+    int                   m_blankFrameMaxDiff;
+    int                   m_darkBrightness;
+    int                   m_dimBrightness;
+    int                   m_borderSetting;
+    bool                  m_aggressive;
+
+    // shared with the recorder thread, protected by m_lock
+    mutable QMutex        m_lock;
+    QWaitCondition        m_wait;
+    QByteArray            m_pending;
+    bool                  m_finishing;
+    bool                  m_failed;
+
+    // decoder thread only
+    AVCodecContext       *m_ctx;
+    AVCodecParserContext *m_parser;
+    AVFrame              *m_frame;
+    bool                  m_inPES;
+    uint                  m_pesHeaderLeft;
+    int64_t               m_pesPts;
+    int64_t               m_pesDts;
+    long long             m_framesDecoded;
+    /// Presentation time of the first frame, the recorder's frame 0
+    int64_t               m_firstPts;
+    int64_t               m_lastPts;
+    /// Added to every pts to undo wraps and discontinuities
+    int64_t               m_ptsOffset;
+    /// Blank frames, in 90kHz ticks from the first frame
+    QVector<int64_t>      m_blankTimes;
+    double                m_decoderFps;
+
+    // after Finish(), blank frames by the recorder's frame numbers
+    frm_dir_map_t         m_blankFrames;
+
+    static const uint     kMaxPendingBytes;
+    static const uint     kFinishTimeout;
+};
+
+#endif // COMMFLAGTAP_H
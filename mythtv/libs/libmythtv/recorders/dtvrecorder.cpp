@@ -22,6 +22,7 @@
 #include "mpegstreamdata.h"
 #include "dvbstreamdata.h"
 #include "dtvrecorder.h"
+#include "commflagtap.h"
 #include "programinfo.h"
 #include "mythlogging.h"
 #include "mpegtables.h"
@@ -80,6 +81,9 @@ DTVRecorder::DTVRecorder(TVRec *rec) :
     _has_no_av(false),
     // record 'raw' mpts?
     _record_mpts(false),
+    // in-recorder commercial flagging
+    _commflag_tap_requested(false),
+    _commflag_tap(NULL),
     // statistics
     _use_pts(false),
     _packet_count(0),
@@ -112,6 +116,8 @@ DTVRecorder::~DTVRecorder(void)
 
     SetStreamData(NULL);
 
+    delete _commflag_tap;
+
     if (_input_pat)
     {
         delete _input_pat;
@@ -137,7 +143,11 @@ void DTVRecorder::SetOption(const QString &name, const QString &value)
 }
 
 /** \fn DTVRecorder::SetOption(const QString&,int)
- *  \brief handles the "wait_for_seqstart" option.
+ *  \brief handles the "wait_for_seqstart", "recordmpts" and
+ *         "commflagtap" options.
+ *
+ *  "commflagtap" asks for the commercial breaks of the current recording
+ *  to be found while it is written, see CommFlagTap.
  */
 void DTVRecorder::SetOption(const QString &name, int value)
 {
@@ -145,6 +155,8 @@ void DTVRecorder::SetOption(const QString &name, int value)
         _wait_for_keyframe_option = (value == 1);
     else if (name == "recordmpts")
         _record_mpts = (value == 1);
+    else if (name == "commflagtap")
+        _commflag_tap_requested = (value == 1);
     else
         RecorderBase::SetOption(name, value);
 }
@@ -162,6 +174,9 @@ void DTVRecorder::SetOptionsFromProfile(RecordingProfile *profile,
 /** \fn DTVRecorder::FinishRecording(void)
  *  \brief Flushes the ringbuffer, and if this is not a live LiveTV
  *         recording saves the position map and filesize.
+ *
+ *  If the commercial flagging tap was running, the commercial breaks
+ *  it found are saved too and the recording is marked as flagged.
  */
 void DTVRecorder::FinishRecording(void)
 {
@@ -174,6 +189,22 @@ void DTVRecorder::FinishRecording(void)
         SetTotalFrames(_frames_written_count);
     }
 
+    if (_commflag_tap)
+    {
+        frm_dir_map_t breaks;
+        if (_commflag_tap->Finish(breaks, GetFrameRate()) && curRecording)
+        {
+            LOG(VB_RECORD, LOG_INFO, LOC + QString("Saving %1 commercial "
+                "break marks found while recording").arg(breaks.size()));
+            curRecording->SaveCommBreakList(breaks);
+            curRecording->SaveCommFlagged(COMM_FLAG_DONE);
+        }
+        delete _commflag_tap;
+        _commflag_tap = NULL;
+    }
+    // the tap covers one recording, the next file gets the regular job
+    _commflag_tap_requested = false;
+
     RecorderBase::FinishRecording();
 }
 
@@ -242,6 +273,16 @@ void DTVRecorder::Reset(void)
     LOG(VB_RECORD, LOG_INFO, LOC + "Reset(void)");
     ResetForNewFile();
 
+    // Frame numbers start over, the tap's would no longer match the file
+    if (_commflag_tap)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC + "Reset, leaving commercial flagging "
+            "to the job queue");
+        delete _commflag_tap;
+        _commflag_tap = NULL;
+        _commflag_tap_requested = false;
+    }
+
     _start_code = 0xffffffff;
 
     if (curRecording)
@@ -336,12 +377,12 @@ void DTVRecorder::BufferedWrite(const TSPacket &tspacket, bool insert)
         if (!_payload_buffer.empty())
         {
             if (ringBuffer)
-                ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
+                WriteToRingBuffer(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
         }
     }
 
-    if (ringBuffer && ringBuffer->Write(tspacket.data(), TSPacket::kSize) < 0 &&
+    if (ringBuffer && WriteToRingBuffer(tspacket.data(), TSPacket::kSize) < 0 &&
         curRecording && curRecording->GetRecordingStatus() != RecStatus::Failing)
     {
         LOG(VB_GENERAL, LOG_INFO, LOC +
@@ -352,6 +393,15 @@ void DTVRecorder::BufferedWrite(const TSPacket &tspacket, bool insert)
     }
 }
 
+/// Writes whole TS packets to the ringbuffer, passing them on to the
+/// commercial flagging tap if there is one.
+int DTVRecorder::WriteToRingBuffer(const unsigned char *buf, uint size)
+{
+    if (_commflag_tap)
+        _commflag_tap->AddTSPackets(buf, size);
+    return ringBuffer->Write(buf, size);
+}
+
 enum { kExtractPTS, kExtractDTS };
 static int64_t extract_timestamp(
     const uint8_t *bufptr, int bytes_left, int pts_or_dts)
@@ -1515,13 +1565,21 @@ bool DTVRecorder::ProcessVideoTSPacket(const TSPacket &tspacket)
 
     uint streamType = _stream_id[tspacket.PID()];
 
+    // Start the commercial flagging tap on the first video packet, before
+    // anything of this PID is written.
+    if (_commflag_tap_requested && !_record_mpts && streamType != 0)
+    {
+        _commflag_tap_requested = false;
+        _commflag_tap = CommFlagTap::Create(tspacket.PID(), streamType);
+    }
+
     if (tspacket.HasPayload() && tspacket.PayloadStart())
     {
         if (_buffer_packets && _first_keyframe >= 0 && !_payload_buffer.empty())
         {
             // Flush the buffer
             if (ringBuffer)
-                ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
+                WriteToRingBuffer(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
         }
 
@@ -1552,7 +1610,7 @@ bool DTVRecorder::ProcessAudioTSPacket(const TSPacket &tspacket)
         {
             // Flush the buffer
             if (ringBuffer)
-                ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
+                WriteToRingBuffer(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
         }
 
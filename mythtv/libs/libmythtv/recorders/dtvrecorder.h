@@ -21,6 +21,7 @@ using namespace std;
 #include "H264Parser.h"
 
 class MPEGStreamData;
+class CommFlagTap;
 class TSPacket;
 class QTime;
 class StreamID;
@@ -101,6 +102,7 @@ class DTVRecorder :
     void UpdateFramesWritten(void);
 
     void BufferedWrite(const TSPacket &tspacket, bool insert = false);
+    int  WriteToRingBuffer(const unsigned char *buf, uint size);
 
     // MPEG TS "audio only" support
     bool FindAudioKeyframes(const TSPacket *tspacket);
@@ -177,6 +179,10 @@ class DTVRecorder :
     unsigned char _continuity_counter[0x1fff + 1];
     vector<TSPacket> _scratch;
 
+    // In-recorder commercial flagging
+    bool          _commflag_tap_requested;
+    CommFlagTap  *_commflag_tap;
+
     // Statistics
     int           _minimum_recording_quality;
     bool          _use_pts; // vs use dts
@@ -0,0 +1,122 @@
+/*
+ *  Frame copy kernel throughput benchmark
+ *
+ *  Times every copyplane/splitplanes kernel the running CPU supports
+ *  over common frame sizes, so a new kernel can be compared against
+ *  the existing ones on the hardware it is meant for.
+ *
+ *  Usage: bench_copyframes [iterations]
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <QElapsedTimer>
+
+#include "mythframe.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+}
+
+static const struct
+{
+    const char *name;
+    int         width;
+    int         height;
+} sizes[] =
+{
+    { "576p",  720,  576  },
+    { "720p",  1280, 720  },
+    { "1080p", 1920, 1088 },
+    { "2160p", 3840, 2160 },
+};
+
+static double rate(qint64 bytes, qint64 nsecs)
+{
+    return nsecs ? (double)bytes / (double)nsecs : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+    if (iterations < 1)
+        iterations = 1;
+
+    int count;
+    const FrameCopyKernels *kernels = framecopy_kernel_list(&count);
+    int cpuflags = av_get_cpu_flags();
+
+    printf("Selected kernel: %s, %d iterations\n",
+           framecopy_kernels()->name, iterations);
+    printf("%-8s %-6s %14s %14s\n",
+           "kernel", "size", "copy (GB/s)", "split (GB/s)");
+
+    for (uint s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        int width  = sizes[s].width;
+        int height = sizes[s].height;
+        // NV12 chroma plane: width/2 interleaved UV pairs per line
+        int pitch  = (width + 63) & ~63;
+        int size   = pitch * height;
+
+        uint8_t *src  = (uint8_t*)av_malloc(size);
+        uint8_t *dst  = (uint8_t*)av_malloc(size);
+        uint8_t *dstu = (uint8_t*)av_malloc(size / 2);
+        uint8_t *dstv = (uint8_t*)av_malloc(size / 2);
+        if (!src || !dst || !dstu || !dstv)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        for (int i = 0; i < size; i++)
+            src[i] = i & 0xff;
+
+        for (int k = 0; k < count; k++)
+        {
+            if ((cpuflags & kernels[k].cpu_flags) != kernels[k].cpu_flags)
+                continue;
+
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < iterations; i++)
+                kernels[k].copyplane(dst, pitch, src, pitch, width, height);
+            qint64 copy = timer.nsecsElapsed();
+
+            timer.restart();
+            for (int i = 0; i < iterations; i++)
+            {
+                kernels[k].splitplanes(dstu, pitch / 2, dstv, pitch / 2,
+                                       src, pitch, width / 2, height);
+            }
+            qint64 split = timer.nsecsElapsed();
+
+            qint64 bytes = (qint64)width * height * iterations;
+            printf("%-8s %-6s %14.2f %14.2f\n", kernels[k].name,
+                   sizes[s].name, rate(bytes, copy), rate(bytes, split));
+        }
+
+        av_freep(&src);
+        av_freep(&dst);
+        av_freep(&dstu);
+        av_freep(&dstv);
+    }
+
+    return 0;
+}
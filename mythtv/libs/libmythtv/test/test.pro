@@ -3,6 +3,7 @@ include (../../../settings.pro)
 TEMPLATE = subdirs
 
 SUBDIRS += $$files(test_*)
+SUBDIRS += bench_copyframes
 
 unittest.target = test
 unittest.commands = ../../../programs/scripts/unittests.sh
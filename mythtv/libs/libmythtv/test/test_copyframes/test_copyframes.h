@@ -24,6 +24,10 @@
 #include "mythframe.h"
 #include "mythavutil.h"
 
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #define MSKIP(MSG) QSKIP(MSG, SkipSingle)
 #else
@@ -1267,4 +1271,68 @@ class TestCopyFrames: public QObject
         av_freep(&bufsrc);
         av_freep(&bufdst);
     }
+    void Kernels_data(void)
+    {
+        QTest::addColumn<int>("width");
+        QTest::newRow("1920") << 1920;
+        QTest::newRow("721") << 721;
+        QTest::newRow("33") << 33;
+        QTest::newRow("7") << 7;
+    }
+
+    // Every kernel the CPU supports must match the C kernels exactly
+    void Kernels(void)
+    {
+        QFETCH(int, width);
+        int count;
+        const FrameCopyKernels *kernels = framecopy_kernel_list(&count);
+        int height = 17;
+        int pitch  = (width * 2 + 63) & ~63;
+
+        uint8_t *src   = (uint8_t*)av_malloc(pitch * height + 1);
+        uint8_t *refu  = (uint8_t*)av_malloc(pitch * height);
+        uint8_t *refv  = (uint8_t*)av_malloc(pitch * height);
+        uint8_t *dstu  = (uint8_t*)av_malloc(pitch * height);
+        uint8_t *dstv  = (uint8_t*)av_malloc(pitch * height);
+        for (int i = 0; i < pitch * height + 1; i++)
+            src[i] = (i * 7 + (i >> 8)) & 0xff;
+
+        // src + 1 also exercises unaligned loads
+        kernels[0].splitplanes(refu, pitch, refv, pitch,
+                               src + 1, pitch, width, height);
+
+        for (int k = 1; k < count; k++)
+        {
+            if ((av_get_cpu_flags() & kernels[k].cpu_flags) !=
+                kernels[k].cpu_flags)
+                continue;
+
+            memset(dstu, 0, pitch * height);
+            memset(dstv, 0, pitch * height);
+            kernels[k].splitplanes(dstu, pitch, dstv, pitch,
+                                   src + 1, pitch, width, height);
+            for (int y = 0; y < height; y++)
+            {
+                QVERIFY2(!memcmp(refu + y * pitch, dstu + y * pitch, width),
+                         kernels[k].name);
+                QVERIFY2(!memcmp(refv + y * pitch, dstv + y * pitch, width),
+                         kernels[k].name);
+            }
+
+            memset(dstu, 0, pitch * height);
+            kernels[k].copyplane(dstu, pitch, src + 1, pitch,
+                                 width * 2 - 1, height);
+            for (int y = 0; y < height; y++)
+            {
+                QVERIFY2(!memcmp(src + 1 + y * pitch, dstu + y * pitch,
+                                 width * 2 - 1), kernels[k].name);
+            }
+        }
+
+        av_freep(&src);
+        av_freep(&refu);
+        av_freep(&refv);
+        av_freep(&dstu);
+        av_freep(&dstv);
+    }
 };
@@ -823,4 +823,90 @@ void TestEITFixups::test64BitEnum(void)
     QVERIFY(1<<31 & 1ull<<32);
 }
 
+void TestEITFixups::testRegExpPrefilter(void)
+{
+    QCOMPARE(EITRegExp("\\s*(Then|Followed by) 60 Seconds\\.").RequiredLiterals(),
+             QStringList(" 60 Seconds."));
+    QCOMPARE(EITRegExp("\\b(?:Season|Series|S)\\s*(\\d+)\\s*,?").RequiredLiterals(),
+             QStringList() << "Season" << "Series" << "S");
+    QCOMPARE(EITRegExp("(?:\\W)?(Sport|Football)(?:\\W)?").RequiredLiterals(),
+             QStringList() << "Sport" << "Football");
+    QCOMPARE(EITRegExp("x?y+z").RequiredLiterals(), QStringList("y"));
+
+    // no literal is needed by every match, the engine always runs
+    QVERIFY(EITRegExp("[:\\.]\\s").RequiredLiterals().isEmpty());
+    QVERIFY(EITRegExp("Foo|\\d+").RequiredLiterals().isEmpty());
+    QVERIFY(EITRegExp("(?:Foo)?\\d+").RequiredLiterals().isEmpty());
+
+    // skipping the engine must not change the outcome
+    EITRegExp rx("\\s*Also in HD\\.", Qt::CaseInsensitive);
+    QVERIFY(rx.MayMatch("Drama. ALSO IN HD."));
+    QVERIFY(!rx.MayMatch("Drama."));
+    QCOMPARE(rx.indexIn("Drama. Also in HD."), 6);
+    QCOMPARE(rx.indexIn("Drama."), -1);
+    QCOMPARE(rx.matchedLength(), -1);
+    QCOMPARE(rx.IndexIn("Drama. also in hd."), 6);
+
+    QString desc("Drama. Also in HD.");
+    QCOMPARE(rx.RemoveFrom(desc), QString("Drama."));
+}
+
+void TestEITFixups::benchmarkFixups(void)
+{
+    // A mix of the events seen on a multi provider setup, most of the
+    // patterns of a fixup don't match most of the events it is applied to.
+    static const struct
+    {
+        FixupValue  fixup;
+        const char *title;
+        const char *subtitle;
+        const char *description;
+    } events[] =
+    {
+        { EITFixUp::kFixUK, "Book of the Week", "",
+          "Girl in the Dark: Anna Lyndsey's account of finding light in the "
+          "darkness after illness changed her life. 3/5. A Descent into "
+          "Darkness: The disquieting persistence of the light." },
+        { EITFixUp::kFixUK, "Hoarders", "",
+          "Fascinating series chronicling the lives of serial hoarders. "
+          "Often facing loss of their children, career, or divorce, can "
+          "people with this disorder be helped? S3, Ep1" },
+        { EITFixUp::kFixUK, "New: Marvel's Agents of...", "",
+          "...S.H.I.E.L.D. Brand new series - Bouncing Back: <description> "
+          "(S3 Ep11/22)  [AD,S]" },
+        { EITFixUp::kFixUK, "Newsnight", "",
+          "With Kirsty Wark. Also in HD." },
+        { EITFixUp::kFixBell, "Movie Night", "",
+          "An old drifter comes to town. (1957) John Wayne, Dean Martin" },
+        { EITFixUp::kFixNL, "Journaal", "",
+          "Het laatste nieuws. Breedbeeld, Herhaling, Teletekst 888" },
+        { EITFixUp::kFixUnitymedia, "Titel", "Beschreib",
+          "Beschreibung ... IMDb Rating: 8.9 /10" },
+        { EITFixUp::kFixATV, "Gilmore Girls",
+          "Eine Hochzeit und ein Todesfall, Folge 17",
+          "Lorelai und Rory helfen Luke in seinem Café aus." },
+        { EITFixUp::kFixGreekSubtitle | EITFixUp::kFixGreekEIT |
+          EITFixUp::kFixGreekCategories, "Ειδήσεις", "",
+          "Δελτίο ειδήσεων με τα γεγονότα της ημέρας." },
+        { EITFixUp::kFixGreekSubtitle | EITFixUp::kFixGreekEIT |
+          EITFixUp::kFixGreekCategories, "Το σπίτι", "",
+          "Κωμική σειρά. Παίζουν: Γιώργος Παπαδόπουλος, Μαρία Νικολάου." },
+    };
+
+    EITFixUp fixup;
+
+    QBENCHMARK
+    {
+        for (uint i = 0; i < sizeof(events) / sizeof(events[0]); ++i)
+        {
+            DBEventEIT *event = SimpleDBEventEIT(events[i].fixup,
+                                                 events[i].title,
+                                                 events[i].subtitle,
+                                                 events[i].description);
+            fixup.Fix(*event);
+            delete event;
+        }
+    }
+}
+
 QTEST_APPLESS_MAIN(TestEITFixups)
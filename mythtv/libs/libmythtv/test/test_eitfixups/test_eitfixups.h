@@ -53,6 +53,8 @@ class TestEITFixups : public QObject
     void testDeDisneyChannel(void);
     void testATV(void);
     void test64BitEnum(void);
+    void testRegExpPrefilter(void);
+    void benchmarkFixups(void);
 
   private:
     static DBEventEIT *SimpleDBEventEIT (FixupValue fix, QString title, QString subtitle, QString description);
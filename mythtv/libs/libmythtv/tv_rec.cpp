@@ -94,7 +94,8 @@ TVRec::TVRec(int _inputid)
       recorderThread(NULL),
       // Configuration variables from database
       transcodeFirst(false),
-      earlyCommFlag(false),         runJobOnHostOnly(false),
+      earlyCommFlag(false),         recorderCommFlag(false),
+      runJobOnHostOnly(false),
       eitCrawlIdleStart(60),        eitTransportTimeout(5*60),
       audioSampleRateDB(0),
       overRecordSecNrml(0),         overRecordSecCat(0),
@@ -179,6 +180,7 @@ bool TVRec::Init(void)
     transcodeFirst    =
         gCoreContext->GetNumSetting("AutoTranscodeBeforeAutoCommflag", 0);
     earlyCommFlag     = gCoreContext->GetNumSetting("AutoCommflagWhileRecording", 0);
+    recorderCommFlag  = gCoreContext->GetNumSetting("CommFlagInRecorder", 0);
     runJobOnHostOnly  = gCoreContext->GetNumSetting("JobsRunOnRecordHost", 0);
     eitTransportTimeout =
         max(gCoreContext->GetNumSetting("EITTransportTimeout", 5) * 60, 6);
@@ -1002,6 +1004,15 @@ void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq)
         autoJob = autoRunJobs.find(curRec->MakeUniqueKey());
     }
     LOG(VB_JOBQUEUE, LOG_INFO, QString("AutoRunJobs 0x%1").arg(*autoJob,0,16));
+    // The recorder may already have found the commercial breaks
+    if (recorderCommFlag &&
+        JobQueue::JobIsInMask(JOB_COMMFLAG, *autoJob) &&
+        (curRec->QueryCommFlagStatus() == COMM_FLAG_DONE))
+    {
+        LOG(VB_JOBQUEUE, LOG_INFO, LOC + "Flagged while recording, "
+            "not queueing a commercial flagging job");
+        JobQueue::RemoveJobsFromMask(JOB_COMMFLAG, *autoJob);
+    }
     if ((recgrp == "LiveTV") || (fsize < 1000) ||
         (curRec->GetRecordingStatus() != RecStatus::Recorded) ||
         (curRec->GetRecordingStartTime().secsTo(
@@ -2791,9 +2802,10 @@ void TVRec::InitAutoRunJobs(RecordingInfo *rec, AutoRunInitType t,
             LoadProfile(NULL, rec, profile);
             recpro = &profile;
         }
+        // Flagging in the recorder takes the place of the early job
         autoRunJobs[rec->MakeUniqueKey()] =
             init_jobs(rec, *recpro, runJobOnHostOnly,
-                      transcodeFirst, earlyCommFlag);
+                      transcodeFirst, earlyCommFlag && !recorderCommFlag);
     }
     else
     {
@@ -4320,6 +4332,18 @@ void TVRec::TuningNewRecorder(MPEGStreamData *streamData)
         GetDTVRecorder()->SetStreamData(streamData);
     }
 
+    // Find commercials while recording if a flagging job is due anyway
+    if (rec && recorderCommFlag && GetDTVRecorder())
+    {
+        QHash<QString,int>::const_iterator autoJob =
+            autoRunJobs.find(rec->MakeUniqueKey());
+        if ((autoJob != autoRunJobs.end()) &&
+            JobQueue::JobIsInMask(JOB_COMMFLAG, *autoJob))
+        {
+            GetDTVRecorder()->SetOption("commflagtap", 1);
+        }
+    }
+
     if (channel && genOpt.inputtype == "MJPEG")
         channel->Open(); // Needed because of NVR::MJPEGInit()
 
@@ -362,6 +362,7 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     // Configuration variables from database
     bool    transcodeFirst;
     bool    earlyCommFlag;
+    bool    recorderCommFlag;
     bool    runJobOnHostOnly;
     int     eitCrawlIdleStart;
     int     eitTransportTimeout;
@@ -8,6 +8,7 @@
 
 #include "mythcontext.h"
 #include "videobuffers.h"
+#include "framebufferpool.h"
 extern "C" {
 #include "libavcodec/avcodec.h"
 }
@@ -140,11 +141,13 @@ VideoBuffers::VideoBuffers()
       keepprebufferframes(0), createdpauseframe(false), rpos(0), vpos(0),
       global_lock(QMutex::Recursive)
 {
+    FrameBufferPool::GetPool()->AddUser();
 }
 
 VideoBuffers::~VideoBuffers()
 {
     DeleteBuffers();
+    FrameBufferPool::GetPool()->RemoveUser();
 }
 
 /**
@@ -738,7 +741,8 @@ bool VideoBuffers::CreateBuffers(VideoFrameType type, int width, int height,
 
     while (bufs.size() < Size())
     {
-        unsigned char *data = (unsigned char*)av_malloc(buf_size + 64);
+        unsigned char *data =
+            FrameBufferPool::GetPool()->Acquire(buf_size + 64);
         if (!data)
         {
             LOG(VB_GENERAL, LOG_ERR, "Failed to allocate memory for frame.");
@@ -794,7 +798,7 @@ uint VideoBuffers::AddBuffer(int width, int height, void* data,
     if (!data)
     {
         int size = buffersize(fmt, width, height);
-        data = av_malloc(size);
+        data = FrameBufferPool::GetPool()->Acquire(size);
         allocated_arrays.push_back((unsigned char*)data);
     }
     init(&buffers[num], fmt, (unsigned char*)data, width, height, 0);
@@ -815,8 +819,10 @@ void VideoBuffers::DeleteBuffers()
         av_freep(&buffers[i].qscale_table);
     }
 
+    // Handing the frames back to the pool rather than freeing them lets
+    // the next CreateBuffers() at this size reuse them
     for (uint i = 0; i < allocated_arrays.size(); i++)
-        av_free(allocated_arrays[i]);
+        FrameBufferPool::GetPool()->Release(allocated_arrays[i]);
     allocated_arrays.clear();
 }
 
@@ -5,6 +5,7 @@
 #include "videooutbase.h"
 #include "videodisplayprofile.h"
 #include "filtermanager.h"
+#include "framebufferpool.h"
 #include "osd.h"
 #include "mythuihelper.h"
 #include "openglvideo.h"
@@ -130,7 +131,8 @@ void VideoOutputOpenGL::DestroyCPUResources(void)
 
     if (av_pause_frame.buf)
     {
-        av_freep(&av_pause_frame.buf);
+        FrameBufferPool::GetPool()->Release(av_pause_frame.buf);
+        av_pause_frame.buf = NULL;
     }
     if (av_pause_frame.qscale_table)
     {
@@ -484,7 +486,7 @@ bool VideoOutputOpenGL::CreatePauseFrame(void)
     int size = buffersize(FMT_YV12,
                           vbuffers.GetScratchFrame()->width,
                           vbuffers.GetScratchFrame()->height);
-    unsigned char *buffer = (unsigned char *)av_malloc(size);
+    unsigned char *buffer = FrameBufferPool::GetPool()->Acquire(size);
     init(&av_pause_frame, FMT_YV12,
          buffer,
          vbuffers.GetScratchFrame()->width,
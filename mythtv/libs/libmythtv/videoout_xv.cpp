@@ -39,6 +39,7 @@ using namespace std;
 #include "mythcorecontext.h"
 #include "mythlogging.h"
 #include "filtermanager.h"
+#include "framebufferpool.h"
 #include "videodisplayprofile.h"
 #define IGNORE_TV_PLAY_REC
 #include "tv.h"
@@ -523,13 +524,14 @@ void VideoOutputXv::CreatePauseFrame(VOSType subtype)
 {
     if (av_pause_frame.buf)
     {
-        av_freep(&av_pause_frame.buf);
+        FrameBufferPool::GetPool()->Release(av_pause_frame.buf);
+        av_pause_frame.buf = NULL;
     }
 
     int size = buffersize(FMT_YV12,
                           vbuffers.GetScratchFrame()->width,
                           vbuffers.GetScratchFrame()->height);
-    unsigned char* buf = (unsigned char*)av_malloc(size);
+    unsigned char* buf = FrameBufferPool::GetPool()->Acquire(size);
     init(&av_pause_frame, FMT_YV12, buf,
          vbuffers.GetScratchFrame()->width,
          vbuffers.GetScratchFrame()->height,
@@ -1278,7 +1280,8 @@ void VideoOutputXv::DeleteBuffers(VOSType subtype, bool delete_pause_frame)
     {
         if (av_pause_frame.buf)
         {
-            av_freep(&av_pause_frame.buf);
+            FrameBufferPool::GetPool()->Release(av_pause_frame.buf);
+            av_pause_frame.buf = NULL;
         }
         if (av_pause_frame.qscale_table)
         {
@@ -18,6 +18,7 @@
 #include "mythxdisplay.h"
 #include "mythavutil.h"
 #include "mthreadpool.h"
+#include "framebufferpool.h"
 
 #ifdef USING_XV
 #include "videoout_xv.h"
@@ -1012,8 +1013,8 @@ void VideoOutput::DoPipResize(int pipwidth, int pipheight)
 
     int sz = buffersize(FMT_YV12,
                         pip_display_size.width(), pip_display_size.height());
-    pip_tmp_buf = (unsigned char*)av_malloc(sz);
-    pip_tmp_buf2 = (unsigned char*)av_malloc(sz);
+    pip_tmp_buf  = FrameBufferPool::GetPool()->Acquire(sz);
+    pip_tmp_buf2 = FrameBufferPool::GetPool()->Acquire(sz);
 
     pip_scaling_context = sws_getCachedContext(pip_scaling_context,
                               pip_video_size.width(), pip_video_size.height(),
@@ -1034,12 +1035,14 @@ void VideoOutput::ShutdownPipResize(void)
 {
     if (pip_tmp_buf)
     {
-        av_freep(&pip_tmp_buf);
+        FrameBufferPool::GetPool()->Release(pip_tmp_buf);
+        pip_tmp_buf = NULL;
     }
 
     if (pip_tmp_buf2)
     {
-        av_freep(&pip_tmp_buf2);
+        FrameBufferPool::GetPool()->Release(pip_tmp_buf2);
+        pip_tmp_buf2 = NULL;
     }
 
     if (pip_scaling_context)
@@ -1202,7 +1205,7 @@ void VideoOutput::DoVideoResize(const QSize &inDim, const QSize &outDim)
     vsz_display_size = outDim;
 
     int sz = vsz_display_size.height() * vsz_display_size.width() * 3 / 2;
-    vsz_tmp_buf = new unsigned char[sz];
+    vsz_tmp_buf = FrameBufferPool::GetPool()->Acquire(sz);
 
     vsz_scale_context = sws_getCachedContext(vsz_scale_context,
                               vsz_video_size.width(), vsz_video_size.height(),
@@ -1329,7 +1332,7 @@ void VideoOutput::ShutdownVideoResize(void)
 {
     if (vsz_tmp_buf)
     {
-        delete [] vsz_tmp_buf;
+        FrameBufferPool::GetPool()->Release(vsz_tmp_buf);
         vsz_tmp_buf = NULL;
     }
 
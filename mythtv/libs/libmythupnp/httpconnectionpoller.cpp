@@ -0,0 +1,300 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpconnectionpoller.cpp
+//
+// Purpose     : Watches idle HTTP keep-alive connections so they don't
+//               hold a worker thread between requests
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Own headers
+#include "httpconnectionpoller.h"
+
+// POSIX headers
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+// Qt headers
+#include <QTcpSocket>
+#include <QThread>
+
+// MythTV headers
+#include "httpserver.h"
+#include "mythlogging.h"
+
+// Largest request header looked for before a connection is handed over
+#define MAX_PEEK_SIZE 16384
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpConnection Class Implementation
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+HttpConnection::~HttpConnection()
+{
+    delete m_pSocket;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpConnectionPoller Class Implementation
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+HttpConnectionPoller::HttpConnectionPoller(HttpServer &httpServer)
+    : MThread("HttpPoller"), m_httpServer(httpServer), m_epollFd(-1),
+      m_bTermRequested(false)
+{
+#ifdef __linux__
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("HttpConnectionPoller: "
+                                         "epoll_create1 failed: %1")
+                                            .arg(strerror(errno)));
+        return;
+    }
+
+    start();
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpConnectionPoller::~HttpConnectionPoller()
+{
+    Stop();
+
+#ifdef __linux__
+    if (m_epollFd >= 0)
+        ::close(m_epollFd);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpConnectionPoller::Stop(void)
+{
+    m_bTermRequested = true;
+    wait();
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<int, HttpConnection*>::iterator it = m_connections.begin();
+    for (; it != m_connections.end(); ++it)
+        Close(*it);
+    m_connections.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpConnectionPoller::Park(HttpConnection *pConnection)
+{
+#ifdef __linux__
+    int fd = pConnection->m_socket;
+
+    QMutexLocker locker(&m_lock);
+
+    if (m_epollFd < 0 || m_bTermRequested)
+        return false;
+
+    pConnection->m_idleTimer.start();
+    m_connections.insert(fd, pConnection);
+
+    // Edge triggered, so a request that is still arriving is only looked
+    // at again when more of it comes in
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events  = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    event.data.fd = fd;
+
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        LOG(VB_HTTP, LOG_ERR, QString("HttpConnectionPoller(%1): "
+                                      "epoll_ctl failed: %2")
+                                        .arg(fd).arg(strerror(errno)));
+        m_connections.remove(fd);
+        return false;
+    }
+
+    LOG(VB_HTTP, LOG_DEBUG, QString("HttpConnectionPoller(%1): Parked, "
+                                    "%2 idle connections")
+                                        .arg(fd).arg(m_connections.size()));
+    return true;
+#else
+    (void) pConnection;
+    return false;
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpConnectionPoller::run(void)
+{
+    RunProlog();
+
+#ifdef __linux__
+    struct epoll_event events[64];
+
+    while (!m_bTermRequested)
+    {
+        // Wake up at least once a second to expire idle connections
+        int nEvents = epoll_wait(m_epollFd, events, 64, 1000);
+
+        if (nEvents < 0 && errno != EINTR)
+        {
+            LOG(VB_GENERAL, LOG_ERR, QString("HttpConnectionPoller: "
+                                             "epoll_wait failed: %1")
+                                                .arg(strerror(errno)));
+            break;
+        }
+
+        QList<HttpConnection*> ready;
+
+        m_lock.lock();
+
+        for (int i = 0; i < nEvents; ++i)
+        {
+            HttpConnection *pConnection =
+                m_connections.value(events[i].data.fd, NULL);
+            if (!pConnection)
+                continue;
+
+            bool bClosed = false;
+            if (HasRequest(pConnection, bClosed))
+            {
+                Remove(pConnection);
+                ready.append(pConnection);
+            }
+            else if (bClosed)
+            {
+                LOG(VB_HTTP, LOG_INFO, QString("HttpConnectionPoller(%1): "
+                                               "Closed by client")
+                                                .arg(pConnection->m_socket));
+                Remove(pConnection);
+                Close(pConnection);
+            }
+        }
+
+        QHash<int, HttpConnection*>::iterator it = m_connections.begin();
+        while (it != m_connections.end())
+        {
+            HttpConnection *pConnection = *it;
+            if (pConnection->m_idleTimer.elapsed() <
+                pConnection->m_socketTimeout)
+            {
+                ++it;
+                continue;
+            }
+
+            LOG(VB_HTTP, LOG_INFO, QString("HttpConnectionPoller(%1): "
+                                           "Idle timeout, closing")
+                                            .arg(pConnection->m_socket));
+            epoll_ctl(m_epollFd, EPOLL_CTL_DEL, pConnection->m_socket, NULL);
+            it = m_connections.erase(it);
+            Close(pConnection);
+        }
+
+        m_lock.unlock();
+
+        // Handed over outside of the lock, so workers can park meanwhile
+        while (!ready.isEmpty())
+            m_httpServer.StartConnection(ready.takeFirst());
+    }
+#endif
+
+    RunEpilog();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpConnectionPoller::HasRequest(HttpConnection *pConnection,
+                                      bool &bClosed) const
+{
+#ifdef __linux__
+    // The bytes of an encrypted connection can't be looked at here, the
+    // worker will have to wait for the rest of the request itself.
+    if (pConnection->m_type == kSSLServer)
+        return true;
+
+    char buf[MAX_PEEK_SIZE];
+    ssize_t len = recv(pConnection->m_socket, buf, sizeof(buf),
+                       MSG_PEEK | MSG_DONTWAIT);
+
+    if (len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+                     errno != EINTR))
+    {
+        bClosed = true;
+        return false;
+    }
+
+    if (len < 0)
+        return false;
+
+    // A header too large to peek at is left to the worker to deal with
+    if (len == (ssize_t)sizeof(buf))
+        return true;
+
+    QByteArray data = QByteArray::fromRawData(buf, len);
+    return data.contains("\r\n\r\n") || data.contains("\n\n");
+#else
+    (void) pConnection;
+    (void) bClosed;
+    return true;
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpConnectionPoller::Remove(HttpConnection *pConnection)
+{
+#ifdef __linux__
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, pConnection->m_socket, NULL);
+#endif
+    m_connections.remove(pConnection->m_socket);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpConnectionPoller::Close(HttpConnection *pConnection)
+{
+    if (pConnection->m_pSocket)
+    {
+        // Parked sockets belong to no thread, take it before closing it
+        pConnection->m_pSocket->moveToThread(QThread::currentThread());
+        pConnection->m_pSocket->close();
+    }
+#ifdef __linux__
+    else
+    {
+        ::close(pConnection->m_socket);
+    }
+#endif
+
+    delete pConnection;
+}
@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpconnectionpoller.h
+//
+// Purpose     : Watches idle HTTP keep-alive connections so they don't
+//               hold a worker thread between requests
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef __HTTPCONNECTIONPOLLER_H__
+#define __HTTPCONNECTIONPOLLER_H__
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+
+// MythTV headers
+#include "mythqtcompat.h"
+#include "serverpool.h"
+#include "mthread.h"
+
+class QTcpSocket;
+class HttpServer;
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpConnection Class Definition
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief The state of one client connection, which is handed between the
+ *        HttpConnectionPoller and the HttpWorker serving its requests.
+ *
+ * Until the first request is read m_pSocket is NULL and only the socket
+ * descriptor is known.
+ */
+class HttpConnection
+{
+  public:
+    HttpConnection(qt_socket_fd_t sock, PoolServerType type)
+        : m_socket(sock), m_type(type), m_pSocket(NULL),
+          m_bEncrypted(false), m_nRequestsHandled(0),
+          m_socketTimeout(5 * 1000) {}
+
+    ~HttpConnection();
+
+    qt_socket_fd_t  m_socket;
+    PoolServerType  m_type;
+    QTcpSocket     *m_pSocket;
+    bool            m_bEncrypted;
+    int             m_nRequestsHandled;
+    int             m_socketTimeout;    // Milliseconds of idle time allowed
+    QElapsedTimer   m_idleTimer;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpConnectionPoller Class Definition
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Parks idle HTTP connections in an epoll set.
+ *
+ * A connection is handed back to the HttpServer, to be served by a worker
+ * from its pool, once the client has sent the complete header of its next
+ * request. Connections that stay idle past their keep-alive timeout, or
+ * that the client closes, are closed here without ever taking a worker.
+ *
+ * Only available on Linux, elsewhere Park() always fails and the workers
+ * wait on their connections as before.
+ */
+class HttpConnectionPoller : public MThread
+{
+  public:
+    explicit HttpConnectionPoller(HttpServer &httpServer);
+    virtual ~HttpConnectionPoller();
+
+    bool IsAvailable(void) const { return m_epollFd >= 0; }
+
+    /// Takes ownership of the connection, unless false is returned
+    bool Park(HttpConnection *pConnection);
+    void Stop(void);
+
+  protected:
+    virtual void run(void);
+
+  private:
+    bool HasRequest(HttpConnection *pConnection, bool &bClosed) const;
+    void Remove(HttpConnection *pConnection);
+    static void Close(HttpConnection *pConnection);
+
+    HttpServer                     &m_httpServer;
+    int                             m_epollFd;
+    volatile bool                   m_bTermRequested;
+    QMutex                          m_lock;         // Guards the following
+    QHash<int, HttpConnection*>     m_connections;
+};
+
+#endif
@@ -172,7 +172,10 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
                              m_nResponseStatus( 200 ),
                              m_pPostProcess   ( NULL ),
                              m_bKeepAlive     ( true ),
-                             m_nKeepAliveTimeout ( 0 )
+                             m_nKeepAliveTimeout ( 0 ),
+                             m_pChunkedWriter ( NULL ),
+                             m_pStreamSerializer( NULL ),
+                             m_nStreamCaptureLimit( 0 )
 {
     m_response.open( QIODevice::ReadWrite );
 }
@@ -181,6 +184,19 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
 //
 /////////////////////////////////////////////////////////////////////////////
 
+HTTPRequest::~HTTPRequest()
+{
+    // The serializer may still hold buffered output for the writer, so it
+    // must go first.
+
+    delete m_pStreamSerializer;
+    delete m_pChunkedWriter;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 RequestType HTTPRequest::SetRequestType( const QString &sType )
 {
     // HTTP
@@ -251,7 +267,10 @@ QString HTTPRequest::BuildResponseHeader( long long nSize )
             SetResponseHeader("Content-Disposition", QString("inline; filename=\"%2\"").arg(QString(filename.toLatin1())));
         }
 
-        SetResponseHeader("Content-Length", QString::number(nSize));
+        if (nSize < 0)
+            SetResponseHeader("Transfer-Encoding", "chunked");
+        else
+            SetResponseHeader("Content-Length", QString::number(nSize));
 
         // See DLNA  7.4.1.3.11.4.3 Tolerance to unavailable contentFeatures.dlna.org header
         //
@@ -319,6 +338,30 @@ qint64 HTTPRequest::SendResponse( void )
 {
     qint64      nBytes    = 0;
 
+    // ----------------------------------------------------------------------
+    // A streamed response has already been written.  If it wasn't completed
+    // the client can only tell by the connection closing.
+    // ----------------------------------------------------------------------
+
+    if ((m_pChunkedWriter != NULL) && m_pChunkedWriter->HeaderSent())
+    {
+        if (!m_pChunkedWriter->Finished() || m_pChunkedWriter->Failed())
+        {
+            LOG(VB_HTTP, LOG_ERR,
+                QString("HTTPRequest::SendResponse( Chunked ) - Incomplete "
+                        "response after %1 bytes -> %2")
+                    .arg(m_pChunkedWriter->BytesSent()).arg(GetPeerAddress()));
+            return( -1 );
+        }
+
+        LOG(VB_HTTP, LOG_INFO,
+            QString("HTTPRequest::SendResponse( Chunked ) :%1 -> %2: %3 bytes")
+                .arg(GetResponseStatus()) .arg(GetPeerAddress())
+                .arg(m_pChunkedWriter->BytesSent()));
+
+        return( m_pChunkedWriter->BytesSent() );
+    }
+
     switch( m_eResponseType )
     {
         // The following are all eligable for gzip compression
@@ -1755,30 +1798,39 @@ bool HTTPRequest::ProcessSOAPPayload( const QString &sSOAPAction )
 /////////////////////////////////////////////////////////////////////////////
 
 Serializer *HTTPRequest::GetSerializer()
+{
+    return CreateSerializer( &m_response );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+Serializer *HTTPRequest::CreateSerializer( QIODevice *pDevice )
 {
     Serializer *pSerializer = NULL;
 
     if (m_bSOAPRequest)
-        pSerializer = (Serializer *)new SoapSerializer(&m_response,
+        pSerializer = (Serializer *)new SoapSerializer(pDevice,
                                                        m_sNameSpace, m_sMethod);
     else
     {
         QString sAccept = GetRequestHeader( "Accept", "*/*" );
 
         if (sAccept.contains( "application/json", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/javascript", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/x-apple-plist+xml", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new XmlPListSerializer(&m_response);
+            pSerializer = (Serializer *)new XmlPListSerializer(pDevice);
     }
 
     // Default to XML
 
     if (pSerializer == NULL)
-        pSerializer = (Serializer *)new XmlSerializer(&m_response, m_sMethod);
+        pSerializer = (Serializer *)new XmlSerializer(pDevice, m_sMethod);
 
     return pSerializer;
 }
@@ -1787,6 +1839,118 @@ Serializer *HTTPRequest::GetSerializer()
 //
 /////////////////////////////////////////////////////////////////////////////
 
+Serializer *HTTPRequest::GetStreamingSerializer()
+{
+    if (m_pStreamSerializer != NULL)
+        return m_pStreamSerializer;
+
+    // ----------------------------------------------------------------------
+    // Chunked encoding needs an HTTP/1.1 client, and a HEAD request has no
+    // body to stream.  SOAP responses are left alone since UPnP control
+    // points don't reliably handle chunked encoding.
+    // ----------------------------------------------------------------------
+
+    if (m_bSOAPRequest || (m_eType == RequestTypeHead))
+        return NULL;
+
+    if ((m_nMajor < 1) || ((m_nMajor == 1) && (m_nMinor < 1)))
+        return NULL;
+
+    m_pChunkedWriter = new HTTPChunkedWriter( this );
+    m_pChunkedWriter->SetCaptureLimit( m_nStreamCaptureLimit );
+    m_pChunkedWriter->open( QIODevice::WriteOnly );
+
+    Serializer *pSerializer = CreateSerializer( m_pChunkedWriter );
+
+    if (!pSerializer->CanStream())
+    {
+        delete pSerializer;
+        delete m_pChunkedWriter;
+        m_pChunkedWriter = NULL;
+
+        return NULL;
+    }
+
+    m_pStreamSerializer = pSerializer;
+
+    return m_pStreamSerializer;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPRequest::IsResponseStreamed() const
+{
+    return (m_pStreamSerializer != NULL) && m_pStreamSerializer->IsStreamed();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPRequest::EndStreamedResponse()
+{
+    if (m_pChunkedWriter == NULL)
+        return false;
+
+    // The method gave up part way through, so leave the response
+    // unterminated and let SendResponse() drop the connection.
+
+    if (m_pStreamSerializer->IsStreamOpen())
+    {
+        LOG(VB_GENERAL, LOG_ERR, "HTTPRequest::EndStreamedResponse - "
+                                 "Streamed response was not completed");
+        return false;
+    }
+
+    // Sends whatever is still buffered, which for a small response is the
+    // header and the whole body, followed by the terminating chunk.
+
+    return m_pChunkedWriter->Finish();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPRequest::GetStreamedBody( QByteArray &body ) const
+{
+    if ((m_pChunkedWriter == NULL) || !m_pChunkedWriter->Finished())
+        return false;
+
+    return m_pChunkedWriter->GetCapture( body );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPRequest::SendChunkedHeader()
+{
+    m_eResponseType     = ResponseTypeOther;
+    m_sResponseTypeText = m_pStreamSerializer->GetContentType();
+    m_nResponseStatus   = 200;
+
+    // The hash used for the ETag isn't known until the body has been
+    // rendered, so a streamed response goes without one.
+
+    m_pStreamSerializer->AddHeaders( m_mapRespHeaders );
+    m_mapRespHeaders.remove( "ETag" );
+
+    QByteArray sHeader = BuildResponseHeader( -1 ).toUtf8();
+
+    LOG(VB_HTTP, LOG_DEBUG, QString("Response header size: %1 bytes")
+                                .arg(sHeader.length()));
+
+    return (WriteBlock( sHeader.constData(), sHeader.length() ) ==
+            sHeader.length());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 QString HTTPRequest::Encode(const QString &sIn)
 {
     QString sStr = sIn;
@@ -2437,6 +2601,145 @@ qint64 BufferedSocketDeviceRequest::ReadBlock(char *pData, qint64 nMaxLen,
 //
 /////////////////////////////////////////////////////////////////////////////
 
+#define CHUNK_SIZE (64 * 1024)
+
+HTTPChunkedWriter::HTTPChunkedWriter( HTTPRequest *pRequest )
+                 : m_pRequest   ( pRequest ),
+                   m_bHeaderSent( false ),
+                   m_bFinished  ( false ),
+                   m_bFailed    ( false ),
+                   m_nBytesSent ( 0 ),
+                   m_nCaptureLimit   ( 0 ),
+                   m_bCaptureOverflow( false )
+{
+    m_buffer.reserve( CHUNK_SIZE );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPChunkedWriter::writeData( const char *pData, qint64 nLen )
+{
+    if (m_bFailed || m_bFinished)
+        return -1;
+
+    m_buffer.append( pData, nLen );
+
+    if ((m_nCaptureLimit > 0) && !m_bCaptureOverflow)
+    {
+        if (m_capture.size() + nLen <= m_nCaptureLimit)
+            m_capture.append( pData, nLen );
+        else
+        {
+            m_bCaptureOverflow = true;
+            m_capture.clear();
+        }
+    }
+
+    if (m_buffer.size() >= CHUNK_SIZE)
+    {
+        if (!WriteChunk( m_buffer.constData(), m_buffer.size() ))
+            return -1;
+
+        m_buffer.resize( 0 );
+    }
+
+    return nLen;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedWriter::Finish()
+{
+    if (m_bFinished)
+        return !m_bFailed;
+
+    if (!m_buffer.isEmpty())
+    {
+        WriteChunk( m_buffer.constData(), m_buffer.size() );
+        m_buffer.resize( 0 );
+    }
+
+    static const char szLastChunk[] = "0\r\n\r\n";
+
+    Send( szLastChunk, sizeof( szLastChunk ) - 1 );
+
+    m_bFinished = true;
+
+    return !m_bFailed;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedWriter::GetCapture( QByteArray &body ) const
+{
+    if ((m_nCaptureLimit <= 0) || m_bCaptureOverflow || m_bFailed)
+        return false;
+
+    body = m_capture;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedWriter::WriteChunk( const char *pData, qint64 nLen )
+{
+    QByteArray sSize = QByteArray::number( nLen, 16 ) + "\r\n";
+
+    return Send( sSize.constData(), sSize.length() ) &&
+           Send( pData, nLen ) &&
+           Send( "\r\n", 2 );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedWriter::Send( const char *pData, qint64 nLen )
+{
+    if (m_bFailed)
+        return false;
+
+    if (!m_bHeaderSent)
+    {
+        m_bHeaderSent = true;
+
+        if (!m_pRequest->SendChunkedHeader())
+        {
+            LOG(VB_HTTP, LOG_ERR, "HTTPChunkedWriter: Error writing header.");
+            m_bFailed = true;
+            return false;
+        }
+    }
+
+    qint64 nBytes = m_pRequest->WriteBlock( pData, nLen );
+
+    if (nBytes != nLen)
+    {
+        LOG(VB_HTTP, LOG_ERR,
+            QString("HTTPChunkedWriter: Incomplete write, %1 of %2 bytes")
+                .arg(nBytes).arg(nLen));
+        m_bFailed = true;
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 qint64 BufferedSocketDeviceRequest::WriteBlock(const char *pData, qint64 nLen)
 {
     qint64 bytesWritten = -1;
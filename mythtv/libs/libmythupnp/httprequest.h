@@ -98,12 +98,64 @@ class IPostProcess
         virtual ~IPostProcess() {};
 };
 
+class HTTPRequest;
+
+/////////////////////////////////////////////////////////////////////////////
+// Writes a response body using chunked transfer encoding.  The response
+// header is only sent with the first chunk, so an error raised before any
+// data is written can still be returned as a normal error response.
+/////////////////////////////////////////////////////////////////////////////
+
+class UPNP_PUBLIC HTTPChunkedWriter : public QIODevice
+{
+    protected:
+
+        HTTPRequest        *m_pRequest;
+        QByteArray          m_buffer;
+
+        bool                m_bHeaderSent;
+        bool                m_bFinished;
+        bool                m_bFailed;
+        qint64              m_nBytesSent;
+
+        QByteArray          m_capture;
+        qint64              m_nCaptureLimit;
+        bool                m_bCaptureOverflow;
+
+    protected:
+
+        virtual qint64  readData  ( char * /*pData*/, qint64 /*nMaxLen*/ )
+                                  { return -1; }
+        virtual qint64  writeData ( const char *pData, qint64 nLen );
+
+        bool            WriteChunk( const char *pData, qint64 nLen );
+        bool            Send      ( const char *pData, qint64 nLen );
+
+    public:
+
+        explicit        HTTPChunkedWriter( HTTPRequest *pRequest );
+        virtual        ~HTTPChunkedWriter() {}
+
+        bool            Finish    ();
+
+        // Keeps a copy of the body, as long as it fits, for GetCapture()
+        void            SetCaptureLimit( qint64 nLimit ) { m_nCaptureLimit = nLimit; }
+        bool            GetCapture( QByteArray &body ) const;
+
+        bool            HeaderSent() const { return m_bHeaderSent; }
+        bool            Finished  () const { return m_bFinished;   }
+        bool            Failed    () const { return m_bFailed;     }
+        qint64          BytesSent () const { return m_nBytesSent;  }
+};
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
 
 class UPNP_PUBLIC HTTPRequest
 {
+    friend class HTTPChunkedWriter;
+
     protected:
 
         static const char  *m_szServerHeaders;
@@ -162,6 +214,10 @@ class UPNP_PUBLIC HTTPRequest
         bool                m_bKeepAlive;
         uint                m_nKeepAliveTimeout;
 
+        HTTPChunkedWriter  *m_pChunkedWriter;
+        Serializer         *m_pStreamSerializer;
+        qint64              m_nStreamCaptureLimit;
+
     protected:
 
         RequestType     SetRequestType      ( const QString &sType  );
@@ -185,7 +241,10 @@ class UPNP_PUBLIC HTTPRequest
 
         void            ParseCookies        ( void );
 
-        QString         BuildResponseHeader ( long long nSize );
+        QString         BuildResponseHeader ( long long nSize ); // -1 = chunked
+        bool            SendChunkedHeader   ( void );
+
+        Serializer *    CreateSerializer    ( QIODevice *pDevice );
 
         qint64          SendData            ( QIODevice *pDevice, qint64 llStart, qint64 llBytes );
         qint64          SendFile            ( QFile &file, qint64 llStart, qint64 llBytes );
@@ -204,7 +263,7 @@ class UPNP_PUBLIC HTTPRequest
     public:
 
                         HTTPRequest     ();
-        virtual        ~HTTPRequest     () {};
+        virtual        ~HTTPRequest     ();
 
         bool            ParseRequest    ();
 
@@ -234,6 +293,19 @@ class UPNP_PUBLIC HTTPRequest
 
         Serializer *    GetSerializer   ();
 
+        // Returns a serializer whose output is written straight to the
+        // client using chunked transfer encoding, or NULL if this request
+        // can't be answered that way.  Owned by the request.
+        Serializer *    GetStreamingSerializer ();
+        bool            IsResponseStreamed     () const;
+        bool            EndStreamedResponse    ();
+
+        // A copy of a streamed body is kept when it's no larger than nLimit
+        // bytes, so that it can still be cached.
+        void            SetStreamCaptureLimit  ( qint64 nLimit )
+                                    { m_nStreamCaptureLimit = nLimit; }
+        bool            GetStreamedBody        ( QByteArray &body ) const;
+
         QByteArray      GetResponsePage     ( void ); // Static response e.g. 400, 404, 501
 
         QString         GetRequestProtocol  () const;
@@ -0,0 +1,351 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsecache.cpp
+//
+// Purpose     : Keeps recent Services API and ContentDirectory responses
+//               until a backend event says their data has changed
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Own headers
+#include "httpresponsecache.h"
+
+// Qt headers
+#include <QStringList>
+
+// MythTV headers
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythevent.h"
+#include "mythdate.h"
+
+#define LOC QString("HttpResponseCache: ")
+
+/////////////////////////////////////////////////////////////////////////////
+// Responses that may be cached, and what they are built from. An empty
+// method matches every method of the service; those rules are only used to
+// invalidate entries when the service is written to.
+/////////////////////////////////////////////////////////////////////////////
+
+static const struct
+{
+    const char *pszBaseUrl;
+    const char *pszMethod;
+    uint        nTags;
+} s_rules[] =
+{
+    { "/Guide",       "GetProgramGuide",     HttpResponseCache::kCacheGuide    |
+                                             HttpResponseCache::kCacheSchedule |
+                                             HttpResponseCache::kCacheChannels  },
+    { "/Guide",       "GetProgramList",      HttpResponseCache::kCacheGuide    |
+                                             HttpResponseCache::kCacheSchedule  },
+    { "/Guide",       "GetProgramDetails",   HttpResponseCache::kCacheGuide    |
+                                             HttpResponseCache::kCacheSchedule  },
+    { "/Guide",       "GetChannelGroupList", HttpResponseCache::kCacheChannels  },
+    { "/Guide",       "GetCategoryList",     HttpResponseCache::kCacheGuide     },
+    { "/Guide",       "",                    HttpResponseCache::kCacheGuide     },
+
+    { "/Channel",     "GetChannelInfoList",  HttpResponseCache::kCacheChannels  },
+    { "/Channel",     "GetChannelInfo",      HttpResponseCache::kCacheChannels  },
+    { "/Channel",     "GetVideoSourceList",  HttpResponseCache::kCacheChannels  },
+    { "/Channel",     "GetVideoMultiplexList", HttpResponseCache::kCacheChannels },
+    { "/Channel",     "",                    HttpResponseCache::kCacheChannels |
+                                             HttpResponseCache::kCacheGuide     },
+
+    { "/Dvr",         "GetRecordedList",     HttpResponseCache::kCacheRecordings },
+    { "/Dvr",         "GetRecorded",         HttpResponseCache::kCacheRecordings },
+    { "/Dvr",         "GetRecGroupList",     HttpResponseCache::kCacheRecordings },
+    { "/Dvr",         "GetTitleList",        HttpResponseCache::kCacheRecordings },
+    { "/Dvr",         "GetTitleInfoList",    HttpResponseCache::kCacheRecordings },
+    { "/Dvr",         "GetUpcomingList",     HttpResponseCache::kCacheSchedule  },
+    { "/Dvr",         "GetConflictList",     HttpResponseCache::kCacheSchedule  },
+    { "/Dvr",         "GetRecordScheduleList", HttpResponseCache::kCacheSchedule },
+    { "/Dvr",         "",                    HttpResponseCache::kCacheRecordings |
+                                             HttpResponseCache::kCacheSchedule  },
+
+    { "/CDS_Control", "Browse",              HttpResponseCache::kCacheRecordings |
+                                             HttpResponseCache::kCacheVideos    |
+                                             HttpResponseCache::kCacheMusic     },
+    { "/CDS_Control", "Search",              HttpResponseCache::kCacheRecordings |
+                                             HttpResponseCache::kCacheVideos    |
+                                             HttpResponseCache::kCacheMusic     },
+};
+
+// Headers added by HTTPRequest when a response is sent. A streamed
+// response has already been sent by the time it is cached.
+static const char *s_transportHeaders[] =
+{
+    "Date", "Server", "Connection", "Keep-Alive", "Content-Language",
+    "Content-Type", "Content-Length", "Content-Encoding", "Transfer-Encoding",
+    "transferMode.dlna.org", "contentFeatures.dlna.org",
+    "Access-Control-Allow-Origin", "Access-Control-Allow-Credentials",
+    "Access-Control-Allow-Headers",
+};
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpResponseCache Class Implementation
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+HttpResponseCache::HttpResponseCache(int nMaxSizeKB, int nMaxAgeSecs) :
+    m_nMaxAgeSecs(nMaxAgeSecs),
+    // A single response may use up to an eighth of the cache
+    m_nMaxEntrySize((qint64)nMaxSizeKB * 1024 / 8),
+    m_cache(nMaxSizeKB)
+{
+    LOG(VB_HTTP, LOG_INFO, LOC + QString("Size %1 KiB, max age %2 secs")
+        .arg(nMaxSizeKB).arg(nMaxAgeSecs));
+
+    gCoreContext->addListener(this);
+}
+
+HttpResponseCache::~HttpResponseCache()
+{
+    gCoreContext->removeListener(this);
+}
+
+/**
+ * \brief Returns the tags of the rule matching the request, or 0 if it
+ *        has none.
+ *
+ * \param bWrites If true, find the data a request that isn't cacheable may
+ *                have changed instead.
+ */
+uint HttpResponseCache::GetTags(const HTTPRequest *pRequest, bool bWrites) const
+{
+    bool bRead = (pRequest->m_eType == RequestTypeGet) ||
+                 (pRequest->m_eType == RequestTypeHead) ||
+                 ((pRequest->m_eType == RequestTypePost) &&
+                  pRequest->m_bSOAPRequest);
+
+    if (bWrites && (pRequest->m_eType != RequestTypePost))
+        return 0;
+
+    // Allow for the REST style calling convention, see ServiceHost
+    QString sMethod    = pRequest->m_sMethod;
+    QString sGetMethod = "Get" + sMethod;
+
+    for (uint i = 0; i < sizeof(s_rules) / sizeof(s_rules[0]); ++i)
+    {
+        if (pRequest->m_sBaseUrl != s_rules[i].pszBaseUrl)
+            continue;
+
+        QString sRuleMethod(s_rules[i].pszMethod);
+
+        if (bWrites)
+        {
+            if (sRuleMethod.isEmpty())
+                return s_rules[i].nTags;
+            continue;
+        }
+
+        if (!bRead || sRuleMethod.isEmpty())
+            continue;
+
+        if ((sRuleMethod == sMethod) || (sRuleMethod == sGetMethod))
+            return s_rules[i].nTags;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Builds the cache key from everything that can change the body of
+ *        the response: the method and its parameters, how the client
+ *        asked for it and the address it was sent to, which ends up in
+ *        any URLs in the response.
+ */
+QString HttpResponseCache::GetKey(const HTTPRequest *pRequest)
+{
+    QStringList parts;
+
+    parts << pRequest->m_sBaseUrl + "/" + pRequest->m_sMethod;
+
+    // Service parameter names aren't case sensitive
+    QMap<QString, QString> params;
+    QStringMap::const_iterator it = pRequest->m_mapParams.begin();
+    for (; it != pRequest->m_mapParams.end(); ++it)
+        params.insert(it.key().toLower(), it.value());
+
+    QString sParams;
+    QMap<QString, QString>::const_iterator pit = params.begin();
+    for (; pit != params.end(); ++pit)
+        sParams += pit.key() + "=" + pit.value() + "&";
+    parts << sParams;
+
+    parts << (pRequest->m_bSOAPRequest ? pRequest->m_sNameSpace : QString());
+
+    HTTPRequest *pReq = const_cast<HTTPRequest *>(pRequest);
+
+    parts << pReq->GetRequestHeader("accept", "")
+          << pReq->GetRequestHeader("user-agent", "")
+          << pReq->GetRequestHeader("host", "")
+          << pReq->GetHostAddress();
+
+    return parts.join("\n");
+}
+
+/**
+ * \brief Fills in the response from the cache.
+ *
+ * The If-None-Match check is left to HTTPRequest::SendResponse() so cached
+ * and uncached responses behave the same.
+ */
+bool HttpResponseCache::Lookup(HTTPRequest *pRequest)
+{
+    if (GetTags(pRequest, false) == 0)
+        return false;
+
+    QString sKey = GetKey(pRequest);
+
+    QMutexLocker locker(&m_lock);
+
+    Entry *pEntry = m_cache.object(sKey);
+
+    if (pEntry == NULL)
+        return false;
+
+    if (pEntry->m_expires < MythDate::current())
+    {
+        m_cache.remove(sKey);
+        return false;
+    }
+
+    pRequest->m_eResponseType     = pEntry->m_eResponseType;
+    pRequest->m_sResponseTypeText = pEntry->m_sResponseTypeText;
+    pRequest->m_nResponseStatus   = 200;
+    pRequest->m_response.buffer() = pEntry->m_body;
+
+    QStringMap::const_iterator it = pEntry->m_headers.begin();
+    for (; it != pEntry->m_headers.end(); ++it)
+        pRequest->m_mapRespHeaders[it.key()] = it.value();
+
+    LOG(VB_HTTP, LOG_DEBUG, LOC + QString("Hit %1/%2")
+        .arg(pRequest->m_sBaseUrl).arg(pRequest->m_sMethod));
+
+    return true;
+}
+
+void HttpResponseCache::Update(HTTPRequest *pRequest)
+{
+    uint nTags = GetTags(pRequest, false);
+
+    if (nTags == 0)
+    {
+        // A POST to a service that has cached methods may have changed
+        // their data, e.g. Dvr/AddRecordSchedule
+        uint nWriteTags = GetTags(pRequest, true);
+
+        if (nWriteTags != 0)
+            Invalidate(nWriteTags);
+
+        return;
+    }
+
+    if (pRequest->m_nResponseStatus != 200)
+        return;
+
+    Entry *pEntry = new Entry;
+
+    if (pRequest->IsResponseStreamed())
+    {
+        if (!pRequest->GetStreamedBody(pEntry->m_body))
+        {
+            delete pEntry;
+            return;
+        }
+    }
+    else
+        pEntry->m_body = pRequest->m_response.buffer();
+
+    if (pEntry->m_body.isEmpty() || (pEntry->m_body.size() > m_nMaxEntrySize) ||
+        !pRequest->m_sFileName.isEmpty() ||
+        (pRequest->m_eResponseType == ResponseTypeFile) ||
+        (pRequest->m_eResponseType == ResponseTypeHeader) ||
+        pRequest->m_mapRespHeaders.contains("Set-Cookie"))
+    {
+        delete pEntry;
+        return;
+    }
+
+    pEntry->m_eResponseType     = pRequest->m_eResponseType;
+    pEntry->m_sResponseTypeText = pRequest->m_sResponseTypeText;
+    pEntry->m_headers           = pRequest->m_mapRespHeaders;
+    pEntry->m_nTags             = nTags;
+
+    for (uint i = 0; i < sizeof(s_transportHeaders) / sizeof(char *); ++i)
+        pEntry->m_headers.remove(s_transportHeaders[i]);
+    pEntry->m_expires = MythDate::current().addSecs(m_nMaxAgeSecs);
+
+    // Streamed responses, and most SOAP responses, go out without an ETag
+    if (!pEntry->m_headers.contains("ETag"))
+        pEntry->m_headers["ETag"] = HTTPRequest::GetETagHash(pEntry->m_body);
+
+    QString sKey = GetKey(pRequest);
+    int     nCost = (pEntry->m_body.size() + 1023) / 1024;
+
+    QMutexLocker locker(&m_lock);
+
+    m_cache.insert(sKey, pEntry, nCost);
+}
+
+void HttpResponseCache::Invalidate(uint nTags)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (nTags == (uint)kCacheAll)
+    {
+        m_cache.clear();
+        return;
+    }
+
+    int nRemoved = 0;
+
+    QList<QString> keys = m_cache.keys();
+    QList<QString>::const_iterator it = keys.begin();
+    for (; it != keys.end(); ++it)
+    {
+        Entry *pEntry = m_cache.object(*it);
+
+        if (pEntry && (pEntry->m_nTags & nTags))
+        {
+            m_cache.remove(*it);
+            nRemoved++;
+        }
+    }
+
+    if (nRemoved > 0)
+    {
+        LOG(VB_HTTP, LOG_DEBUG, LOC + QString("Invalidated %1 entries (0x%2)")
+            .arg(nRemoved).arg(nTags, 0, 16));
+    }
+}
+
+void HttpResponseCache::customEvent(QEvent *e)
+{
+    if (e->type() != MythEvent::MythEventMessage)
+        return;
+
+    MythEvent *me = static_cast<MythEvent *>(e);
+    QString message = me->Message();
+
+    if (message == "SCHEDULE_CHANGE")
+        Invalidate(kCacheSchedule);
+    else if (message.startsWith("RECORDING_LIST_CHANGE") ||
+             message.startsWith("UPDATE_FILE_SIZE"))
+        Invalidate(kCacheRecordings);
+    else if (message.startsWith("VIDEO_LIST_CHANGE"))
+        Invalidate(kCacheVideos);
+    else if (message.startsWith("MUSIC_SCANNER_FINISHED") ||
+             message.startsWith("MUSIC_RESYNC_FINISHED") ||
+             message.startsWith("MUSIC_METADATA_CHANGED"))
+        Invalidate(kCacheMusic);
+    else if (message.startsWith("SYSTEM_EVENT MYTHFILLDATABASE_RAN"))
+        Invalidate(kCacheGuide | kCacheChannels);
+    else if (message == "CLEAR_SETTINGS_CACHE")
+        Invalidate(kCacheAll);
+}
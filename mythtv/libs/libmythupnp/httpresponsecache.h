@@ -0,0 +1,103 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsecache.h
+//
+// Purpose     : Keeps recent Services API and ContentDirectory responses
+//               until a backend event says their data has changed
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef __HTTPRESPONSECACHE_H__
+#define __HTTPRESPONSECACHE_H__
+
+// Qt headers
+#include <QByteArray>
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <QCache>
+
+// MythTV headers
+#include "upnpexp.h"
+#include "httprequest.h"
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpResponseCache Class Definition
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Caches complete responses of read-only service calls.
+ *
+ * Only the methods listed in the rule table in httpresponsecache.cpp are
+ * cached. Each rule names the kinds of data its responses are built from.
+ * Entries are dropped when a backend event (SCHEDULE_CHANGE,
+ * RECORDING_LIST_CHANGE, MYTHFILLDATABASE_RAN, ...) reports a change to
+ * one of those, when a POST to the same service may have changed them, or
+ * after a maximum age as a fallback for changes that aren't announced.
+ *
+ * Every cached response carries an ETag, so a client polling unchanged
+ * data gets a 304 from HTTPRequest::SendResponse() without the service
+ * being called at all.
+ */
+class UPNP_PUBLIC HttpResponseCache : public QObject
+{
+  public:
+    /// The kinds of data a cached response depends on
+    enum CacheTag
+    {
+        kCacheGuide      = 0x01,
+        kCacheSchedule   = 0x02,
+        kCacheRecordings = 0x04,
+        kCacheChannels   = 0x08,
+        kCacheVideos     = 0x10,
+        kCacheMusic      = 0x20,
+        kCacheAll        = 0xff
+    };
+
+    HttpResponseCache(int nMaxSizeKB, int nMaxAgeSecs);
+    virtual ~HttpResponseCache();
+
+    /// Fills in the response and returns true if a cached copy exists
+    bool Lookup(HTTPRequest *pRequest);
+    /// Called once a request has been processed, to cache its response or
+    /// invalidate whatever it may have changed
+    void Update(HTTPRequest *pRequest);
+    /// Largest response that is worth keeping
+    qint64 GetMaxEntrySize(void) const { return m_nMaxEntrySize; }
+
+    bool IsCacheable(const HTTPRequest *pRequest) const
+    { return GetTags(pRequest, false) != 0; }
+
+    void Invalidate(uint nTags);
+
+  protected:
+    virtual void customEvent(QEvent *e);
+
+  private:
+    class Entry
+    {
+      public:
+        QByteArray      m_body;
+        ResponseType    m_eResponseType;
+        QString         m_sResponseTypeText;
+        QStringMap      m_headers;
+        uint            m_nTags;
+        QDateTime       m_expires;
+    };
+
+    uint GetTags(const HTTPRequest *pRequest, bool bWrites) const;
+    static QString GetKey(const HTTPRequest *pRequest);
+
+    int                         m_nMaxAgeSecs;
+    qint64                      m_nMaxEntrySize;
+    QMutex                      m_lock;         // Guards the following
+    QCache<QString, Entry>      m_cache;        // Cost is size in KiB
+};
+
+#endif
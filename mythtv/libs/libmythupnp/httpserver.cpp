@@ -41,6 +41,8 @@
 #include "htmlserver.h"
 #include "mythversion.h"
 #include "mythcorecontext.h"
+#include "httpconnectionpoller.h"
+#include "httpresponsecache.h"
 
 #include "serviceHosts/rttiServiceHost.h"
 
@@ -116,7 +118,8 @@ QString  HttpServer::s_platform;
 
 HttpServer::HttpServer() :
     ServerPool(), m_sSharePath(GetShareDir()),
-    m_threadPool("HttpServerPool"), m_running(true),
+    m_threadPool("HttpServerPool"), m_pPoller(NULL), m_pResponseCache(NULL),
+    m_running(true),
     m_privateToken(QUuid::createUuid().toString()) // Cryptographically random and sufficiently long enough to act as a secure token
 {
     // Number of connections processed concurrently
@@ -129,6 +132,20 @@ HttpServer::HttpServer() :
     LOG(VB_HTTP, LOG_NOTICE, QString("HttpServer(): Max Thread Count %1")
                                 .arg(m_threadPool.maxThreadCount()));
 
+    // Idle keep-alive connections wait here, not on a worker thread
+    m_pPoller = new HttpConnectionPoller(*this);
+
+    // Responses of read-only service calls are kept until the backend
+    // announces a change to their data
+    int nCacheSizeKB = gCoreContext->GetNumSetting("HTTP/ResponseCacheSizeKB",
+                                                   32 * 1024);
+    if (nCacheSizeKB > 0)
+    {
+        int nMaxAge = gCoreContext->GetNumSetting("HTTP/ResponseCacheMaxAge",
+                                                  5 * 60);
+        m_pResponseCache = new HttpResponseCache(nCacheSizeKB, nMaxAge);
+    }
+
     // ----------------------------------------------------------------------
     // Build Platform String
     // ----------------------------------------------------------------------
@@ -174,8 +191,17 @@ HttpServer::~HttpServer()
     m_running = false;
     m_rwlock.unlock();
 
+    // Closes the parked connections, workers can't park any more after this
+    m_pPoller->Stop();
+
     m_threadPool.Stop();
 
+    delete m_pPoller;
+    m_pPoller = NULL;
+
+    delete m_pResponseCache;
+    m_pResponseCache = NULL;
+
     while (!m_extensions.empty())
     {
         delete m_extensions.takeFirst();
@@ -310,8 +336,15 @@ void HttpServer::newTcpConnection(qt_socket_fd_t socket)
     if (server)
         type = server->GetServerType();
 
+    HttpConnection *pConnection = new HttpConnection(socket, type);
+
+    // A plain connection doesn't need a worker until its first request
+    // has arrived, SSL ones do for the handshake.
+    if (type != kSSLServer && ParkConnection(pConnection))
+        return;
+
     m_threadPool.startReserved(
-        new HttpWorker(*this, socket, type
+        new HttpWorker(*this, pConnection
 #ifndef QT_NO_OPENSSL
                        , m_sslConfig
 #endif
@@ -323,6 +356,34 @@ void HttpServer::newTcpConnection(qt_socket_fd_t socket)
 //
 /////////////////////////////////////////////////////////////////////////////
 
+bool HttpServer::ParkConnection(HttpConnection *pConnection)
+{
+    if (!IsRunning())
+        return false;
+
+    return m_pPoller->Park(pConnection);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::StartConnection(HttpConnection *pConnection)
+{
+    // Not reserved, the request waits its turn when all workers are busy
+    m_threadPool.start(
+        new HttpWorker(*this, pConnection
+#ifndef QT_NO_OPENSSL
+                       , m_sslConfig
+#endif
+                       ),
+        QString("HttpServer%1").arg(pConnection->m_socket));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 void HttpServer::RegisterExtension( HttpServerExtension *pExtension )
 {
     if (pExtension != NULL )
@@ -374,6 +435,17 @@ void HttpServer::DelegateRequest(HTTPRequest *pRequest)
     bool bProcessed = false;
 
     LOG(VB_HTTP, LOG_DEBUG, QString("m_sBaseUrl: %1").arg( pRequest->m_sBaseUrl ));
+
+    if (m_pResponseCache)
+    {
+        if (m_pResponseCache->Lookup(pRequest))
+            return;
+
+        // Keep a copy of a streamed response so it can still be cached
+        if (m_pResponseCache->IsCacheable(pRequest))
+            pRequest->SetStreamCaptureLimit(m_pResponseCache->GetMaxEntrySize());
+    }
+
     m_rwlock.lockForRead();
 
     QList< HttpServerExtension* > list = m_basePaths.values( pRequest->m_sBaseUrl );
@@ -424,6 +496,8 @@ void HttpServer::DelegateRequest(HTTPRequest *pRequest)
         pRequest->m_nResponseStatus = 404;
         pRequest->m_response.write( pRequest->GetResponsePage() );
     }
+    else if (m_pResponseCache)
+        m_pResponseCache->Update(pRequest);
 }
 
 uint HttpServer::GetSocketTimeout(HTTPRequest* pRequest) const
@@ -450,45 +524,44 @@ uint HttpServer::GetSocketTimeout(HTTPRequest* pRequest) const
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
-HttpWorker::HttpWorker(HttpServer &httpServer, qt_socket_fd_t sock,
-                       PoolServerType type
+HttpWorker::HttpWorker(HttpServer &httpServer, HttpConnection *pConnection
 #ifndef QT_NO_OPENSSL
                        , QSslConfiguration sslConfig
 #endif
 )
-           : m_httpServer(httpServer), m_socket(sock),
-             m_socketTimeout(5 * 1000), m_connectionType(type)
+           : m_httpServer(httpServer), m_pConnection(pConnection)
 #ifndef QT_NO_OPENSSL
              , m_sslConfig(sslConfig)
 #endif
 {
-    LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): New connection")
-                                        .arg(m_socket));
+    if (!m_pConnection->m_pSocket)
+        LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): New connection")
+                                        .arg(m_pConnection->m_socket));
 }                  
 
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
 
-void HttpWorker::run(void)
+HttpWorker::~HttpWorker()
 {
-#if 0
-    LOG(VB_HTTP, LOG_DEBUG,
-        QString("HttpWorker::run() socket=%1 -- begin").arg(m_socket));
-#endif
+    delete m_pConnection;
+}
 
-    bool                    bTimeout   = false;
-    bool                    bKeepAlive = true;
-    HTTPRequest            *pRequest   = NULL;
-    QTcpSocket             *pSocket;
-    bool                    bEncrypted = false;
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
 
-    if (m_connectionType == kSSLServer)
+bool HttpWorker::OpenSocket(void)
+{
+    QTcpSocket *pSocket;
+
+    if (m_pConnection->m_type == kSSLServer)
     {
 
 #ifndef QT_NO_OPENSSL
         QSslSocket *pSslSocket = new QSslSocket();
-        if (pSslSocket->setSocketDescriptor(m_socket)
+        if (pSslSocket->setSocketDescriptor(m_pConnection->m_socket)
            && gCoreContext->CheckSubnet(pSslSocket))
         {
             pSslSocket->setSslConfiguration(m_sslConfig);
@@ -497,7 +570,7 @@ void HttpWorker::run(void)
             {
                 LOG(VB_HTTP, LOG_INFO, "SSL Handshake occurred, connection encrypted");
                 LOG(VB_HTTP, LOG_INFO, QString("Using %1 cipher").arg(pSslSocket->sessionCipher().name()));
-                bEncrypted = true;
+                m_pConnection->m_bEncrypted = true;
             }
             else
             {
@@ -515,37 +588,87 @@ void HttpWorker::run(void)
         if (pSslSocket)
             pSocket = dynamic_cast<QTcpSocket *>(pSslSocket);
         else
-            return;
+            return false;
 #else
-        return;
+        return false;
 #endif
     }
     else // Plain old unencrypted socket
     {
         pSocket = new QTcpSocket();
-        pSocket->setSocketDescriptor(m_socket);
+        pSocket->setSocketDescriptor(m_pConnection->m_socket);
         if (!gCoreContext->CheckSubnet(pSocket))
         {
             delete pSocket;
             pSocket = 0;
-            return;
+            return false;
         }
 
     }
 
     pSocket->setSocketOption(QAbstractSocket::KeepAliveOption, QVariant(1));
-    int nRequestsHandled = 0; // Allow debugging of keep-alive and connection re-use
+    m_pConnection->m_pSocket = pSocket;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpWorker::run(void)
+{
+#if 0
+    LOG(VB_HTTP, LOG_DEBUG,
+        QString("HttpWorker::run() socket=%1 -- begin")
+            .arg(m_pConnection->m_socket));
+#endif
+
+    bool                    bTimeout   = false;
+    bool                    bKeepAlive = true;
+    HTTPRequest            *pRequest   = NULL;
+    QTcpSocket             *pSocket;
+    int                     nRequests  = 0; // Handled by this run
+
+    if (m_pConnection->m_pSocket)
+    {
+        // Coming back from the poller, which leaves sockets to no thread
+        m_pConnection->m_pSocket->moveToThread(QThread::currentThread());
+    }
+    else if (!OpenSocket())
+    {
+        return;
+    }
+
+    pSocket = m_pConnection->m_pSocket;
+    qt_socket_fd_t socket = m_pConnection->m_socket;
 
     try
     {
         while (m_httpServer.IsRunning() && bKeepAlive && pSocket->isValid() &&
                pSocket->state() == QAbstractSocket::ConnectedState)
         {
+            // Rather than wait here for the client's next request, give an
+            // idle keep-alive connection to the poller and free up this
+            // thread. The poller hands it back once a request has arrived.
+            if (nRequests > 0 && pSocket->bytesAvailable() == 0 &&
+                pSocket->bytesToWrite() == 0)
+            {
+                pSocket->moveToThread(NULL);
+                if (m_httpServer.ParkConnection(m_pConnection))
+                {
+                    m_pConnection = NULL;
+                    return;
+                }
+                pSocket->moveToThread(QThread::currentThread());
+            }
+
             // We set a timeout on keep-alive connections to avoid blocking
             // new clients from connecting - Default at time of writing was
             // 5 seconds for initial connection, then up to 10 seconds of idle
             // time between each subsequent request on the same connection
-            bTimeout = !(pSocket->waitForReadyRead(m_socketTimeout));
+            bTimeout = !(pSocket->waitForReadyRead(
+                             m_pConnection->m_socketTimeout));
 
             if (bTimeout) // Either client closed the socket or we timed out waiting for new data
                 break;
@@ -563,7 +686,7 @@ void HttpWorker::run(void)
                 pRequest = new BufferedSocketDeviceRequest( pSocket );
                 if (pRequest != NULL)
                 {
-                    pRequest->m_bEncrypted = bEncrypted;
+                    pRequest->m_bEncrypted = m_pConnection->m_bEncrypted;
                     if ( pRequest->ParseRequest() )
                     {
                         bKeepAlive = pRequest->GetKeepAlive();
@@ -571,7 +694,7 @@ void HttpWorker::run(void)
                         // but must appear in the response headers
                         uint nTimeout = m_httpServer.GetSocketTimeout(pRequest); // Seconds
                         pRequest->SetKeepAliveTimeout(nTimeout);
-                        m_socketTimeout = nTimeout * 1000; // Milliseconds
+                        m_pConnection->m_socketTimeout = nTimeout * 1000; // Milliseconds
 
                         // ------------------------------------------------------
                         // Request Parsed... Pass on to Main HttpServer class to 
@@ -583,7 +706,7 @@ void HttpWorker::run(void)
                             pRequest->m_eType != RequestTypeUnknown)
                             m_httpServer.DelegateRequest(pRequest);
 
-                        nRequestsHandled++;
+                        m_pConnection->m_nRequestsHandled++;
                     }
                     else
                     {
@@ -614,6 +737,7 @@ void HttpWorker::run(void)
 
                     delete pRequest;
                     pRequest = NULL;
+                    nRequests++;
                 }
                 else
                 {
@@ -640,7 +764,7 @@ void HttpWorker::run(void)
         !(bKeepAlive && pSocket->error() == QAbstractSocket::SocketTimeoutError)) // This 'error' isn't an error when keep-alive is active
     {
         LOG(VB_HTTP, LOG_WARNING, QString("HttpWorker(%1): Error %2 (%3)")
-                                   .arg(m_socket)
+                                   .arg(socket)
                                    .arg(pSocket->errorString())
                                    .arg(pSocket->error()));
     }
@@ -655,7 +779,7 @@ void HttpWorker::run(void)
         LOG(VB_HTTP, LOG_DEBUG, QString("HttpWorker(%1): "
                                         "Waiting for %2 bytes to be written "
                                         "before closing the connection.")
-                                            .arg(m_socket)
+                                            .arg(socket)
                                             .arg(pSocket->bytesToWrite()));
 
         // If the client stops reading for longer than 'writeTimeout' then
@@ -671,7 +795,7 @@ void HttpWorker::run(void)
             LOG(VB_GENERAL, LOG_WARNING, QString("HttpWorker(%1): "
                                          "Timed out waiting to write bytes to "
                                          "the socket, waited %2 seconds")
-                                            .arg(m_socket)
+                                            .arg(socket)
                                             .arg(writeTimeout / 1000));
             break;
         }
@@ -682,23 +806,21 @@ void HttpWorker::run(void)
         LOG(VB_HTTP, LOG_WARNING, QString("HttpWorker(%1): "
                                           "Failed to write %2 bytes to "
                                           "socket, (%3)")
-                                            .arg(m_socket)
+                                            .arg(socket)
                                             .arg(pSocket->bytesToWrite())
                                             .arg(pSocket->errorString()));
     }
 
     LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection %2 closed. %3 requests were handled")
-                                        .arg(m_socket)
+                                        .arg(socket)
                                         .arg(pSocket->socketDescriptor())
-                                        .arg(nRequestsHandled));
+                                        .arg(m_pConnection->m_nRequestsHandled));
 
     pSocket->close();
     delete pSocket;
-    pSocket = NULL;
+    m_pConnection->m_pSocket = NULL;
 
 #if 0
     LOG(VB_HTTP, LOG_DEBUG, "HttpWorkerThread::run() -- end");
 #endif
 }
-
-
@@ -47,6 +47,9 @@ typedef struct timeval  TaskTime;
 class HttpWorkerThread;
 class QScriptEngine;
 class HttpServer;
+class HttpConnection;
+class HttpConnectionPoller;
+class HttpResponseCache;
 #ifndef QT_NO_OPENSSL
 class QSslKey;
 class QSslCertificate;
@@ -125,6 +128,17 @@ class UPNP_PUBLIC HttpServer : public ServerPool
      */
     uint GetSocketTimeout(HTTPRequest*) const;
 
+    /**
+     * \brief Hand an idle connection to the poller until its next request
+     *        arrives. Returns false, keeping the connection with the caller,
+     *        if it can't be parked.
+     */
+    bool ParkConnection(HttpConnection *pConnection);
+    /**
+     * \brief Serve the next request of a parked connection on the pool
+     */
+    void StartConnection(HttpConnection *pConnection);
+
     QString GetSharePath(void) const
     { // never modified after creation, so no need to lock
         return m_sSharePath;
@@ -148,6 +162,8 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     QMultiMap< QString, HttpServerExtension* >  m_basePaths;
     QString                 m_sSharePath;
     MThreadPool             m_threadPool;
+    HttpConnectionPoller   *m_pPoller;
+    HttpResponseCache      *m_pResponseCache; // NULL when disabled
     bool                    m_running; // protected by m_rwlock
 
     static QMutex           s_platformLock;
@@ -179,25 +195,28 @@ class HttpWorker : public QRunnable
   public:
 
     /**
-     * \param httpServer The parent server of this request
-     * \param sock       The socket
-     * \param socketTimeout The time in seconds to wait after the connection goes idle before closing the socket
-     * \param type       The type of connection - Plain TCP, SSL or other?
-     * \param sslConfig  The SSL configuration (for SSL sockets)
+     * \param httpServer  The parent server of this request
+     * \param pConnection The connection to serve, which the worker takes
+     *                    ownership of. It holds the socket, the time to
+     *                    wait after the connection goes idle before closing
+     *                    it, and the type of connection - Plain TCP, SSL or
+     *                    other?
+     * \param sslConfig   The SSL configuration (for SSL sockets)
      */
-    HttpWorker(HttpServer &httpServer, qt_socket_fd_t sock, PoolServerType type
+    HttpWorker(HttpServer &httpServer, HttpConnection *pConnection
 #ifndef QT_NO_OPENSSL
                , QSslConfiguration sslConfig
 #endif
     );
+    virtual ~HttpWorker();
 
     virtual void run(void);
 
   protected:
+    bool OpenSocket(void);
+
     HttpServer &m_httpServer; 
-    qt_socket_fd_t m_socket;
-    int         m_socketTimeout;
-    PoolServerType m_connectionType;
+    HttpConnection *m_pConnection;
 
 #ifndef QT_NO_OPENSSL
     QSslConfiguration       m_sslConfig;
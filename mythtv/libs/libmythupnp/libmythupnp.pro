@@ -22,12 +22,13 @@ HEADERS += msocketdevice.h
 HEADERS += httprequest.h upnp.h ssdp.h taskqueue.h upnpsubscription.h
 HEADERS += upnpdevice.h upnptasknotify.h upnptasksearch.h upnputil.h
 HEADERS += httpserver.h upnpcds.h upnpcdsobjects.h bufferedsocketdevice.h upnpmsrr.h
+HEADERS += upnpcdsindex.h
 HEADERS += eventing.h upnpcmgr.h upnptaskevent.h upnptaskcache.h ssdpcache.h
 HEADERS += configuration.h
 HEADERS += soapclient.h mythxmlclient.h mmembuf.h upnpexp.h
 HEADERS += upnpserviceimpl.h
 HEADERS += servicehost.h wsdl.h htmlserver.h serverSideScripting.h xsd.h
-HEADERS += upnphelpers.h websocket.h
+HEADERS += upnphelpers.h websocket.h httpconnectionpoller.h httpresponsecache.h
 
 HEADERS += services/rtti.h
 HEADERS += serviceHosts/rttiServiceHost.h
@@ -45,12 +46,14 @@ mingw | win32-msvc*:SOURCES += msocketdevice_win.cpp
 SOURCES += httprequest.cpp upnp.cpp ssdp.cpp taskqueue.cpp upnputil.cpp
 SOURCES += upnpdevice.cpp upnptasknotify.cpp upnptasksearch.cpp
 SOURCES += httpserver.cpp upnpcds.cpp upnpcdsobjects.cpp bufferedsocketdevice.cpp
+SOURCES += upnpcdsindex.cpp
 SOURCES += eventing.cpp upnpcmgr.cpp upnpmsrr.cpp upnptaskevent.cpp ssdpcache.cpp
 SOURCES += configuration.cpp soapclient.cpp mythxmlclient.cpp mmembuf.cpp
 SOURCES += upnpserviceimpl.cpp
 SOURCES += htmlserver.cpp serverSideScripting.cpp
 SOURCES += servicehost.cpp wsdl.cpp upnpsubscription.cpp xsd.cpp
-SOURCES += upnphelpers.cpp websocket.cpp
+SOURCES += upnphelpers.cpp websocket.cpp httpconnectionpoller.cpp
+SOURCES += httpresponsecache.cpp
 
 SOURCES += services/rtti.cpp
 
@@ -81,7 +84,7 @@ inc.path = $${PREFIX}/include/mythtv/upnp/
 
 inc.files  = httprequest.h upnp.h ssdp.h taskqueue.h bufferedsocketdevice.h
 inc.files += upnpdevice.h upnptasknotify.h upnptasksearch.h upnputil.h
-inc.files += httpserver.h httpstatus.h upnpcds.h upnpcdsobjects.h
+inc.files += httpserver.h httpstatus.h upnpcds.h upnpcdsobjects.h upnpcdsindex.h
 inc.files += eventing.h upnpcmgr.h upnptaskevent.h upnptaskcache.h ssdpcache.h
 inc.files += upnpimpl.h configuration.h
 inc.files += soapclient.h mythxmlclient.h mmembuf.h upnpsubscription.h
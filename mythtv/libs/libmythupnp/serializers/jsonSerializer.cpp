@@ -21,7 +21,8 @@
 //////////////////////////////////////////////////////////////////////////////
 
 JSONSerializer::JSONSerializer( QIODevice *pDevice, const QString &/*sRequestName*/ )
-               : m_Stream( pDevice ), m_bCommaNeeded( false )
+               : m_Stream( pDevice ), m_bCommaNeeded( false ),
+                 m_bFirstListItem( true )
 {
 }
 
@@ -113,6 +114,50 @@ void JSONSerializer::AddProperty( const QString       &sName,
 //
 //////////////////////////////////////////////////////////////////////////////
 
+void JSONSerializer::BeginList( const QString     &sName,
+                                const QMetaObject */*pMetaParent*/ )
+{
+    if (m_bCommaNeeded)
+        m_Stream << ", ";
+
+    m_Stream << "\"" << sName << "\": [";
+
+    m_bFirstListItem = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void JSONSerializer::AddListItem( const QObject *pObject )
+{
+    if (m_bFirstListItem)
+        m_bFirstListItem = false;
+    else
+        m_Stream << ",";
+
+    m_bCommaNeeded = false;
+
+    m_Stream << "{";
+    SerializeObjectProperties( pObject );
+    m_Stream << "}";
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void JSONSerializer::EndList( const QString &/*sName*/ )
+{
+    m_Stream << "]";
+
+    m_bCommaNeeded = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
 void JSONSerializer::RenderValue( const QVariant &vValue )
 {
     
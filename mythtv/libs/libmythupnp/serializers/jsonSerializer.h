@@ -35,6 +35,7 @@ class UPNP_PUBLIC JSONSerializer : public Serializer
 
         QTextStream   m_Stream;
         bool          m_bCommaNeeded;
+        bool          m_bFirstListItem;
 
         virtual void BeginSerialize( QString &sName );
         virtual void EndSerialize  ();
@@ -47,6 +48,11 @@ class UPNP_PUBLIC JSONSerializer : public Serializer
                                   const QMetaObject   *pMetaParent,
                                   const QMetaProperty *pMetaProp );
 
+        virtual void BeginList  ( const QString       &sName,
+                                  const QMetaObject   *pMetaParent );
+        virtual void AddListItem( const QObject       *pObject );
+        virtual void EndList    ( const QString       &sName );
+
 
         void RenderValue     ( const QVariant     &vValue );
 
@@ -63,6 +69,8 @@ class UPNP_PUBLIC JSONSerializer : public Serializer
 
         virtual QString GetContentType();
 
+        virtual bool    CanStream() { return true; }
+
 };
 
 #endif
@@ -31,7 +31,7 @@ void Serializer::AddHeaders( QStringMap &headers )
 //
 //////////////////////////////////////////////////////////////////////////////
 
-void Serializer::Serialize( const QObject *pObject, const QString &_sName )
+QString Serializer::GetObjectName( const QObject *pObject, const QString &_sName )
 {
     QString sName = _sName;
 
@@ -48,6 +48,17 @@ void Serializer::Serialize( const QObject *pObject, const QString &_sName )
             sName = sName.mid( 1 );
     }
 
+    return sName;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void Serializer::Serialize( const QObject *pObject, const QString &_sName )
+{
+    QString sName = GetObjectName( pObject, _sName );
+
     // ---------------------------------------------------------------
 
     m_hash.reset();
@@ -84,6 +95,56 @@ void Serializer::Serialize( const QVariant &vValue, const QString &_sName )
 //
 //////////////////////////////////////////////////////////////////////////////
 
+void Serializer::BeginStream( const QObject *pHeader, const QString &sListName )
+{
+    m_bStreamed       = true;
+    m_pStreamHeader   = pHeader;
+    m_sStreamName     = GetObjectName( pHeader, QString() );
+    m_sStreamListName = sListName;
+
+    m_hash.reset();
+
+    BeginSerialize( m_sStreamName );
+
+    m_hash.addData( m_sStreamName.toUtf8() );
+
+    BeginObject( m_sStreamName, pHeader );
+
+    SerializeObjectProperties( pHeader, sListName );
+
+    m_hash.addData( sListName.toUtf8() );
+
+    BeginList( sListName, pHeader->metaObject() );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void Serializer::AddStreamItem( const QObject *pItem )
+{
+    AddListItem( pItem );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void Serializer::EndStream()
+{
+    EndList( m_sStreamListName );
+
+    EndObject( m_sStreamName, m_pStreamHeader );
+
+    EndSerialize();
+
+    m_pStreamHeader = NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
 void Serializer::SerializeObject( const QObject *pObject, const QString &sName )
 {
     m_hash.addData( sName.toUtf8() );
@@ -99,7 +160,8 @@ void Serializer::SerializeObject( const QObject *pObject, const QString &sName )
 //
 //////////////////////////////////////////////////////////////////////////////
 
-void Serializer::SerializeObjectProperties( const QObject *pObject )
+void Serializer::SerializeObjectProperties( const QObject *pObject,
+                                            const QString &sSkipProp )
 {
     if (pObject != NULL)
     {
@@ -118,6 +180,9 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 
                 if ( sPropName.compare( "objectName" ) == 0)
                     continue;
+
+                if ( !sSkipProp.isEmpty() && sPropName == sSkipProp )
+                    continue;
                 
                 bool bHash = false;
 
@@ -34,6 +34,11 @@ class UPNP_PUBLIC Serializer
 
         QCryptographicHash  m_hash;
 
+        bool                m_bStreamed;
+        const QObject      *m_pStreamHeader;
+        QString             m_sStreamName;
+        QString             m_sStreamListName;
+
         virtual void BeginSerialize( QString &/*sName*/ ) {}
         virtual void EndSerialize  () {}
 
@@ -47,8 +52,22 @@ class UPNP_PUBLIC Serializer
 
         //////////////////////////////////////////////////////////////////////
 
+        // Used by the streaming methods below.  Only serializers that
+        // return true from CanStream() need to implement them.
+
+        virtual void BeginList  ( const QString     &/*sName*/,
+                                  const QMetaObject */*pMetaParent*/ ) {}
+        virtual void AddListItem( const QObject */*pObject*/ ) {}
+        virtual void EndList    ( const QString &/*sName*/ ) {}
+
+        //////////////////////////////////////////////////////////////////////
+
         void SerializeObject          ( const QObject *pObject, const QString &sName );
-        void SerializeObjectProperties( const QObject *pObject );
+        void SerializeObjectProperties( const QObject *pObject,
+                                        const QString &sSkipProp = QString() );
+
+        QString    GetObjectName         ( const QObject *pObject,
+                                           const QString &sName );
 
         QString    ReadPropertyMetadata  ( const QObject *pObject, 
                                                  QString  sPropName, 
@@ -59,6 +78,25 @@ class UPNP_PUBLIC Serializer
         virtual void Serialize( const QObject *pObject, const QString &_sName = QString() );
         virtual void Serialize( const QVariant &vValue, const QString &sName );
 
+        //////////////////////////////////////////////////////////////////////
+        // Streaming Methods
+        //
+        // Renders the same document as Serialize( pHeader ) would if the
+        // list property sListName held all of the items passed to
+        // AddStreamItem().  The list must be the last property of pHeader.
+        // Items can be deleted as soon as AddStreamItem() returns, so the
+        // complete object graph never has to exist at once.
+        //////////////////////////////////////////////////////////////////////
+
+        virtual bool CanStream    () { return false; }
+        bool         IsStreamed   () const { return m_bStreamed; }
+        bool         IsStreamOpen () const { return m_pStreamHeader != NULL; }
+
+        virtual void BeginStream  ( const QObject *pHeader,
+                                    const QString &sListName );
+        virtual void AddStreamItem( const QObject *pItem );
+        virtual void EndStream    ();
+
         //////////////////////////////////////////////////////////////////////
         // Helper Methods
         //////////////////////////////////////////////////////////////////////
@@ -68,12 +106,14 @@ class UPNP_PUBLIC Serializer
 
 
         inline Serializer();
+        virtual ~Serializer() {}
 };
 
 Q_DECLARE_METATYPE( QList<QObject*> )
 
 inline Serializer::Serializer() :
-    m_hash(QCryptographicHash::Sha1)
+    m_hash(QCryptographicHash::Sha1), m_bStreamed(false),
+    m_pStreamHeader(NULL)
 {
     qRegisterMetaType< QList<QObject*> >("QList<QObject*>");
 }
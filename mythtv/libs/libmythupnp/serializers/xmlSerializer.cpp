@@ -138,6 +138,37 @@ void XmlSerializer::AddProperty( const QString       &sName,
 //
 //////////////////////////////////////////////////////////////////////////////
 
+void XmlSerializer::BeginList( const QString &sName, const QMetaObject *pMetaParent )
+{
+    m_pXmlWriter->writeStartElement( sName );
+
+    m_sListItemName = GetContentName( sName, pMetaParent, NULL );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void XmlSerializer::AddListItem( const QObject *pObject )
+{
+    m_pXmlWriter->writeStartElement( m_sListItemName );
+    SerializeObjectProperties( pObject );
+    m_pXmlWriter->writeEndElement();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void XmlSerializer::EndList( const QString &/*sName*/ )
+{
+    m_pXmlWriter->writeEndElement();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
 void XmlSerializer::RenderEnum( const QString       &sName ,
                                 const QVariant      &vValue,
                                 const QMetaProperty *pMetaProp )
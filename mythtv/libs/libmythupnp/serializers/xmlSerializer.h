@@ -37,6 +37,7 @@ class UPNP_PUBLIC XmlSerializer : public Serializer
         QXmlStreamWriter *m_pXmlWriter;
         QString           m_sRequestName;
         bool              m_bIsRoot;
+        QString           m_sListItemName;
 
         virtual void BeginSerialize( QString &sName );
         virtual void EndSerialize  ();
@@ -49,6 +50,11 @@ class UPNP_PUBLIC XmlSerializer : public Serializer
                                   const QMetaObject   *pMetaParent,
                                   const QMetaProperty *pMetaProp );
 
+        virtual void BeginList  ( const QString       &sName,
+                                  const QMetaObject   *pMetaParent );
+        virtual void AddListItem( const QObject       *pObject );
+        virtual void EndList    ( const QString       &sName );
+
         void    RenderValue     ( const QString &sName, const QVariant     &vValue );
 
         void    RenderEnum      ( const QString       &sName ,
@@ -78,6 +84,8 @@ class UPNP_PUBLIC XmlSerializer : public Serializer
 
         virtual QString GetContentType();
 
+        virtual bool    CanStream() { return true; }
+
 };
 
 #endif
@@ -26,16 +26,108 @@
 
 MethodInfo::MethodInfo()
 {
-    m_nMethodIndex = 0;
-    m_eRequestType = (RequestType)(RequestTypeGet | RequestTypePost |
-                                   RequestTypeHead);
+    m_nMethodIndex  = 0;
+    m_nReturnTypeId = 0;
+    m_eRequestType  = (RequestType)(RequestTypeGet | RequestTypePost |
+                                    RequestTypeHead);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Resolve everything Invoke needs from m_oMethod up front, so a request only
+// has to look up its values and convert them.  Must be called after the
+// service's custom types have been registered.
+//////////////////////////////////////////////////////////////////////////////
+
+void MethodInfo::Prepare( )
+{
+    m_nReturnTypeId = QMetaType::type( m_oMethod.typeName() );
+
+    QList<QByteArray> paramNames = m_oMethod.parameterNames();
+    QList<QByteArray> paramTypes = m_oMethod.parameterTypes();
+
+    if (paramNames.length() >= _MAX_PARAMS)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("MethodInfo::Prepare - %1 has too many parameters")
+                .arg(m_sName));
+    }
+
+    m_params.clear();
+    m_params.reserve( paramNames.length() );
+
+    for (int nIdx = 0; nIdx < paramNames.length(); nIdx++)
+    {
+        MethodParamInfo param;
+
+        param.m_sName     = QString( paramNames[ nIdx ] ).toLower();
+        param.m_sTypeName = paramTypes[ nIdx ];
+        param.m_nTypeId   = QMetaType::type( paramTypes[ nIdx ] );
+
+        if (param.m_nTypeId == 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("MethodInfo::Prepare - %1: Type unknown '%2'")
+                    .arg(m_sName).arg(param.m_sTypeName));
+        }
+        else if (param.m_nTypeId >= QMetaType::User)
+            param.m_bIsEnum = ResolveEnum( param );
+
+        m_params.append( param );
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Any type name containing :: is assumed to be an enum, the same as
+// Service::ConvertToParameterPtr does.
+//////////////////////////////////////////////////////////////////////////////
+
+bool MethodInfo::ResolveEnum( MethodParamInfo &param )
+{
+    int nLastIdx = param.m_sTypeName.lastIndexOf( "::" );
+
+    if (nLastIdx == -1)
+        return false;
+
+    QString sParentFQN = param.m_sTypeName.mid( 0, nLastIdx );
+    QString sEnumName  = param.m_sTypeName.mid( nLastIdx+2  );
+
+    // ----------------------------------------------------------------------
+    // Create Parent object so we can get to its metaObject
+    // ----------------------------------------------------------------------
+
+    int nParentId = QMetaType::type( sParentFQN.toUtf8() );
+
+    if (nParentId == 0)
+        return false;
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    QObject *pParentClass = (QObject *)QMetaType::construct( nParentId );
+#else
+    QObject *pParentClass = (QObject *)QMetaType::create( nParentId );
+#endif
+
+    if (pParentClass == NULL)
+        return false;
+
+    const QMetaObject *pMetaObject = pParentClass->metaObject();
+
+    QMetaType::destroy( nParentId, pParentClass );
+
+    int nEnumIdx = pMetaObject->indexOfEnumerator( sEnumName.toUtf8() );
+
+    if (nEnumIdx < 0 )
+        return false;
+
+    param.m_oEnum = pMetaObject->enumerator( nEnumIdx );
+
+    return true;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
 
-QVariant MethodInfo::Invoke( Service *pService, const QStringMap &reqParams )
+QVariant MethodInfo::Invoke( Service *pService, const QStringMap &reqParams ) const
 {
     HttpRedirectException exception;
     bool                  bExceptionThrown = false;
@@ -57,20 +149,18 @@ QVariant MethodInfo::Invoke( Service *pService, const QStringMap &reqParams )
 
     pService->m_parsedParams = lowerParams.keys();
 
-
-    QList<QByteArray> paramNames = m_oMethod.parameterNames();
-    QList<QByteArray> paramTypes = m_oMethod.parameterTypes();
-
     // ----------------------------------------------------------------------
     // Create Parameter array (Can't have more than _MAX_PARAMS parameters)....
-    // switched to static array for performance.
+    // Only the slots actually used are cleared.
     // ----------------------------------------------------------------------
 
+    int   nParams = qMin( m_params.size(), _MAX_PARAMS - 1 );
+
     void *param[ _MAX_PARAMS ];
     int   types[ _MAX_PARAMS ];
 
-    memset( param, 0, _MAX_PARAMS * sizeof(void *));
-    memset( types, 0, _MAX_PARAMS * sizeof(int));
+    memset( param, 0, (nParams + 1) * sizeof(void *));
+    memset( types, 0, (nParams + 1) * sizeof(int));
 
     try
     {
@@ -78,53 +168,49 @@ QVariant MethodInfo::Invoke( Service *pService, const QStringMap &reqParams )
         // Add a place for the Return value
         // --------------------------------------------------------------
 
-        int nRetIdx = QMetaType::type( m_oMethod.typeName() ); 
-
-        if (nRetIdx != 0)
+        if (m_nReturnTypeId != 0)
         {
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-            param[ 0 ] = QMetaType::construct( nRetIdx );    
+            param[ 0 ] = QMetaType::construct( m_nReturnTypeId );
 #else
-            param[ 0 ] = QMetaType::create( nRetIdx );
+            param[ 0 ] = QMetaType::create( m_nReturnTypeId );
 #endif
-            types[ 0 ] = nRetIdx;
-        }
-        else
-        {
-            param[ 0 ] = NULL;    
-            types[ 0 ] = 0;
+            types[ 0 ] = m_nReturnTypeId;
         }
 
         // --------------------------------------------------------------
         // Fill in parameters from request values
         // --------------------------------------------------------------
 
-        for( int nIdx = 0; nIdx < paramNames.length(); nIdx++ )
+        for( int nIdx = 0; nIdx < nParams; nIdx++ )
         {
-            QString sValue     = lowerParams[ paramNames[ nIdx ].toLower() ];
-            QString sParamType = paramTypes[ nIdx ];
+            const MethodParamInfo &info = m_params[ nIdx ];
 
-            int     nId        = QMetaType::type( paramTypes[ nIdx ] );
-            void   *pParam     = NULL;
+            QString sValue = lowerParams.value( info.m_sName );
+            void   *pParam = NULL;
 
-            if (nId != 0)
+            if (info.m_nTypeId != 0)
             {
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-                pParam = QMetaType::construct( nId );
+                pParam = QMetaType::construct( info.m_nTypeId );
 #else
-                pParam = QMetaType::create( nId );
+                pParam = QMetaType::create( info.m_nTypeId );
 #endif
             }
-            else
+
+            types[nIdx+1] = info.m_nTypeId;
+
+            if (info.m_bIsEnum)
             {
-                LOG(VB_GENERAL, LOG_ERR,
-                    QString("MethodInfo::Invoke - Type unknown '%1'")
-                        .arg(sParamType));
-            }
+                if (pParam != NULL)
+                    *(( int *)pParam) = info.m_oEnum.keyToValue( sValue.toUtf8() );
 
-            types[nIdx+1] = nId;
-            param[nIdx+1] = pService->ConvertToParameterPtr( nId, sParamType,
-                                                             pParam, sValue );
+                param[nIdx+1] = pParam;
+            }
+            else
+                param[nIdx+1] = pService->ConvertToParameterPtr( info.m_nTypeId,
+                                                                 info.m_sTypeName,
+                                                                 pParam, sValue );
         }
 
 #if 0
@@ -146,7 +232,7 @@ QVariant MethodInfo::Invoke( Service *pService, const QStringMap &reqParams )
         // created.
         // --------------------------------------------------------------
 
-        for (int nIdx=1; nIdx < paramNames.length()+1; nIdx++)
+        for (int nIdx=1; nIdx < nParams+1; nIdx++)
         {
             if ((types[ nIdx ] != 0) && (param[ nIdx ] != NULL))
                 QMetaType::destroy( types[ nIdx ], param[ nIdx ] );
@@ -273,6 +359,8 @@ ServiceHost::ServiceHost(const QMetaObject &metaObject,
                                                          RequestTypeHead);
             }
 
+            oInfo.Prepare();
+
             m_Methods.insert( oInfo.m_sName, oInfo );
         }
     }
@@ -385,11 +473,11 @@ bool ServiceHost::ProcessRequest( HTTPRequest *pRequest )
             // --------------------------------------------------------------
 
             QString sMethodName  = pRequest->m_sMethod;
-            bool    bMethodFound = false;
 
-            if (m_Methods.contains(sMethodName))
-                bMethodFound = true;
-            else
+            MetaInfoMap::const_iterator itMethod =
+                m_Methods.constFind( sMethodName );
+
+            if (itMethod == m_Methods.constEnd())
             {
                 switch( pRequest->m_eType )
                 {
@@ -410,13 +498,12 @@ bool ServiceHost::ProcessRequest( HTTPRequest *pRequest )
                         break;
                 }
 
-                if (m_Methods.contains(sMethodName))
-                    bMethodFound = true;
+                itMethod = m_Methods.constFind( sMethodName );
             }
 
-            if (bMethodFound)
+            if (itMethod != m_Methods.constEnd())
             {
-                MethodInfo oInfo = m_Methods.value( sMethodName );
+                const MethodInfo &oInfo = *itMethod;
 
                 if (( pRequest->m_eType & oInfo.m_eRequestType ) != 0)
                 {
@@ -429,10 +516,27 @@ bool ServiceHost::ProcessRequest( HTTPRequest *pRequest )
                     pService = 
                         qobject_cast<Service*>(m_oMetaObject.newInstance());
 
+                    pService->m_pStreamSerializer =
+                        pRequest->GetStreamingSerializer();
+
                     QVariant vResult = oInfo.Invoke(pService,
                                                     pRequest->m_mapParams);
 
-                    bHandled = FormatResponse( pRequest, vResult );
+                    // ------------------------------------------------------
+                    // If the method streamed its result, it has already
+                    // been written to the client.
+                    // ------------------------------------------------------
+
+                    if (pRequest->IsResponseStreamed())
+                    {
+                        if ( vResult.canConvert< QObject* >())
+                            delete vResult.value< QObject* >();
+
+                        pRequest->EndStreamedResponse();
+                        bHandled = true;
+                    }
+                    else
+                        bHandled = FormatResponse( pRequest, vResult );
                 }
             }
 
@@ -490,6 +594,7 @@ bool ServiceHost::FormatResponse( HTTPRequest *pRequest, QObject *pResults )
 
         pRequest->FormatActionResponse( pSer );
 
+        delete pSer;
         delete pResults;
 
         return true;
@@ -555,5 +660,7 @@ bool ServiceHost::FormatResponse( HTTPRequest *pRequest, QVariant vValue )
 
     pRequest->FormatActionResponse( pSer );
 
+    delete pSer;
+
     return true;
 }
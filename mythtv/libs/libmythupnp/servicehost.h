@@ -15,6 +15,8 @@
 
 #include <QMetaObject>
 #include <QMetaMethod>
+#include <QMetaEnum>
+#include <QVector>
 #include <QMap>
 
 #include "upnpexp.h"
@@ -30,6 +32,29 @@
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////
+// Everything needed to convert one request value into a method argument,
+// resolved once when the ServiceHost is created.
+//////////////////////////////////////////////////////////////////////////////
+
+class UPNP_PUBLIC MethodParamInfo
+{
+    public:
+
+        QString         m_sName;        // lower case, for request lookups
+        QString         m_sTypeName;
+        int             m_nTypeId;
+        bool            m_bIsEnum;
+        QMetaEnum       m_oEnum;
+
+    public:
+        MethodParamInfo() : m_nTypeId( 0 ), m_bIsEnum( false ) {}
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
 class UPNP_PUBLIC MethodInfo
 {
     public:
@@ -39,10 +64,19 @@ class UPNP_PUBLIC MethodInfo
         QMetaMethod     m_oMethod;
         RequestType     m_eRequestType;
 
+        int                         m_nReturnTypeId;
+        QVector< MethodParamInfo >  m_params;
+
+    protected:
+
+        static bool ResolveEnum( MethodParamInfo &param );
+
     public:
         MethodInfo();
 
-        QVariant Invoke( Service *pService, const QStringMap &reqParams );
+        void     Prepare( );
+
+        QVariant Invoke( Service *pService, const QStringMap &reqParams ) const;
 };
 
 typedef QMap< QString, MethodInfo > MetaInfoMap;
@@ -81,10 +81,13 @@ SSDP::SSDP() :
     m_pNotifyTask          ( NULL ),
     m_bAnnouncementsEnabled( false ),
     m_bTermRequested       ( false ),
-    m_lock                 ( QMutex::NonRecursive )
+    m_lock                 ( QMutex::NonRecursive ),
+    m_nLastPurge           ( 0 )
 {
     LOG(VB_UPNP, LOG_NOTICE, "Starting up SSDP Thread..." );
 
+    m_clock.start();
+
     Configuration *pConfig = UPnp::GetConfiguration();
 
     m_nPort       = pConfig->GetValue("UPnP/SSDP/Port"      , SSDP_PORT      );
@@ -544,11 +547,13 @@ bool SSDP::ProcessSearchRequest( const QStringMap &sHeaders,
 
     // ----------------------------------------------------------------------
     // Adjust timeout to be a random interval between 0 and MX (max of 120)
+    // Spread over the whole interval, not just on whole seconds, so replies
+    // to a burst of searches don't all go out together.
     // ----------------------------------------------------------------------
 
     nMX = (nMX > 120) ? 120 : nMX;
 
-    int nNewMX = (int)(0 + ((unsigned short)random() % nMX)) * 1000;
+    int nNewMX = (int)(random() % (nMX * 1000));
 
     // ----------------------------------------------------------------------
     // See what they are looking for...
@@ -556,6 +561,9 @@ bool SSDP::ProcessSearchRequest( const QStringMap &sHeaders,
 
     if ((sST == "ssdp:all") || (sST == "upnp:rootdevice"))
     {
+        if (!AllowSearchReply( peerAddress, peerPort, sST, nNewMX ))
+            return false;
+
         UPnpSearchTask *pTask = new UPnpSearchTask( m_nServicePort, 
             peerAddress, peerPort, sST, 
             UPnp::g_UPnpDeviceDesc.m_rootDevice.GetUDN());
@@ -582,18 +590,21 @@ bool SSDP::ProcessSearchRequest( const QStringMap &sHeaders,
 
     if (sUDN.length() > 0)
     {
+        if (!AllowSearchReply( peerAddress, peerPort, sST, 0 ))
+            return false;
+
         UPnpSearchTask *pTask = new UPnpSearchTask( m_nServicePort,
                                                     peerAddress,
                                                     peerPort,
                                                     sST, 
                                                     sUDN );
 
-        // Excute task now for fastest response, queue for time-delayed response
-        // -=>TODO: To be trully uPnp compliant, this Execute should be removed.
+        // Excute task now for fastest response, this is how our frontends
+        // find their backend. It used to be queued for a time-delayed
+        // response as well, but clients repeat their searches themselves.
+        // -=>TODO: To be trully uPnp compliant, this should be queued.
         pTask->Execute( NULL );
 
-        TaskQueue::Instance()->AddTask( nNewMX, pTask );
-
         pTask->DecrRef();
 
         return true;
@@ -602,6 +613,89 @@ bool SSDP::ProcessSearchRequest( const QStringMap &sHeaders,
     return false;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Decides whether a search is answered. A search repeated while our reply
+// to it is still waiting to be sent is ignored, as clients send each one
+// several times and on every interface. Each peer address is also limited
+// to SSDP_MAX_REPLIES_PER_PEER replies a second, so a noisy device can't
+// hold up the replies to everyone else.
+/////////////////////////////////////////////////////////////////////////////
+
+bool SSDP::AllowSearchReply( const QHostAddress &peerAddress,
+                             quint16             peerPort,
+                             const QString      &sST,
+                             int                 nDelayMs )
+{
+    qint64 nNow = m_clock.elapsed();
+
+    // ----------------------------------------------------------------------
+    // Forget replies that have been sent, and peers that have gone quiet
+    // ----------------------------------------------------------------------
+
+    if (nNow - m_nLastPurge > 10000)
+    {
+        QHash<QString, qint64>::iterator it = m_pendingReplies.begin();
+        while (it != m_pendingReplies.end())
+        {
+            if (*it < nNow)
+                it = m_pendingReplies.erase( it );
+            else
+                ++it;
+        }
+
+        QHash<QString, QPair<qint64, int> >::iterator itPeer =
+            m_peerReplies.begin();
+        while (itPeer != m_peerReplies.end())
+        {
+            if (nNow - itPeer->first >= 1000)
+                itPeer = m_peerReplies.erase( itPeer );
+            else
+                ++itPeer;
+        }
+
+        m_nLastPurge = nNow;
+    }
+
+    QString sAddress = peerAddress.toString();
+    QString sKey     = QString( "%1:%2 %3" ).arg( sAddress )
+                                            .arg( peerPort )
+                                            .arg( sST );
+
+    QHash<QString, qint64>::const_iterator it =
+        m_pendingReplies.constFind( sKey );
+
+    if (it != m_pendingReplies.constEnd() && *it >= nNow)
+    {
+        LOG(VB_UPNP, LOG_DEBUG, QString("SSDP: Reply to %1 already queued")
+                                    .arg(sKey));
+        return false;
+    }
+
+    QPair<qint64, int> &replies = m_peerReplies[ sAddress ];
+
+    if (nNow - replies.first >= 1000)
+    {
+        replies.first  = nNow;
+        replies.second = 0;
+    }
+
+    if (++replies.second > SSDP_MAX_REPLIES_PER_PEER)
+    {
+        if (replies.second == SSDP_MAX_REPLIES_PER_PEER + 1)
+            LOG(VB_UPNP, LOG_WARNING,
+                QString("SSDP: Too many searches from %1, ignoring them")
+                    .arg(sAddress));
+        return false;
+    }
+
+    // Hold on to it a little past the reply, the same search often arrives
+    // again through another interface or socket
+
+    m_pendingReplies.insert( sKey, nNow + nDelayMs + 500 );
+
+    return true;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -14,6 +14,9 @@
 #define __SSDP_H__
 
 #include <QFile>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPair>
 
 #include "upnpexp.h"
 #include "mthread.h"
@@ -27,6 +30,9 @@
 #define SSDP_PORT       1900
 #define SSDP_SEARCHPORT 6549
 
+// Search replies scheduled for one peer address per second, at most
+#define SSDP_MAX_REPLIES_PER_PEER 20
+
 typedef enum
 {
     SSDPM_Unknown         = 0,
@@ -77,6 +83,17 @@ class UPNP_PUBLIC SSDP : public MThread
         bool                m_bTermRequested;
         QMutex              m_lock;
 
+        // ------------------------------------------------------------------
+        // Only used on the SSDP thread, so not locked.
+        // ------------------------------------------------------------------
+
+        QElapsedTimer                       m_clock;
+        qint64                              m_nLastPurge;
+        /// "address:port ST" -> ms the reply to it is due to be sent
+        QHash<QString, qint64>              m_pendingReplies;
+        /// address -> (start of its current 1s window, replies in window)
+        QHash<QString, QPair<qint64, int> > m_peerReplies;
+
     private:
 
         // ------------------------------------------------------------------
@@ -93,6 +110,11 @@ class UPNP_PUBLIC SSDP : public MThread
         bool    ProcessSearchResponse( const QStringMap &sHeaders );
         bool    ProcessNotify        ( const QStringMap &sHeaders );
 
+        bool    AllowSearchReply     ( const QHostAddress &peerAddress,
+                                       quint16             peerPort,
+                                       const QString      &sST,
+                                       int                 nDelayMs );
+
         bool    IsTermRequested      ();
 
         QString GetHeaderValue    ( const QStringMap &headers,
@@ -41,7 +41,7 @@ SSDPCacheEntries::~SSDPCacheEntries()
 /// Clears the cache of all entries.
 void SSDPCacheEntries::Clear(void)
 {
-    QMutexLocker locker(&m_mutex);
+    QWriteLocker locker(&m_lock);
 
     EntryMap::iterator it = m_mapEntries.begin();
     for (; it != m_mapEntries.end(); ++it)
@@ -57,9 +57,9 @@ void SSDPCacheEntries::Clear(void)
 /// \note Caller must call DecrRef on non-NULL DeviceLocation when done with it.
 DeviceLocation *SSDPCacheEntries::Find(const QString &sUSN)
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
 
-    EntryMap::iterator it = m_mapEntries.find(GetNormalizedUSN(sUSN));
+    EntryMap::const_iterator it = m_mapEntries.constFind(GetNormalizedUSN(sUSN));
     DeviceLocation *pEntry = (it != m_mapEntries.end()) ? *it : NULL;
     if (pEntry)
         pEntry->IncrRef();
@@ -71,7 +71,7 @@ DeviceLocation *SSDPCacheEntries::Find(const QString &sUSN)
 /// \note Caller must call DecrRef on non-NULL DeviceLocation when done with it.
 DeviceLocation *SSDPCacheEntries::GetFirst(void)
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
     if (m_mapEntries.empty())
         return NULL;
     DeviceLocation *loc = *m_mapEntries.begin();
@@ -83,7 +83,7 @@ DeviceLocation *SSDPCacheEntries::GetFirst(void)
 /// \note Caller must call DecrRef() on each entry in the map.
 void SSDPCacheEntries::GetEntryMap(EntryMap &map)
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
 
     EntryMap::const_iterator it = m_mapEntries.begin();
     for (; it != m_mapEntries.end(); ++it)
@@ -96,7 +96,7 @@ void SSDPCacheEntries::GetEntryMap(EntryMap &map)
 /// Inserts a device location into the cache
 void SSDPCacheEntries::Insert(const QString &sUSN, DeviceLocation *pEntry)
 {
-    QMutexLocker locker(&m_mutex);
+    QWriteLocker locker(&m_lock);
 
     pEntry->IncrRef();
 
@@ -116,10 +116,29 @@ void SSDPCacheEntries::Insert(const QString &sUSN, DeviceLocation *pEntry)
             .arg(pEntry->m_sUSN).arg(pEntry->m_sLocation));
 }
 
+/// Updates the location and expiry of a device already in the cache,
+/// returns false if it isn't.
+bool SSDPCacheEntries::Refresh(const QString &sUSN, const QString &sLocation,
+                               const TaskTime &ttExpires)
+{
+    QWriteLocker locker(&m_lock);
+
+    EntryMap::iterator it = m_mapEntries.find(GetNormalizedUSN(sUSN));
+    if ((it == m_mapEntries.end()) || (*it == NULL))
+        return false;
+
+    // Devices repeat their announcements, the location seldom changes
+    if ((*it)->m_sLocation != sLocation)
+        (*it)->m_sLocation = sLocation;
+    (*it)->m_ttExpires = ttExpires;
+
+    return true;
+}
+
 /// Removes a specific entry from the cache
 void SSDPCacheEntries::Remove( const QString &sUSN )
 {
-    QMutexLocker locker(&m_mutex);
+    QWriteLocker locker(&m_lock);
 
     QString usn = GetNormalizedUSN(sUSN);
     EntryMap::iterator it = m_mapEntries.find(usn);
@@ -142,7 +161,7 @@ void SSDPCacheEntries::Remove( const QString &sUSN )
 /// Removes expired cache entries, returning the number removed.
 uint SSDPCacheEntries::RemoveStale(const TaskTime &ttNow)
 {
-    QMutexLocker locker(&m_mutex);
+    QWriteLocker locker(&m_lock);
     uint nCount = 0;
 
     EntryMap::iterator it = m_mapEntries.begin();
@@ -155,7 +174,7 @@ uint SSDPCacheEntries::RemoveStale(const TaskTime &ttNow)
         else if ((*it)->m_ttExpires < ttNow)
         {
             // Note: locking is not required above since we hold
-            // one reference to each entry and are holding m_mutex.
+            // one reference to each entry and are holding m_lock.
             (*it)->DecrRef();
 
             // -=>TODO: Need to somehow call SSDPCache::NotifyRemove
@@ -176,7 +195,7 @@ uint SSDPCacheEntries::RemoveStale(const TaskTime &ttNow)
 QTextStream &SSDPCacheEntries::OutputXML(
     QTextStream &os, uint *pnEntryCount) const
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
 
     EntryMap::const_iterator it  = m_mapEntries.begin();
     for (; it != m_mapEntries.end(); ++it)
@@ -185,7 +204,7 @@ QTextStream &SSDPCacheEntries::OutputXML(
             continue;
 
         // Note: IncrRef,DecrRef not required since SSDPCacheEntries
-        // holds one reference to each entry and we are holding m_mutex.
+        // holds one reference to each entry and we are holding m_lock.
         os << "<Service usn='" << (*it)->m_sUSN 
            << "' expiresInSecs='" << (*it)->ExpiresInSecs()
            << "' url='" << (*it)->m_sLocation << "' />" << endl;
@@ -200,7 +219,7 @@ QTextStream &SSDPCacheEntries::OutputXML(
 /// Prints this service to the console in human readable form
 void SSDPCacheEntries::Dump(uint &nEntryCount) const
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
 
     EntryMap::const_iterator it  = m_mapEntries.begin();
     for (; it != m_mapEntries.end(); ++it)
@@ -209,7 +228,7 @@ void SSDPCacheEntries::Dump(uint &nEntryCount) const
             continue;
 
         // Note: IncrRef,DecrRef not required since SSDPCacheEntries
-        // holds one reference to each entry and we are holding m_mutex.
+        // holds one reference to each entry and we are holding m_lock.
         LOG(VB_UPNP, LOG_DEBUG, QString(" * \t\t%1\t | %2\t | %3 ")
                 .arg((*it)->m_sUSN) .arg((*it)->ExpiresInSecs())
                 .arg((*it)->m_sLocation));
@@ -279,7 +298,7 @@ SSDPCache::~SSDPCache()
 
 void SSDPCache::Clear(void)
 {
-    QMutexLocker locker(&m_mutex);
+    QWriteLocker locker(&m_lock);
 
     SSDPCacheEntriesMap::iterator it  = m_cache.begin();
     for (; it != m_cache.end(); ++it)
@@ -295,9 +314,9 @@ void SSDPCache::Clear(void)
 /// \note Caller must call DecrRef on non-NULL when done with it.
 SSDPCacheEntries *SSDPCache::Find(const QString &sURI)
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
 
-    SSDPCacheEntriesMap::iterator it = m_cache.find(sURI);
+    SSDPCacheEntriesMap::const_iterator it = m_cache.constFind(sURI);
     if (it != m_cache.end() && (*it != NULL))
         (*it)->IncrRef();
 
@@ -341,9 +360,23 @@ void SSDPCache::Add( const QString &sURI,
     // Get a Pointer to a Entries QDict... (Create if not found)
     // --------------------------------------------------------------
 
+    // Nearly every call renews an announcement of a known type, so look
+    // for it without keeping readers out first.
+
     SSDPCacheEntries *pEntries = NULL;
     {
-        QMutexLocker locker(&m_mutex);
+        QReadLocker locker(&m_lock);
+        SSDPCacheEntriesMap::const_iterator it = m_cache.constFind(sURI);
+        if (it != m_cache.constEnd() && (*it != NULL))
+        {
+            pEntries = *it;
+            pEntries->IncrRef();
+        }
+    }
+
+    if (pEntries == NULL)
+    {
+        QWriteLocker locker(&m_lock);
         SSDPCacheEntriesMap::iterator it = m_cache.find(sURI);
         if (it == m_cache.end() || (*it == NULL))
         {
@@ -355,23 +388,18 @@ void SSDPCache::Add( const QString &sURI,
     }
 
     // --------------------------------------------------------------
-    // See if the Entries Collection contains our USN... (Create if not found)
+    // Renew our USN if the Entries Collection has it... (Create if not found)
     // --------------------------------------------------------------
 
-    DeviceLocation *pEntry = pEntries->Find(sUSN);
-    if (pEntry == NULL)
+    if (!pEntries->Refresh(sUSN, sLocation, ttExpires))
     {
-        pEntry = new DeviceLocation(sURI, sUSN, sLocation, ttExpires);
+        DeviceLocation *pEntry =
+            new DeviceLocation(sURI, sUSN, sLocation, ttExpires);
         pEntries->Insert(sUSN, pEntry);
+        pEntry->DecrRef();
         NotifyAdd(sURI, sUSN, sLocation);
     }
-    else
-    {
-        pEntry->m_sLocation = sLocation;
-        pEntry->m_ttExpires = ttExpires;
-    }
 
-    pEntry->DecrRef();
     pEntries->DecrRef();
 }
      
@@ -520,7 +548,7 @@ void SSDPCache::NotifyRemove( const QString &sURI, const QString &sUSN )
 QTextStream &SSDPCache::OutputXML(
     QTextStream &os, uint *pnDevCount, uint *pnEntryCount) const
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
 
     if (pnDevCount != NULL)
         *pnDevCount   = 0;
@@ -558,7 +586,7 @@ void SSDPCache::Dump(void)
     if (!VERBOSE_LEVEL_CHECK(VB_UPNP, LOG_DEBUG))
         return;
 
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
 
     LOG(VB_UPNP, LOG_DEBUG, "========================================"
                             "=======================================");
@@ -15,7 +15,7 @@
 
 // Qt headers
 #include <QObject>
-#include <QMutex>
+#include <QReadWriteLock>
 #include <QMap>
 
 // MythTV headers
@@ -42,8 +42,10 @@ class UPNP_PUBLIC SSDPCacheEntries : public ReferenceCounter
 
     void Clear(void);
     uint Count(void) const
-        { QMutexLocker locker(&m_mutex); return m_mapEntries.size(); }
+        { QReadLocker locker(&m_lock); return m_mapEntries.size(); }
     void Insert(const QString &sUSN, DeviceLocation *pEntry);
+    bool Refresh(const QString &sUSN, const QString &sLocation,
+                 const TaskTime &ttExpires);
     void Remove(const QString &sUSN);
     uint RemoveStale(const TaskTime &ttNow);
 
@@ -62,8 +64,10 @@ class UPNP_PUBLIC SSDPCacheEntries : public ReferenceCounter
     static int      g_nAllocated;       // Debugging only
 
   protected:
-    mutable QMutex  m_mutex;
-    EntryMap        m_mapEntries;
+    /// Lookups only read, so they share the lock and don't wait on each
+    /// other, only on a device being added or removed
+    mutable QReadWriteLock  m_lock;
+    EntryMap                m_mapEntries;
 };
 
 /// Key == Service Type URI
@@ -88,7 +92,7 @@ class UPNP_PUBLIC SSDPCache : public QObject,
 
     protected:
 
-        mutable QMutex          m_mutex;
+        mutable QReadWriteLock  m_lock;
         SSDPCacheEntriesMap     m_cache;
 
         void NotifyAdd   ( const QString &sURI,
@@ -110,8 +114,8 @@ class UPNP_PUBLIC SSDPCache : public QObject,
 
         virtual ~SSDPCache();
 
-        void Lock       () { m_mutex.lock();   }
-        void Unlock     () { m_mutex.unlock(); }
+        void Lock       () { m_lock.lockForWrite(); }
+        void Unlock     () { m_lock.unlock();       }
 
         SSDPCacheEntriesMap::Iterator Begin() { return m_cache.begin(); }
         SSDPCacheEntriesMap::Iterator End  () { return m_cache.end();   }
@@ -99,7 +99,7 @@ TaskQueue::TaskQueue() : MThread("TaskQueue"), m_bTermRequested( false )
 
 TaskQueue::~TaskQueue()
 {
-    m_bTermRequested = true; 
+    RequestTerminate();
 
     wait();
 
@@ -108,7 +108,10 @@ TaskQueue::~TaskQueue()
 
 void TaskQueue::RequestTerminate()
 {
+    m_mutex.lock();
     m_bTermRequested = true;
+    m_waitCond.wakeAll();
+    m_mutex.unlock();
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -132,7 +135,11 @@ void TaskQueue::run( )
         TaskTime ttNow;
         gettimeofday( (&ttNow), NULL );
 
-        if ((pTask = GetNextExpiredTask( ttNow )) != NULL)
+        // Run every task that is due. A burst of M-SEARCH replies must not
+        // be spread out by a sleep between each one.
+
+        while (!m_bTermRequested &&
+               (pTask = GetNextExpiredTask( ttNow )) != NULL)
         {
             try
             {
@@ -143,11 +150,22 @@ void TaskQueue::run( )
             {
                 LOG(VB_GENERAL, LOG_ERR, "Call to Execute threw an exception.");
             }
-
         }
-        // Make sure to throttle our processing.
 
-        msleep( 100 );
+        // ------------------------------------------------------------------
+        // Sleep until the next task is due, or an earlier one is added.
+        // ------------------------------------------------------------------
+
+        gettimeofday( (&ttNow), NULL );
+
+        m_mutex.lock();
+
+        long nDelay = GetNextTaskDelay( ttNow );
+
+        if (!m_bTermRequested && nDelay > 0)
+            m_waitCond.wait( &m_mutex, nDelay );
+
+        m_mutex.unlock();
     }
 
     RunEpilog();
@@ -198,7 +216,16 @@ void TaskQueue::AddTask( TaskTime ttKey, Task *pTask )
     {
         m_mutex.lock();
         pTask->IncrRef();
-        m_mapTasks.insert( TaskMap::value_type( ttKey, pTask ));
+
+        TaskMap::iterator it =
+            m_mapTasks.insert( TaskMap::value_type( ttKey, pTask ));
+
+        // Only a task due before the one being waited for needs the
+        // thread woken
+
+        if (it == m_mapTasks.begin())
+            m_waitCond.wakeAll();
+
         m_mutex.unlock();
     }
 }
@@ -250,3 +277,23 @@ Task *TaskQueue::GetNextExpiredTask( TaskTime tt, long nWithinMilliSecs /*=50*/
 
     return pTask;
 }
+
+/////////////////////////////////////////////////////////////////////////////
+// Returns the milliseconds until the next task is due, less the 50ms
+// GetNextExpiredTask allows for. m_mutex must be held.
+/////////////////////////////////////////////////////////////////////////////
+
+long TaskQueue::GetNextTaskDelay( TaskTime tt )
+{
+    // Nothing queued, just wake up now and again to check for termination
+
+    if (m_mapTasks.empty())
+        return 1000;
+
+    TaskTime ttTask = m_mapTasks.begin()->first;
+
+    long nDelay = (ttTask.tv_sec  - tt.tv_sec ) * 1000 +
+                  (ttTask.tv_usec - tt.tv_usec) / 1000 - 50;
+
+    return (nDelay > 1000) ? 1000 : nDelay;
+}
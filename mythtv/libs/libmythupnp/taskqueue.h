@@ -26,6 +26,7 @@
 
 // Qt headers
 #include <QMutex>
+#include <QWaitCondition>
 
 // MythTV headers
 #include "referencecounter.h"
@@ -88,13 +89,15 @@ class UPNP_PUBLIC TaskQueue : public MThread
 
     protected:
 
-        TaskMap     m_mapTasks;
-        QMutex      m_mutex;
-        bool        m_bTermRequested;
+        TaskMap         m_mapTasks;
+        QMutex          m_mutex;
+        QWaitCondition  m_waitCond;     // Woken when an earlier task is added
+        bool            m_bTermRequested;
 
     protected:
 
         bool  IsTermRequested();
+        long  GetNextTaskDelay   ( TaskTime tt );
 
         virtual void run    ();
 
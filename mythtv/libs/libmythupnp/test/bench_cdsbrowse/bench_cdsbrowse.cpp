@@ -0,0 +1,361 @@
+/*
+ *  ContentDirectory crawl benchmark
+ *
+ *  Simulates a renderer building its own database from a large music
+ *  library: every container is read with BrowseDirectChildren one page at a
+ *  time, and every page is rendered to DIDL-Lite, through
+ *  UPnpCDSExtension::Browse(). The library is generated in memory, so the
+ *  run measures paging and rendering rather than MySQL.
+ *
+ *  The crawl runs twice. The first run sorts the whole container for every
+ *  page, which is the work "ORDER BY ... LIMIT offset,count" asks of the
+ *  database; the second pages through UPnpCDSIndex as the backend's
+ *  extensions do. Compare the slowest request of each: without the index it
+ *  grows with the size of the library, with it only with the page size.
+ *
+ *  Usage: bench_cdsbrowse [tracks] [page size]
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+#include "upnpcds.h"
+#include "upnpcdsindex.h"
+
+#define TRACKS_PER_ALBUM  12
+#define ALBUMS_PER_ARTIST 8
+
+// The library the extension serves, standing in for the music tables.
+
+class BenchLibrary
+{
+    public:
+
+        QVector<QString> m_artists;     // Indexed by id
+        QVector<QString> m_albums;
+        QVector<int>     m_albumArtist;
+        QVector<QString> m_tracks;
+        QVector<int>     m_trackAlbum;
+
+        explicit BenchLibrary( int nTracks )
+        {
+            // Names in no particular order, so sorting them costs something
+            srand( 1 );
+
+            int nAlbums  = qMax( nTracks / TRACKS_PER_ALBUM, 1 );
+            int nArtists = qMax( nAlbums / ALBUMS_PER_ARTIST, 1 );
+
+            for (int i = 0; i < nArtists; i++)
+                m_artists.append( QString( "Artist %1" ).arg( rand() ) );
+
+            for (int i = 0; i < nAlbums; i++)
+            {
+                m_albums.append( QString( "Album %1" ).arg( rand() ) );
+                m_albumArtist.append( i % nArtists );
+            }
+
+            for (int i = 0; i < nTracks; i++)
+            {
+                m_tracks.append( QString( "Track %1" ).arg( rand() ) );
+                m_trackAlbum.append( i % nAlbums );
+            }
+        }
+};
+
+// The ids of a container, filtered and sorted the way the SQL does it.
+
+class BenchSort
+{
+    public:
+
+        explicit BenchSort( const QVector<QString> &names ) : m_names( names ) {}
+
+        bool operator()( int a, int b ) const
+        {
+            return m_names[a] < m_names[b] || (m_names[a] == m_names[b] && a < b);
+        }
+
+    private:
+
+        const QVector<QString> &m_names;
+};
+
+class BenchMusic : public UPnpCDSExtension
+{
+    protected:
+
+        const BenchLibrary &m_library;
+        UPnpCDSIndex       *m_pIndex;
+
+    public:
+
+        BenchMusic( const BenchLibrary &library, UPnpCDSIndex *pIndex )
+            : UPnpCDSExtension( "Music", "Music",
+                                "object.item.audioItem.musicTrack" ),
+              m_library( library ), m_pIndex( pIndex ) {}
+
+    protected:
+
+        virtual void CreateRoot( void )
+        {
+            m_pRoot = CDSObject::CreateContainer( m_sExtensionId, m_sName, "0" );
+
+            const char *containers[] = { "Track", "Album", "Artist" };
+
+            for (uint i = 0; i < sizeof(containers) / sizeof(containers[0]); i++)
+            {
+                CDSObject *pContainer = CDSObject::CreateContainer(
+                    m_sExtensionId + "/" + containers[i], containers[i],
+                    m_sExtensionId );
+                m_pRoot->AddChild( pContainer );
+            }
+        }
+
+        virtual bool LoadChildren( const UPnpCDSRequest  *pRequest,
+                                   UPnpCDSExtensionResults *pResults,
+                                   IDTokenMap tokens, QString currentToken )
+        {
+            if (currentToken.isEmpty() || currentToken == "music")
+            {
+                pResults->Add( GetRoot()->GetChildren() );
+                pResults->m_nTotalMatches = GetRoot()->GetChildCount();
+                return true;
+            }
+
+            if (currentToken == "track" ||
+                (currentToken == "album" && tokens["album"].toInt() > 0))
+                return Load( "Track", pRequest, pResults, tokens );
+
+            if (currentToken == "album" ||
+                (currentToken == "artist" && tokens["artist"].toInt() > 0))
+                return Load( "Album", pRequest, pResults, tokens );
+
+            if (currentToken == "artist")
+                return Load( "Artist", pRequest, pResults, tokens );
+
+            return false;
+        }
+
+    private:
+
+        QVector<int> Select( const QString &sKind, IDTokenMap &tokens )
+        {
+            int nAlbum  = tokens["album"].toInt() - 1;
+            int nArtist = tokens["artist"].toInt() - 1;
+
+            QVector<int> ids;
+
+            if (sKind == "Track")
+            {
+                for (int i = 0; i < m_library.m_tracks.size(); i++)
+                    if (nAlbum < 0 || m_library.m_trackAlbum[i] == nAlbum)
+                        ids.append( i );
+                std::sort( ids.begin(), ids.end(), BenchSort( m_library.m_tracks ));
+            }
+            else if (sKind == "Album")
+            {
+                for (int i = 0; i < m_library.m_albums.size(); i++)
+                    if (nArtist < 0 || m_library.m_albumArtist[i] == nArtist)
+                        ids.append( i );
+                std::sort( ids.begin(), ids.end(), BenchSort( m_library.m_albums ));
+            }
+            else
+            {
+                for (int i = 0; i < m_library.m_artists.size(); i++)
+                    ids.append( i );
+                std::sort( ids.begin(), ids.end(), BenchSort( m_library.m_artists ));
+            }
+
+            return ids;
+        }
+
+        bool Load( const QString &sKind, const UPnpCDSRequest *pRequest,
+                   UPnpCDSExtensionResults *pResults, IDTokenMap tokens )
+        {
+            uint nOffset = pRequest->m_nStartingIndex;
+            uint nCount  = pRequest->m_nRequestedCount;
+
+            QString      sKey = UPnpCDSIndex::GetKey( sKind, tokens );
+            QVector<int> ids;
+            uint         nTotal = 0;
+
+            if (!m_pIndex || !m_pIndex->GetPage( sKey, nOffset, nCount, ids, nTotal ))
+            {
+                uint nGeneration = m_pIndex ? m_pIndex->GetGeneration() : 0;
+
+                QVector<int> all = Select( sKind, tokens );
+
+                if (m_pIndex)
+                    m_pIndex->Insert( sKey, all, nGeneration );
+
+                nTotal = all.size();
+
+                if (nOffset < nTotal)
+                    ids = all.mid( nOffset, qMin( nCount, nTotal - nOffset ));
+            }
+
+            pResults->m_nTotalMatches = nTotal;
+
+            for (int i = 0; i < ids.size(); i++)
+            {
+                int        nId = ids[i];
+                CDSObject *pObject;
+
+                // Ids are 1 based in the object ids, like database keys
+                if (sKind == "Track")
+                {
+                    pObject = CDSObject::CreateMusicTrack(
+                        CreateIDString( pRequest->m_sObjectId, "Track", nId + 1 ),
+                        m_library.m_tracks[nId], pRequest->m_sParentId );
+
+                    int nAlbum = m_library.m_trackAlbum[nId];
+                    pObject->SetPropValue( "album",  m_library.m_albums[nAlbum] );
+                    pObject->SetPropValue( "artist", m_library.m_artists[
+                                               m_library.m_albumArtist[nAlbum]] );
+                }
+                else if (sKind == "Album")
+                {
+                    pObject = CDSObject::CreateMusicAlbum(
+                        CreateIDString( pRequest->m_sObjectId, "Album", nId + 1 ),
+                        m_library.m_albums[nId], pRequest->m_sParentId );
+                    pObject->SetPropValue( "artist", m_library.m_artists[
+                                               m_library.m_albumArtist[nId]] );
+                }
+                else
+                {
+                    pObject = CDSObject::CreateMusicArtist(
+                        CreateIDString( pRequest->m_sObjectId, "Artist", nId + 1 ),
+                        m_library.m_artists[nId], pRequest->m_sParentId );
+                }
+
+                pResults->Add( pObject );
+                pObject->DecrRef();
+            }
+
+            return true;
+        }
+};
+
+static void Crawl( const char *pszName, UPnpCDSExtension &extension,
+                   int nPageSize )
+{
+    QStringList containers( "Music" );
+    FilterMap   filter( QStringList( "*" ));
+
+    int    nRequests = 0;
+    int    nObjects  = 0;
+    qint64 nBytes    = 0;
+    qint64 nSlowest  = 0;
+
+    QElapsedTimer total;
+    total.start();
+
+    while (!containers.isEmpty())
+    {
+        QString sId     = containers.takeFirst();
+        uint    nOffset = 0;
+        uint    nTotal  = 1;
+
+        while (nOffset < nTotal)
+        {
+            UPnpCDSRequest request;
+
+            request.m_sObjectId       = sId;
+            request.m_eBrowseFlag     = CDS_BrowseDirectChildren;
+            request.m_nStartingIndex  = nOffset;
+            request.m_nRequestedCount = nPageSize;
+
+            QElapsedTimer timer;
+            timer.start();
+
+            UPnpCDSExtensionResults *pResults = extension.Browse( &request );
+
+            if (!pResults || pResults->m_eErrorCode != UPnPResult_Success)
+            {
+                fprintf( stderr, "Browse of %s failed\n", qPrintable( sId ));
+                delete pResults;
+                break;
+            }
+
+            nBytes += pResults->GetResultXML( filter ).toUtf8().size();
+
+            nSlowest = qMax( nSlowest, timer.nsecsElapsed() );
+
+            CDSObjects::const_iterator it;
+            for (it = pResults->m_List.begin(); it != pResults->m_List.end(); ++it)
+            {
+                if ((*it)->m_eType == OT_Container)
+                    containers.append( (*it)->m_sId );
+            }
+
+            nTotal   = pResults->m_nTotalMatches;
+            nOffset += pResults->m_List.size();
+
+            nRequests++;
+            nObjects += pResults->m_List.size();
+
+            bool bEmpty = pResults->m_List.isEmpty();
+
+            delete pResults;
+
+            if (bEmpty)
+                break;
+        }
+    }
+
+    qint64 nsecs = total.nsecsElapsed();
+
+    printf( "%-10s %10d %10d %10.1f %12.0f %10.2f %10.2f\n", pszName,
+            nRequests, nObjects, (double)nBytes / (1024 * 1024),
+            nsecs ? (double)nRequests * 1e9 / (double)nsecs : 0.0,
+            (double)nsecs / 1e9, (double)nSlowest / 1e6 );
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    int nTracks   = (argc > 1) ? atoi(argv[1]) : 60000;
+    int nPageSize = (argc > 2) ? atoi(argv[2]) : 50;
+
+    // Browse totals are 16 bit
+    nTracks   = qBound(1, nTracks, 65535);
+    nPageSize = qBound(1, nPageSize, 65535);
+
+    BenchLibrary library( nTracks );
+
+    printf("%d tracks, %d albums, %d artists, %d objects per page\n",
+           library.m_tracks.size(), library.m_albums.size(),
+           library.m_artists.size(), nPageSize);
+    printf("%-10s %10s %10s %10s %12s %10s %10s\n", "crawl", "requests",
+           "objects", "MiB", "requests/s", "secs", "slowest ms");
+
+    BenchMusic unindexed( library, NULL );
+    Crawl( "sort", unindexed, nPageSize );
+
+    UPnpCDSIndex index( "Bench" );
+    BenchMusic   indexed( library, &index );
+    Crawl( "index", indexed, nPageSize );
+
+    return 0;
+}
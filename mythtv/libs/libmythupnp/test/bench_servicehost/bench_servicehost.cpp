@@ -0,0 +1,170 @@
+/*
+ *  Service dispatch benchmark
+ *
+ *  Feeds canned requests through ServiceHost::ProcessRequest() from an
+ *  in-memory loopback client and reports requests per second, so changes
+ *  to request parsing, method dispatch and serialization can be measured
+ *  without a backend or a network in the way.
+ *
+ *  Usage: bench_servicehost [iterations]
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include "bench_servicehost.h"
+#include "configuration.h"
+#include "httprequest.h"
+#include "servicehost.h"
+#include "upnp.h"
+
+// Answers every setting with its default, so nothing touches the disk.
+
+class BenchConfiguration : public Configuration
+{
+    public:
+
+        virtual bool    Load    ( void ) { return true; }
+        virtual bool    Save    ( void ) { return true; }
+
+        virtual int     GetValue( const QString &, int     Default ) { return Default; }
+        virtual QString GetValue( const QString &, QString Default ) { return Default; }
+
+        virtual void    SetValue( const QString &, int     ) {}
+        virtual void    SetValue( const QString &, QString ) {}
+        virtual void    ClearValue( const QString & ) {}
+};
+
+// Reads the request from a buffer and discards the response.
+
+class LoopbackRequest : public HTTPRequest
+{
+    protected:
+
+        QByteArray  m_request;
+        int         m_nPos;
+
+    public:
+
+        explicit LoopbackRequest( const QByteArray &request )
+            : m_request( request ), m_nPos( 0 ) {}
+
+        virtual QString ReadLine( int /*msecs*/ )
+        {
+            int nEnd = m_request.indexOf( '\n', m_nPos );
+
+            if (nEnd < 0)
+                nEnd = m_request.size() - 1;
+
+            QString sLine = QString::fromUtf8( m_request.constData() + m_nPos,
+                                               nEnd + 1 - m_nPos );
+            m_nPos = nEnd + 1;
+
+            return sLine;
+        }
+
+        virtual qint64 ReadBlock( char *pData, qint64 nMaxLen, int /*msecs*/ )
+        {
+            qint64 nLen = qMin( nMaxLen, (qint64)(m_request.size() - m_nPos) );
+
+            memcpy( pData, m_request.constData() + m_nPos, nLen );
+            m_nPos += nLen;
+
+            return nLen;
+        }
+
+        virtual qint64  WriteBlock     ( const char *, qint64 nLen ) { return nLen; }
+        virtual QString GetHostAddress () { return "127.0.0.1"; }
+        virtual quint16 GetHostPort    () { return 6544; }
+        virtual QString GetPeerAddress () { return "127.0.0.1"; }
+        virtual int     getSocketHandle() { return -1; }
+};
+
+static const struct
+{
+    const char *name;
+    const char *request;
+} requests[] =
+{
+    { "GetSetting (xml)",
+      "GET /Bench/GetSetting?HostName=frontend&Key=Theme&Default=none HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "\r\n" },
+    { "GetSetting (json)",
+      "GET /Bench/GetSetting?HostName=frontend&Key=Theme&Default=none HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Accept: application/json\r\n"
+      "\r\n" },
+    { "GetRecorderCount",
+      "GET /Bench/GetRecorderCount?SourceId=3&Visible=true"
+      "&StartTime=2016-01-01T10:00:00Z HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "\r\n" },
+    { "PutSetting (POST)",
+      "POST /Bench/PutSetting HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Content-Type: application/x-www-form-urlencoded\r\n"
+      "Content-Length: 38\r\n"
+      "\r\n"
+      "HostName=frontend&Key=Theme&Value=dark" },
+};
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    int iterations = (argc > 1) ? atoi(argv[1]) : 100000;
+    if (iterations < 1)
+        iterations = 1;
+
+    UPnp::SetConfiguration( new BenchConfiguration() );
+
+    ServiceHost host( BenchService::staticMetaObject, "Bench", "/Bench", "" );
+
+    printf("%d iterations\n", iterations);
+    printf("%-20s %14s\n", "request", "requests/s");
+
+    for (uint r = 0; r < sizeof(requests) / sizeof(requests[0]); r++)
+    {
+        QByteArray request( requests[r].request );
+        int        failed = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < iterations; i++)
+        {
+            LoopbackRequest oRequest( request );
+
+            if (!oRequest.ParseRequest() ||
+                !host.ProcessRequest( &oRequest ) ||
+                oRequest.m_nResponseStatus != 200)
+                failed++;
+        }
+
+        qint64 nsecs = timer.nsecsElapsed();
+
+        printf("%-20s %14.0f%s\n", requests[r].name,
+               nsecs ? (double)iterations * 1e9 / (double)nsecs : 0.0,
+               failed ? "  (failures)" : "");
+    }
+
+    return 0;
+}
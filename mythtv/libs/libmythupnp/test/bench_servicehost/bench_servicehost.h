@@ -0,0 +1,61 @@
+/*
+ *  Service dispatch benchmark
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QDateTime>
+#include <QString>
+
+#include "service.h"
+
+// Stand-in for the small, frequently polled calls such as
+// Myth/GetSetting and Dvr/GetRecorderList.
+
+class BenchService : public Service
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version", "1.0" );
+
+    Q_CLASSINFO( "PutSetting_Method", "POST" );
+
+    public:
+
+        Q_INVOKABLE explicit BenchService( QObject *parent = 0 )
+            : Service( parent ) {}
+
+    public slots:
+
+        QString GetSetting ( const QString   &HostName,
+                             const QString   &Key,
+                             const QString   &Default )
+        {
+            return HostName + Key + Default;
+        }
+
+        int     GetRecorderCount( int              SourceId,
+                                  bool             Visible,
+                                  const QDateTime &StartTime )
+        {
+            return SourceId + (Visible ? 1 : 0) + StartTime.date().day();
+        }
+
+        bool    PutSetting ( const QString   &HostName,
+                             const QString   &Key,
+                             const QString   &Value )
+        {
+            return !(HostName + Key + Value).isEmpty();
+        }
+};
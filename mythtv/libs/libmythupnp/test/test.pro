@@ -0,0 +1,5 @@
+include (../../../settings.pro)
+
+TEMPLATE = subdirs
+
+SUBDIRS += bench_servicehost bench_cdsbrowse
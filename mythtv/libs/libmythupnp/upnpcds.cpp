@@ -17,6 +17,7 @@ using namespace std;
 
 #include "upnp.h"
 #include "upnpcds.h"
+#include "upnpcdsindex.h"
 #include "upnputil.h"
 #include "mythlogging.h"
 #include "mythversion.h"
@@ -801,6 +802,103 @@ UPnpCDSExtension::~UPnpCDSExtension()
 //
 /////////////////////////////////////////////////////////////////////////////
 
+// Most objects of a container returned by one Browse. A request for all of
+// them (RequestedCount 0) would otherwise load the whole container in one
+// query, the control point pages through the rest using TotalMatches.
+static const uint kMaxIndexPageSize = 500;
+
+/**
+ * \brief Returns a page of the ids of the container, from the index or, the
+ *        first time it is browsed, by running sIdSql to build its list.
+ *
+ * sIdSql gets the WHERE clause of the tokens (BuildWhereClause()) as its
+ * only argument.
+ */
+bool UPnpCDSExtension::LoadIndexPage(UPnpCDSIndex *pIndex,
+                                     const QString &sKind,
+                                     const QString &sIdSql,
+                                     const UPnpCDSRequest *pRequest,
+                                     IDTokenMap tokens,
+                                     QVector<int> &ids, uint &nTotal)
+{
+    QString sKey   = UPnpCDSIndex::GetKey(sKind, tokens);
+    uint    nCount = std::min((uint)pRequest->m_nRequestedCount,
+                              kMaxIndexPageSize);
+
+    if (pIndex->GetPage(sKey, pRequest->m_nStartingIndex, nCount,
+                        ids, nTotal))
+        return true;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    QStringList clauses;
+    query.prepare(sIdSql.arg(BuildWhereClause(clauses, tokens)));
+
+    BindValues(query, tokens);
+
+    return pIndex->Build(sKey, query, pRequest->m_nStartingIndex, nCount,
+                         ids, nTotal);
+}
+
+/**
+ * \brief Adds the objects loaded for a page to the results, in the order of
+ *        the page's ids, and releases them.
+ *
+ * The rows of a page are loaded with "WHERE id IN (...)" and come back in
+ * whatever order the database likes. Without ids, a single object was
+ * loaded and the objects are added as they are.
+ */
+void UPnpCDSExtension::AddIndexPage(UPnpCDSExtensionResults *pResults,
+                                    const QVector<int> &ids,
+                                    const QMap<int, CDSObject*> &objects)
+{
+    if (ids.isEmpty())
+    {
+        QMap<int, CDSObject*>::const_iterator it = objects.begin();
+        for (; it != objects.end(); ++it)
+            pResults->Add(*it);
+    }
+    else
+    {
+        for (int i = 0; i < ids.size(); ++i)
+        {
+            CDSObject *pObject = objects.value(ids[i], NULL);
+            if (pObject)
+                pResults->Add(pObject);
+        }
+    }
+
+    QMap<int, CDSObject*>::const_iterator it = objects.begin();
+    for (; it != objects.end(); ++it)
+        (*it)->DecrRef();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+QString UPnpCDSExtension::BuildWhereClause( QStringList clauses,
+                                            IDTokenMap /*tokens*/ )
+{
+    if (clauses.isEmpty())
+        return QString();
+
+    return " WHERE " + clauses.join(" AND ");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void UPnpCDSExtension::BindValues( MSqlQuery &/*query*/,
+                                   IDTokenMap /*tokens*/ )
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 bool UPnpCDSExtension::IsBrowseRequestForUs( UPnpCDSRequest *pRequest )
 {
     if (!pRequest->m_sObjectId.startsWith(m_sExtensionId, Qt::CaseSensitive))
@@ -17,6 +17,7 @@
 #include <QMap>
 #include <QString>
 #include <QObject>
+#include <QVector>
 
 #include "upnp.h"
 #include "upnpcdsobjects.h"
@@ -24,6 +25,7 @@
 #include "mythdbcon.h"
 
 class UPnpCDS;
+class UPnpCDSIndex;
 
 typedef enum 
 {
@@ -253,6 +255,26 @@ class UPNP_PUBLIC UPnpCDSExtension
                                       const QString &Name,
                                       const QString &Value );
 
+        // ------------------------------------------------------------------
+        // Paging of containers listed from an UPnpCDSIndex
+        // ------------------------------------------------------------------
+
+        bool LoadIndexPage ( UPnpCDSIndex *pIndex,
+                             const QString &sKind,
+                             const QString &sIdSql,
+                             const UPnpCDSRequest *pRequest,
+                             IDTokenMap tokens,
+                             QVector<int> &ids,
+                             uint &nTotal );
+        void AddIndexPage  ( UPnpCDSExtensionResults *pResults,
+                             const QVector<int> &ids,
+                             const QMap<int, CDSObject*> &objects );
+
+        virtual QString BuildWhereClause ( QStringList clauses,
+                                           IDTokenMap tokens );
+        virtual void    BindValues       ( MSqlQuery &query,
+                                           IDTokenMap tokens );
+
         CDSObject *m_pRoot;
 
     public:
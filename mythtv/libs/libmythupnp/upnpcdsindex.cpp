@@ -0,0 +1,243 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: upnpcdsindex.cpp
+//
+// Purpose     : Sorted object id lists for ContentDirectory containers, so
+//               a Browse of any page costs the same as the first one
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Own headers
+#include "upnpcdsindex.h"
+
+// Qt headers
+#include <QStringList>
+
+// MythTV headers
+#include "mythlogging.h"
+#include "mythdb.h"
+
+#define LOC QString("UPnpCDSIndex(%1): ").arg(m_sName)
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// UPnpCDSIndex Class Implementation
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+UPnpCDSIndex::UPnpCDSIndex(const QString &sName, int nMaxSizeKB) :
+    m_sName(sName),
+    m_nGeneration(0),
+    m_containers(nMaxSizeKB)
+{
+}
+
+/**
+ * \brief Returns the key of the container listing objects of sKind,
+ *        filtered by the tokens of its object id.
+ *
+ * Tokens without a value, such as the "Track" of "Music/Track", don't
+ * filter anything and are left out.
+ */
+QString UPnpCDSIndex::GetKey(const QString &sKind, const IDTokenMap &tokens)
+{
+    QStringList parts(sKind.toLower());
+
+    // IDTokenMap is sorted by token name, so the key doesn't depend on the
+    // order of the tokens in the object id
+    IDTokenMap::const_iterator it;
+    for (it = tokens.constBegin(); it != tokens.constEnd(); ++it)
+    {
+        if (it.value().isEmpty())
+            continue;
+
+        parts << QString("%1=%2").arg(it.key()).arg(it.value());
+    }
+
+    return parts.join('/');
+}
+
+uint UPnpCDSIndex::GetGeneration(void) const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_nGeneration;
+}
+
+/**
+ * \brief Copies the ids of a page of the container into ids.
+ *
+ * \return false if the container isn't indexed; the caller should build its
+ *         list, Insert() it and try again.
+ */
+bool UPnpCDSIndex::GetPage(const QString &sKey, uint nOffset, uint nCount,
+                           QVector<int> &ids, uint &nTotal)
+{
+    QMutexLocker locker(&m_lock);
+
+    Container *pContainer = m_containers.object(sKey);
+
+    if (pContainer == NULL)
+        return false;
+
+    nTotal = pContainer->m_ids.size();
+
+    ids.clear();
+
+    if (nOffset < nTotal)
+        ids = pContainer->m_ids.mid(nOffset, qMin(nCount, nTotal - nOffset));
+
+    return true;
+}
+
+void UPnpCDSIndex::Insert(const QString &sKey, const QVector<int> &ids,
+                          uint nGeneration)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (nGeneration != m_nGeneration)
+    {
+        LOG(VB_UPNP, LOG_DEBUG, LOC +
+            QString("Not indexing '%1', library changed while it was read")
+                .arg(sKey));
+        return;
+    }
+
+    Container *pContainer = new Container;
+
+    pContainer->m_sKind = sKey.section('/', 0, 0);
+    pContainer->m_ids   = ids;
+
+    int nCost = (ids.size() * sizeof(int) + 1023) / 1024;
+
+    LOG(VB_UPNP, LOG_DEBUG, LOC + QString("Indexed '%1', %2 objects")
+        .arg(sKey).arg(ids.size()));
+
+    // QCache deletes the container if it is bigger than the whole cache
+    m_containers.insert(sKey, pContainer, qMax(nCost, 1));
+}
+
+/**
+ * \brief Builds the list of a container that GetPage() didn't find, and
+ *        returns a page of it as GetPage() would have.
+ *
+ * \param query A prepared query selecting the ids of the container's
+ *              objects, in order, in its first column.
+ */
+bool UPnpCDSIndex::Build(const QString &sKey, MSqlQuery &query,
+                         uint nOffset, uint nCount,
+                         QVector<int> &ids, uint &nTotal)
+{
+    uint nGeneration = GetGeneration();
+
+    if (!query.exec())
+    {
+        MythDB::DBError("UPnpCDSIndex::Build", query);
+        return false;
+    }
+
+    QVector<int> all;
+    all.reserve(qMax(query.size(), 0));
+
+    while (query.next())
+        all.append(query.value(0).toInt());
+
+    Insert(sKey, all, nGeneration);
+
+    nTotal = all.size();
+
+    ids.clear();
+
+    if (nOffset < nTotal)
+        ids = all.mid(nOffset, qMin(nCount, nTotal - nOffset));
+
+    return true;
+}
+
+/**
+ * \brief Drops every list, for changes that may affect any container.
+ */
+void UPnpCDSIndex::Invalidate(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    ++m_nGeneration;
+
+    m_containers.clear();
+
+    LOG(VB_UPNP, LOG_DEBUG, LOC + "Invalidated all containers");
+}
+
+/**
+ * \brief Drops the lists of the containers listing objects of sKind.
+ */
+void UPnpCDSIndex::Invalidate(const QString &sKind)
+{
+    QMutexLocker locker(&m_lock);
+
+    ++m_nGeneration;
+
+    QString sLowerKind = sKind.toLower();
+
+    QList<QString> keys = m_containers.keys();
+
+    QList<QString>::const_iterator it;
+    for (it = keys.constBegin(); it != keys.constEnd(); ++it)
+    {
+        if (m_containers.object(*it)->m_sKind == sLowerKind)
+            m_containers.remove(*it);
+    }
+
+    LOG(VB_UPNP, LOG_DEBUG, LOC + QString("Invalidated '%1' containers")
+        .arg(sLowerKind));
+}
+
+/**
+ * \brief Removes a deleted object from the lists it is in.
+ *
+ * Removing an object doesn't change the order of the others, so the lists
+ * are edited in place rather than rebuilt.
+ */
+void UPnpCDSIndex::RemoveItem(const QString &sKind, int nId)
+{
+    QMutexLocker locker(&m_lock);
+
+    ++m_nGeneration;
+
+    QString sLowerKind = sKind.toLower();
+
+    QList<QString> keys = m_containers.keys();
+
+    QList<QString>::const_iterator it;
+    for (it = keys.constBegin(); it != keys.constEnd(); ++it)
+    {
+        Container *pContainer = m_containers.object(*it);
+
+        if (pContainer->m_sKind != sLowerKind)
+            continue;
+
+        // A container lists an object once at most
+        int nIndex = pContainer->m_ids.indexOf(nId);
+        if (nIndex >= 0)
+            pContainer->m_ids.remove(nIndex);
+    }
+}
+
+/**
+ * \brief Formats ids for an SQL "IN (...)" or "FIELD(...)" clause.
+ */
+QString UPnpCDSIndex::ToSqlList(const QVector<int> &ids)
+{
+    QStringList list;
+
+    QVector<int>::const_iterator it;
+    for (it = ids.constBegin(); it != ids.constEnd(); ++it)
+        list << QString::number(*it);
+
+    return list.join(',');
+}
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: upnpcdsindex.h
+//
+// Purpose     : Sorted object id lists for ContentDirectory containers, so
+//               a Browse of any page costs the same as the first one
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef UPNPCDSINDEX_H_
+#define UPNPCDSINDEX_H_
+
+// Qt headers
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QCache>
+
+// MythTV headers
+#include "upnpexp.h"
+#include "upnpcds.h"
+#include "mythdbcon.h"
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// UPnpCDSIndex Class Definition
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Keeps the sorted ids of the children of CDS containers.
+ *
+ * The extensions used to fetch a page of a container with
+ * "SQL_CALC_FOUND_ROWS ... LIMIT offset,count", which makes the database
+ * join, group and sort the whole container for every page. Renderers read
+ * large containers one page at a time, so crawling the 60k tracks of a
+ * music library re-sorted them hundreds of times.
+ *
+ * Instead an extension asks the index for the ids of the page. The first
+ * request for a container runs a single id-only query to build its list;
+ * later pages are a slice of that list, and only the rows of the page are
+ * then loaded from the database ("WHERE id IN (...)").
+ *
+ * Containers are keyed by the kind of object they list and the tokens of
+ * the object id that filter them (see GetKey()). Lists are dropped or
+ * edited when the library changes and rebuilt lazily, container by
+ * container, the next time they are browsed. The owning extension decides
+ * which events affect which kinds by listening for them in a subclass.
+ */
+class UPNP_PUBLIC UPnpCDSIndex : public QObject
+{
+  public:
+    explicit UPnpCDSIndex(const QString &sName, int nMaxSizeKB = 16 * 1024);
+    virtual ~UPnpCDSIndex() { }
+
+    static QString GetKey     ( const QString    &sKind,
+                                const IDTokenMap &tokens );
+
+    /// Changes every time lists are invalidated. Pass the value read before
+    /// building a list to Insert(), so a list built from data that changed
+    /// meanwhile is thrown away rather than stored.
+    uint    GetGeneration     ( void ) const;
+
+    bool    GetPage           ( const QString  &sKey,
+                                uint            nOffset,
+                                uint            nCount,
+                                QVector<int>   &ids,
+                                uint           &nTotal );
+    void    Insert            ( const QString      &sKey,
+                                const QVector<int> &ids,
+                                uint                nGeneration );
+    bool    Build             ( const QString  &sKey,
+                                MSqlQuery      &query,
+                                uint            nOffset,
+                                uint            nCount,
+                                QVector<int>   &ids,
+                                uint           &nTotal );
+
+    void    Invalidate        ( void );
+    void    Invalidate        ( const QString &sKind );
+    void    RemoveItem        ( const QString &sKind, int nId );
+
+    static QString ToSqlList  ( const QVector<int> &ids );
+
+  private:
+    class Container
+    {
+      public:
+        QString       m_sKind;
+        QVector<int>  m_ids;
+    };
+
+    QString                     m_sName;
+    mutable QMutex              m_lock;         // Guards the following
+    uint                        m_nGeneration;
+    QCache<QString, Container>  m_containers;   // Cost is size in KiB
+};
+
+#endif
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
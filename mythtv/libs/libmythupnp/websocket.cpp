@@ -17,6 +17,11 @@
 #include <QtCore>
 #include <QtGlobal>
 
+// Bytes the socket may hold unsent before messages are queued instead
+static const qint64 kMaxSocketBacklog = 64 * 1024;
+// Bytes of queued messages at which a client is deemed to have stalled
+static const qint64 kMaxSendQueue = 1024 * 1024;
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -118,7 +123,8 @@ WebSocketWorker::WebSocketWorker(WebSocketServer& webSocketServer,
 #ifndef QT_NO_OPENSSL
                   m_sslConfig(sslConfig),
 #endif
-                  m_fuzzTesting(false)
+                  m_fuzzTesting(false),
+                  m_sendQueueBytes(0), m_sendBlocked(false)
 {
     setObjectName(QString("WebSocketWorker(%1)")
                         .arg(m_socketFD));
@@ -220,6 +226,7 @@ void WebSocketWorker::SetupSocket()
 
     connect(m_socket, SIGNAL(readyRead()), SLOT(doRead()));
     connect(m_socket, SIGNAL(disconnected()), SLOT(CloseConnection()));
+    connect(m_socket, SIGNAL(bytesWritten(qint64)), SLOT(doWrite(qint64)));
 
     // Setup heartbeat
     m_heartBeat->setInterval(20000); // 20 second
@@ -846,6 +853,33 @@ bool WebSocketWorker::SendFrame(const QByteArray &frame)
         return false;
     }
 
+    // Control frames may be sent between messages, so a ping, pong or close
+    // never waits behind the queue
+    bool isControl = frame.at(0) & 0x08;
+
+    if (!isControl &&
+        (!m_sendQueue.isEmpty() || m_socket->bytesToWrite() >= kMaxSocketBacklog))
+    {
+        m_sendQueue.append(frame);
+        m_sendQueueBytes += frame.length();
+
+        if (m_sendQueueBytes > kMaxSendQueue)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, QString("WebSocketWorker(%1): "
+                                         "Client has stopped reading, %2 "
+                                         "bytes queued. Closing connection.")
+                                            .arg(m_socketFD)
+                                            .arg(m_sendQueueBytes));
+            m_sendQueue.clear();
+            m_sendQueueBytes = 0;
+            SendClose(kClosePolicy, "Client is not reading messages");
+            return false;
+        }
+
+        SetBackPressure(true);
+        return true;
+    }
+
     LOG(VB_HTTP, LOG_DEBUG, QString("WebSocketWorker::SendFrame() - '%1'...").arg(QString(frame.left(64).toHex())));
 
     m_socket->write(frame.constData(), frame.length());
@@ -853,6 +887,37 @@ bool WebSocketWorker::SendFrame(const QByteArray &frame)
     return true;
 }
 
+void WebSocketWorker::doWrite(qint64 /*bytes*/)
+{
+    while (!m_sendQueue.isEmpty() &&
+           m_socket->bytesToWrite() < kMaxSocketBacklog)
+    {
+        QByteArray frame = m_sendQueue.takeFirst();
+        m_sendQueueBytes -= frame.length();
+        m_socket->write(frame.constData(), frame.length());
+    }
+
+    if (m_sendQueue.isEmpty())
+        SetBackPressure(false);
+}
+
+void WebSocketWorker::SetBackPressure(bool blocked)
+{
+    if (blocked == m_sendBlocked)
+        return;
+
+    m_sendBlocked = blocked;
+
+    LOG(VB_HTTP, LOG_DEBUG, QString("WebSocketWorker(%1): Client %2")
+                                .arg(m_socketFD)
+                                .arg(blocked ? "is falling behind" :
+                                               "has caught up"));
+
+    QList<WebSocketExtension*>::iterator it = m_extensions.begin();
+    for (; it != m_extensions.end(); ++it)
+        (*it)->HandleBackPressure(blocked);
+}
+
 bool WebSocketWorker::SendText(const QString &message)
 {
     return SendText(message.trimmed().toUtf8());
@@ -145,6 +145,14 @@ class WebSocketExtension : public QObject
     virtual bool HandleTextFrame(const WebSocketFrame &/*frame*/) { return false; }
     virtual bool HandleBinaryFrame(const WebSocketFrame &/*frame*/) { return false; }
 
+    /**
+     * Called when the client stops reading fast enough for the messages sent
+     * to it (blocked is true), and again once it has caught up. Messages sent
+     * in between are held by the worker, so an extension producing messages
+     * of its own accord should hold them back, or merge them, until then.
+     */
+    virtual void HandleBackPressure(bool /*blocked*/) { }
+
   signals:
     void SendTextMessage(const QString &);
     void SendBinaryMessage(const QByteArray &);
@@ -194,6 +202,12 @@ class WebSocketWorkerThread : public QRunnable
  * registered extensions wish to handle them. It is also responsible for
  * creating properly formatted, valid frames and transmitting them to the
  * client.
+ *
+ * Outgoing messages are held in a queue of their own while the socket's
+ * write buffer is full, and the extensions are told so they can throttle
+ * themselves. A client that stops reading altogether is disconnected once
+ * the queue reaches its limit, rather than the backend buffering for it
+ * indefinitely.
  */
 class WebSocketWorker : public QObject
 {
@@ -245,6 +259,7 @@ class WebSocketWorker : public QObject
     void CloseConnection();
 
     void SendHeartBeat();
+    void doWrite(qint64 bytes);
     bool SendText(const QString &message);
     bool SendText(const QByteArray &message);
     bool SendBinary(const QByteArray &data);
@@ -271,6 +286,8 @@ class WebSocketWorker : public QObject
     void RegisterExtension(WebSocketExtension *extension);
     void DeregisterExtension(WebSocketExtension *extension);
 
+    void SetBackPressure(bool blocked);
+
     QEventLoop *m_eventLoop;
     WebSocketServer &m_webSocketServer;
     qt_socket_fd_t m_socketFD;
@@ -292,6 +309,10 @@ class WebSocketWorker : public QObject
     bool m_fuzzTesting;
 
     QList<WebSocketExtension *> m_extensions;
+
+    QList<QByteArray> m_sendQueue; // Frames waiting for the socket to drain
+    qint64 m_sendQueueBytes;
+    bool m_sendBlocked;
 };
 
 #endif
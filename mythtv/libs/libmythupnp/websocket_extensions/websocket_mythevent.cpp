@@ -4,10 +4,93 @@
 #include "mythevent.h"
 #include "mythlogging.h"
 
+// How long refresh events are held to merge repeats
+#define COALESCE_MS 250
+// Events held for a client which isn't keeping up before the oldest go
+#define MAX_PENDING_EVENTS 256
+
+typedef enum
+{
+    kMergeNone   = 0, /// Every event is sent
+    kMergeSame   = 1, /// Repeats of the same message are sent once
+    kMergeLatest = 2  /// Only the latest value (the last token) is sent
+} MergeType;
+
+typedef struct
+{
+    const char *name;
+    const char *eventClass;
+    MergeType   merge;
+} EventInfo;
+
+static const EventInfo kEvents[] =
+{
+    { "SCHEDULE_CHANGE",         "SCHEDULE",   kMergeSame   },
+    { "SCHEDULER_RAN",           "SCHEDULE",   kMergeSame   },
+
+    { "RECORDING_LIST_CHANGE",   "RECORDINGS", kMergeSame   },
+    { "MASTER_UPDATE_REC_INFO",  "RECORDINGS", kMergeSame   },
+    { "MASTER_UPDATE_PROG_INFO", "RECORDINGS", kMergeSame   },
+    { "UPDATE_FILE_SIZE",        "RECORDINGS", kMergeLatest },
+    { "COMMFLAG_UPDATE",         "RECORDINGS", kMergeNone   },
+    { "GENERATED_PIXMAP",        "RECORDINGS", kMergeNone   },
+    { "VIDEO_LIST_CHANGE",       "RECORDINGS", kMergeSame   },
+
+    { "SIGNAL",                  "RECORDERS",  kMergeSame   },
+    { "ASK_RECORDING",           "RECORDERS",  kMergeNone   },
+    { "DONE_RECORDING",          "RECORDERS",  kMergeNone   },
+    { "REC_STARTED_WRITING",     "RECORDERS",  kMergeNone   },
+    { "REC_FAILING",             "RECORDERS",  kMergeNone   },
+    { "TUNING_SIGNAL_TIMEOUT",   "RECORDERS",  kMergeNone   },
+    { "LIVETV_CHAIN",            "RECORDERS",  kMergeSame   },
+    { "LIVETV_WATCH",            "RECORDERS",  kMergeNone   },
+    { "LIVETV_EXITED",           "RECORDERS",  kMergeNone   },
+};
+
+static const char *kSystemClass = "SYSTEM";
+
+static QHash<QString, const EventInfo *> IndexEvents(void)
+{
+    QHash<QString, const EventInfo *> events;
+
+    for (uint i = 0; i < sizeof(kEvents) / sizeof(kEvents[0]); ++i)
+        events[kEvents[i].name] = &kEvents[i];
+
+    return events;
+}
+
+static const EventInfo *FindEvent(const QString &name)
+{
+    // Every client's thread looks events up, the index is built once
+    static const QHash<QString, const EventInfo *> s_events = IndexEvents();
+
+    return s_events.value(name, NULL);
+}
+
+static bool IsEventClass(const QString &eventClass)
+{
+    if (eventClass == kSystemClass)
+        return true;
+
+    for (uint i = 0; i < sizeof(kEvents) / sizeof(kEvents[0]); ++i)
+    {
+        if (eventClass == kEvents[i].eventClass)
+            return true;
+    }
+
+    return false;
+}
+
 WebSocketMythEvent::WebSocketMythEvent()
-                   : WebSocketExtension(), m_sendEvents(false)
+                   : WebSocketExtension(), m_sendEvents(false),
+                     m_dropped(0), m_blocked(false)
 {
     setObjectName("WebSocketMythEvent");
+
+    m_coalesceTimer.setSingleShot(true);
+    m_coalesceTimer.setInterval(COALESCE_MS);
+    connect(&m_coalesceTimer, SIGNAL(timeout()), SLOT(SendPending()));
+
     gCoreContext->addListener(this);
 }
 
@@ -33,6 +116,9 @@ bool WebSocketMythEvent::HandleTextFrame(const WebSocketFrame &frame)
     else if (tokens[0] == "WS_EVENT_DISABLE")
     {
         m_sendEvents = false;
+        m_pending.clear();
+        m_pendingKeys.clear();
+        m_dropped = 0;
         LOG(VB_HTTP, LOG_NOTICE, "WebSocketMythEvent: Disabled");
     }
     else if (tokens[0] == "WS_EVENT_SET_FILTER")
@@ -47,10 +133,45 @@ bool WebSocketMythEvent::HandleTextFrame(const WebSocketFrame &frame)
         QString filterString = m_filters.join(", ");
         LOG(VB_HTTP, LOG_NOTICE, QString("WebSocketMythEvent: Updated filters (%1)").arg(filterString));
     }
+    else if (tokens[0] == "WS_EVENT_SUBSCRIBE" ||
+             tokens[0] == "WS_EVENT_UNSUBSCRIBE")
+    {
+        bool subscribe = (tokens[0] == "WS_EVENT_SUBSCRIBE");
+
+        for (int i = 1; i < tokens.length(); ++i)
+        {
+            QString eventClass = tokens[i].toUpper();
+
+            if (!IsEventClass(eventClass))
+            {
+                LOG(VB_HTTP, LOG_WARNING, QString("WebSocketMythEvent: Unknown event class '%1'").arg(eventClass));
+                continue;
+            }
+
+            if (subscribe)
+                m_classes.insert(eventClass);
+            else
+                m_classes.remove(eventClass);
+        }
+
+        QStringList classes = m_classes.toList();
+        LOG(VB_HTTP, LOG_NOTICE, QString("WebSocketMythEvent: Updated event classes (%1)").arg(classes.join(", ")));
+        return true;
+    }
 
     return false;
 }
 
+void WebSocketMythEvent::HandleBackPressure(bool blocked)
+{
+    m_blocked = blocked;
+
+    // Whatever piled up while the client was behind has been merged as far
+    // as it can be, don't hold it any longer
+    if (!m_blocked && !m_pending.isEmpty())
+        SendPending();
+}
+
 void WebSocketMythEvent::customEvent(QEvent* event)
 {
     if ((MythEvent::Type)(event->type()) == MythEvent::MythEventMessage)
@@ -60,19 +181,106 @@ void WebSocketMythEvent::customEvent(QEvent* event)
 
         MythEvent *me = (MythEvent *)event;
         QString message = me->Message();
+        QString eventClass;
 
         if (message.startsWith("SYSTEM_EVENT"))
+        {
             message.remove(0, 13); // Strip SYSTEM_EVENT from the frontend, it's not useful
+            eventClass = kSystemClass;
+        }
 
-        QStringList tokens = message.split(" ", QString::SkipEmptyParts);
+        // Only the name is needed to filter the event, so don't split the
+        // whole message for every client
+        QString name = message.section(' ', 0, 0, QString::SectionSkipEmpty);
 
-        if (tokens.isEmpty())
+        if (name.isEmpty())
             return;
 
+        const EventInfo *info = eventClass.isEmpty() ? FindEvent(name) : NULL;
+        if (info)
+            eventClass = info->eventClass;
+
         // If no-one is listening for this event, then ignore it
-        if (!m_filters.contains("ALL") && !m_filters.contains(tokens[0]))
+        if (!m_filters.contains("ALL") && !m_filters.contains(name) &&
+            (eventClass.isEmpty() || !m_classes.contains(eventClass)))
             return;
 
-        SendTextMessage(message);
+        QString key;
+        if (info && info->merge == kMergeSame)
+            key = message;
+        else if (info && info->merge == kMergeLatest)
+            key = message.section(' ', 0, -2, QString::SectionSkipEmpty);
+
+        Queue(message, key);
+    }
+}
+
+/**
+ * Events which can be merged wait for COALESCE_MS so that repeats of them can
+ * be, any other event is sent at once along with those waiting before it.
+ * A merged event takes the place of the latest repeat, so it still follows
+ * every event that was posted before that.
+ */
+void WebSocketMythEvent::Queue(const QString &message, const QString &key)
+{
+    if (!key.isEmpty() && m_pendingKeys.contains(key))
+    {
+        m_pending.removeAt(m_pendingKeys[key]);
+        IndexPending();
+    }
+
+    if (m_pending.size() >= MAX_PENDING_EVENTS)
+    {
+        // Drop a quarter at a time, so a client that stays behind doesn't
+        // cost a re-index for every event
+        int drop = MAX_PENDING_EVENTS / 4;
+        m_pending.erase(m_pending.begin(), m_pending.begin() + drop);
+        m_dropped += drop;
+        IndexPending();
+
+        LOG(VB_HTTP, LOG_WARNING, QString("WebSocketMythEvent: Client is not keeping up, dropped %1 events").arg(drop));
+    }
+
+    if (!key.isEmpty())
+        m_pendingKeys[key] = m_pending.size();
+    m_pending.append(qMakePair(key, message));
+
+    if (m_blocked)
+        return;
+
+    if (key.isEmpty())
+        SendPending();
+    else if (!m_coalesceTimer.isActive())
+        m_coalesceTimer.start();
+}
+
+void WebSocketMythEvent::IndexPending(void)
+{
+    m_pendingKeys.clear();
+
+    for (int i = 0; i < m_pending.size(); ++i)
+    {
+        if (!m_pending[i].first.isEmpty())
+            m_pendingKeys[m_pending[i].first] = i;
     }
 }
+
+void WebSocketMythEvent::SendPending(void)
+{
+    m_coalesceTimer.stop();
+
+    if (m_blocked)
+        return;
+
+    if (m_dropped)
+    {
+        SendTextMessage(QString("WS_EVENT_DROPPED %1").arg(m_dropped));
+        m_dropped = 0;
+    }
+
+    // Sending can block the client, which leaves the rest waiting here
+    while (!m_pending.isEmpty() && !m_blocked)
+        SendTextMessage(m_pending.takeFirst().second);
+
+    IndexPending();
+}
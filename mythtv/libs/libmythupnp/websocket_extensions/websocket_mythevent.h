@@ -4,11 +4,30 @@
 #include "websocket.h"
 
 #include <QStringList>
+#include <QTimer>
+#include <QHash>
+#include <QPair>
+#include <QSet>
 
 /** \class WebSocketMythEvent
  *
  *  \brief Extension for sending MythEvents over WebSocketServer
  *
+ * Clients choose the events they receive with WS_EVENT_SET_FILTER, by name,
+ * and with WS_EVENT_SUBSCRIBE / WS_EVENT_UNSUBSCRIBE, by class:
+ *
+ *   SCHEDULE     Schedule changes and scheduler runs
+ *   RECORDINGS   Changes to the recording list and to recordings
+ *   RECORDERS    Recorder and Live TV state, signal monitoring
+ *   SYSTEM       System events (SYSTEM_EVENT)
+ *
+ * Events which only tell the client to refresh something, such as
+ * SCHEDULE_CHANGE, arrive in bursts. They are held for a short time and
+ * repeats of the same event merged, as are file size updates of the same
+ * recording. While the client is not keeping up the events wait here,
+ * merged the same way; if too many build up the oldest are discarded and
+ * the client is sent "WS_EVENT_DROPPED <count>" so it knows to refresh.
+ *
  * \ingroup WebSocket_Extensions
  */
 class WebSocketMythEvent : public WebSocketExtension
@@ -20,11 +39,25 @@ class WebSocketMythEvent : public WebSocketExtension
     virtual ~WebSocketMythEvent();
 
     virtual bool HandleTextFrame(const WebSocketFrame &frame);
+    virtual void HandleBackPressure(bool blocked);
     virtual void customEvent(QEvent*);
 
+  private slots:
+    void SendPending(void);
+
   private:
+    void Queue(const QString &message, const QString &key);
+    void IndexPending(void);
+
     QStringList m_filters;
+    QSet<QString> m_classes; /// Event classes the client subscribed to
     bool m_sendEvents; /// True if the client has enabled events
+
+    QList<QPair<QString, QString> > m_pending; /// Unsent (merge key, event)
+    QHash<QString, int> m_pendingKeys; /// Index of mergeable pending events
+    uint m_dropped; /// Events discarded since the last send
+    bool m_blocked; /// True while the client is falling behind
+    QTimer m_coalesceTimer;
 };
 
 #endif
@@ -57,6 +57,12 @@ libmythmetadata-test.target = buildtestmythmetadata
 libmythmetadata-test.commands = cd libmythmetadata/test && $(QMAKE) && $(MAKE)
 unix:QMAKE_EXTRA_TARGETS += libmythmetadata-test
 
+# benchmarks libmythupnp
+libmythupnp-test.depends = sub-libmythupnp
+libmythupnp-test.target = buildtestmythupnp
+libmythupnp-test.commands = cd libmythupnp/test && $(QMAKE) && $(MAKE)
+unix:QMAKE_EXTRA_TARGETS += libmythupnp-test
+
 unittest.depends = libmyth-test libmythbase-test libmythtv-test libmythmetadata-test
 unittest.target = test
 unittest.commands = ../programs/scripts/unittests.sh
@@ -0,0 +1,333 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpremux.cpp
+//
+// Purpose - Byte-range HTTP Live Streaming playlists of recordings
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+
+// MythTV headers
+#include "httpremux.h"
+
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythdate.h"
+#include "encoderlink.h"
+#include "recordinginfo.h"
+#include "backendutil.h"
+#include "upnp.h"
+#include "HLS/httpliveremux.h"
+
+// How often a blocking playlist reload looks for the part it was asked for
+#define BLOCKING_RELOAD_POLL_MS 200
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpRemux::HttpRemux( QMap<int, EncoderLink *> *tvList )
+         : HttpServerExtension( "HttpRemux" , QString()),
+           m_nBlockingReloads( 0 )
+{
+    m_pEncoders = tvList;
+
+    // A quarter of the HTTP server's threads (see HttpServer::HttpServer())
+    m_nMaxBlockingReloads = std::max( QThread::idealThreadCount() / 2, 1 );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpRemux::~HttpRemux()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+QStringList HttpRemux::GetBasePaths()
+{
+    return QStringList( "/HLS" );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpRemux::ProcessRequest( HTTPRequest *pRequest )
+{
+    try
+    {
+        if (pRequest)
+        {
+            if (pRequest->m_sBaseUrl != "/HLS")
+                return false;
+
+            LOG(VB_UPNP, LOG_INFO,
+                QString("HttpRemux::ProcessRequest: %1 : %2")
+                    .arg(pRequest->m_sMethod)
+                    .arg(pRequest->m_sRawRequest));
+
+            if (pRequest->m_sMethod == "Recording.m3u8")
+            {
+                GetRecordingPlaylist( pRequest );
+                return true;
+            }
+        }
+    }
+    catch( ... )
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "HttpRemux::ProcessRequest() - Unexpected Exception");
+    }
+
+    return false;
+}
+
+// ==========================================================================
+// Request handler Methods
+// ==========================================================================
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpRemux::GetRecordingPlaylist( HTTPRequest *pRequest )
+{
+    pRequest->m_eResponseType   = ResponseTypeHTML;
+    pRequest->m_nResponseStatus = 404;
+
+    // Parameters are case insensitive, as they are for the Services API
+
+    QStringMap params;
+    QStringMap::const_iterator it = pRequest->m_mapParams.begin();
+    for (; it != pRequest->m_mapParams.end(); ++it)
+        params[ it.key().toLower() ] = *it;
+
+    uint      nRecordedId  = params[ "recordedid"  ].toUInt();
+    uint      nChanId      = params[ "chanid"      ].toUInt();
+    QDateTime dtStartTime  = MythDate::fromString( params[ "starttime" ] );
+    uint      nSegmentSize = params[ "segmentsize" ].toUInt();
+    bool      bLowLatency  = params[ "lowlatency"  ].toInt() ||
+                             params[ "lowlatency"  ].toLower() == "true";
+
+    bool bBlock = params.contains( "_hls_msn" );
+    int  nMSN   = params[ "_hls_msn" ].toInt();
+    int  nPart  = params.contains( "_hls_part" ) ?
+                  params[ "_hls_part" ].toInt() : -1;
+
+    if (nRecordedId == 0 && (nChanId == 0 || !dtStartTime.isValid()))
+    {
+        pRequest->m_nResponseStatus = 400;
+        return;
+    }
+
+    // ----------------------------------------------------------------------
+    // Read Recording From Database
+    // ----------------------------------------------------------------------
+
+    RecordingInfo *pginfo = (nRecordedId > 0) ?
+                            new RecordingInfo( nRecordedId ) :
+                            new RecordingInfo( nChanId, dtStartTime.toUTC() );
+
+    if (!pginfo->GetChanID())
+    {
+        LOG(VB_UPNP, LOG_ERR, QString("HttpRemux: Recording %1 not found")
+            .arg(nRecordedId));
+        delete pginfo;
+        return;
+    }
+
+    if (pginfo->GetHostname().toLower() != gCoreContext->GetHostName().toLower())
+    {
+        // The keyframes of a recording in progress are only known to the
+        // backend recording it
+
+        UPnp::FormatRedirectResponse( pRequest, pginfo->GetHostname() );
+        delete pginfo;
+        return;
+    }
+
+    // Only a transport stream can be cut into segments without remuxing,
+    // and only H.264 video in one is playable by HLS players. Recordings
+    // without a recordedfile row, or made before the codecs were stored,
+    // have neither and are given the benefit of the doubt.
+
+    RecordingFile *pFile = pginfo->GetRecordingFile();
+    QString sFileName( GetPlaybackURL( pginfo ));
+
+    if (pFile->m_containerFormat != formatMPEG2_TS &&
+        pFile->m_containerFormat != formatUnknown)
+    {
+        LOG(VB_UPNP, LOG_ERR, QString("HttpRemux: %1 is not a transport "
+                                      "stream").arg(sFileName));
+        pRequest->m_nResponseStatus = 415;
+        delete pginfo;
+        return;
+    }
+
+    if (!pFile->m_videoCodec.isEmpty() && pFile->m_videoCodec != "H264")
+    {
+        LOG(VB_UPNP, LOG_ERR, QString("HttpRemux: %1 has '%2' video, "
+                                      "not H.264").arg(sFileName)
+                                      .arg(pFile->m_videoCodec));
+        pRequest->m_nResponseStatus = 415;
+        delete pginfo;
+        return;
+    }
+
+    if (!QFile::exists( sFileName ))
+    {
+        delete pginfo;
+        return;
+    }
+
+    double frameRate = pFile->m_videoFrameRate;
+    if (frameRate <= 0.0)
+        frameRate = pginfo->QueryAverageFrameRate() / 1000.0;
+
+    // ----------------------------------------------------------------------
+    // Build the playlist from the keyframe map
+    // ----------------------------------------------------------------------
+
+    QString sMediaURL = QString( "/Content/GetRecording?RecordedId=%1" )
+                            .arg( pginfo->GetRecordingID() );
+
+    HTTPLiveRemux remux( sMediaURL, nSegmentSize );
+    EncoderLink  *pEncoder = GetEncoder( *pginfo );
+    frm_pos_map_t positions;
+    frm_pos_map_t durations;
+
+    bool bFinished = Update( remux, pEncoder, *pginfo, sFileName,
+                             positions, durations, frameRate );
+
+    // Blocking reload: hold the request until the part the player asked
+    // for is written, for at most three target durations. When too many
+    // are already waiting the current playlist is returned straight away,
+    // the player just asks again.
+
+    if (bBlock && !bFinished &&
+        m_nBlockingReloads.fetchAndAddOrdered( 1 ) >= m_nMaxBlockingReloads)
+    {
+        m_nBlockingReloads.fetchAndAddOrdered( -1 );
+        bBlock = false;
+    }
+
+    if (bBlock && !bFinished)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        qint64 nTimeout = remux.GetTargetDuration() * 3000;
+
+        while (!remux.HasPart( nMSN, nPart ) && timer.elapsed() < nTimeout)
+        {
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds( BLOCKING_RELOAD_POLL_MS ));
+
+            bFinished = Update( remux, pEncoder, *pginfo, sFileName,
+                                positions, durations, frameRate );
+            if (bFinished)
+                break;
+        }
+
+        m_nBlockingReloads.fetchAndAddOrdered( -1 );
+    }
+
+    delete pginfo;
+
+    if (remux.IsEmpty() && bFinished)
+        return;
+
+    QTextStream stream( &pRequest->m_response );
+    stream << remux.GetPlaylist( bLowLatency );
+    stream.flush();
+
+    pRequest->m_eResponseType     = ResponseTypeOther;
+    pRequest->m_sResponseTypeText = "application/vnd.apple.mpegurl";
+    pRequest->m_nResponseStatus   = 200;
+    pRequest->m_mapRespHeaders[ "Cache-Control" ] = "no-cache";
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Returns the local recorder writing the recording, if it is in progress
+/////////////////////////////////////////////////////////////////////////////
+
+EncoderLink *HttpRemux::GetEncoder( const ProgramInfo &pginfo )
+{
+    if (!m_pEncoders)
+        return NULL;
+
+    QMap<int, EncoderLink *>::const_iterator it = m_pEncoders->begin();
+    for (; it != m_pEncoders->end(); ++it)
+    {
+        EncoderLink *pEncoder = *it;
+
+        if (pEncoder->IsLocal() && pEncoder->MatchesRecording( &pginfo ))
+            return pEncoder;
+    }
+
+    return NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Brings the keyframe map up to date and passes it to the remuxer. The
+// recorder's own map is used while recording, the database one only lags
+// it by the save interval. Returns whether the recording has finished.
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpRemux::Update( HTTPLiveRemux &remux, EncoderLink *pEncoder,
+                        const ProgramInfo &pginfo, const QString &sFileName,
+                        frm_pos_map_t &positions, frm_pos_map_t &durations,
+                        double frameRate )
+{
+    bool bFinished = !pEncoder || !pEncoder->MatchesRecording( &pginfo );
+
+    if (!bFinished)
+    {
+        // Only fetch the keyframes added since the last update
+
+        int64_t nStart = positions.isEmpty() ? 0 : positions.lastKey();
+
+        frm_pos_map_t newPositions;
+        frm_pos_map_t newDurations;
+
+        if (pEncoder->GetKeyframePositions( nStart, -1, newPositions ) &&
+            pEncoder->GetKeyframeDurations( nStart, -1, newDurations ))
+        {
+            frm_pos_map_t::const_iterator it = newPositions.begin();
+            for (; it != newPositions.end(); ++it)
+                positions.insert( it.key(), *it );
+
+            for (it = newDurations.begin(); it != newDurations.end(); ++it)
+                durations.insert( it.key(), *it );
+        }
+        else
+            bFinished = true;
+    }
+
+    if (bFinished)
+    {
+        positions.clear();
+        durations.clear();
+        pginfo.QueryPositionMap( positions, MARK_GOP_BYFRAME );
+        pginfo.QueryPositionMap( durations, MARK_DURATION_MS );
+    }
+
+    remux.SetKeyframes( positions, durations, frameRate );
+    remux.SetEnd( QFileInfo( sFileName ).size(), bFinished );
+
+    return bFinished;
+}
@@ -0,0 +1,70 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpremux.h
+//
+// Purpose - Byte-range HTTP Live Streaming playlists of recordings
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPREMUX_H_
+#define HTTPREMUX_H_
+
+#include <QAtomicInt>
+#include <QMap>
+
+#include "httpserver.h"
+#include "programtypes.h"
+
+class EncoderLink;
+class ProgramInfo;
+class HTTPLiveRemux;
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Serves /HLS/Recording.m3u8, an HLS media playlist of an H.264 transport
+// stream recording whose segments are byte ranges of the recording itself, cut on
+// its keyframes. Players fetch the segments from Content/GetRecording, so
+// nothing is transcoded or copied, and a recording in progress can be
+// watched seconds behind live.
+//
+// Parameters:
+//   RecordedId, or ChanId and StartTime  the recording
+//   SegmentSize                          seconds per segment (default 6)
+//   LowLatency                           list GOPs as partial segments
+//   _HLS_msn, _HLS_part                  blocking playlist reload
+//
+/////////////////////////////////////////////////////////////////////////////
+
+class HttpRemux : public HttpServerExtension
+{
+    private:
+
+        QMap<int, EncoderLink *>    *m_pEncoders;
+
+        // Blocking reloads hold an HTTP server thread each, so only a few
+        // may wait at a time, the others are answered right away
+        QAtomicInt                   m_nBlockingReloads;
+        int                          m_nMaxBlockingReloads;
+
+    private:
+
+        void         GetRecordingPlaylist( HTTPRequest *pRequest );
+
+        EncoderLink *GetEncoder          ( const ProgramInfo &pginfo );
+        bool         Update              ( HTTPLiveRemux &remux,
+                                           EncoderLink *pEncoder,
+                                           const ProgramInfo &pginfo,
+                                           const QString &sFileName,
+                                           frm_pos_map_t &positions,
+                                           frm_pos_map_t &durations,
+                                           double frameRate );
+
+    public:
+                 explicit HttpRemux( QMap<int, EncoderLink *> *tvList );
+        virtual ~HttpRemux();
+
+        virtual QStringList GetBasePaths();
+
+        bool     ProcessRequest( HTTPRequest *pRequest );
+};
+
+#endif
@@ -57,6 +57,7 @@
 
 #include "mediaserver.h"
 #include "httpstatus.h"
+#include "httpremux.h"
 #include "mythlogging.h"
 
 #define LOC      QString("MythBackend: ")
@@ -688,6 +689,10 @@ int run_backend(MythBackendCommandLineParser &cmdline)
 
         httpStatus = new HttpStatus( &tvList, sched, expirer, ismaster );
         pHS->RegisterExtension( httpStatus );
+
+        LOG(VB_GENERAL, LOG_INFO, "Main::Registering HttpRemux Extension");
+
+        pHS->RegisterExtension( new HttpRemux( &tvList ));
     }
 
     mainServer = new MainServer(
@@ -27,6 +27,7 @@
 #include <QRegExp>
 
 #include "dvr.h"
+#include "serializers/serializer.h"
 
 #include "compat.h"
 #include "mythversion.h"
@@ -88,10 +89,11 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
         delete *mit;
 
     // ----------------------------------------------------------------------
-    // Build Response
+    // Select the programs to return.  The counts have to be known before
+    // any program is serialized.
     // ----------------------------------------------------------------------
 
-    DTC::ProgramList *pPrograms = new DTC::ProgramList();
+    QList< ProgramInfo* > selected;
     int nAvailable = 0;
 
     int nMax      = (nCount > 0) ? nCount : progList.size();
@@ -121,13 +123,15 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
         ++nAvailable;
         ++nCount;
 
-        DTC::Program *pProgram = pPrograms->AddNewProgram();
-
-        FillProgramInfo( pProgram, pInfo, true );
+        selected.append( pInfo );
     }
 
+    // ----------------------------------------------------------------------
+    // Build Response
     // ----------------------------------------------------------------------
 
+    DTC::ProgramList *pPrograms = new DTC::ProgramList();
+
     pPrograms->setStartIndex    ( nStartIndex     );
     pPrograms->setCount         ( nCount          );
     pPrograms->setTotalAvailable( nAvailable      );
@@ -135,6 +139,38 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
     pPrograms->setVersion       ( MYTH_BINARY_VERSION );
     pPrograms->setProtoVer      ( MYTH_PROTO_VERSION  );
 
+    // ----------------------------------------------------------------------
+    // Stream the programs one at a time if we can, rather than holding
+    // them all in the response.
+    // ----------------------------------------------------------------------
+
+    if (m_pStreamSerializer != NULL)
+    {
+        m_pStreamSerializer->BeginStream( pPrograms, "Programs" );
+
+        for (int n = 0; n < selected.size(); n++)
+        {
+            DTC::Program oProgram;
+
+            FillProgramInfo( &oProgram, selected[ n ], true );
+
+            m_pStreamSerializer->AddStreamItem( &oProgram );
+        }
+
+        m_pStreamSerializer->EndStream();
+
+        delete pPrograms;
+
+        return NULL;
+    }
+
+    for (int n = 0; n < selected.size(); n++)
+    {
+        DTC::Program *pProgram = pPrograms->AddNewProgram();
+
+        FillProgramInfo( pProgram, selected[ n ], true );
+    }
+
     return pPrograms;
 }
 
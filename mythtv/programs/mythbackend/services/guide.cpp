@@ -26,6 +26,7 @@
 #include <math.h>
 
 #include "guide.h"
+#include "serializers/serializer.h"
 
 #include "compat.h"
 #include "mythversion.h"
@@ -120,12 +121,35 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
 
     DTC::ProgramGuide *pGuide = new DTC::ProgramGuide();
 
+    pGuide->setStartTime    ( dtStartTime   );
+    pGuide->setEndTime      ( dtEndTime     );
+    pGuide->setDetails      ( bDetails      );
+
+    pGuide->setStartIndex    ( nStartIndex     );
+    pGuide->setCount         ( chanList.size() );
+    pGuide->setTotalAvailable( nTotalAvailable );
+    pGuide->setAsOf          ( MythDate::current() );
+
+    pGuide->setVersion      ( MYTH_BINARY_VERSION );
+    pGuide->setProtoVer     ( MYTH_PROTO_VERSION  );
+
+    // ----------------------------------------------------------------------
+    // When streaming, each channel is serialized and freed as soon as its
+    // programmes are loaded, instead of keeping the whole guide in memory.
+    // ----------------------------------------------------------------------
+
+    if (m_pStreamSerializer != NULL)
+        m_pStreamSerializer->BeginStream( pGuide, "Channels" );
+
     ChannelInfoList::iterator chan_it;
     for (chan_it = chanList.begin(); chan_it != chanList.end(); ++chan_it)
     {
         // Create ChannelInfo Object
         DTC::ChannelInfo *pChannel   = NULL;
-        pChannel = pGuide->AddNewChannel();
+        if (m_pStreamSerializer != NULL)
+            pChannel = new DTC::ChannelInfo();
+        else
+            pChannel = pGuide->AddNewChannel();
         FillChannelInfo( pChannel, (*chan_it), bDetails );
 
         // Load the list of programmes for this channel
@@ -141,21 +165,22 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
             DTC::Program *pProgram = pChannel->AddNewProgram();
             FillProgramInfo( pProgram, *progIt, false, bDetails, false ); // No cast info
         }
-    }
 
-    // ----------------------------------------------------------------------
+        if (m_pStreamSerializer != NULL)
+        {
+            m_pStreamSerializer->AddStreamItem( pChannel );
+            delete pChannel;
+        }
+    }
 
-    pGuide->setStartTime    ( dtStartTime   );
-    pGuide->setEndTime      ( dtEndTime     );
-    pGuide->setDetails      ( bDetails      );
+    if (m_pStreamSerializer != NULL)
+    {
+        m_pStreamSerializer->EndStream();
 
-    pGuide->setStartIndex    ( nStartIndex     );
-    pGuide->setCount         ( chanList.size() );
-    pGuide->setTotalAvailable( nTotalAvailable );
-    pGuide->setAsOf          ( MythDate::current() );
+        delete pGuide;
 
-    pGuide->setVersion      ( MYTH_BINARY_VERSION );
-    pGuide->setProtoVer     ( MYTH_PROTO_VERSION  );
+        return NULL;
+    }
 
     return pGuide;
 }
@@ -16,10 +16,45 @@
 
 #include "storagegroup.h"
 #include "upnpcdsmusic.h"
+#include "upnpcdsindex.h"
 #include "httprequest.h"
 #include "mythcorecontext.h"
+#include "mythevent.h"
 #include "upnphelpers.h"
 
+/**
+ * \brief Drops the music index when the library is scanned or edited.
+ *
+ * A changed track may move to another album, artist or genre, so any
+ * change invalidates every container; they are rebuilt as they're browsed.
+ */
+class UPnpCDSMusicIndex : public UPnpCDSIndex
+{
+  public:
+    UPnpCDSMusicIndex() : UPnpCDSIndex("Music")
+    {
+        gCoreContext->addListener(this);
+    }
+    virtual ~UPnpCDSMusicIndex()
+    {
+        gCoreContext->removeListener(this);
+    }
+
+  protected:
+    virtual void customEvent(QEvent *e)
+    {
+        if (e->type() != MythEvent::MythEventMessage)
+            return;
+
+        QString message = static_cast<MythEvent *>(e)->Message();
+
+        if (message.startsWith("MUSIC_SCANNER_FINISHED") ||
+            message.startsWith("MUSIC_RESYNC_FINISHED") ||
+            message.startsWith("MUSIC_METADATA_CHANGED"))
+            Invalidate();
+    }
+};
+
 /**
  * \brief Music Extension for UPnP ContentDirectory Service
  *
@@ -57,7 +92,8 @@
  */
 UPnpCDSMusic::UPnpCDSMusic()
              : UPnpCDSExtension( "Music", "Music",
-                                 "object.item.audioItem.musicTrack" )
+                                 "object.item.audioItem.musicTrack" ),
+               m_pIndex(new UPnpCDSMusicIndex())
 {
     QString sServerIp   = gCoreContext->GetBackendServerIP();
     int sPort           = gCoreContext->GetBackendStatusPort();
@@ -73,6 +109,11 @@ UPnpCDSMusic::UPnpCDSMusic()
     m_shortcuts.insert(UPnPShortcutFeature::MUSIC_GENRES, "Music/Genre");
 }
 
+UPnpCDSMusic::~UPnpCDSMusic()
+{
+    delete m_pIndex;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -465,14 +506,9 @@ bool UPnpCDSMusic::LoadAlbums(const UPnpCDSRequest *pRequest,
 {
     QString sRequestId = pRequest->m_sObjectId;
 
-    uint16_t nCount = pRequest->m_nRequestedCount;
-    uint16_t nOffset = pRequest->m_nStartingIndex;
+    MSqlQuery query(MSqlQuery::InitCon());
 
-    // We must use a dedicated connection to get an acccurate value from
-    // FOUND_ROWS()
-    MSqlQuery query(MSqlQuery::InitCon(MSqlQuery::kDedicatedConnection));
-
-    QString sql = "SELECT SQL_CALC_FOUND_ROWS "
+    QString sql = "SELECT "
                   "a.album_id, a.album_name, t.artist_name, a.year, "
                   "a.compilation, s.song_id, g.genre, "
                   "COUNT(a.album_id), w.albumart_id "
@@ -483,22 +519,48 @@ bool UPnpCDSMusic::LoadAlbums(const UPnpCDSRequest *pRequest,
                   "LEFT JOIN music_albumart w ON s.song_id=w.song_id "
                   "%1 " // WHERE clauses
                   "GROUP BY a.album_id "
-                  "ORDER BY a.album_name "
-                  "LIMIT :OFFSET,:COUNT";
+                  "%2"; // ORDER BY
 
     QStringList clauses;
+    QString orderByString = "ORDER BY a.album_name";
+    uint nTotal = 0;
+    QVector<int> ids;
+
+    // A single album is loaded directly, a list one page at a time
+    if (tokens["album"].toInt() <= 0)
+    {
+        if (!LoadIndexPage(m_pIndex, "Album",
+                           "SELECT a.album_id FROM music_albums a "
+                           "LEFT JOIN music_songs s ON a.album_id=s.album_id "
+                           "%1 " // WHERE clauses
+                           "GROUP BY a.album_id "
+                           "ORDER BY a.album_name",
+                           pRequest, tokens, ids, nTotal))
+            return false;
+
+        pResults->m_nTotalMatches = nTotal;
+
+        if (ids.isEmpty())
+            return true;
+
+        QString sIds = UPnpCDSIndex::ToSqlList(ids);
+        clauses.append(QString("a.album_id IN (%1)").arg(sIds));
+        // The rows come back in any order, AddIndexPage() puts them in
+        // the order of the page
+        orderByString.clear();
+    }
+
     QString whereString = BuildWhereClause(clauses, tokens);
 
-    query.prepare(sql.arg(whereString));
+    query.prepare(sql.arg(whereString).arg(orderByString));
 
     BindValues(query, tokens);
 
-    query.bindValue(":OFFSET", nOffset);
-    query.bindValue(":COUNT", nCount);
-
     if (!query.exec())
         return false;
 
+    QMap<int, CDSObject*> objects;
+
     while (query.next())
     {
         int nAlbumID = query.value(0).toInt();
@@ -530,19 +592,13 @@ bool UPnpCDSMusic::LoadAlbums(const UPnpCDSRequest *pRequest,
         if (nAlbumArtID > 0)
             PopulateArtworkURIS(pContainer, nSongId);
 
-        pResults->Add(pContainer);
-        pContainer->DecrRef();
+        objects.insert(nAlbumID, pContainer);
     }
 
-    // Just in case FOUND_ROWS() should fail, ensure m_nTotalMatches contains
-    // at least the size of this result set
-    if (query.size() > 0)
-        pResults->m_nTotalMatches = query.size();
+    AddIndexPage(pResults, ids, objects);
 
-    // Fetch the total number of matches ignoring any LIMITs
-    query.prepare("SELECT FOUND_ROWS()");
-    if (query.exec() && query.next())
-            pResults->m_nTotalMatches = query.value(0).toUInt();
+    if (nTotal == 0 && query.size() > 0)
+        pResults->m_nTotalMatches = query.size();
 
     return true;
 }
@@ -557,39 +613,62 @@ bool UPnpCDSMusic::LoadArtists(const UPnpCDSRequest *pRequest,
 {
     QString sRequestId = pRequest->m_sObjectId;
 
-    uint16_t nCount = pRequest->m_nRequestedCount;
-    uint16_t nOffset = pRequest->m_nStartingIndex;
+    MSqlQuery query(MSqlQuery::InitCon());
 
-    // We must use a dedicated connection to get an accurate value from
-    // FOUND_ROWS()
-    MSqlQuery query(MSqlQuery::InitCon(MSqlQuery::kDedicatedConnection));
+    // The id index and the rows must list the same artists, so both
+    // queries use the same joins: only artists with songs are listed
+    QString sFrom = "FROM music_artists t "
+                    "LEFT JOIN music_albums a ON a.artist_id = t.artist_id "
+                    "JOIN music_songs s ON t.artist_id = s.artist_id "
+                    "LEFT JOIN music_genres g ON s.genre_id = g.genre_id ";
 
-    QString sql = "SELECT SQL_CALC_FOUND_ROWS "
+    QString sql = "SELECT "
                   "t.artist_id, t.artist_name, CONCAT_WS(',', g.genre), "
                   "COUNT(DISTINCT a.album_id) "
-                  "FROM music_artists t "
-                  "LEFT JOIN music_albums a ON a.artist_id = t.artist_id "
-                  "JOIN music_songs s ON t.artist_id = s.artist_id "
-                  "LEFT JOIN music_genres g ON s.genre_id = g.genre_id "
+                  + sFrom +
                   "%1 " // WHERE clauses
                   "GROUP BY t.artist_id "
-                  "ORDER BY t.artist_name "
-                  "LIMIT :OFFSET,:COUNT";
-
+                  "%2"; // ORDER BY
 
     QStringList clauses;
+    QString orderByString = "ORDER BY t.artist_name";
+    uint nTotal = 0;
+    QVector<int> ids;
+
+    // A single artist is loaded directly, a list one page at a time
+    if (tokens["artist"].toInt() <= 0)
+    {
+        if (!LoadIndexPage(m_pIndex, "Artist",
+                           "SELECT t.artist_id " + sFrom +
+                           "%1 " // WHERE clauses
+                           "GROUP BY t.artist_id "
+                           "ORDER BY t.artist_name",
+                           pRequest, tokens, ids, nTotal))
+            return false;
+
+        pResults->m_nTotalMatches = nTotal;
+
+        if (ids.isEmpty())
+            return true;
+
+        QString sIds = UPnpCDSIndex::ToSqlList(ids);
+        clauses.append(QString("t.artist_id IN (%1)").arg(sIds));
+        // The rows come back in any order, AddIndexPage() puts them in
+        // the order of the page
+        orderByString.clear();
+    }
+
     QString whereString = BuildWhereClause(clauses, tokens);
 
-    query.prepare(sql.arg(whereString));
+    query.prepare(sql.arg(whereString).arg(orderByString));
 
     BindValues(query, tokens);
 
-    query.bindValue(":OFFSET", nOffset);
-    query.bindValue(":COUNT", nCount);
-
     if (!query.exec())
         return false;
 
+    QMap<int, CDSObject*> objects;
+
     while (query.next())
     {
         int nArtistId = query.value(0).toInt();
@@ -613,19 +692,13 @@ bool UPnpCDSMusic::LoadArtists(const UPnpCDSRequest *pRequest,
         // Artwork
         //PopulateArtistURIS(pContainer, nArtistId);
 
-        pResults->Add(pContainer);
-        pContainer->DecrRef();
+        objects.insert(nArtistId, pContainer);
     }
 
-    // Just in case FOUND_ROWS() should fail, ensure m_nTotalMatches contains
-    // at least the size of this result set
-    if (query.size() > 0)
-        pResults->m_nTotalMatches = query.size();
+    AddIndexPage(pResults, ids, objects);
 
-    // Fetch the total number of matches ignoring any LIMITs
-    query.prepare("SELECT FOUND_ROWS()");
-    if (query.exec() && query.next())
-            pResults->m_nTotalMatches = query.value(0).toUInt();
+    if (nTotal == 0 && query.size() > 0)
+        pResults->m_nTotalMatches = query.size();
 
     return true;
 }
@@ -712,14 +785,9 @@ bool UPnpCDSMusic::LoadTracks(const UPnpCDSRequest *pRequest,
 {
     QString sRequestId = pRequest->m_sObjectId;
 
-    uint16_t nCount = pRequest->m_nRequestedCount;
-    uint16_t nOffset = pRequest->m_nStartingIndex;
+    MSqlQuery query(MSqlQuery::InitCon());
 
-    // We must use a dedicated connection to get an acccurate value from
-    // FOUND_ROWS()
-    MSqlQuery query(MSqlQuery::InitCon(MSqlQuery::kDedicatedConnection));
-
-    QString sql = "SELECT SQL_CALC_FOUND_ROWS s.song_id, t.artist_name, "
+    QString sql = "SELECT s.song_id, t.artist_name, "
                   "a.album_name, s.name, "
                   "g.genre, s.year, s.track, "
                   "s.description, s.filename, s.length, s.size, "
@@ -731,22 +799,50 @@ bool UPnpCDSMusic::LoadTracks(const UPnpCDSRequest *pRequest,
                   "LEFT JOIN music_albumart w ON s.song_id = w.song_id "
                   "%1 " // WHERE clauses
                   "GROUP BY s.song_id "
-                  "ORDER BY t.artist_name, a.album_name, s.track "
-                  "LIMIT :OFFSET,:COUNT";
+                  "%2"; // ORDER BY
 
     QStringList clauses;
+    QString orderByString = "ORDER BY t.artist_name, a.album_name, s.track";
+    uint nTotal = 0;
+    QVector<int> ids;
+
+    // A single track is loaded directly, a list one page at a time
+    if (tokens["track"].toInt() <= 0)
+    {
+        if (!LoadIndexPage(m_pIndex, "Track",
+                           "SELECT s.song_id FROM music_songs s "
+                           "LEFT JOIN music_artists t "
+                           "       ON t.artist_id = s.artist_id "
+                           "LEFT JOIN music_albums a "
+                           "       ON a.album_id = s.album_id "
+                           "%1 " // WHERE clauses
+                           "ORDER BY t.artist_name, a.album_name, s.track",
+                           pRequest, tokens, ids, nTotal))
+            return false;
+
+        pResults->m_nTotalMatches = nTotal;
+
+        if (ids.isEmpty())
+            return true;
+
+        QString sIds = UPnpCDSIndex::ToSqlList(ids);
+        clauses.append(QString("s.song_id IN (%1)").arg(sIds));
+        // The rows come back in any order, AddIndexPage() puts them in
+        // the order of the page
+        orderByString.clear();
+    }
+
     QString whereString = BuildWhereClause(clauses, tokens);
 
-    query.prepare(sql.arg(whereString));
+    query.prepare(sql.arg(whereString).arg(orderByString));
 
     BindValues(query, tokens);
 
-    query.bindValue(":OFFSET", nOffset);
-    query.bindValue(":COUNT", nCount);
-
     if (!query.exec())
         return false;
 
+    QMap<int, CDSObject*> objects;
+
     while (query.next())
     {
         int            nId          = query.value( 0).toInt();
@@ -823,19 +919,13 @@ bool UPnpCDSMusic::LoadTracks(const UPnpCDSRequest *pRequest,
         if (nFileSize > 0)
             pResource->AddAttribute( "size"      , QString::number( nFileSize) );
 
-        pResults->Add(pItem);
-        pItem->DecrRef();
+        objects.insert(nId, pItem);
     }
 
-    // Just in case FOUND_ROWS() should fail, ensure m_nTotalMatches contains
-    // at least the size of this result set
-    if (query.size() > 0)
-        pResults->m_nTotalMatches = query.size();
+    AddIndexPage(pResults, ids, objects);
 
-    // Fetch the total number of matches ignoring any LIMITs
-    query.prepare("SELECT FOUND_ROWS()");
-    if (query.exec() && query.next())
-            pResults->m_nTotalMatches = query.value(0).toUInt();
+    if (nTotal == 0 && query.size() > 0)
+        pResults->m_nTotalMatches = query.size();
 
     return true;
 }
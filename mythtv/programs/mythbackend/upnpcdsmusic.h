@@ -12,6 +12,7 @@
 #define UPnpCDSMusic_H_
 
 #include <QString>
+#include <QVector>
 
 #include "upnpcds.h"
 
@@ -19,12 +20,13 @@
 //
 //////////////////////////////////////////////////////////////////////////////
 class MSqlQuery;
+class UPnpCDSIndex;
 class UPnpCDSMusic : public UPnpCDSExtension
 {
     public:
 
         UPnpCDSMusic();
-        virtual ~UPnpCDSMusic() { };
+        virtual ~UPnpCDSMusic();
 
     protected:
 
@@ -45,6 +47,7 @@ class UPnpCDSMusic : public UPnpCDSExtension
     private:
 
         QUrl             m_URIBase;
+        UPnpCDSIndex    *m_pIndex;
 
         void             PopulateArtworkURIS( CDSObject *pItem,
                                               int songID );
@@ -19,10 +19,12 @@
 
 // MythTV headers
 #include "upnpcdstv.h"
+#include "upnpcdsindex.h"
 #include "httprequest.h"
 #include "storagegroup.h"
 #include "mythdate.h"
 #include "mythcorecontext.h"
+#include "mythevent.h"
 #include "upnphelpers.h"
 #include "recordinginfo.h"
 
@@ -43,6 +45,45 @@
 */
 
 
+/**
+ * \brief Keeps the recording index in step with the recording list.
+ *
+ * A deleted recording is simply removed from the lists. Anything else may
+ * move a recording between groups, titles or dates, so the lists are
+ * rebuilt.
+ */
+class UPnpCDSTvIndex : public UPnpCDSIndex
+{
+  public:
+    UPnpCDSTvIndex() : UPnpCDSIndex("Recordings")
+    {
+        gCoreContext->addListener(this);
+    }
+    virtual ~UPnpCDSTvIndex()
+    {
+        gCoreContext->removeListener(this);
+    }
+
+  protected:
+    virtual void customEvent(QEvent *e)
+    {
+        if (e->type() != MythEvent::MythEventMessage)
+            return;
+
+        QString message = static_cast<MythEvent *>(e)->Message();
+
+        if (!message.startsWith("RECORDING_LIST_CHANGE"))
+            return;
+
+        QStringList tokens = message.simplified().split(" ");
+
+        if (tokens.size() == 3 && tokens[1] == "DELETE")
+            RemoveItem("Recording", tokens[2].toInt());
+        else
+            Invalidate("Recording");
+    }
+};
+
 // UPnpCDSRootInfo UPnpCDSTv::g_RootNodes[] =
 // {
 //     {   "All Recordings",
@@ -132,7 +173,8 @@
 
 UPnpCDSTv::UPnpCDSTv()
           : UPnpCDSExtension( "Recordings", "Recordings",
-                              "object.item.videoItem" )
+                              "object.item.videoItem" ),
+            m_pIndex(new UPnpCDSTvIndex())
 {
     QString sServerIp   = gCoreContext->GetBackendServerIP();
     int sPort           = gCoreContext->GetBackendStatusPort();
@@ -144,6 +186,11 @@ UPnpCDSTv::UPnpCDSTv()
     m_shortcuts.insert(UPnPShortcutFeature::VIDEOS_RECORDINGS, "Recordings");
 }
 
+UPnpCDSTv::~UPnpCDSTv()
+{
+    delete m_pIndex;
+}
+
 void UPnpCDSTv::CreateRoot()
 {
     if (m_pRoot)
@@ -938,22 +985,9 @@ bool UPnpCDSTv::LoadRecordings(const UPnpCDSRequest* pRequest,
 {
     QString sRequestId = pRequest->m_sObjectId;
 
-    uint16_t nCount = pRequest->m_nRequestedCount;
-    uint16_t nOffset = pRequest->m_nStartingIndex;
+    MSqlQuery query(MSqlQuery::InitCon());
 
-    // HACK this is a bit of a hack for loading Recordings in the Title view
-    //      where the count/start index from the request aren't applicable
-    if (tokens["recording"].toInt() > 0)
-    {
-        nCount = 1;
-        nOffset = 0;
-    }
-
-    // We must use a dedicated connection to get an accurate value from
-    // FOUND_ROWS()
-    MSqlQuery query(MSqlQuery::InitCon(MSqlQuery::kDedicatedConnection));
-
-    QString sql = "SELECT SQL_CALC_FOUND_ROWS "
+    QString sql = "SELECT "
                   "r.chanid, r.starttime, r.endtime, r.title, "
                   "r.subtitle, r.description, r.category, "
                   "r.hostname, r.recgroup, r.filesize, "
@@ -973,8 +1007,7 @@ bool UPnpCDSTv::LoadRecordings(const UPnpCDSRequest* pRequest,
                   "LEFT JOIN recgroups g ON r.recgroup=g.recgroup "
                   "LEFT JOIN recordedfile f ON r.recordedid=f.recordedid "
                   "%1 " // WHERE clauses
-                  "%2 " // ORDER BY
-                  "LIMIT :OFFSET,:COUNT";
+                  "%2"; // ORDER BY
 
 
     QString orderByString = "ORDER BY r.starttime DESC, r.title";
@@ -983,18 +1016,48 @@ bool UPnpCDSTv::LoadRecordings(const UPnpCDSRequest* pRequest,
         orderByString = "ORDER BY p.season, p.episode, r.starttime ASC"; // In season/episode order, falling back to recorded order
 
     QStringList clauses;
+    uint nTotal = 0;
+    QVector<int> ids;
+
+    // A single recording is loaded directly, e.g. in the Title view where
+    // the count/start index from the request aren't applicable. A list is
+    // loaded one page at a time.
+    if (tokens["recording"].toInt() <= 0)
+    {
+        QString idSql = "SELECT r.recordedid FROM recorded r "
+                        "LEFT JOIN recordedprogram p ON p.chanid=r.chanid "
+                        "                           AND p.starttime=r.progstart "
+                        "LEFT JOIN recgroups g ON r.recgroup=g.recgroup "
+                        "%1 " // WHERE clauses
+                        + orderByString;
+
+        if (!LoadIndexPage(m_pIndex, "Recording", idSql, pRequest, tokens,
+                           ids, nTotal))
+            return false;
+
+        pResults->m_nTotalMatches = nTotal;
+
+        if (ids.isEmpty())
+            return true;
+
+        QString sIds = UPnpCDSIndex::ToSqlList(ids);
+        clauses.append(QString("r.recordedid IN (%1)").arg(sIds));
+        // The rows come back in any order, AddIndexPage() puts them in
+        // the order of the page
+        orderByString.clear();
+    }
+
     QString whereString = BuildWhereClause(clauses, tokens);
 
     query.prepare(sql.arg(whereString).arg(orderByString));
 
     BindValues(query, tokens);
 
-    query.bindValue(":OFFSET", nOffset);
-    query.bindValue(":COUNT", nCount);
-
     if (!query.exec())
         return false;
 
+    QMap<int, CDSObject*> objects;
+
     while (query.next())
     {
         int            nChanid      = query.value( 0).toInt();
@@ -1301,19 +1364,13 @@ bool UPnpCDSTv::LoadRecordings(const UPnpCDSRequest* pRequest,
             PopulateArtworkURIS(pItem, sInetRef, nSeason, URIBase);
         }
 
-        pResults->Add( pItem );
-        pItem->DecrRef();
+        objects.insert(nRecordedId, pItem);
     }
 
-    // Just in case FOUND_ROWS() should fail, ensure m_nTotalMatches contains
-    // at least the size of this result set
-    if (query.size() > 0)
-        pResults->m_nTotalMatches = query.size();
+    AddIndexPage(pResults, ids, objects);
 
-    // Fetch the total number of matches ignoring any LIMITs
-    query.prepare("SELECT FOUND_ROWS()");
-    if (query.exec() && query.next())
-            pResults->m_nTotalMatches = query.value(0).toUInt();
+    if (nTotal == 0 && query.size() > 0)
+        pResults->m_nTotalMatches = query.size();
 
     return true;
 }
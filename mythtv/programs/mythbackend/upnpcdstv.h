@@ -11,18 +11,21 @@
 #ifndef UPnpCDSTV_H_
 #define UPnpCDSTV_H_
 
+#include <QVector>
+
 #include "upnpcds.h"
 
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
 
+class UPnpCDSIndex;
 class UPnpCDSTv : public UPnpCDSExtension
 {
     public:
 
         UPnpCDSTv();
-        virtual ~UPnpCDSTv() {}
+        virtual ~UPnpCDSTv();
 
     protected:
 
@@ -79,6 +82,7 @@ class UPnpCDSTv : public UPnpCDSExtension
                              IDTokenMap tokens );
 
         QUrl                   m_URIBase;
+        UPnpCDSIndex          *m_pIndex;
 
         QStringMap             m_mapBackendIp;
         QMap<QString, int>     m_mapBackendPort;
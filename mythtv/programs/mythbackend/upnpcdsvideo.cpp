@@ -14,9 +14,11 @@
 
 // MythTV headers
 #include "upnpcdsvideo.h"
+#include "upnpcdsindex.h"
 #include "httprequest.h"
 #include "mythdate.h"
 #include "mythcorecontext.h"
+#include "mythevent.h"
 #include "storagegroup.h"
 #include "upnphelpers.h"
 
@@ -24,9 +26,38 @@
 #define LOC_WARN QString("UPnpCDSVideo, Warning: ")
 #define LOC_ERR QString("UPnpCDSVideo, Error: ")
 
+/**
+ * \brief Drops the video index when a video scan finds changes.
+ */
+class UPnpCDSVideoIndex : public UPnpCDSIndex
+{
+  public:
+    UPnpCDSVideoIndex() : UPnpCDSIndex("Videos")
+    {
+        gCoreContext->addListener(this);
+    }
+    virtual ~UPnpCDSVideoIndex()
+    {
+        gCoreContext->removeListener(this);
+    }
+
+  protected:
+    virtual void customEvent(QEvent *e)
+    {
+        if (e->type() != MythEvent::MythEventMessage)
+            return;
+
+        QString message = static_cast<MythEvent *>(e)->Message();
+
+        if (message.startsWith("VIDEO_LIST_CHANGE"))
+            Invalidate();
+    }
+};
+
 UPnpCDSVideo::UPnpCDSVideo()
              : UPnpCDSExtension( "Videos", "Videos",
-                                 "object.item.videoItem" )
+                                 "object.item.videoItem" ),
+               m_pIndex(new UPnpCDSVideoIndex())
 {
     QString sServerIp   = gCoreContext->GetBackendServerIP();
     int sPort           = gCoreContext->GetBackendStatusPort();
@@ -40,6 +71,11 @@ UPnpCDSVideo::UPnpCDSVideo()
     m_shortcuts.insert(UPnPShortcutFeature::VIDEOS_GENRES, "Videos/Genre");
 }
 
+UPnpCDSVideo::~UPnpCDSVideo()
+{
+    delete m_pIndex;
+}
+
 void UPnpCDSVideo::CreateRoot()
 {
     if (m_pRoot)
@@ -615,14 +651,9 @@ bool UPnpCDSVideo::LoadVideos(const UPnpCDSRequest* pRequest,
 {
     QString sRequestId = pRequest->m_sObjectId;
 
-    uint16_t nCount = pRequest->m_nRequestedCount;
-    uint16_t nOffset = pRequest->m_nStartingIndex;
+    MSqlQuery query(MSqlQuery::InitCon());
 
-    // We must use a dedicated connection to get an acccurate value from
-    // FOUND_ROWS()
-    MSqlQuery query(MSqlQuery::InitCon(MSqlQuery::kDedicatedConnection));
-
-    QString sql = "SELECT SQL_CALC_FOUND_ROWS "
+    QString sql = "SELECT "
                   "v.intid, title, subtitle, filename, director, plot, "
                   "rating, year, userrating, length, "
                   "season, episode, coverfile, insertdate, host, "
@@ -630,22 +661,46 @@ bool UPnpCDSVideo::LoadVideos(const UPnpCDSRequest* pRequest,
                   "FROM videometadata v "
                   "LEFT JOIN videogenre g ON g.intid=v.category "
                   "%1 " //
-                  "ORDER BY title, season, episode "
-                  "LIMIT :OFFSET,:COUNT ";
+                  "%2"; // ORDER BY
 
     QStringList clauses;
+    QString orderByString = "ORDER BY title, season, episode";
+    uint nTotal = 0;
+    QVector<int> ids;
+
+    // A single video is loaded directly, a list one page at a time
+    if (tokens["video"].toInt() <= 0)
+    {
+        if (!LoadIndexPage(m_pIndex, "Video",
+                           "SELECT v.intid FROM videometadata v "
+                           "%1 " // WHERE clauses
+                           "ORDER BY title, season, episode",
+                           pRequest, tokens, ids, nTotal))
+            return false;
+
+        pResults->m_nTotalMatches = nTotal;
+
+        if (ids.isEmpty())
+            return true;
+
+        QString sIds = UPnpCDSIndex::ToSqlList(ids);
+        clauses.append(QString("v.intid IN (%1)").arg(sIds));
+        // The rows come back in any order, AddIndexPage() puts them in
+        // the order of the page
+        orderByString.clear();
+    }
+
     QString whereString = BuildWhereClause(clauses, tokens);
 
-    query.prepare(sql.arg(whereString));
+    query.prepare(sql.arg(whereString).arg(orderByString));
 
     BindValues(query, tokens);
 
-    query.bindValue(":OFFSET", nOffset);
-    query.bindValue(":COUNT", nCount);
-
     if (!query.exec())
         return false;
 
+    QMap<int, CDSObject*> objects;
+
     while (query.next())
     {
 
@@ -840,19 +895,13 @@ bool UPnpCDSVideo::LoadVideos(const UPnpCDSRequest* pRequest,
             PopulateArtworkURIS(pItem, nVidID, URIBase);
         }
 
-        pResults->Add( pItem );
-        pItem->DecrRef();
+        objects.insert(nVidID, pItem);
     }
 
-    // Just in case FOUND_ROWS() should fail, ensure m_nTotalMatches contains
-    // at least the size of this result set
-    if (query.size() >= 0)
-        pResults->m_nTotalMatches = query.size();
+    AddIndexPage(pResults, ids, objects);
 
-    // Fetch the total number of matches ignoring any LIMITs
-    query.prepare("SELECT FOUND_ROWS()");
-    if (query.exec() && query.next())
-            pResults->m_nTotalMatches = query.value(0).toUInt();
+    if (nTotal == 0 && query.size() > 0)
+        pResults->m_nTotalMatches = query.size();
 
     return true;
 }
@@ -11,6 +11,8 @@
 #ifndef UPnpCDSVIDEO_H_
 #define UPnpCDSVIDEO_H_
 
+#include <QVector>
+
 #include "mainserver.h"
 #include "upnpcds.h"
               
@@ -20,12 +22,13 @@ typedef QMap<int, QString> IntMap;
 //
 //////////////////////////////////////////////////////////////////////////////
 
+class UPnpCDSIndex;
 class UPnpCDSVideo : public UPnpCDSExtension
 {
     public:
 
         UPnpCDSVideo( );
-        virtual ~UPnpCDSVideo() {}
+        virtual ~UPnpCDSVideo();
 
     protected:
 
@@ -77,6 +80,7 @@ class UPnpCDSVideo : public UPnpCDSExtension
         QMap<QString, int>     m_mapBackendPort;
 
         QUrl m_URIBase;
+        UPnpCDSIndex *m_pIndex;
 
 };
 
@@ -12,6 +12,8 @@ using namespace std;
 #include <QDir>
 #include <QFileInfo>
 #include <QCoreApplication>
+#include <QRunnable>
+#include <QMutex>
 
 // MythTV headers
 #include "compat.h"
@@ -20,6 +22,7 @@ using namespace std;
 #include "mythplayer.h"
 #include "programinfo.h"
 #include "channelutil.h"
+#include "mthreadpool.h"
 
 // Commercial Flagging headers
 #include "CommDetector2.h"
@@ -302,6 +305,172 @@ QString strftimeval(const struct timeval *tv)
 
 using namespace commDetector2;
 
+/*
+ * One part of a completed recording, analysed by its own player on a pool
+ * thread. Only the per-frame analyzers are run here (HistogramAnalyzer for
+ * blank and scene change detection, TemplateMatcher for the logo); their
+ * results depend on nothing but the frame itself, so copying them into the
+ * main analyzers gives the same arrays as a serial run. Everything that
+ * looks across frames, such as scene change differences and break
+ * building, happens afterwards in finished() on the merged arrays.
+ */
+class CommDetector2Segment : public QRunnable
+{
+public:
+    CommDetector2Segment(CommFlagPlayerSource *_source, MythPlayer *_player,
+            long long _first, long long _last)
+        : source(_source), player(_player), first(_first), last(_last),
+          pgmConverter(NULL),
+          borderDetector(NULL), cannyEdgeDetector(NULL),
+          histogramAnalyzer(NULL), logoMatcher(NULL),
+          queued(false), framesDone(0), stop(false), done(false),
+          ok(false)
+    {
+        setAutoDelete(false);
+    }
+
+    ~CommDetector2Segment()
+    {
+        delete histogramAnalyzer;
+        delete logoMatcher;
+        delete pgmConverter;
+        delete borderDetector;
+        delete cannyEdgeDetector;
+        source->DeletePlayer(player);
+    }
+
+    bool init(bool histograms, TemplateFinder *logoFinder, bool logo,
+            long long nframes, const QString &debugdir)
+    {
+        if (player->OpenFile() < 0 || !player->InitVideo())
+            return false;
+        player->EnableSubtitles(false);
+
+        /* Both analyzers run on this thread, so they share one converter. */
+        if (histograms || logo)
+            pgmConverter = new PGMConverter();
+
+        if (histograms)
+        {
+            borderDetector = new BorderDetector();
+            histogramAnalyzer = new HistogramAnalyzer(pgmConverter,
+                    borderDetector, debugdir);
+            if (logoFinder)
+            {
+                histogramAnalyzer->setLogoState(logoFinder);
+                borderDetector->setLogoState(logoFinder);
+            }
+            if (histogramAnalyzer->MythPlayerInited(player, nframes) !=
+                    FrameAnalyzer::ANALYZE_OK)
+                return false;
+        }
+
+        if (logo)
+        {
+            cannyEdgeDetector = new CannyEdgeDetector();
+            logoMatcher = new TemplateMatcher(pgmConverter,
+                    cannyEdgeDetector, logoFinder, debugdir);
+            if (logoMatcher->MythPlayerInited(player, nframes) !=
+                    FrameAnalyzer::ANALYZE_OK)
+                return false;
+        }
+
+        return true;
+    }
+
+    virtual void run(void)
+    {
+        long long wanted = first;
+        bool reachedEnd = false;
+        bool started = false;
+
+        player->ResetTotalDuration();
+
+        while (player->GetEof() == kEofStateNone)
+        {
+            {
+                QMutexLocker locker(&lock);
+                if (stop)
+                    break;
+            }
+
+            VideoFrame *frame = player->GetRawVideoFrame(wanted);
+            wanted = -1;
+
+            if (!started && frame->frameNumber != first)
+            {
+                LOG(VB_COMMFLAG, LOG_ERR,
+                    QString("CommDetector2 segment seek to frame %1 "
+                            "landed on %2").arg(first)
+                        .arg(frame->frameNumber));
+                player->DiscardVideoFrame(frame);
+                break;
+            }
+            started = true;
+
+            if (frame->frameNumber >= last)
+            {
+                player->DiscardVideoFrame(frame);
+                reachedEnd = true;
+                break;
+            }
+
+            long long frameno = frame->frameNumber + 1;
+            long long nextFrame;
+            if (histogramAnalyzer)
+                (void)histogramAnalyzer->analyzeFrame(frame, frameno);
+            if (logoMatcher)
+                (void)logoMatcher->analyzeFrame(frame, frameno, &nextFrame);
+
+            player->DiscardVideoFrame(frame);
+
+            QMutexLocker locker(&lock);
+            framesDone++;
+        }
+
+        /* The last segment runs to the end of the file. */
+        if (started && last == LLONG_MAX)
+            reachedEnd = true;
+
+        QMutexLocker locker(&lock);
+        ok = reachedEnd && !stop;
+        done = true;
+    }
+
+    long long progress(bool *pdone, bool *pok) const
+    {
+        QMutexLocker locker(&lock);
+        *pdone = done;
+        *pok = ok;
+        return framesDone;
+    }
+
+    void requestStop(void)
+    {
+        QMutexLocker locker(&lock);
+        stop = true;
+    }
+
+    CommFlagPlayerSource    *source;
+    MythPlayer              *player;
+    long long               first;              /* first frame number */
+    long long               last;               /* one past the last */
+
+    PGMConverter            *pgmConverter;
+    BorderDetector          *borderDetector;
+    CannyEdgeDetector       *cannyEdgeDetector;
+    HistogramAnalyzer       *histogramAnalyzer;
+    TemplateMatcher         *logoMatcher;
+    bool                    queued;             /* handed to the pool */
+
+private:
+    mutable QMutex          lock;
+    long long               framesDone;
+    bool                    stop;
+    bool                    done;
+    bool                    ok;
+};
+
 CommDetector2::CommDetector2(
     enum SkipTypes     commDetectMethod_in,
     bool               showProgress_in,
@@ -323,12 +492,13 @@ CommDetector2::CommDetector2(
     finished(false),                currentFrameNumber(0),
     logoFinder(NULL),               logoMatcher(NULL),
     blankFrameDetector(NULL),       sceneChangeDetector(NULL),
+    histogramAnalyzer(NULL),
+    segmentSource(NULL),            segments(0),
     debugdir("")
 {
     FrameAnalyzerItem        pass0, pass1;
     PGMConverter            *pgmConverter = NULL;
     BorderDetector          *borderDetector = NULL;
-    HistogramAnalyzer       *histogramAnalyzer = NULL;
 
     if (useDB)
         debugdir = debugDirectory(chanid, recstartts);
@@ -414,8 +584,15 @@ CommDetector2::CommDetector2(
 
         if (!logoMatcher)
         {
-            logoMatcher = new TemplateMatcher(pgmConverter, cannyEdgeDetector,
-                    logoFinder, debugdir);
+            /*
+             * When pipelined, the matcher runs alongside the histogram
+             * analyzers on another thread, so it needs a greyscale converter
+             * of its own rather than sharing their cached image.
+             */
+            PGMConverter *matcherPgmConverter = FramePipeline::isUseful() ?
+                new PGMConverter() : pgmConverter;
+            logoMatcher = new TemplateMatcher(matcherPgmConverter,
+                    cannyEdgeDetector, logoFinder, debugdir);
             pass1.push_back(logoMatcher);
         }
     }
@@ -520,6 +697,197 @@ int CommDetector2::computeBreaks(long long nframes)
     return 0;
 }
 
+/*
+ * Split a pass into FramePipeline lanes. Analyzers sharing a
+ * HistogramAnalyzer must run on the same thread; everything else gets a
+ * lane of its own.
+ */
+FrameAnalyzerList CommDetector2::pipelineLanes(
+    const FrameAnalyzerItem &pass) const
+{
+    FrameAnalyzerList lanes;
+    FrameAnalyzerItem histogramLane;
+
+    for (FrameAnalyzerItem::const_iterator it = pass.begin();
+         it != pass.end(); ++it)
+    {
+        if (*it == blankFrameDetector || *it == sceneChangeDetector)
+            histogramLane.push_back(*it);
+        else
+            lanes.push_back(FrameAnalyzerItem(1, *it));
+    }
+
+    if (!histogramLane.empty())
+        lanes.insert(lanes.begin(), histogramLane);
+
+    return lanes;
+}
+
+void CommDetector2::SetParallelSegments(CommFlagPlayerSource *source,
+        uint _segments)
+{
+    segmentSource = source;
+    segments = _segments;
+}
+
+/*
+ * Split the rest of a completed recording at keyframes and start analysing
+ * every part but the first on its own player. Returns the frame number at
+ * which the caller should stop, or LLONG_MAX to flag serially.
+ */
+long long CommDetector2::startSegments(const FrameAnalyzerItem &pass,
+        long long nframes, vector<CommDetector2Segment*> &segmentList)
+{
+    /* TUNABLE: Shorter parts spend more time opening players than flagging. */
+    const long long MINSEGLEN = (long long)roundf(120 * player->GetFrameRate());
+
+    bool histograms = std::find(pass.begin(), pass.end(), blankFrameDetector)
+            != pass.end() ||
+        std::find(pass.begin(), pass.end(), sceneChangeDetector) != pass.end();
+    bool logo = std::find(pass.begin(), pass.end(), logoMatcher) != pass.end();
+
+    frm_pos_map_t keyframes;
+    if (!segmentSource->GetKeyframes(keyframes) || keyframes.size() < 2)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO,
+            "CommDetector2: no seek table, not flagging in segments");
+        return LLONG_MAX;
+    }
+
+    unsigned int nsegments = min((long long)segments, nframes / MINSEGLEN);
+    vector<long long> starts;
+    for (unsigned int ii = 1; ii < nsegments; ii++)
+    {
+        frm_pos_map_t::const_iterator kk =
+            keyframes.lowerBound(nframes * ii / nsegments);
+        if (kk == keyframes.end())
+            break;
+        long long start = kk.key();
+        if (start - (starts.empty() ? 0 : starts.back()) >= MINSEGLEN)
+            starts.push_back(start);
+    }
+    if (starts.empty())
+        return LLONG_MAX;
+
+    bool opened = true;
+    for (unsigned int ii = 0; ii < starts.size() && opened; ii++)
+    {
+        long long last = ii + 1 < starts.size() ? starts[ii + 1] : LLONG_MAX;
+        MythPlayer *segplayer = segmentSource->CreatePlayer();
+        if (!segplayer)
+        {
+            opened = false;
+            break;
+        }
+
+        CommDetector2Segment *segment = new CommDetector2Segment(
+            segmentSource, segplayer, starts[ii], last);
+        segmentList.push_back(segment);
+        opened = segment->init(histograms, logoFinder, logo, nframes,
+                               debugdir);
+    }
+
+    if (!opened)
+    {
+        LOG(VB_COMMFLAG, LOG_ERR,
+            "CommDetector2: could not open segment players, "
+            "flagging serially");
+        stopSegments(segmentList);
+        return LLONG_MAX;
+    }
+
+    MThreadPool *pool = MThreadPool::globalInstance();
+    pool->setMaxThreadCount(max(pool->maxThreadCount(),
+                                (int)segmentList.size() + 2));
+    for (unsigned int ii = 0; ii < segmentList.size(); ii++)
+    {
+        segmentList[ii]->queued = true;
+        pool->start(segmentList[ii], QString("CommFlagSegment%1").arg(ii + 1));
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("CommDetector2: flagging in %1 segments, first ends at "
+                "frame %2").arg(segmentList.size() + 1).arg(starts[0]));
+
+    return starts[0];
+}
+
+/*
+ * Wait for the segment players while keeping the job responsive. Returns
+ * true if every segment covered its frames.
+ */
+bool CommDetector2::waitForSegments(
+        const vector<CommDetector2Segment*> &segmentList, long long frameno,
+        long long nframes, const QTime &passTime, unsigned int passno,
+        unsigned int npasses)
+{
+    for (;;)
+    {
+        long long frames = frameno;
+        bool alldone = true, allok = true;
+        for (unsigned int ii = 0; ii < segmentList.size(); ii++)
+        {
+            bool done, ok;
+            frames += segmentList[ii]->progress(&done, &ok);
+            alldone = alldone && done;
+            allok = allok && ok;
+        }
+
+        if (alldone)
+            return allok;
+
+        emit breathe();
+        if (m_bStop)
+            return false;
+
+        if (showProgress)
+            reportState(passTime.elapsed(), frames, nframes, passno, npasses);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+}
+
+void CommDetector2::mergeSegments(
+        const vector<CommDetector2Segment*> &segmentList, long long nframes)
+{
+    /* Analyzers see frame numbers one greater than the player's. */
+    for (unsigned int ii = 0; ii < segmentList.size(); ii++)
+    {
+        const CommDetector2Segment *segment = segmentList[ii];
+        long long first = segment->first + 1;
+        long long last = segment->last == LLONG_MAX ?
+            nframes : min(nframes, segment->last + 1);
+
+        if (histogramAnalyzer && segment->histogramAnalyzer)
+            histogramAnalyzer->mergeFrames(segment->histogramAnalyzer,
+                    first, last);
+        if (logoMatcher && segment->logoMatcher)
+            logoMatcher->mergeFrames(segment->logoMatcher, first, last);
+    }
+}
+
+void CommDetector2::stopSegments(vector<CommDetector2Segment*> &segmentList)
+{
+    if (segmentList.empty())
+        return;
+
+    for (unsigned int ii = 0; ii < segmentList.size(); ii++)
+        segmentList[ii]->requestStop();
+
+    for (unsigned int ii = 0; ii < segmentList.size(); ii++)
+    {
+        bool done = false, ok;
+        while (segmentList[ii]->queued && !done)
+        {
+            (void)segmentList[ii]->progress(&done, &ok);
+            if (!done)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        delete segmentList[ii];
+    }
+    segmentList.clear();
+}
+
 bool CommDetector2::go(void)
 {
     int minlag = 7; // seconds
@@ -585,6 +953,30 @@ bool CommDetector2::go(void)
 
         player->ResetTotalDuration();
 
+        /*
+         * Decode here and analyze on worker threads. Each frame is copied,
+         * so this only pays off with more than one analyzer or a core to
+         * spare for the decoder.
+         */
+        FramePipeline *pipeline = NULL;
+        if (!(*currentPass).empty() && FramePipeline::isUseful())
+            pipeline = new FramePipeline(pipelineLanes(*currentPass));
+
+        /*
+         * A completed recording can be split up, the rest of it analysed
+         * by other players while this one does the first part. The logo
+         * search samples the whole recording, so it always runs serially.
+         */
+        vector<CommDetector2Segment*> segmentList;
+        long long stopFrame = LLONG_MAX;
+        bool segmentsOk = false;
+        if (postprocessing && segmentSource && segments > 1 &&
+                !(*currentPass).empty() &&
+                !searchingForLogo(logoFinder, *currentPass))
+        {
+            stopFrame = startSegments(*currentPass, nframes, segmentList);
+        }
+
         if (searchingForLogo(logoFinder, *currentPass))
             emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
                 "Performing Logo Identification"));
@@ -592,7 +984,8 @@ bool CommDetector2::go(void)
         clock.start();
         passTime.start();
         memset(&getframetime, 0, sizeof(getframetime));
-        while (!(*currentPass).empty() && player->GetEof() == kEofStateNone)
+        while ((pipeline ? !pipeline->empty() : !(*currentPass).empty()) &&
+               player->GetEof() == kEofStateNone)
         {
             struct timeval start, end, elapsedtv;
 
@@ -618,12 +1011,32 @@ bool CommDetector2::go(void)
                         .arg(lastFrameNumber).arg(currentFrameNumber));
             }
 
+            if (currentFrame->frameNumber >= stopFrame)
+            {
+                segmentsOk = waitForSegments(segmentList, currentFrameNumber,
+                        nframes, passTime, passno, npasses);
+                if (segmentsOk || m_bStop)
+                {
+                    player->DiscardVideoFrame(currentFrame);
+                    break;
+                }
+
+                /* Carry on from here as if segments had never been used. */
+                LOG(VB_COMMFLAG, LOG_WARNING,
+                    "CommDetector2: a segment failed, flagging the rest "
+                    "serially");
+                stopSegments(segmentList);
+                stopFrame = LLONG_MAX;
+            }
+
             if (stopForBreath(isRecording, currentFrameNumber))
             {
                 emit breathe();
                 if (m_bStop)
                 {
                     player->DiscardVideoFrame(currentFrame);
+                    delete pipeline;
+                    stopSegments(segmentList);
                     return false;
                 }
             }
@@ -642,9 +1055,17 @@ bool CommDetector2::go(void)
                         nframes, passno, npasses);
             }
 
-            nextFrame = processFrame(
-                *currentPass, finishedAnalyzers,
-                deadAnalyzers, currentFrame, currentFrameNumber);
+            if (pipeline)
+            {
+                pipeline->push(currentFrame, currentFrameNumber);
+                nextFrame = pipeline->nextFrame(currentFrameNumber);
+            }
+            else
+            {
+                nextFrame = processFrame(
+                    *currentPass, finishedAnalyzers,
+                    deadAnalyzers, currentFrame, currentFrameNumber);
+            }
 
             if (((currentFrameNumber >= 1) && (nframes > 0) &&
                  (((nextFrame * 10) / nframes) !=
@@ -681,6 +1102,12 @@ bool CommDetector2::go(void)
             {
                 frm_dir_map_t breakMap;
 
+                // The analyzers must be idle while their maps are read
+                if (pipeline)
+                {
+                    pipeline->sync(*currentPass, finishedAnalyzers,
+                                   deadAnalyzers);
+                }
                 GetCommercialBreakList(breakMap);
 
                 frm_dir_map_t::const_iterator ii, jj;
@@ -707,6 +1134,22 @@ bool CommDetector2::go(void)
             player->DiscardVideoFrame(currentFrame);
         }
 
+        if (pipeline)
+        {
+            pipeline->sync(*currentPass, finishedAnalyzers, deadAnalyzers);
+            delete pipeline;
+        }
+
+        if (segmentsOk)
+        {
+            mergeSegments(segmentList, nframes);
+            /* This player has not seen the whole recording. */
+            player->ResetTotalDuration();
+        }
+        stopSegments(segmentList);
+        if (m_bStop)
+            return false;
+
         // Save total duration only on the last pass, which hopefully does
         // no skipping.
         if (passno + 1 == npasses)
@@ -14,12 +14,15 @@ using namespace std;
 // Commercial Flagging headers
 #include "CommDetectorBase.h"
 #include "FrameAnalyzer.h"
+#include "FramePipeline.h"
 
 class MythPlayer;
 class TemplateFinder;
 class TemplateMatcher;
 class BlankFrameDetector;
 class SceneChangeDetector;
+class HistogramAnalyzer;
+class CommDetector2Segment;
 
 namespace commDetector2 {
 
@@ -31,7 +34,6 @@ QString strftimeval(const struct timeval *tv);
 
 };  /* namespace */
 
-typedef vector<FrameAnalyzer*>    FrameAnalyzerItem;
 typedef vector<FrameAnalyzerItem> FrameAnalyzerList;
 
 class CommDetector2 : public CommDetectorBase
@@ -46,6 +48,8 @@ class CommDetector2 : public CommDetectorBase
     virtual void GetCommercialBreakList(frm_dir_map_t &comms);
     virtual void recordingFinished(long long totalFileSize);
     virtual void requestCommBreakMapUpdate(void);
+    virtual void SetParallelSegments(CommFlagPlayerSource *source,
+                                     uint segments);
     virtual void PrintFullMap(
         ostream &out, const frm_dir_map_t *comm_breaks, bool verbose) const;
 
@@ -55,6 +59,16 @@ class CommDetector2 : public CommDetectorBase
     void reportState(int elapsed_sec, long long frameno, long long nframes,
             unsigned int passno, unsigned int npasses);
     int computeBreaks(long long nframes);
+    FrameAnalyzerList pipelineLanes(const FrameAnalyzerItem &pass) const;
+
+    long long startSegments(const FrameAnalyzerItem &pass, long long nframes,
+            vector<CommDetector2Segment*> &segmentList);
+    bool waitForSegments(const vector<CommDetector2Segment*> &segmentList,
+            long long frameno, long long nframes, const QTime &passTime,
+            unsigned int passno, unsigned int npasses);
+    void mergeSegments(const vector<CommDetector2Segment*> &segmentList,
+            long long nframes);
+    void stopSegments(vector<CommDetector2Segment*> &segmentList);
 
   private:
     enum SkipTypes          commDetectMethod;
@@ -79,6 +93,10 @@ class CommDetector2 : public CommDetectorBase
     TemplateMatcher         *logoMatcher;
     BlankFrameDetector      *blankFrameDetector;
     SceneChangeDetector     *sceneChangeDetector;
+    HistogramAnalyzer       *histogramAnalyzer;
+
+    CommFlagPlayerSource    *segmentSource;
+    unsigned int            segments;           /* for completed recordings */
 
     QString                 debugdir;
 };
@@ -19,6 +19,23 @@ typedef enum commMapValues {
 
 typedef QMap<uint64_t, CommMapValue> show_map_t;
 
+class MythPlayer;
+
+/** \class CommFlagPlayerSource
+ *  \brief Opens extra players on the recording being flagged, so that a
+ *         detector can analyse several parts of it at the same time.
+ */
+class CommFlagPlayerSource
+{
+public:
+    virtual ~CommFlagPlayerSource() {}
+
+    virtual MythPlayer *CreatePlayer(void) = 0;
+    virtual void DeletePlayer(MythPlayer *player) = 0;
+    /// Fills in the keyframe frame numbers of a completed recording
+    virtual bool GetKeyframes(frm_pos_map_t &keyframes) = 0;
+};
+
 /** \class CommDetectorBase
  *  \brief Abstract base class for all CommDetectors.
  *   Please use the CommDetectFactory to make actual instances.
@@ -40,6 +57,9 @@ public:
     virtual void recordingFinished(long long totalFileSize)
         { (void)totalFileSize; };
     virtual void requestCommBreakMapUpdate(void) {};
+    virtual void SetParallelSegments(CommFlagPlayerSource *source,
+                                     uint segments)
+        { (void)source; (void)segments; };
 
     virtual void PrintFullMap(
         ostream &out, const frm_dir_map_t *comm_breaks, bool verbose) const = 0;
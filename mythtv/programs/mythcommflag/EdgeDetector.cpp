@@ -1,4 +1,5 @@
 // ANSI C headers
+#include <climits>
 #include <cstdlib>
 
 // C++ headers
@@ -19,6 +20,7 @@ extern "C" {
 // Commercial Flagging headers
 #include "FrameAnalyzer.h"
 #include "EdgeDetector.h"
+#include "pgmkernels.h"
 
 namespace edgeDetector {
 
@@ -36,25 +38,31 @@ sgm_init_exclude(unsigned int *sgm, const AVPicture *src, int srcheight,
      * that pixel: how much it differs from its neighbors.
      */
     const int       srcwidth = src->linesize[0];
-    int             rr, cc, dx, dy, rr2, cc2;
+    const PGMKernels *kernels = pgm_kernels();
+    int             rr, rr2, cc2, exclude1, exclude2;
     unsigned char   *rr0, *rr1;
 
     memset(sgm, 0, srcwidth * srcheight * sizeof(*sgm));
     rr2 = srcheight - 1;
     cc2 = srcwidth - 1;
+
+    /* Columns [exclude1, exclude2) of the excluded rows are left zero. */
+    exclude1 = min(max(excludecol, 0), cc2);
+    exclude2 = min(max(excludecol + excludewidth, exclude1), cc2);
+
     for (rr = 0; rr < rr2; rr++)
     {
-        for (cc = 0; cc < cc2; cc++)
+        rr0 = &src->data[0][rr * srcwidth];
+        rr1 = &src->data[0][(rr + 1) * srcwidth];
+        if (rr >= excluderow && rr < excluderow + excludeheight)
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                rr0 = &src->data[0][rr * srcwidth + cc];
-                rr1 = &src->data[0][(rr + 1) * srcwidth + cc];
-                dx = rr1[1] - rr0[0];   /* southeast - northwest */
-                dy = rr1[0] - rr0[1];   /* southwest - northeast */
-                sgm[rr * srcwidth + cc] = dx * dx + dy * dy;
-            }
+            kernels->sgm(&sgm[rr * srcwidth], rr0, rr1, exclude1);
+            kernels->sgm(&sgm[rr * srcwidth + exclude2],
+                    rr0 + exclude2, rr1 + exclude2, cc2 - exclude2);
+        }
+        else
+        {
+            kernels->sgm(&sgm[rr * srcwidth], rr0, rr1, cc2);
         }
     }
     return sgm;
@@ -68,11 +76,6 @@ sgm_init(unsigned int *sgm, const AVPicture *src, int srcheight)
 }
 #endif /* LATER */
 
-static int sort_ascending(const void *aa, const void *bb)
-{
-    return *(unsigned int*)aa - *(unsigned int*)bb;
-}
-
 static int
 edge_mark(AVPicture *dst, int dstheight,
         int extratop, int extraright, int extrabottom, int extraleft,
@@ -91,8 +94,9 @@ edge_mark(AVPicture *dst, int dstheight,
 
     const int           dstwidth = dst->linesize[0];
     const int           padded_width = extraleft + dstwidth + extraright;
-    unsigned int        thresholdval;
-    int                 nn, dstnn, ii, rr, cc, first, last, last2;
+    unsigned int        thresholdval, nextval;
+    int                 nn, dstnn, ii, jj, rr, cc, first, last;
+    int                 nless, nequal;
 
     (void)extrabottom;  /* gcc */
 
@@ -132,29 +136,39 @@ edge_mark(AVPicture *dst, int dstheight,
             return 0;
     }
 
-    qsort(sgmsorted, nn, sizeof(*sgmsorted), sort_ascending);
-
+    /*
+     * Only the value at the percentile and its run of equal values in sorted
+     * order are needed, so select it in linear time rather than sorting:
+     * "first" and "last" are the sorted positions of that run, and
+     * "nextval" the value that would follow it.
+     */
     ii = percentile * nn / 100;
+    nth_element(sgmsorted, sgmsorted + ii, sgmsorted + nn);
     thresholdval = sgmsorted[ii];
 
+    nless = nequal = 0;
+    nextval = UINT_MAX;
+    for (jj = 0; jj < nn; jj++)
+    {
+        if (sgmsorted[jj] < thresholdval)
+            nless++;
+        else if (sgmsorted[jj] == thresholdval)
+            nequal++;
+        else if (sgmsorted[jj] < nextval)
+            nextval = sgmsorted[jj];
+    }
+    first = nless;
+    last = nless + nequal - 1;
+
     /*
      * Try not to pick up too many edges, and eliminate degenerate edge-less
      * cases.
      */
-    for (first = ii; first > 0 && sgmsorted[first] == thresholdval; first--) ;
-    if (sgmsorted[first] != thresholdval)
-        first++;
     if (first * 100 / nn < MINTHRESHOLDPCT)
     {
         unsigned int    newthresholdval;
 
-        last2 = nn - 1;
-        for (last = ii; last < last2 && sgmsorted[last] == thresholdval;
-                last++) ;
-        if (sgmsorted[last] != thresholdval)
-            last--;
-
-        newthresholdval = sgmsorted[min(last + 1, nn - 1)];
+        newthresholdval = last + 1 < nn ? nextval : thresholdval;
         if (thresholdval == newthresholdval)
         {
             /* Degenerate case; no edges (e.g., blank frame). */
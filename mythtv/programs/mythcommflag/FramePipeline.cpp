@@ -0,0 +1,362 @@
+// ANSI C headers
+#include <cstring>
+
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QRunnable>
+#include <QThread>
+
+// MythTV headers
+#include "mythlogging.h"
+#include "mthreadpool.h"
+#include "mythframe.h"
+#include "framebufferpool.h"
+
+// Commercial Flagging headers
+#include "FramePipeline.h"
+
+/* A decoded frame shared by every lane until the last one is done. */
+struct FramePipelineFrame
+{
+    VideoFrame      frame;
+    long long       frameno;
+    int             refs;
+};
+
+class FramePipelineLane
+{
+public:
+    explicit FramePipelineLane(const FrameAnalyzerItem &_analyzers)
+        : analyzers(_analyzers),
+          wanted(_analyzers.size(), FrameAnalyzer::NEXTFRAME),
+          skipping(_analyzers.size(), false),
+          busy(false)
+    {
+    }
+
+    FrameAnalyzerItem           analyzers;  /* still running */
+    vector<long long>           wanted;     /* next frame, per analyzer */
+    vector<bool>                skipping;   /* asked for a later frame */
+    QList<FramePipelineFrame*>  queue;
+    bool                        busy;
+};
+
+class FramePipelineWorker : public QRunnable
+{
+public:
+    FramePipelineWorker(FramePipeline *_pipeline, FramePipelineLane *_lane)
+        : pipeline(_pipeline), lane(_lane) {}
+
+    virtual void run(void) { pipeline->runLane(lane); }
+
+private:
+    FramePipeline       *pipeline;
+    FramePipelineLane   *lane;
+};
+
+FramePipeline::FramePipeline(const vector<FrameAnalyzerItem> &_lanes,
+                             uint _maxQueued)
+    : pool(new MThreadPool("CommFlagAnalyzers"))
+    , maxQueued(_maxQueued)
+    , queued(0)
+    , stopping(false)
+{
+    FrameBufferPool::GetPool()->AddUser();
+
+    for (uint ii = 0; ii < _lanes.size(); ii++)
+    {
+        if (!_lanes[ii].empty())
+            lanes.push_back(new FramePipelineLane(_lanes[ii]));
+    }
+
+    pool->setMaxThreadCount(lanes.size());
+    for (int ii = 0; ii < lanes.size(); ii++)
+    {
+        pool->start(new FramePipelineWorker(this, lanes[ii]),
+                    QString("CommFlagLane%1").arg(ii));
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("FramePipeline: analysing on %1 worker thread(s)")
+            .arg(lanes.size()));
+}
+
+FramePipeline::~FramePipeline(void)
+{
+    lock.lock();
+    stopping = true;
+    frameQueued.wakeAll();
+    lock.unlock();
+
+    pool->waitForDone();
+    delete pool;
+
+    for (int ii = 0; ii < lanes.size(); ii++)
+    {
+        while (!lanes[ii]->queue.empty())
+            releaseFrameLocked(lanes[ii]->queue.takeFirst());
+        delete lanes[ii];
+    }
+
+    FrameBufferPool::GetPool()->RemoveUser();
+}
+
+/*
+ * Pipelining only pays off when decoding and analysis can actually run on
+ * different cores.
+ */
+bool
+FramePipeline::isUseful(void)
+{
+    return QThread::idealThreadCount() > 1;
+}
+
+void
+FramePipeline::push(const VideoFrame *frame, long long frameno)
+{
+    QMutexLocker locker(&lock);
+
+    while (queued >= maxQueued && !stopping)
+        frameDone.wait(&lock);
+
+    FramePipelineFrame *pframe = NULL;
+    for (int ii = 0; ii < lanes.size(); ii++)
+    {
+        if (lanes[ii]->analyzers.empty())
+            continue;
+
+        if (!pframe)
+        {
+            unsigned char *buf = FrameBufferPool::GetPool()->Acquire(
+                frame->size);
+            if (!buf)
+                return;
+
+            /* The player reuses its frames as soon as they are discarded. */
+            pframe = new FramePipelineFrame;
+            pframe->frame = *frame;
+            pframe->frame.buf = buf;
+            pframe->frame.qscale_table = NULL;
+            pframe->frame.qstride = 0;
+            memcpy(buf, frame->buf, frame->size);
+            pframe->frameno = frameno;
+            pframe->refs = 0;
+            queued++;
+        }
+
+        pframe->refs++;
+        lanes[ii]->queue.push_back(pframe);
+    }
+
+    frameQueued.wakeAll();
+}
+
+bool
+FramePipeline::skippingLocked(void) const
+{
+    for (int ii = 0; ii < lanes.size(); ii++)
+    {
+        const vector<bool> &skipping = lanes[ii]->skipping;
+        for (uint jj = 0; jj < skipping.size(); jj++)
+        {
+            if (skipping[jj])
+                return true;
+        }
+    }
+    return false;
+}
+
+long long
+FramePipeline::nextFrame(long long frameno)
+{
+    QMutexLocker locker(&lock);
+
+    if (!skippingLocked())
+        return frameno + 1;
+
+    /*
+     * Someone wants to skip ahead; wait for every lane to catch up so that
+     * the seek goes where a serial run would have gone.
+     */
+    locker.unlock();
+    flush();
+    locker.relock();
+
+    long long minNextFrame = FrameAnalyzer::ANYFRAME;
+    for (int ii = 0; ii < lanes.size(); ii++)
+    {
+        const vector<long long> &wanted = lanes[ii]->wanted;
+        for (uint jj = 0; jj < wanted.size(); jj++)
+            minNextFrame = std::min(minNextFrame, wanted[jj]);
+    }
+
+    if (minNextFrame == FrameAnalyzer::ANYFRAME ||
+        minNextFrame == FrameAnalyzer::NEXTFRAME)
+        minNextFrame = frameno + 1;
+
+    return minNextFrame;
+}
+
+bool
+FramePipeline::empty(void) const
+{
+    QMutexLocker locker(&lock);
+
+    for (int ii = 0; ii < lanes.size(); ii++)
+    {
+        if (!lanes[ii]->analyzers.empty())
+            return false;
+    }
+    return true;
+}
+
+void
+FramePipeline::flush(void)
+{
+    QMutexLocker locker(&lock);
+
+    for (;;)
+    {
+        bool idle = true;
+        for (int ii = 0; ii < lanes.size() && idle; ii++)
+            idle = lanes[ii]->queue.empty() && !lanes[ii]->busy;
+        if (idle || stopping)
+            return;
+        frameDone.wait(&lock);
+    }
+}
+
+void
+FramePipeline::sync(FrameAnalyzerItem &pass, FrameAnalyzerItem &finished,
+                      FrameAnalyzerItem &dead)
+{
+    flush();
+
+    QMutexLocker locker(&lock);
+
+    /* Keep the survivors in their original order. */
+    FrameAnalyzerItem::iterator it = pass.begin();
+    while (it != pass.end())
+    {
+        bool running = false;
+        for (int ii = 0; ii < lanes.size() && !running; ii++)
+        {
+            const FrameAnalyzerItem &analyzers = lanes[ii]->analyzers;
+            running = std::find(analyzers.begin(), analyzers.end(), *it) !=
+                analyzers.end();
+        }
+        if (running)
+            ++it;
+        else
+            it = pass.erase(it);
+    }
+
+    finished.insert(finished.end(),
+                    finishedAnalyzers.begin(), finishedAnalyzers.end());
+    dead.insert(dead.end(), deadAnalyzers.begin(), deadAnalyzers.end());
+    finishedAnalyzers.clear();
+    deadAnalyzers.clear();
+}
+
+void
+FramePipeline::releaseFrameLocked(FramePipelineFrame *pframe)
+{
+    if (--pframe->refs > 0)
+        return;
+
+    FrameBufferPool::GetPool()->Release(pframe->frame.buf);
+    delete pframe;
+    queued--;
+}
+
+void
+FramePipeline::runLane(FramePipelineLane *lane)
+{
+    QMutexLocker locker(&lock);
+
+    for (;;)
+    {
+        while (lane->queue.empty() && !stopping)
+            frameQueued.wait(&lock);
+        if (stopping)
+            break;
+
+        FramePipelineFrame *pframe = lane->queue.takeFirst();
+        long long frameno = pframe->frameno;
+        lane->busy = true;
+
+        /*
+         * Analyze from copies so the lock can be dropped; only this worker
+         * changes the lane, so the copies stay valid until it relocks.
+         */
+        FrameAnalyzerItem analyzers = lane->analyzers;
+        vector<long long> wanted = lane->wanted;
+        locker.unlock();
+
+        vector<FrameAnalyzer::analyzeFrameResult> results(analyzers.size(),
+            FrameAnalyzer::ANALYZE_OK);
+        vector<long long> next(wanted);
+        for (uint ii = 0; ii < analyzers.size(); ii++)
+        {
+            if (wanted[ii] != FrameAnalyzer::NEXTFRAME && frameno < wanted[ii])
+                continue;
+
+            results[ii] = analyzers[ii]->analyzeFrame(&pframe->frame,
+                                                      frameno, &next[ii]);
+            if (next[ii] == FrameAnalyzer::ANYFRAME ||
+                next[ii] == FrameAnalyzer::NEXTFRAME)
+                next[ii] = frameno + 1;
+        }
+
+        locker.relock();
+
+        FrameAnalyzerItem::iterator it = lane->analyzers.begin();
+        for (uint ii = 0; ii < results.size(); ii++)
+        {
+            uint idx = it - lane->analyzers.begin();
+
+            if ((FrameAnalyzer::ANALYZE_OK    == results[ii]) ||
+                (FrameAnalyzer::ANALYZE_ERROR == results[ii]))
+            {
+                lane->wanted[idx] = next[ii];
+                lane->skipping[idx] = next[ii] > frameno + 1;
+                ++it;
+                continue;
+            }
+
+            if (FrameAnalyzer::ANALYZE_FINISHED == results[ii])
+            {
+                finishedAnalyzers.push_back(*it);
+            }
+            else
+            {
+                if (FrameAnalyzer::ANALYZE_FATAL != results[ii])
+                {
+                    LOG(VB_GENERAL, LOG_ERR,
+                        QString("Unexpected return value from "
+                                "%1::analyzeFrame: %2")
+                            .arg((*it)->name()).arg(results[ii]));
+                }
+                deadAnalyzers.push_back(*it);
+            }
+            lane->wanted.erase(lane->wanted.begin() + idx);
+            lane->skipping.erase(lane->skipping.begin() + idx);
+            it = lane->analyzers.erase(it);
+        }
+
+        /* A lane with nothing left to run stops taking frames. */
+        if (lane->analyzers.empty())
+        {
+            while (!lane->queue.empty())
+                releaseFrameLocked(lane->queue.takeFirst());
+        }
+
+        releaseFrameLocked(pframe);
+        lane->busy = false;
+        frameDone.wakeAll();
+    }
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,89 @@
+/*
+ * FramePipeline
+ *
+ * Runs the frame analyzers of one commercial flagging pass on worker
+ * threads while the caller keeps decoding.
+ */
+
+#ifndef __FRAMEPIPELINE_H__
+#define __FRAMEPIPELINE_H__
+
+#include <vector>
+using namespace std;
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+
+#include "FrameAnalyzer.h"
+
+class MThreadPool;
+class FramePipelineLane;
+class FramePipelineWorker;
+struct FramePipelineFrame;
+
+typedef vector<FrameAnalyzer*>    FrameAnalyzerItem;
+
+/*
+ * Analyzers are grouped into lanes. Analyzers that share helper objects
+ * (for example BlankFrameDetector and SceneChangeDetector, which share a
+ * HistogramAnalyzer) must be in the same lane. Each lane runs on its own
+ * worker and sees the frames in decode order, so every analyzer still gets
+ * its frames one at a time and in order, only on another thread.
+ *
+ * Each analyzer is only given the frames at or after the one it asked for.
+ * While any analyzer is skipping ahead the caller is made to wait until the
+ * lanes catch up, so the next frame requested from the decoder is exactly
+ * the one a serial run would have asked for.
+ */
+class FramePipeline
+{
+    friend class FramePipelineWorker;
+
+public:
+    FramePipeline(const vector<FrameAnalyzerItem> &lanes,
+                  uint maxQueued = 32);
+    ~FramePipeline(void);
+
+    /* Copy "frame" and queue it for every lane. Blocks when full. */
+    void push(const VideoFrame *frame, long long frameno);
+
+    /* Frame number the decoder should fetch after "frameno". */
+    long long nextFrame(long long frameno);
+
+    /* True once every analyzer has finished or died. */
+    bool empty(void) const;
+
+    /*
+     * Wait for queued frames, then move the analyzers that finished or
+     * died out of "pass" and into "finished" and "dead".
+     */
+    void sync(FrameAnalyzerItem &pass, FrameAnalyzerItem &finished,
+              FrameAnalyzerItem &dead);
+
+    /* Wait until every queued frame has been analyzed. */
+    void flush(void);
+
+    static bool isUseful(void);
+
+private:
+    bool skippingLocked(void) const;
+    void runLane(FramePipelineLane *lane);
+    void releaseFrameLocked(FramePipelineFrame *pframe);
+
+    mutable QMutex              lock;
+    QWaitCondition              frameQueued;
+    QWaitCondition              frameDone;
+
+    QList<FramePipelineLane*>   lanes;
+    FrameAnalyzerItem           finishedAnalyzers;
+    FrameAnalyzerItem           deadAnalyzers;
+    MThreadPool                *pool;
+    uint                        maxQueued;
+    uint                        queued;
+    bool                        stopping;
+};
+
+#endif  /* !__FRAMEPIPELINE_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -441,6 +441,32 @@ HistogramAnalyzer::finished(long long nframes, bool final)
     return 0;
 }
 
+/*
+ * Copy the per-frame results for frames [first, last) from an analyzer
+ * that was run over that part of the recording.
+ */
+void
+HistogramAnalyzer::mergeFrames(const HistogramAnalyzer *other,
+        long long first, long long last)
+{
+    if (!monochromatic || !other->monochromatic || first >= last)
+        return;
+
+    long long count = last - first;
+    memcpy(&mean[first], &other->mean[first], count * sizeof(*mean));
+    memcpy(&median[first], &other->median[first], count * sizeof(*median));
+    memcpy(&stddev[first], &other->stddev[first], count * sizeof(*stddev));
+    memcpy(&frow[first], &other->frow[first], count * sizeof(*frow));
+    memcpy(&fcol[first], &other->fcol[first], count * sizeof(*fcol));
+    memcpy(&fwidth[first], &other->fwidth[first], count * sizeof(*fwidth));
+    memcpy(&fheight[first], &other->fheight[first],
+            count * sizeof(*fheight));
+    memcpy(&histogram[first], &other->histogram[first],
+            count * sizeof(*histogram));
+    memcpy(&monochromatic[first], &other->monochromatic[first],
+            count * sizeof(*monochromatic));
+}
+
 int
 HistogramAnalyzer::reportTime(void) const
 {
@@ -30,6 +30,8 @@ public:
             long long frameno);
     int finished(long long nframes, bool final);
     int reportTime(void) const;
+    void mergeFrames(const HistogramAnalyzer *other, long long first,
+            long long last);
 
     /* Each color 0-255 gets a scaled frequency counter 0-255. */
     typedef unsigned char   Histogram[UCHAR_MAX + 1];
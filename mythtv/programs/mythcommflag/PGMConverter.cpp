@@ -17,10 +17,40 @@
 
 using namespace commDetector2;
 
+namespace {
+
+void
+downscale(AVPicture *dst, int dstwidth, int dstheight,
+        const unsigned char *src, int srcpitch, int scale)
+{
+    /* Each output pixel is the rounded mean of a scale x scale block. */
+    const int       area = scale * scale;
+    unsigned int    sum;
+    int             rr, cc, ii, jj;
+
+    for (rr = 0; rr < dstheight; rr++)
+    {
+        const unsigned char *row = src + rr * scale * srcpitch;
+        unsigned char       *out = dst->data[0] + rr * dst->linesize[0];
+
+        for (cc = 0; cc < dstwidth; cc++)
+        {
+            sum = 0;
+            for (ii = 0; ii < scale; ii++)
+                for (jj = 0; jj < scale; jj++)
+                    sum += row[ii * srcpitch + cc * scale + jj];
+            out[cc] = (sum + area / 2) / area;
+        }
+    }
+}
+
+};  /* namespace */
+
 PGMConverter::PGMConverter(void)
     : frameno(-1)
     , width(-1)
     , height(-1)
+    , scale(1)
 #ifdef PGM_CONVERT_GREYSCALE
     , time_reported(false)
     , m_copy(NULL)
@@ -52,8 +82,30 @@ PGMConverter::MythPlayerInited(const MythPlayer *player)
         return 0;
 
     QSize buf_dim = player->GetVideoBufferSize();
-    width  = buf_dim.width();
-    height = buf_dim.height();
+
+#ifdef PGM_CONVERT_GREYSCALE
+    /*
+     * TUNABLE:
+     *
+     * When the player was asked for a low resolution decode but the codec
+     * could not provide one (only MPEG-1/2 support it), average the luma
+     * down by powers of two until the image is about as wide as a low
+     * resolution MPEG-2 decode would be. The detectors only need coarse
+     * luma, and their cost grows with the number of pixels.
+     */
+    static const int    MINWIDTH = 320;
+    static const int    MAXSCALE = 8;
+
+    scale = 1;
+    if (player->IsDecodingLowRes())
+    {
+        while (scale < MAXSCALE && buf_dim.width() / (scale * 2) >= MINWIDTH)
+            scale *= 2;
+    }
+#endif /* PGM_CONVERT_GREYSCALE */
+
+    width  = buf_dim.width() / scale;
+    height = buf_dim.height() / scale;
 
 #ifdef PGM_CONVERT_GREYSCALE
     if (avpicture_alloc(&pgm, AV_PIX_FMT_GRAY8, width, height))
@@ -68,8 +120,17 @@ PGMConverter::MythPlayerInited(const MythPlayer *player)
         delete m_copy;
     }
     m_copy = new MythAVCopy;
-    LOG(VB_COMMFLAG, LOG_INFO, QString("PGMConverter::MythPlayerInited "
-                                       "using true greyscale conversion"));
+    if (scale > 1)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, QString("PGMConverter::MythPlayerInited "
+                                           "using 1/%1 scale luma (%2x%3)")
+                .arg(scale).arg(width).arg(height));
+    }
+    else
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, QString("PGMConverter::MythPlayerInited "
+                                           "using true greyscale conversion"));
+    }
 #else  /* !PGM_CONVERT_GREYSCALE */
     LOG(VB_COMMFLAG, LOG_INFO, QString("PGMConverter::MythPlayerInited "
                                        "(YUV shortcut)"));
@@ -97,7 +158,19 @@ PGMConverter::getImage(const VideoFrame *frame, long long _frameno,
 
 #ifdef PGM_CONVERT_GREYSCALE
     (void)gettimeofday(&start, NULL);
-    if (m_copy->Copy(&pgm, frame, pgm.data[0], AV_PIX_FMT_GRAY8) < 0)
+    if (scale > 1)
+    {
+        if (frame->codec != FMT_YV12 && frame->codec != FMT_NV12)
+        {
+            LOG(VB_COMMFLAG, LOG_ERR,
+                QString("PGMConverter::getImage cannot scale frame type %1")
+                    .arg(frame->codec));
+            goto error;
+        }
+        downscale(&pgm, width, height, frame->buf + frame->offsets[0],
+                frame->pitches[0], scale);
+    }
+    else if (m_copy->Copy(&pgm, frame, pgm.data[0], AV_PIX_FMT_GRAY8) < 0)
         goto error;
     (void)gettimeofday(&end, NULL);
     timersub(&end, &start, &elapsed);
@@ -123,6 +196,13 @@ error:
     return NULL;
 }
 
+void
+PGMConverter::getDimensions(int *pwidth, int *pheight) const
+{
+    *pwidth = width;
+    *pheight = height;
+}
+
 int
 PGMConverter::reportTime(void)
 {
@@ -37,11 +37,13 @@ public:
     int MythPlayerInited(const MythPlayer *player);
     const AVPicture *getImage(const VideoFrame *frame, long long frameno,
             int *pwidth, int *pheight);
+    void getDimensions(int *pwidth, int *pheight) const;
     int reportTime(void);
 
 private:
     long long       frameno;            /* frame number */
-    int             width, height;      /* frame dimensions */
+    int             width, height;      /* image dimensions */
+    int             scale;              /* frame pixels per image pixel */
     AVPicture       pgm;                /* grayscale frame */
 #ifdef PGM_CONVERT_GREYSCALE
     struct timeval  convert_time;
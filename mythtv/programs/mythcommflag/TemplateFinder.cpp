@@ -801,9 +801,11 @@ TemplateFinder::MythPlayerInited(MythPlayer *player, long long nframes)
     QString tmpldims, playerdims;
 
     (void)nframes; /* gcc */
-    QSize buf_dim = player->GetVideoBufferSize();
-    width  = buf_dim.width();
-    height = buf_dim.height();
+    if (pgmConverter->MythPlayerInited(player))
+        goto free_tmpl;
+
+    /* The converter may hand out scaled down images. */
+    pgmConverter->getDimensions(&width, &height);
     playerdims = QString("%1x%2").arg(width).arg(height);
 
     if (debug_template)
@@ -823,9 +825,6 @@ TemplateFinder::MythPlayerInited(MythPlayer *player, long long nframes)
         }
     }
 
-    if (pgmConverter->MythPlayerInited(player))
-        goto free_tmpl;
-
     if (borderDetector->MythPlayerInited(player))
         goto free_tmpl;
 
@@ -22,6 +22,7 @@ using namespace std;
 #include "CommDetector2.h"
 #include "FrameAnalyzer.h"
 #include "pgm.h"
+#include "pgmkernels.h"
 #include "PGMConverter.h"
 #include "EdgeDetector.h"
 #include "BlankFrameDetector.h"
@@ -37,13 +38,8 @@ int pgm_set(const AVPicture *pict, int height)
 {
     const int   width = pict->linesize[0];
     const int   size = height * width;
-    int         score, ii;
 
-    score = 0;
-    for (ii = 0; ii < size; ii++)
-        if (pict->data[0][ii])
-            score++;
-    return score;
+    return pgm_kernels()->count_set(pict->data[0], size);
 }
 
 int pgm_match(const AVPicture *tmpl, const AVPicture *test, int height,
@@ -61,6 +57,14 @@ int pgm_match(const AVPicture *tmpl, const AVPicture *test, int height,
         return -1;
     }
 
+    if (!radius)
+    {
+        /* No jitter: an edge pixel matches only the same test pixel. */
+        *pscore = pgm_kernels()->count_both_set(tmpl->data[0], test->data[0],
+                height * width);
+        return 0;
+    }
+
     score = 0;
     for (rr = 0; rr < height; rr++)
     {
@@ -501,6 +505,21 @@ error:
     return ANALYZE_ERROR;
 }
 
+/*
+ * Copy the per-frame match counts for frames [first, last) from a matcher
+ * that was run over that part of the recording.
+ */
+void
+TemplateMatcher::mergeFrames(const TemplateMatcher *other, long long first,
+        long long last)
+{
+    if (!matches || !other->matches || first >= last)
+        return;
+
+    memcpy(&matches[first], &other->matches[first],
+            (last - first) * sizeof(*matches));
+}
+
 int
 TemplateMatcher::finished(long long nframes, bool final)
 {
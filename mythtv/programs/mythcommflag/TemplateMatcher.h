@@ -51,6 +51,8 @@ public:
     const FrameAnalyzer::FrameMap *getBreaks(void) const { return &breakMap; }
     int adjustForBlanks(const BlankFrameDetector *bf, long long nframes);
     int computeBreaks(FrameMap *breaks);
+    void mergeFrames(const TemplateMatcher *other, long long first,
+            long long last);
 
 private:
     PGMConverter            *pgmConverter;
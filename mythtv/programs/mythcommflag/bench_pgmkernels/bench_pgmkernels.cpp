@@ -0,0 +1,259 @@
+/*
+ *  PGM kernel benchmark and regression check
+ *
+ *  Runs the convolution, squared gradient magnitude and pixel count kernels
+ *  of every instruction set the running CPU supports over greyscale images,
+ *  checks that their output is bit-exact against the C kernels and reports
+ *  how long each set takes per image. Without arguments a few synthetic
+ *  images are used; pass binary (P5) PGM files, for instance those written
+ *  by mythcommflag's debug output, to test on recorded frames.
+ *
+ *  Usage: bench_pgmkernels [-n iterations] [image.pgm ...]
+ *
+ *  Exits with status 1 if any kernel disagrees with the C version.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+using namespace std;
+
+#include <QElapsedTimer>
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+#include "pgmkernels.h"
+
+/* Same mask as CannyEdgeDetector: sigma 0.5, radius 2. */
+static const int MASK_RADIUS = 2;
+static const int MASK_WIDTH = 2 * MASK_RADIUS + 1;
+
+struct Image
+{
+    QString                 name;
+    int                     width;
+    int                     height;
+    vector<unsigned char>   data;
+};
+
+/* Everything a kernel set produces for one image. */
+struct Output
+{
+    vector<unsigned char>   convolved;
+    vector<unsigned int>    sgm;
+    int                     nset;
+    int                     nboth;
+};
+
+static void make_mask(double *mask)
+{
+    const double    TWO_SIGMA2 = 2 * 0.5 * 0.5;
+    double          sum = 1.0;
+
+    mask[MASK_RADIUS] = 1.0;
+    for (int rr = 1; rr <= MASK_RADIUS; rr++)
+    {
+        double val = exp(-(rr * rr) / TWO_SIGMA2);
+        mask[MASK_RADIUS + rr] = val;
+        mask[MASK_RADIUS - rr] = val;
+        sum += 2 * val;
+    }
+    for (int ii = 0; ii < MASK_WIDTH; ii++)
+        mask[ii] /= sum;
+}
+
+static bool read_pgm(const char *filename, Image &img)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp)
+    {
+        fprintf(stderr, "%s: cannot open\n", filename);
+        return false;
+    }
+
+    int  maxgray = 0;
+    bool ok = fscanf(fp, "P5 %d %d %d", &img.width, &img.height,
+                     &maxgray) == 3 && fgetc(fp) != EOF &&
+              img.width > 0 && img.height > 0 && maxgray == 255;
+    if (ok)
+    {
+        img.name = QString(filename).section('/', -1);
+        img.data.resize(img.width * img.height);
+        ok = fread(&img.data[0], 1, img.data.size(), fp) == img.data.size();
+    }
+    fclose(fp);
+
+    if (!ok)
+        fprintf(stderr, "%s: not an 8 bit binary PGM\n", filename);
+    return ok;
+}
+
+/*
+ * Gradients, hard edged boxes and noise, so every kernel sees flat areas,
+ * edges and zero runs.
+ */
+static Image synthetic(int width, int height)
+{
+    Image img;
+    img.name = QString("synthetic %1x%2").arg(width).arg(height);
+    img.width = width;
+    img.height = height;
+    img.data.resize(width * height);
+
+    srand(width * height);
+    for (int rr = 0; rr < height; rr++)
+    {
+        for (int cc = 0; cc < width; cc++)
+        {
+            int val = (rr * 255 / height + cc * 255 / width) / 2;
+            if ((rr / 48 + cc / 64) % 3 == 0)
+                val = 0;
+            else if ((rr / 48 + cc / 64) % 3 == 1)
+                val = min(255, val + rand() % 32);
+            img.data[rr * width + cc] = val;
+        }
+    }
+    return img;
+}
+
+static void run(const PGMKernels *kernels, const Image &img,
+                const double *mask, Output &out)
+{
+    const int width = img.width + 2 * MASK_RADIUS;
+    const int height = img.height + 2 * MASK_RADIUS;
+    vector<unsigned char> padded(width * height, 0);
+    vector<unsigned char> scratch(width * height, 0);
+
+    for (int rr = 0; rr < img.height; rr++)
+    {
+        memcpy(&padded[(rr + MASK_RADIUS) * width + MASK_RADIUS],
+               &img.data[rr * img.width], img.width);
+    }
+
+    out.convolved.assign(width * height, 0);
+    for (int rr = MASK_RADIUS; rr < height - MASK_RADIUS; rr++)
+    {
+        kernels->convolve(&scratch[rr * width + MASK_RADIUS],
+                          &padded[(rr - MASK_RADIUS) * width + MASK_RADIUS],
+                          img.width, width, mask, MASK_WIDTH);
+    }
+    for (int rr = MASK_RADIUS; rr < height - MASK_RADIUS; rr++)
+    {
+        kernels->convolve(&out.convolved[rr * width + MASK_RADIUS],
+                          &scratch[rr * width], img.width, 1,
+                          mask, MASK_WIDTH);
+    }
+
+    out.sgm.assign(width * height, 0);
+    for (int rr = 0; rr < height - 1; rr++)
+    {
+        kernels->sgm(&out.sgm[rr * width], &out.convolved[rr * width],
+                     &out.convolved[(rr + 1) * width], width - 1);
+    }
+
+    out.nset = kernels->count_set(&img.data[0], img.data.size());
+    out.nboth = kernels->count_both_set(&img.data[0], &padded[0],
+                                        img.data.size());
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = 20;
+    vector<Image> images;
+
+    for (int ii = 1; ii < argc; ii++)
+    {
+        if (!strcmp(argv[ii], "-n") && ii + 1 < argc)
+        {
+            iterations = max(1, atoi(argv[++ii]));
+            continue;
+        }
+        Image img;
+        if (!read_pgm(argv[ii], img))
+            return 2;
+        images.push_back(img);
+    }
+    if (images.empty())
+    {
+        images.push_back(synthetic(720, 480));
+        images.push_back(synthetic(1280, 720));
+        images.push_back(synthetic(1920, 1080));
+        images.push_back(synthetic(1917, 1077));
+    }
+
+    double mask[MASK_WIDTH];
+    make_mask(mask);
+
+    int count;
+    const PGMKernels *kernels = pgm_kernel_list(&count);
+    int cpu = av_get_cpu_flags();
+    int failures = 0;
+
+    printf("Selected kernels: %s\n", pgm_kernels()->name);
+
+    for (size_t jj = 0; jj < images.size(); jj++)
+    {
+        const Image &img = images[jj];
+        Output reference;
+        qint64 reference_ns = 0;
+
+        printf("%s\n", qPrintable(img.name));
+        for (int kk = 0; kk < count; kk++)
+        {
+            if ((cpu & kernels[kk].cpu_flags) != kernels[kk].cpu_flags)
+            {
+                printf("  %-6s not supported by this CPU\n", kernels[kk].name);
+                continue;
+            }
+
+            Output out;
+            QElapsedTimer timer;
+            timer.start();
+            for (int ii = 0; ii < iterations; ii++)
+                run(&kernels[kk], img, mask, out);
+            qint64 ns = timer.nsecsElapsed() / iterations;
+
+            bool exact = true;
+            if (kk == 0)
+            {
+                reference = out;
+                reference_ns = ns;
+            }
+            else
+            {
+                exact = out.convolved == reference.convolved &&
+                        out.sgm == reference.sgm &&
+                        out.nset == reference.nset &&
+                        out.nboth == reference.nboth;
+                if (!exact)
+                    failures++;
+            }
+
+            printf("  %-6s %8.3f ms %6.2fx  %s\n", kernels[kk].name,
+                   ns / 1e6, ns ? (double)reference_ns / ns : 0.0,
+                   exact ? "ok" : "MISMATCH");
+        }
+    }
+
+    return failures ? 1 : 0;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
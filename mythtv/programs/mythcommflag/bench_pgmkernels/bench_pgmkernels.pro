@@ -0,0 +1,29 @@
+include ( ../../../settings.pro )
+
+QT += xml sql network
+
+TEMPLATE = app
+TARGET = bench_pgmkernels
+DEPENDPATH += . ..
+INCLUDEPATH += . .. ../../.. ../../../libs/libmythbase ../../../external/FFmpeg
+
+LIBS += -L../../../libs/libmythbase -lmythbase-$$LIBVERSION
+LIBS += -L../../../external/FFmpeg/libavutil -lmythavutil
+
+contains(CONFIG_MYTHLOGSERVER, "yes") {
+  LIBS += -L../../../external/zeromq/src/.libs -lmythzmq
+  LIBS += -L../../../external/nzmqt/src -lmythnzmqt
+  QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../external/zeromq/src/.libs/
+  QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../external/nzmqt/src/
+}
+
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../external/FFmpeg/libavutil
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../libs/libmythbase
+
+# Input
+HEADERS += ../pgmkernels.h
+SOURCES += bench_pgmkernels.cpp ../pgmkernels.cpp
+
+QMAKE_CLEAN += $(TARGET)
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
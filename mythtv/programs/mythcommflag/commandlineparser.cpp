@@ -61,6 +61,15 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
         "off, blank, scene, blankscene, logo, all, "
         "d2, d2_logo, d2_blank, d2_scene, d2_all", "")
             ->SetGroup("Commflagging");
+    add("--segments", "segments", 0U,
+        "Split a completed recording into this many parts and flag them "
+        "in parallel (d2 methods only).", "")
+            ->SetGroup("Commflagging");
+    add("--fullres", "fullres", false,
+        "Decode and analyse frames at full resolution. Slower, intended "
+        "as a reference when judging the default reduced resolution "
+        "analysis.", "")
+            ->SetGroup("Commflagging");
     add("--outputmethod", "outputmethod", "",
         "Format of output written to outputfile, essentials, full.", "")
             ->SetGroup("Commflagging");
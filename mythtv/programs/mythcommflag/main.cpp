@@ -522,11 +522,62 @@ static void incomingCustomEvent(QEvent* e)
     }
 }
 
+/// Opens further players on the recording for segment-parallel flagging
+class SegmentPlayerSource : public CommFlagPlayerSource
+{
+  public:
+    SegmentPlayerSource(const ProgramInfo *pginfo, const QString &filename,
+                        PlayerFlags flags) :
+        m_pginfo(pginfo), m_filename(filename), m_flags(flags) {}
+
+    ~SegmentPlayerSource()
+    {
+        QMap<MythPlayer*, PlayerContext*>::iterator it = m_contexts.begin();
+        for (; it != m_contexts.end(); ++it)
+            delete *it;
+    }
+
+    MythPlayer *CreatePlayer(void)
+    {
+        RingBuffer *rbuf = RingBuffer::Create(m_filename, false);
+        if (!rbuf)
+            return NULL;
+
+        MythCommFlagPlayer *cfp = new MythCommFlagPlayer(m_flags);
+        PlayerContext *ctx = new PlayerContext(kFlaggerInUseID);
+        ctx->SetPlayingInfo(m_pginfo);
+        ctx->SetRingBuffer(rbuf);
+        ctx->SetPlayer(cfp);
+        cfp->SetPlayerInfo(NULL, NULL, ctx);
+
+        m_contexts[cfp] = ctx;
+        return cfp;
+    }
+
+    void DeletePlayer(MythPlayer *player)
+    {
+        delete m_contexts.take(player);
+    }
+
+    bool GetKeyframes(frm_pos_map_t &keyframes)
+    {
+        m_pginfo->QueryPositionMap(keyframes, MARK_GOP_BYFRAME);
+        return !keyframes.empty();
+    }
+
+  private:
+    const ProgramInfo                   *m_pginfo;
+    QString                              m_filename;
+    PlayerFlags                          m_flags;
+    QMap<MythPlayer*, PlayerContext*>    m_contexts;
+};
+
 static int DoFlagCommercials(
     ProgramInfo *program_info,
     bool showPercentage, bool fullSpeed, int jobid,
     MythCommFlagPlayer* cfp, enum SkipTypes commDetectMethod,
-    const QString &outputfilename, bool useDB)
+    const QString &outputfilename, bool useDB,
+    CommFlagPlayerSource *segmentSource = NULL, uint segments = 0)
 {
     CommDetectorFactory factory;
     commDetector = factory.makeCommDetector(
@@ -538,6 +589,9 @@ static int DoFlagCommercials(
         program_info->GetRecordingStartTime(),
         program_info->GetRecordingEndTime(), useDB);
 
+    if (segmentSource && segments > 1)
+        commDetector->SetParallelSegments(segmentSource, segments);
+
     if (jobid > 0)
         LOG(VB_COMMFLAG, LOG_INFO,
             QString("mythcommflag processing JobID %1").arg(jobid));
@@ -870,15 +924,24 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
 
     PlayerFlags flags = (PlayerFlags)(kAudioMuted   |
                                       kVideoIsNull  |
-                                      kDecodeLowRes |
                                       kDecodeSingleThreaded |
-                                      kDecodeNoLoopFilter |
                                       kNoITV);
-    /* blank detector needs to be only sample center for this optimization. */
-    if ((COMM_DETECT_BLANKS  == commDetectMethod) ||
-        (COMM_DETECT_2_BLANK == commDetectMethod))
+    /*
+     * The detectors only need coarse luma, so unless asked for a full
+     * resolution reference run, decode (and for d2 methods, analyse) at
+     * reduced resolution.
+     */
+    if (!cmdline.toBool("fullres"))
     {
-        flags = (PlayerFlags) (flags | kDecodeFewBlocks);
+        flags = (PlayerFlags) (flags | kDecodeLowRes | kDecodeNoLoopFilter);
+
+        /* blank detector needs to be only sample center for this
+         * optimization. */
+        if ((COMM_DETECT_BLANKS  == commDetectMethod) ||
+            (COMM_DETECT_2_BLANK == commDetectMethod))
+        {
+            flags = (PlayerFlags) (flags | kDecodeFewBlocks);
+        }
     }
 
     MythCommFlagPlayer *cfp = new MythCommFlagPlayer(flags);
@@ -921,9 +984,19 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
 
     // TODO: Add back insertion of job if not in jobqueue
 
+    /* Completed recordings can be flagged in parallel segments. */
+    uint segments = cmdline.toBool("segments") ? cmdline.toUInt("segments") :
+        gCoreContext->GetNumSetting("CommFlagSegments", 0);
+    SegmentPlayerSource *segmentSource = NULL;
+    if (useDB && !watchingRecording && segments > 1)
+        segmentSource = new SegmentPlayerSource(program_info, filename, flags);
+
     breaksFound = DoFlagCommercials(
         program_info, progress, fullSpeed, jobid,
-        cfp, commDetectMethod, outputfilename, useDB);
+        cfp, commDetectMethod, outputfilename, useDB,
+        segmentSource, segments);
+
+    delete segmentSource;
 
     if (progress)
         cerr << breaksFound << "\n";
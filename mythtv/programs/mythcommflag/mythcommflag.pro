@@ -21,10 +21,10 @@ HEADERS += ClassicCommDetector.h
 HEADERS += Histogram.h
 HEADERS += quickselect.h
 HEADERS += CommDetector2.h
-HEADERS += pgm.h
+HEADERS += pgm.h pgmkernels.h
 HEADERS += EdgeDetector.h CannyEdgeDetector.h
 HEADERS += PGMConverter.h BorderDetector.h
-HEADERS += FrameAnalyzer.h
+HEADERS += FrameAnalyzer.h FramePipeline.h
 HEADERS += TemplateFinder.h TemplateMatcher.h
 HEADERS += HistogramAnalyzer.h
 HEADERS += BlankFrameDetector.h
@@ -42,10 +42,10 @@ SOURCES += ClassicCommDetector.cpp
 SOURCES += Histogram.cpp
 SOURCES += quickselect.c
 SOURCES += CommDetector2.cpp
-SOURCES += pgm.cpp
+SOURCES += pgm.cpp pgmkernels.cpp
 SOURCES += EdgeDetector.cpp CannyEdgeDetector.cpp
 SOURCES += PGMConverter.cpp BorderDetector.cpp
-SOURCES += FrameAnalyzer.cpp
+SOURCES += FrameAnalyzer.cpp FramePipeline.cpp
 SOURCES += TemplateFinder.cpp TemplateMatcher.cpp
 SOURCES += HistogramAnalyzer.cpp
 SOURCES += BlankFrameDetector.cpp
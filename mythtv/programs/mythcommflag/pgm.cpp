@@ -8,6 +8,7 @@ extern "C" {
 #include "mythframe.h"
 #include "mythlogging.h"
 #include "pgm.h"
+#include "pgmkernels.h"
 
 // TODO: verify this
 /*
@@ -225,8 +226,9 @@ int pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
     const int       srcwidth = src->linesize[0];
     const int       newwidth = srcwidth + 2 * mask_radius;
     const int       newheight = srcheight + 2 * mask_radius;
-    int             ii, rr, cc, rr2, cc2;
-    double          sum;
+    const int       mask_width = 2 * mask_radius + 1;
+    const PGMKernels *kernels = pgm_kernels();
+    int             rr, rr2;
 
     /* Get a padded copy of the src image for use by the convolutions. */
     if (pgm_expand_uniform(s1, src, srcheight, mask_radius))
@@ -238,34 +240,19 @@ int pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
 
     /* "s1" convolve with column vector => "s2" */
     rr2 = mask_radius + srcheight;
-    cc2 = mask_radius + srcwidth;
     for (rr = mask_radius; rr < rr2; rr++)
     {
-        for (cc = mask_radius; cc < cc2; cc++)
-        {
-            sum = 0;
-            for (ii = -mask_radius; ii <= mask_radius; ii++)
-            {
-                sum += mask[ii + mask_radius] *
-                    s1->data[0][(rr + ii) * newwidth + cc];
-            }
-            s2->data[0][rr * newwidth + cc] = (unsigned char)(sum + 0.5);
-        }
+        kernels->convolve(&s2->data[0][rr * newwidth + mask_radius],
+                &s1->data[0][(rr - mask_radius) * newwidth + mask_radius],
+                srcwidth, newwidth, mask, mask_width);
     }
 
     /* "s2" convolve with row vector => "dst" */
     for (rr = mask_radius; rr < rr2; rr++)
     {
-        for (cc = mask_radius; cc < cc2; cc++)
-        {
-            sum = 0;
-            for (ii = -mask_radius; ii <= mask_radius; ii++)
-            {
-                sum += mask[ii + mask_radius] *
-                    s2->data[0][rr * newwidth + cc + ii];
-            }
-            dst->data[0][rr * newwidth + cc] = (unsigned char)(sum + 0.5);
-        }
+        kernels->convolve(&dst->data[0][rr * newwidth + mask_radius],
+                &s2->data[0][rr * newwidth],
+                srcwidth, 1, mask, mask_width);
     }
 
     return 0;
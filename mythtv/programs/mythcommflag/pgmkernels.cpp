@@ -0,0 +1,498 @@
+#include <stdint.h>
+
+#include "mythconfig.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+#include "mythlogging.h"
+#include "pgmkernels.h"
+
+/*
+ * The C kernels are the reference; keep their arithmetic exactly as in the
+ * original pgm/edge detector loops.
+ */
+
+static void
+convolve(unsigned char *dst, const unsigned char *src, int width, int stride,
+        const double *mask, int masklen)
+{
+    int         ii, jj;
+    double      sum;
+
+    for (ii = 0; ii < width; ii++)
+    {
+        sum = 0;
+        for (jj = 0; jj < masklen; jj++)
+            sum += mask[jj] * src[jj * stride + ii];
+        dst[ii] = (unsigned char)(sum + 0.5);
+    }
+}
+
+static void
+sgm(unsigned int *sgm, const unsigned char *row0, const unsigned char *row1,
+        int width)
+{
+    int         ii, dx, dy;
+
+    for (ii = 0; ii < width; ii++)
+    {
+        dx = row1[ii + 1] - row0[ii];   /* southeast - northwest */
+        dy = row1[ii] - row0[ii + 1];   /* southwest - northeast */
+        sgm[ii] = dx * dx + dy * dy;
+    }
+}
+
+static int
+count_set(const unsigned char *buf, int len)
+{
+    int         ii, count;
+
+    count = 0;
+    for (ii = 0; ii < len; ii++)
+        if (buf[ii])
+            count++;
+    return count;
+}
+
+static int
+count_both_set(const unsigned char *aa, const unsigned char *bb, int len)
+{
+    int         ii, count;
+
+    count = 0;
+    for (ii = 0; ii < len; ii++)
+        if (aa[ii] && bb[ii])
+            count++;
+    return count;
+}
+
+/*
+ * Only 64 bit x86 is handled: 32 bit builds may do the C double arithmetic
+ * in x87 extended precision, which the SSE2 kernels would not reproduce bit
+ * for bit.
+ */
+#if ARCH_X86_64
+
+static const double half = 0.5;
+
+static void
+SSE2_convolve(unsigned char *dst, const unsigned char *src, int width,
+        int stride, const double *mask, int masklen)
+{
+    const intptr_t  step = stride;
+    int             ii = 0;
+
+    if (masklen < 1)
+    {
+        convolve(dst, src, width, stride, mask, masklen);
+        return;
+    }
+
+    /* Four pixels at a time, in two pairs of doubles. */
+    for (; ii < (width & ~3); ii += 4)
+    {
+        const unsigned char *ss = &src[ii];
+        const double        *mm = mask;
+        intptr_t            nn = masklen;
+
+        asm volatile (
+            "pxor       %%xmm0, %%xmm0\n"
+            "pxor       %%xmm1, %%xmm1\n"
+            "pxor       %%xmm7, %%xmm7\n"
+            "1:\n"
+            "movd       (%[ss]), %%xmm2\n"
+            "punpcklbw  %%xmm7, %%xmm2\n"
+            "punpcklwd  %%xmm7, %%xmm2\n"
+            "cvtdq2pd   %%xmm2, %%xmm3\n"
+            "pshufd     $0xee, %%xmm2, %%xmm2\n"
+            "cvtdq2pd   %%xmm2, %%xmm2\n"
+            "movsd      (%[mm]), %%xmm4\n"
+            "unpcklpd   %%xmm4, %%xmm4\n"
+            "mulpd      %%xmm4, %%xmm3\n"
+            "mulpd      %%xmm4, %%xmm2\n"
+            "addpd      %%xmm3, %%xmm0\n"
+            "addpd      %%xmm2, %%xmm1\n"
+            "add        %[step], %[ss]\n"
+            "add        $8, %[mm]\n"
+            "dec        %[nn]\n"
+            "jnz        1b\n"
+            "movsd      (%[half]), %%xmm4\n"
+            "unpcklpd   %%xmm4, %%xmm4\n"
+            "addpd      %%xmm4, %%xmm0\n"
+            "addpd      %%xmm4, %%xmm1\n"
+            "cvttpd2dq  %%xmm0, %%xmm0\n"
+            "cvttpd2dq  %%xmm1, %%xmm1\n"
+            "punpcklqdq %%xmm1, %%xmm0\n"
+            "packssdw   %%xmm0, %%xmm0\n"
+            "packuswb   %%xmm0, %%xmm0\n"
+            "movd       %%xmm0, (%[dst])\n"
+            : [ss]"+r"(ss), [mm]"+r"(mm), [nn]"+r"(nn)
+            : [dst]"r"(&dst[ii]), [step]"r"(step), [half]"r"(&half)
+            : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm7");
+    }
+
+    if (ii < width)
+        convolve(&dst[ii], &src[ii], width - ii, stride, mask, masklen);
+}
+
+static void
+SSE2_sgm(unsigned int *sgm_out, const unsigned char *row0,
+        const unsigned char *row1, int width)
+{
+    int         ii = 0;
+
+    /*
+     * Widen to words, then pmaddwd of the interleaved (dx, dy) pairs with
+     * themselves gives dx * dx + dy * dy.
+     */
+    for (; ii < (width & ~7); ii += 8)
+    {
+        asm volatile (
+            "pxor       %%xmm7, %%xmm7\n"
+            "movq       (%[r0]), %%xmm0\n"
+            "movq       1(%[r0]), %%xmm1\n"
+            "movq       (%[r1]), %%xmm2\n"
+            "movq       1(%[r1]), %%xmm3\n"
+            "punpcklbw  %%xmm7, %%xmm0\n"
+            "punpcklbw  %%xmm7, %%xmm1\n"
+            "punpcklbw  %%xmm7, %%xmm2\n"
+            "punpcklbw  %%xmm7, %%xmm3\n"
+            "psubw      %%xmm0, %%xmm3\n"
+            "psubw      %%xmm1, %%xmm2\n"
+            "movdqa     %%xmm3, %%xmm4\n"
+            "punpcklwd  %%xmm2, %%xmm3\n"
+            "punpckhwd  %%xmm2, %%xmm4\n"
+            "pmaddwd    %%xmm3, %%xmm3\n"
+            "pmaddwd    %%xmm4, %%xmm4\n"
+            "movdqu     %%xmm3, (%[out])\n"
+            "movdqu     %%xmm4, 16(%[out])\n"
+            : : [out]"r"(&sgm_out[ii]), [r0]"r"(&row0[ii]), [r1]"r"(&row1[ii])
+            : "memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm7");
+    }
+
+    if (ii < width)
+        sgm(&sgm_out[ii], &row0[ii], &row1[ii], width - ii);
+}
+
+/*
+ * The count kernels count zero bytes per byte lane, at most 255 blocks at a
+ * time so the lanes cannot wrap, then sum the lanes with psadbw.
+ */
+static int
+SSE2_count_set(const unsigned char *buf, int len)
+{
+    const unsigned char *pp = buf;
+    int                 ii = 0, zeros = 0;
+
+    while (ii < (len & ~15))
+    {
+        intptr_t    blocks = (len - ii) / 16;
+        uint64_t    lo, hi;
+
+        if (blocks > 255)
+            blocks = 255;
+        ii += blocks * 16;
+
+        asm volatile (
+            "pxor       %%xmm7, %%xmm7\n"
+            "pxor       %%xmm1, %%xmm1\n"
+            "1:\n"
+            "movdqu     (%[pp]), %%xmm0\n"
+            "pcmpeqb    %%xmm7, %%xmm0\n"
+            "psubb      %%xmm0, %%xmm1\n"
+            "add        $16, %[pp]\n"
+            "dec        %[nn]\n"
+            "jnz        1b\n"
+            "psadbw     %%xmm7, %%xmm1\n"
+            "movq       %%xmm1, %[lo]\n"
+            "punpckhqdq %%xmm1, %%xmm1\n"
+            "movq       %%xmm1, %[hi]\n"
+            : [pp]"+r"(pp), [nn]"+r"(blocks), [lo]"=r"(lo), [hi]"=r"(hi)
+            :
+            : "memory", "cc", "xmm0", "xmm1", "xmm7");
+        zeros += lo + hi;
+    }
+
+    return ii - zeros + count_set(&buf[ii], len - ii);
+}
+
+static int
+SSE2_count_both_set(const unsigned char *aa, const unsigned char *bb,
+        int len)
+{
+    const unsigned char *pa = aa, *pb = bb;
+    int                 ii = 0, zeros = 0;
+
+    while (ii < (len & ~15))
+    {
+        intptr_t    blocks = (len - ii) / 16;
+        uint64_t    lo, hi;
+
+        if (blocks > 255)
+            blocks = 255;
+        ii += blocks * 16;
+
+        asm volatile (
+            "pxor       %%xmm7, %%xmm7\n"
+            "pxor       %%xmm1, %%xmm1\n"
+            "1:\n"
+            "movdqu     (%[pa]), %%xmm0\n"
+            "movdqu     (%[pb]), %%xmm2\n"
+            "pcmpeqb    %%xmm7, %%xmm0\n"
+            "pcmpeqb    %%xmm7, %%xmm2\n"
+            "por        %%xmm2, %%xmm0\n"
+            "psubb      %%xmm0, %%xmm1\n"
+            "add        $16, %[pa]\n"
+            "add        $16, %[pb]\n"
+            "dec        %[nn]\n"
+            "jnz        1b\n"
+            "psadbw     %%xmm7, %%xmm1\n"
+            "movq       %%xmm1, %[lo]\n"
+            "punpckhqdq %%xmm1, %%xmm1\n"
+            "movq       %%xmm1, %[hi]\n"
+            : [pa]"+r"(pa), [pb]"+r"(pb), [nn]"+r"(blocks),
+              [lo]"=r"(lo), [hi]"=r"(hi)
+            :
+            : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm7");
+        zeros += lo + hi;
+    }
+
+    return ii - zeros + count_both_set(&aa[ii], &bb[ii], len - ii);
+}
+
+#if HAVE_AVX2_INLINE
+static void
+AVX2_convolve(unsigned char *dst, const unsigned char *src, int width,
+        int stride, const double *mask, int masklen)
+{
+    const intptr_t  step = stride;
+    int             ii = 0;
+
+    if (masklen < 1)
+    {
+        convolve(dst, src, width, stride, mask, masklen);
+        return;
+    }
+
+    /*
+     * Eight pixels at a time, in two sets of four doubles. Separate multiply
+     * and add (no FMA), so rounding matches the C version.
+     */
+    for (; ii < (width & ~7); ii += 8)
+    {
+        const unsigned char *ss = &src[ii];
+        const double        *mm = mask;
+        intptr_t            nn = masklen;
+
+        asm volatile (
+            "vxorpd         %%ymm0, %%ymm0, %%ymm0\n"
+            "vxorpd         %%ymm1, %%ymm1, %%ymm1\n"
+            "1:\n"
+            "vpmovzxbd      (%[ss]), %%ymm2\n"
+            "vcvtdq2pd      %%xmm2, %%ymm3\n"
+            "vextracti128   $1, %%ymm2, %%xmm2\n"
+            "vcvtdq2pd      %%xmm2, %%ymm2\n"
+            "vbroadcastsd   (%[mm]), %%ymm4\n"
+            "vmulpd         %%ymm4, %%ymm3, %%ymm3\n"
+            "vmulpd         %%ymm4, %%ymm2, %%ymm2\n"
+            "vaddpd         %%ymm3, %%ymm0, %%ymm0\n"
+            "vaddpd         %%ymm2, %%ymm1, %%ymm1\n"
+            "add            %[step], %[ss]\n"
+            "add            $8, %[mm]\n"
+            "dec            %[nn]\n"
+            "jnz            1b\n"
+            "vbroadcastsd   (%[half]), %%ymm4\n"
+            "vaddpd         %%ymm4, %%ymm0, %%ymm0\n"
+            "vaddpd         %%ymm4, %%ymm1, %%ymm1\n"
+            "vcvttpd2dqy    %%ymm0, %%xmm0\n"
+            "vcvttpd2dqy    %%ymm1, %%xmm1\n"
+            "vpackssdw      %%xmm1, %%xmm0, %%xmm0\n"
+            "vpackuswb      %%xmm0, %%xmm0, %%xmm0\n"
+            "vmovq          %%xmm0, (%[dst])\n"
+            : [ss]"+r"(ss), [mm]"+r"(mm), [nn]"+r"(nn)
+            : [dst]"r"(&dst[ii]), [step]"r"(step), [half]"r"(&half)
+            : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4");
+    }
+    // avoid the AVX to SSE transition penalty in whatever runs next
+    asm volatile ("vzeroupper");
+
+    if (ii < width)
+        convolve(&dst[ii], &src[ii], width - ii, stride, mask, masklen);
+}
+
+static void
+AVX2_sgm(unsigned int *sgm_out, const unsigned char *row0,
+        const unsigned char *row1, int width)
+{
+    int         ii = 0;
+
+    /*
+     * vpunpck[lh]wd work within each 128 bit lane, so vperm2i128 puts the
+     * sixteen results back in pixel order.
+     */
+    for (; ii < (width & ~15); ii += 16)
+    {
+        asm volatile (
+            "vpmovzxbw      (%[r0]), %%ymm0\n"
+            "vpmovzxbw      1(%[r0]), %%ymm1\n"
+            "vpmovzxbw      (%[r1]), %%ymm2\n"
+            "vpmovzxbw      1(%[r1]), %%ymm3\n"
+            "vpsubw         %%ymm0, %%ymm3, %%ymm3\n"
+            "vpsubw         %%ymm1, %%ymm2, %%ymm2\n"
+            "vpunpcklwd     %%ymm2, %%ymm3, %%ymm4\n"
+            "vpunpckhwd     %%ymm2, %%ymm3, %%ymm5\n"
+            "vpmaddwd       %%ymm4, %%ymm4, %%ymm4\n"
+            "vpmaddwd       %%ymm5, %%ymm5, %%ymm5\n"
+            "vperm2i128     $0x20, %%ymm5, %%ymm4, %%ymm0\n"
+            "vperm2i128     $0x31, %%ymm5, %%ymm4, %%ymm1\n"
+            "vmovdqu        %%ymm0, (%[out])\n"
+            "vmovdqu        %%ymm1, 32(%[out])\n"
+            : : [out]"r"(&sgm_out[ii]), [r0]"r"(&row0[ii]), [r1]"r"(&row1[ii])
+            : "memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5");
+    }
+    asm volatile ("vzeroupper");
+
+    if (ii < width)
+        SSE2_sgm(&sgm_out[ii], &row0[ii], &row1[ii], width - ii);
+}
+
+static int
+AVX2_count_set(const unsigned char *buf, int len)
+{
+    const unsigned char *pp = buf;
+    int                 ii = 0, zeros = 0;
+
+    while (ii < (len & ~31))
+    {
+        intptr_t    blocks = (len - ii) / 32;
+        uint64_t    count;
+
+        if (blocks > 255)
+            blocks = 255;
+        ii += blocks * 32;
+
+        asm volatile (
+            "vpxor          %%ymm7, %%ymm7, %%ymm7\n"
+            "vpxor          %%ymm1, %%ymm1, %%ymm1\n"
+            "1:\n"
+            "vpcmpeqb       (%[pp]), %%ymm7, %%ymm0\n"
+            "vpsubb         %%ymm0, %%ymm1, %%ymm1\n"
+            "add            $32, %[pp]\n"
+            "dec            %[nn]\n"
+            "jnz            1b\n"
+            "vpsadbw        %%ymm7, %%ymm1, %%ymm1\n"
+            "vextracti128   $1, %%ymm1, %%xmm2\n"
+            "vpaddq         %%xmm2, %%xmm1, %%xmm1\n"
+            "vpunpckhqdq    %%xmm1, %%xmm1, %%xmm2\n"
+            "vpaddq         %%xmm2, %%xmm1, %%xmm1\n"
+            "vmovq          %%xmm1, %[count]\n"
+            "vzeroupper\n"
+            : [pp]"+r"(pp), [nn]"+r"(blocks), [count]"=r"(count)
+            :
+            : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm7");
+        zeros += count;
+    }
+
+    return ii - zeros + SSE2_count_set(&buf[ii], len - ii);
+}
+
+static int
+AVX2_count_both_set(const unsigned char *aa, const unsigned char *bb,
+        int len)
+{
+    const unsigned char *pa = aa, *pb = bb;
+    int                 ii = 0, zeros = 0;
+
+    while (ii < (len & ~31))
+    {
+        intptr_t    blocks = (len - ii) / 32;
+        uint64_t    count;
+
+        if (blocks > 255)
+            blocks = 255;
+        ii += blocks * 32;
+
+        asm volatile (
+            "vpxor          %%ymm7, %%ymm7, %%ymm7\n"
+            "vpxor          %%ymm1, %%ymm1, %%ymm1\n"
+            "1:\n"
+            "vpcmpeqb       (%[pa]), %%ymm7, %%ymm0\n"
+            "vpcmpeqb       (%[pb]), %%ymm7, %%ymm2\n"
+            "vpor           %%ymm2, %%ymm0, %%ymm0\n"
+            "vpsubb         %%ymm0, %%ymm1, %%ymm1\n"
+            "add            $32, %[pa]\n"
+            "add            $32, %[pb]\n"
+            "dec            %[nn]\n"
+            "jnz            1b\n"
+            "vpsadbw        %%ymm7, %%ymm1, %%ymm1\n"
+            "vextracti128   $1, %%ymm1, %%xmm2\n"
+            "vpaddq         %%xmm2, %%xmm1, %%xmm1\n"
+            "vpunpckhqdq    %%xmm1, %%xmm1, %%xmm2\n"
+            "vpaddq         %%xmm2, %%xmm1, %%xmm1\n"
+            "vmovq          %%xmm1, %[count]\n"
+            "vzeroupper\n"
+            : [pa]"+r"(pa), [pb]"+r"(pb), [nn]"+r"(blocks),
+              [count]"=r"(count)
+            :
+            : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm7");
+        zeros += count;
+    }
+
+    return ii - zeros + SSE2_count_both_set(&aa[ii], &bb[ii], len - ii);
+}
+#endif /* HAVE_AVX2_INLINE */
+#endif /* ARCH_X86_64 */
+
+/* Ordered from slowest to fastest, the first entry must need no CPU flags. */
+static const PGMKernels kernel_list[] =
+{
+    { "C",      0,                  convolve,       sgm,
+        count_set,          count_both_set          },
+#if ARCH_X86_64
+    { "SSE2",   AV_CPU_FLAG_SSE2,   SSE2_convolve,  SSE2_sgm,
+        SSE2_count_set,     SSE2_count_both_set     },
+#if HAVE_AVX2_INLINE
+    { "AVX2",   AV_CPU_FLAG_AVX2,   AVX2_convolve,  AVX2_sgm,
+        AVX2_count_set,     AVX2_count_both_set     },
+#endif
+#endif
+};
+
+/*
+ * All kernels compiled in, slowest first, whether or not this CPU supports
+ * them. Check cpu_flags before calling one.
+ */
+const PGMKernels *
+pgm_kernel_list(int *count)
+{
+    *count = sizeof(kernel_list) / sizeof(kernel_list[0]);
+    return kernel_list;
+}
+
+/*
+ * The fastest kernels this CPU supports, chosen at the first call.
+ */
+const PGMKernels *
+pgm_kernels(void)
+{
+    static const PGMKernels *best = NULL;
+    if (best)
+        return best;
+
+    const int           flags = av_get_cpu_flags();
+    const PGMKernels    *found = &kernel_list[0];
+    int                 count = sizeof(kernel_list) / sizeof(kernel_list[0]);
+
+    for (int ii = 1; ii < count; ii++)
+    {
+        if ((flags & kernel_list[ii].cpu_flags) == kernel_list[ii].cpu_flags)
+            found = &kernel_list[ii];
+    }
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("Using %1 PGM kernels").arg(found->name));
+    best = found;
+    return best;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,48 @@
+/*
+ * pgmkernels.h
+ *
+ * Inner loops of the PGM (greyscale) image routines, in plain C and in
+ * SIMD versions selected at runtime. Every version produces exactly the
+ * same output as the C one.
+ */
+
+#ifndef __PGMKERNELS_H__
+#define __PGMKERNELS_H__
+
+typedef struct PGMKernels_
+{
+    const char  *name;
+    int         cpu_flags;  /* AV_CPU_FLAG_* needed to use these */
+
+    /*
+     * One-dimensional convolution of "width" pixels:
+     *
+     *   dst[ii] = (unsigned char)(sum(mask[jj] * src[jj * stride + ii]) + 0.5)
+     *
+     * summed in double precision in order of increasing jj. A stride of one
+     * convolves along a row, a stride of the line size along a column.
+     */
+    void (*convolve)(unsigned char *dst, const unsigned char *src, int width,
+            int stride, const double *mask, int masklen);
+
+    /*
+     * Squared gradient magnitude of "width" pixels on a 45-degree rotated
+     * set of axes; reads width + 1 pixels of each row.
+     */
+    void (*sgm)(unsigned int *sgm, const unsigned char *row0,
+            const unsigned char *row1, int width);
+
+    /* Number of nonzero pixels. */
+    int (*count_set)(const unsigned char *buf, int len);
+
+    /* Number of pixels that are nonzero in both buffers. */
+    int (*count_both_set)(const unsigned char *aa, const unsigned char *bb,
+            int len);
+} PGMKernels;
+
+const PGMKernels *pgm_kernels(void);
+const PGMKernels *pgm_kernel_list(int *count);
+
+#endif  /* !__PGMKERNELS_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -308,23 +308,17 @@ bool FillData::GrabDDData(Source source, int poffset,
 // XMLTV stuff
 bool FillData::GrabDataFromFile(int id, QString &filename)
 {
-    ChannelInfoList chanlist;
-    QMap<QString, QList<ProgInfo> > proglist;
+    uint progcount = 0;
 
     xmltv_parser.lateInit();
-    if (!xmltv_parser.parseFile(filename, &chanlist, &proglist))
+    if (!xmltv_parser.parseFile(filename, id, &chan_data, progcount))
         return false;
 
-    chan_data.handleChannels(id, &chanlist);
-    if (proglist.count() == 0)
+    if (progcount == 0)
     {
         LOG(VB_GENERAL, LOG_INFO, "No programs found in data.");
         endofdata = true;
     }
-    else
-    {
-        prog_data.HandlePrograms(id, proglist);
-    }
     return true;
 }
 
@@ -4,8 +4,9 @@
 #include <QFile>
 #include <QStringList>
 #include <QDateTime>
-#include <QDomDocument>
 #include <QUrl>
+#include <QMap>
+#include <QXmlStreamReader>
 
 // C++ headers
 #include <iostream>
@@ -29,6 +30,9 @@
 #include "channeldata.h"
 #include "fillutil.h"
 
+// Most programmes of one channel held in memory before some are stored
+static const int kMaxPendingPrograms = 1000;
+
 XMLTVParser::XMLTVParser() : current_year(0)
 {
     current_year = MythDate::current().date().toString("yyyy").toUInt();
@@ -60,64 +64,93 @@ static uint ELFHash(const QByteArray &ba)
     return h;
 }
 
-static QString getFirstText(QDomElement element)
+// Text directly inside the element the reader is on, which is left on the
+// matching end element.
+static QString readText(QXmlStreamReader &xml)
+{
+    return xml.readElementText(QXmlStreamReader::SkipChildElements);
+}
+
+// Text of the first <value> element anywhere below the element the reader
+// is on. The rest of the element is skipped.
+static bool readFirstValue(QXmlStreamReader &xml, QString &value)
 {
-    for (QDomNode dname = element.firstChild(); !dname.isNull();
-         dname = dname.nextSibling())
+    bool found = false;
+    int depth = 1;
+
+    while (depth > 0 && !xml.atEnd())
     {
-        QDomText t = dname.toText();
-        if (!t.isNull())
-            return t.data();
+        xml.readNext();
+        if (xml.isStartElement())
+        {
+            if (!found && xml.name() == "value")
+            {
+                value = readText(xml);
+                found = true;
+            }
+            else
+            {
+                ++depth;
+            }
+        }
+        else if (xml.isEndElement())
+        {
+            --depth;
+        }
     }
-    return QString();
+
+    return found;
 }
 
-ChannelInfo *XMLTVParser::parseChannel(QDomElement &element, QUrl &baseUrl)
+ChannelInfo *XMLTVParser::parseChannel(QXmlStreamReader &xml, QUrl &baseUrl)
 {
     ChannelInfo *chaninfo = new ChannelInfo;
 
-    QString xmltvid = element.attribute("id", "");
+    QString xmltvid = xml.attributes().value("id").toString();
 
     chaninfo->xmltvid = xmltvid;
     chaninfo->tvformat = "Default";
 
-    for (QDomNode child = element.firstChild(); !child.isNull();
-         child = child.nextSibling())
+    while (xml.readNextStartElement())
     {
-        QDomElement info = child.toElement();
-        if (!info.isNull())
+        if (xml.name() == "icon")
         {
-            if (info.tagName() == "icon")
+            QString path = xml.attributes().value("src").toString();
+            if (!path.isEmpty() && !path.contains("://"))
             {
-                QString path = info.attribute("src", "");
-                if (!path.isEmpty() && !path.contains("://"))
-                {
-                    QString base = baseUrl.toString(QUrl::StripTrailingSlash);
-                    chaninfo->icon = base +
-                        ((path.startsWith("/")) ? path : QString("/") + path);
-                }
-                else if (!path.isEmpty())
-                {
-                    QUrl url(path);
-                    if (url.isValid())
-                        chaninfo->icon = url.toString();
-                }
+                QString base = baseUrl.toString(QUrl::StripTrailingSlash);
+                chaninfo->icon = base +
+                    ((path.startsWith("/")) ? path : QString("/") + path);
             }
-            else if (info.tagName() == "display-name")
+            else if (!path.isEmpty())
             {
-                if (chaninfo->name.isEmpty())
-                {
-                    chaninfo->name = info.text();
-                }
-                else if (chaninfo->callsign.isEmpty())
-                {
-                    chaninfo->callsign = info.text();
-                }
-                else if (chaninfo->channum.isEmpty())
-                {
-                    chaninfo->channum = info.text();
-                }
+                QUrl url(path);
+                if (url.isValid())
+                    chaninfo->icon = url.toString();
             }
+            xml.skipCurrentElement();
+        }
+        else if (xml.name() == "display-name")
+        {
+            QString text =
+                xml.readElementText(QXmlStreamReader::IncludeChildElements);
+
+            if (chaninfo->name.isEmpty())
+            {
+                chaninfo->name = text;
+            }
+            else if (chaninfo->callsign.isEmpty())
+            {
+                chaninfo->callsign = text;
+            }
+            else if (chaninfo->channum.isEmpty())
+            {
+                chaninfo->channum = text;
+            }
+        }
+        else
+        {
+            xml.skipCurrentElement();
         }
     }
 
@@ -245,90 +278,88 @@ static void fromXMLTVDate(QString &timestr, QDateTime &dt)
     timestr = MythDate::toString(dt, MythDate::kFilename);
 }
 
-static void parseCredits(QDomElement &element, ProgInfo *pginfo)
+static void parseCredits(QXmlStreamReader &xml, ProgInfo *pginfo)
 {
-    for (QDomNode child = element.firstChild(); !child.isNull();
-         child = child.nextSibling())
+    while (xml.readNextStartElement())
     {
-        QDomElement info = child.toElement();
-        if (!info.isNull())
-            pginfo->AddPerson(info.tagName(), getFirstText(info));
+        QString role = xml.name().toString();
+        pginfo->AddPerson(role, readText(xml));
     }
 }
 
-static void parseVideo(QDomElement &element, ProgInfo *pginfo)
+static void parseVideo(QXmlStreamReader &xml, ProgInfo *pginfo)
 {
-    for (QDomNode child = element.firstChild(); !child.isNull();
-         child = child.nextSibling())
+    while (xml.readNextStartElement())
     {
-        QDomElement info = child.toElement();
-        if (!info.isNull())
+        if (xml.name() == "quality")
         {
-            if (info.tagName() == "quality")
-            {
-                if (getFirstText(info) == "HDTV")
-                    pginfo->videoProps |= VID_HDTV;
-            }
-            else if (info.tagName() == "aspect")
-            {
-                if (getFirstText(info) == "16:9")
-                    pginfo->videoProps |= VID_WIDESCREEN;
-            }
+            if (readText(xml) == "HDTV")
+                pginfo->videoProps |= VID_HDTV;
+        }
+        else if (xml.name() == "aspect")
+        {
+            if (readText(xml) == "16:9")
+                pginfo->videoProps |= VID_WIDESCREEN;
+        }
+        else
+        {
+            xml.skipCurrentElement();
         }
     }
 }
 
-static void parseAudio(QDomElement &element, ProgInfo *pginfo)
+static void parseAudio(QXmlStreamReader &xml, ProgInfo *pginfo)
 {
-    for (QDomNode child = element.firstChild(); !child.isNull();
-         child = child.nextSibling())
+    while (xml.readNextStartElement())
     {
-        QDomElement info = child.toElement();
-        if (!info.isNull())
+        if (xml.name() == "stereo")
         {
-            if (info.tagName() == "stereo")
+            QString text = readText(xml);
+            if (text == "mono")
             {
-                if (getFirstText(info) == "mono")
-                {
-                    pginfo->audioProps |= AUD_MONO;
-                }
-                else if (getFirstText(info) == "stereo")
-                {
-                    pginfo->audioProps |= AUD_STEREO;
-                }
-                else if (getFirstText(info) == "dolby" ||
-                        getFirstText(info) == "dolby digital")
-                {
-                    pginfo->audioProps |= AUD_DOLBY;
-                }
-                else if (getFirstText(info) == "surround")
-                {
-                    pginfo->audioProps |= AUD_SURROUND;
-                }
+                pginfo->audioProps |= AUD_MONO;
             }
+            else if (text == "stereo")
+            {
+                pginfo->audioProps |= AUD_STEREO;
+            }
+            else if (text == "dolby" || text == "dolby digital")
+            {
+                pginfo->audioProps |= AUD_DOLBY;
+            }
+            else if (text == "surround")
+            {
+                pginfo->audioProps |= AUD_SURROUND;
+            }
+        }
+        else
+        {
+            xml.skipCurrentElement();
         }
     }
 }
 
-ProgInfo *XMLTVParser::parseProgram(QDomElement &element)
+ProgInfo *XMLTVParser::parseProgram(QXmlStreamReader &xml)
 {
     QString programid, season, episode, totalepisodes;
     ProgInfo *pginfo = new ProgInfo();
 
-    QString text = element.attribute("start", "");
+    QXmlStreamAttributes attrs = xml.attributes();
+
+    QString text = attrs.value("start").toString();
     fromXMLTVDate(text, pginfo->starttime);
     pginfo->startts = text;
 
-    text = element.attribute("stop", "");
+    text = attrs.value("stop").toString();
     fromXMLTVDate(text, pginfo->endtime);
     pginfo->endts = text;
 
-    text = element.attribute("channel", "");
+    text = attrs.value("channel").toString();
     QStringList split = text.split(" ");
 
     pginfo->channel = split[0];
 
-    text = element.attribute("clumpidx", "");
+    text = attrs.value("clumpidx").toString();
     if (!text.isEmpty())
     {
         split = text.split('/');
@@ -336,248 +367,246 @@ ProgInfo *XMLTVParser::parseProgram(QDomElement &element)
         pginfo->clumpmax = split[1];
     }
 
-    for (QDomNode child = element.firstChild(); !child.isNull();
-         child = child.nextSibling())
+    while (xml.readNextStartElement())
     {
-        QDomElement info = child.toElement();
-        if (!info.isNull())
+        const QString tag = xml.name().toString();
+        attrs = xml.attributes();
+
+        if (tag == "title")
         {
-            if (info.tagName() == "title")
+            if (attrs.value("lang") == "ja_JP")
             {
-                if (info.attribute("lang") == "ja_JP")
-                {
-                    pginfo->title = getFirstText(info);
-                }
-                else if (info.attribute("lang") == "ja_JP@kana")
-                {
-                    pginfo->title_pronounce = getFirstText(info);
-                }
-                else if (pginfo->title.isEmpty())
-                {
-                    pginfo->title = getFirstText(info);
-                }
+                pginfo->title = readText(xml);
             }
-            else if (info.tagName() == "sub-title" &&
-                     pginfo->subtitle.isEmpty())
+            else if (attrs.value("lang") == "ja_JP@kana")
             {
-                pginfo->subtitle = getFirstText(info);
+                pginfo->title_pronounce = readText(xml);
             }
-            else if (info.tagName() == "desc" && pginfo->description.isEmpty())
+            else if (pginfo->title.isEmpty())
             {
-                pginfo->description = getFirstText(info);
+                pginfo->title = readText(xml);
             }
-            else if (info.tagName() == "category")
+            else
             {
-                const QString cat = getFirstText(info);
-
-                if (ProgramInfo::kCategoryNone == pginfo->categoryType &&
-                    string_to_myth_category_type(cat) != ProgramInfo::kCategoryNone)
-                {
-                    pginfo->categoryType = string_to_myth_category_type(cat);
-                }
-                else if (pginfo->category.isEmpty())
-                {
-                    pginfo->category = cat;
-                }
-
-                if ((cat.compare(QObject::tr("movie"),Qt::CaseInsensitive) == 0) ||
-                    (cat.compare(QObject::tr("film"),Qt::CaseInsensitive) == 0))
-                {
-                    // Hack for tv_grab_uk_rt
-                    pginfo->categoryType = ProgramInfo::kCategoryMovie;
-                }
-
-                pginfo->genres.append(cat);
-            }
-            else if (info.tagName() == "date" && !pginfo->airdate)
-            {
-                // Movie production year
-                QString date = getFirstText(info);
-                pginfo->airdate = date.left(4).toUInt();
-            }
-            else if (info.tagName() == "star-rating" && pginfo->stars == 0.0)
-            {
-                QDomNodeList values = info.elementsByTagName("value");
-                QDomElement item;
-                QString stars;
-                float num, den;
-                float rating = 0.0;
-
-                // Use the first rating to appear in the xml, this should be
-                // the most important one.
-                //
-                // Averaging is not a good idea here, any subsequent ratings
-                // are likely to represent that days recommended programmes
-                // which on a bad night could given to an average programme.
-                // In the case of uk_rt it's not unknown for a recommendation
-                // to be given to programmes which are 'so bad, you have to
-                // watch!'
-                //
-                // XMLTV uses zero based ratings and signals no rating by absence.
-                // A rating from 1 to 5 is encoded as 0/4 to 4/4.
-                // MythTV uses zero to signal no rating!
-                // The same rating is encoded as 0.2 to 1.0 with steps of 0.2, it
-                // is not encoded as 0.0 to 1.0 with steps of 0.25 because
-                // 0 signals no rating!
-                // See http://xmltv.cvs.sourceforge.net/viewvc/xmltv/xmltv/xmltv.dtd?revision=1.47&view=markup#l539
-                item = values.item(0).toElement();
-                if (!item.isNull())
-                {
-                    stars = getFirstText(item);
-                    num = stars.section('/', 0, 0).toFloat() + 1;
-                    den = stars.section('/', 1, 1).toFloat() + 1;
-                    if (0.0 < den)
-                        rating = num/den;
-                }
-
-                pginfo->stars = rating;
+                xml.skipCurrentElement();
             }
-            else if (info.tagName() == "rating")
+        }
+        else if (tag == "sub-title" && pginfo->subtitle.isEmpty())
+        {
+            pginfo->subtitle = readText(xml);
+        }
+        else if (tag == "desc" && pginfo->description.isEmpty())
+        {
+            pginfo->description = readText(xml);
+        }
+        else if (tag == "category")
+        {
+            const QString cat = readText(xml);
+
+            if (ProgramInfo::kCategoryNone == pginfo->categoryType &&
+                string_to_myth_category_type(cat) != ProgramInfo::kCategoryNone)
             {
-                // again, the structure of ratings seems poorly represented
-                // in the XML.  no idea what we'd do with multiple values.
-                QDomNodeList values = info.elementsByTagName("value");
-                QDomElement item = values.item(0).toElement();
-                if (item.isNull())
-                    continue;
-                EventRating rating;
-                rating.system = info.attribute("system", "");
-                rating.rating = getFirstText(item);
-                pginfo->ratings.append(rating);
+                pginfo->categoryType = string_to_myth_category_type(cat);
             }
-            else if (info.tagName() == "previously-shown")
+            else if (pginfo->category.isEmpty())
             {
-                pginfo->previouslyshown = true;
-
-                QString prevdate = info.attribute("start");
-                if (!prevdate.isEmpty())
-                {
-                    QDateTime date;
-                    fromXMLTVDate(prevdate, date);
-                    pginfo->originalairdate = date.date();
-                }
+                pginfo->category = cat;
             }
-            else if (info.tagName() == "credits")
+
+            if ((cat.compare(QObject::tr("movie"),Qt::CaseInsensitive) == 0) ||
+                (cat.compare(QObject::tr("film"),Qt::CaseInsensitive) == 0))
             {
-                parseCredits(info, pginfo);
+                // Hack for tv_grab_uk_rt
+                pginfo->categoryType = ProgramInfo::kCategoryMovie;
             }
-            else if (info.tagName() == "subtitles")
+
+            pginfo->genres.append(cat);
+        }
+        else if (tag == "date" && !pginfo->airdate)
+        {
+            // Movie production year
+            QString date = readText(xml);
+            pginfo->airdate = date.left(4).toUInt();
+        }
+        else if (tag == "star-rating" && pginfo->stars == 0.0)
+        {
+            QString stars;
+            float num, den;
+            float rating = 0.0;
+
+            // Use the first rating to appear in the xml, this should be
+            // the most important one.
+            //
+            // Averaging is not a good idea here, any subsequent ratings
+            // are likely to represent that days recommended programmes
+            // which on a bad night could given to an average programme.
+            // In the case of uk_rt it's not unknown for a recommendation
+            // to be given to programmes which are 'so bad, you have to
+            // watch!'
+            //
+            // XMLTV uses zero based ratings and signals no rating by absence.
+            // A rating from 1 to 5 is encoded as 0/4 to 4/4.
+            // MythTV uses zero to signal no rating!
+            // The same rating is encoded as 0.2 to 1.0 with steps of 0.2, it
+            // is not encoded as 0.0 to 1.0 with steps of 0.25 because
+            // 0 signals no rating!
+            // See http://xmltv.cvs.sourceforge.net/viewvc/xmltv/xmltv/xmltv.dtd?revision=1.47&view=markup#l539
+            if (readFirstValue(xml, stars))
             {
-                if (info.attribute("type") == "teletext")
-                    pginfo->subtitleType |= SUB_NORMAL;
-                else if (info.attribute("type") == "onscreen")
-                    pginfo->subtitleType |= SUB_ONSCREEN;
-                else if (info.attribute("type") == "deaf-signed")
-                    pginfo->subtitleType |= SUB_SIGNED;
+                num = stars.section('/', 0, 0).toFloat() + 1;
+                den = stars.section('/', 1, 1).toFloat() + 1;
+                if (0.0 < den)
+                    rating = num/den;
             }
-            else if (info.tagName() == "audio")
+
+            pginfo->stars = rating;
+        }
+        else if (tag == "rating")
+        {
+            // again, the structure of ratings seems poorly represented
+            // in the XML.  no idea what we'd do with multiple values.
+            EventRating rating;
+            rating.system = attrs.value("system").toString();
+            if (readFirstValue(xml, rating.rating))
+                pginfo->ratings.append(rating);
+        }
+        else if (tag == "previously-shown")
+        {
+            pginfo->previouslyshown = true;
+
+            QString prevdate = attrs.value("start").toString();
+            if (!prevdate.isEmpty())
             {
-                parseAudio(info, pginfo);
+                QDateTime date;
+                fromXMLTVDate(prevdate, date);
+                pginfo->originalairdate = date.date();
             }
-            else if (info.tagName() == "video")
+            xml.skipCurrentElement();
+        }
+        else if (tag == "credits")
+        {
+            parseCredits(xml, pginfo);
+        }
+        else if (tag == "subtitles")
+        {
+            if (attrs.value("type") == "teletext")
+                pginfo->subtitleType |= SUB_NORMAL;
+            else if (attrs.value("type") == "onscreen")
+                pginfo->subtitleType |= SUB_ONSCREEN;
+            else if (attrs.value("type") == "deaf-signed")
+                pginfo->subtitleType |= SUB_SIGNED;
+            xml.skipCurrentElement();
+        }
+        else if (tag == "audio")
+        {
+            parseAudio(xml, pginfo);
+        }
+        else if (tag == "video")
+        {
+            parseVideo(xml, pginfo);
+        }
+        else if (tag == "episode-num")
+        {
+            const QString system = attrs.value("system").toString();
+            const QString episodenum = readText(xml);
+
+            if (system == "dd_progid")
             {
-                parseVideo(info, pginfo);
+                // if this field includes a dot, strip it out
+                programid = episodenum;
+                int idx = programid.indexOf('.');
+                if (idx != -1)
+                    programid.remove(idx, 1);
+                /* Only EPisodes and SHows are part of a series for SD */
+                if (programid.startsWith(QString("EP")) ||
+                    programid.startsWith(QString("SH")))
+                    pginfo->seriesId = QString("EP") + programid.mid(2,8);
             }
-            else if (info.tagName() == "episode-num")
+            else if (system == "xmltv_ns")
             {
-                if (info.attribute("system") == "dd_progid")
+                int tmp;
+                episode = episodenum.section('.',1,1);
+                totalepisodes = episode.section('/',1,1).trimmed();
+                episode = episode.section('/',0,0).trimmed();
+                season = episodenum.section('.',0,0).trimmed();
+                season = season.section('/',0,0).trimmed();
+                QString part(episodenum.section('.',2,2));
+                QString partnumber(part.section('/',0,0).trimmed());
+                QString parttotal(part.section('/',1,1).trimmed());
+
+                pginfo->categoryType = ProgramInfo::kCategorySeries;
+
+                if (!season.isEmpty())
                 {
-                    QString episodenum(getFirstText(info));
-                    // if this field includes a dot, strip it out
-                    int idx = episodenum.indexOf('.');
-                    if (idx != -1)
-                        episodenum.remove(idx, 1);
-                    programid = episodenum;
-                    /* Only EPisodes and SHows are part of a series for SD */
-                    if (programid.startsWith(QString("EP")) ||
-                        programid.startsWith(QString("SH")))
-                        pginfo->seriesId = QString("EP") + programid.mid(2,8);
+                    tmp = season.toUInt() + 1;
+                    pginfo->season = tmp;
+                    season = QString::number(tmp);
+                    pginfo->syndicatedepisodenumber = QString('S' + season);
                 }
-                else if (info.attribute("system") == "xmltv_ns")
-                {
-                    int tmp;
-                    QString episodenum(getFirstText(info));
-                    episode = episodenum.section('.',1,1);
-                    totalepisodes = episode.section('/',1,1).trimmed();
-                    episode = episode.section('/',0,0).trimmed();
-                    season = episodenum.section('.',0,0).trimmed();
-                    season = season.section('/',0,0).trimmed();
-                    QString part(episodenum.section('.',2,2));
-                    QString partnumber(part.section('/',0,0).trimmed());
-                    QString parttotal(part.section('/',1,1).trimmed());
-
-                    pginfo->categoryType = ProgramInfo::kCategorySeries;
-
-                    if (!season.isEmpty())
-                    {
-                        tmp = season.toUInt() + 1;
-                        pginfo->season = tmp;
-                        season = QString::number(tmp);
-                        pginfo->syndicatedepisodenumber = QString('S' + season);
-                    }
-
-                    if (!episode.isEmpty())
-                    {
-                        tmp = episode.toUInt() + 1;
-                        pginfo->episode = tmp;
-                        episode = QString::number(tmp);
-                        pginfo->syndicatedepisodenumber.append(QString('E' + episode));
-                    }
 
-                    if (!totalepisodes.isEmpty())
-                    {
-                        pginfo->totalepisodes = totalepisodes.toUInt();
-                    }
+                if (!episode.isEmpty())
+                {
+                    tmp = episode.toUInt() + 1;
+                    pginfo->episode = tmp;
+                    episode = QString::number(tmp);
+                    pginfo->syndicatedepisodenumber.append(QString('E' + episode));
+                }
 
-                    uint partno = 0;
-                    if (!partnumber.isEmpty())
-                    {
-                        bool ok;
-                        partno = partnumber.toUInt(&ok) + 1;
-                        partno = (ok) ? partno : 0;
-                    }
+                if (!totalepisodes.isEmpty())
+                {
+                    pginfo->totalepisodes = totalepisodes.toUInt();
+                }
 
-                    if (!parttotal.isEmpty() && partno > 0)
-                    {
-                        bool ok;
-                        uint partto = parttotal.toUInt(&ok);
-                        if (ok && partnumber <= parttotal)
-                        {
-                            pginfo->parttotal  = partto;
-                            pginfo->partnumber = partno;
-                        }
-                    }
+                uint partno = 0;
+                if (!partnumber.isEmpty())
+                {
+                    bool ok;
+                    partno = partnumber.toUInt(&ok) + 1;
+                    partno = (ok) ? partno : 0;
                 }
-                else if (info.attribute("system") == "onscreen")
+
+                if (!parttotal.isEmpty() && partno > 0)
                 {
-                    pginfo->categoryType = ProgramInfo::kCategorySeries;
-                    if (pginfo->subtitle.isEmpty())
+                    bool ok;
+                    uint partto = parttotal.toUInt(&ok);
+                    if (ok && partnumber <= parttotal)
                     {
-                        pginfo->subtitle = getFirstText(info);
+                        pginfo->parttotal  = partto;
+                        pginfo->partnumber = partno;
                     }
                 }
-                else if ((info.attribute("system") == "themoviedb.org") &&
-                    (_movieGrabberPath.endsWith(QString("/tmdb3.py"))))
+            }
+            else if (system == "onscreen")
+            {
+                pginfo->categoryType = ProgramInfo::kCategorySeries;
+                if (pginfo->subtitle.isEmpty())
                 {
-                    /* text is movie/<inetref> */
-                    QString inetrefRaw(getFirstText(info));
-                    if (inetrefRaw.startsWith(QString("movie/"))) {
-                        QString inetref(QString ("tmdb3.py_") + inetrefRaw.section('/',1,1).trimmed());
-                        pginfo->inetref = inetref;
-                    }
+                    pginfo->subtitle = episodenum;
                 }
-                else if ((info.attribute("system") == "thetvdb.com") &&
-                    (_tvGrabberPath.endsWith(QString("/ttvdb.py"))))
-                {
-                    /* text is series/<inetref> */
-                    QString inetrefRaw(getFirstText(info));
-                    if (inetrefRaw.startsWith(QString("series/"))) {
-                        QString inetref(QString ("ttvdb.py_") + inetrefRaw.section('/',1,1).trimmed());
-                        pginfo->inetref = inetref;
-                        /* ProgInfo does not have a collectionref, so we don't set any */
-                    }
+            }
+            else if ((system == "themoviedb.org") &&
+                (_movieGrabberPath.endsWith(QString("/tmdb3.py"))))
+            {
+                /* text is movie/<inetref> */
+                if (episodenum.startsWith(QString("movie/"))) {
+                    QString inetref(QString ("tmdb3.py_") + episodenum.section('/',1,1).trimmed());
+                    pginfo->inetref = inetref;
                 }
             }
+            else if ((system == "thetvdb.com") &&
+                (_tvGrabberPath.endsWith(QString("/ttvdb.py"))))
+            {
+                /* text is series/<inetref> */
+                if (episodenum.startsWith(QString("series/"))) {
+                    QString inetref(QString ("ttvdb.py_") + episodenum.section('/',1,1).trimmed());
+                    pginfo->inetref = inetref;
+                    /* ProgInfo does not have a collectionref, so we don't set any */
+                }
+            }
+        }
+        else
+        {
+            xml.skipCurrentElement();
         }
     }
 
@@ -646,13 +675,33 @@ ProgInfo *XMLTVParser::parseProgram(QDomElement &element)
     return pginfo;
 }
 
+// Hands the programs collected for one channel over to the database. When
+// "keeplast" is set the last program is held back, so that it can still
+// take its end time from the next one in the file.
+static void handle_programs(uint sourceid, const QString &xmltvid,
+                            QList<ProgInfo> &pending, bool keeplast,
+                            uint &unchanged, uint &updated)
+{
+    if (pending.isEmpty())
+        return;
+
+    QList<ProgInfo> held;
+    if (keeplast)
+        held.push_back(pending.takeLast());
+
+    ProgramData::HandlePrograms(sourceid, xmltvid, pending,
+                                unchanged, updated);
+
+    pending = held;
+}
+
 bool XMLTVParser::parseFile(
-    QString filename, ChannelInfoList *chanlist,
-    QMap<QString, QList<ProgInfo> > *proglist)
+    QString filename, uint sourceid, ChannelData *chandata, uint &progcount)
 {
-    QDomDocument doc;
     QFile f;
 
+    progcount = 0;
+
     if (!dash_open(f, filename, QIODevice::ReadOnly))
     {
         LOG(VB_GENERAL, LOG_ERR,
@@ -660,107 +709,156 @@ bool XMLTVParser::parseFile(
         return false;
     }
 
-    QString errorMsg = "unknown";
-    int errorLine = 0;
-    int errorColumn = 0;
+    QXmlStreamReader xml(&f);
 
-    if (!doc.setContent(&f, &errorMsg, &errorLine, &errorColumn))
+    if (!xml.readNextStartElement())
     {
         LOG(VB_GENERAL, LOG_ERR, QString("Error in %1:%2: %3")
-            .arg(errorLine).arg(errorColumn).arg(errorMsg));
+            .arg(xml.lineNumber()).arg(xml.columnNumber())
+            .arg(xml.errorString()));
 
         f.close();
         return true;
     }
 
-    f.close();
+    QUrl baseUrl(xml.attributes().value("source-data-url").toString());
+    //QUrl sourceUrl(xml.attributes().value("source-info-url").toString());
 
-    QDomElement docElem = doc.documentElement();
+    ChannelInfoList chanlist;
 
-    QUrl baseUrl(docElem.attribute("source-data-url", ""));
-    //QUrl sourceUrl(docElem.attribute("source-info-url", ""));
+    // The programmes are kept per channel, as files don't have to group
+    // them by channel. A channel's programmes are stored once there are
+    // too many of them, keeping the last one back so that the next batch
+    // can still give it an end time, and all of them at the end.
+    QMap<QString, QList<ProgInfo> > pending;
+    uint unchanged = 0, updated = 0;
 
     QString aggregatedTitle;
     QString aggregatedDesc;
 
-    QDomNode n = docElem.firstChild();
-    while (!n.isNull())
+    while (xml.readNextStartElement())
     {
-        QDomElement e = n.toElement();
-        if (!e.isNull())
+        if (xml.name() == "channel")
+        {
+            ChannelInfo *chinfo = parseChannel(xml, baseUrl);
+            if (!chinfo->xmltvid.isEmpty())
+                chanlist.push_back(*chinfo);
+            delete chinfo;
+        }
+        else if (xml.name() == "programme")
         {
-            if (e.tagName() == "channel")
+            // The channels must be in the database before their programmes.
+            if (!chanlist.empty())
             {
-                ChannelInfo *chinfo = parseChannel(e, baseUrl);
-                if (!chinfo->xmltvid.isEmpty())
-                    chanlist->push_back(*chinfo);
-                delete chinfo;
+                chandata->handleChannels(sourceid, &chanlist);
+                chanlist.clear();
             }
-            else if (e.tagName() == "programme")
+
+            ProgInfo *pginfo = parseProgram(xml);
+
+            if (!(pginfo->starttime.isValid()))
             {
-                ProgInfo *pginfo = parseProgram(e);
+                LOG(VB_GENERAL, LOG_WARNING, QString("Invalid programme (%1), "
+                                                    "invalid start time, "
+                                                    "skipping")
+                                                    .arg(pginfo->title));
+            }
+            else if (pginfo->channel.isEmpty())
+            {
+                LOG(VB_GENERAL, LOG_WARNING, QString("Invalid programme (%1), "
+                                                    "missing channel, "
+                                                    "skipping")
+                                                    .arg(pginfo->title));
+            }
+            else if (pginfo->startts == pginfo->endts)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, QString("Invalid programme (%1), "
+                                                    "identical start and end "
+                                                    "times, skipping")
+                                                    .arg(pginfo->title));
+            }
+            else
+            {
+                bool complete = pginfo->clumpidx.isEmpty();
 
-                if (!(pginfo->starttime.isValid()))
-                {
-                    LOG(VB_GENERAL, LOG_WARNING, QString("Invalid programme (%1), "
-                                                        "invalid start time, "
-                                                        "skipping")
-                                                        .arg(pginfo->title));
-                }
-                else if (pginfo->channel.isEmpty())
+                if (!complete)
                 {
-                    LOG(VB_GENERAL, LOG_WARNING, QString("Invalid programme (%1), "
-                                                        "missing channel, "
-                                                        "skipping")
-                                                        .arg(pginfo->title));
-                }
-                else if (pginfo->startts == pginfo->endts)
-                {
-                    LOG(VB_GENERAL, LOG_WARNING, QString("Invalid programme (%1), "
-                                                        "identical start and end "
-                                                        "times, skipping")
-                                                        .arg(pginfo->title));
+                    /* append all titles/descriptions from one clump */
+                    if (pginfo->clumpidx.toInt() == 0)
+                    {
+                        aggregatedTitle.clear();
+                        aggregatedDesc.clear();
+                    }
+
+                    if (!pginfo->title.isEmpty())
+                    {
+                        if (!aggregatedTitle.isEmpty())
+                            aggregatedTitle.append(" | ");
+                        aggregatedTitle.append(pginfo->title);
+                    }
+
+                    if (!pginfo->description.isEmpty())
+                    {
+                        if (!aggregatedDesc.isEmpty())
+                            aggregatedDesc.append(" | ");
+                        aggregatedDesc.append(pginfo->description);
+                    }
+                    if (pginfo->clumpidx.toInt() ==
+                        pginfo->clumpmax.toInt() - 1)
+                    {
+                        pginfo->title = aggregatedTitle;
+                        pginfo->description = aggregatedDesc;
+                        complete = true;
+                    }
                 }
-                else
+
+                if (complete)
                 {
-                    if (pginfo->clumpidx.isEmpty())
-                        (*proglist)[pginfo->channel].push_back(*pginfo);
-                    else
+                    QList<ProgInfo> &proglist = pending[pginfo->channel];
+                    if (proglist.size() >= kMaxPendingPrograms)
                     {
-                        /* append all titles/descriptions from one clump */
-                        if (pginfo->clumpidx.toInt() == 0)
-                        {
-                            aggregatedTitle.clear();
-                            aggregatedDesc.clear();
-                        }
-
-                        if (!pginfo->title.isEmpty())
-                        {
-                            if (!aggregatedTitle.isEmpty())
-                                aggregatedTitle.append(" | ");
-                            aggregatedTitle.append(pginfo->title);
-                        }
-
-                        if (!pginfo->description.isEmpty())
-                        {
-                            if (!aggregatedDesc.isEmpty())
-                                aggregatedDesc.append(" | ");
-                            aggregatedDesc.append(pginfo->description);
-                        }
-                        if (pginfo->clumpidx.toInt() ==
-                            pginfo->clumpmax.toInt() - 1)
-                        {
-                            pginfo->title = aggregatedTitle;
-                            pginfo->description = aggregatedDesc;
-                            (*proglist)[pginfo->channel].push_back(*pginfo);
-                        }
+                        handle_programs(sourceid, pginfo->channel, proglist,
+                                        true, unchanged, updated);
                     }
+
+                    proglist.push_back(*pginfo);
+                    progcount++;
                 }
-                delete pginfo;
             }
+            delete pginfo;
         }
-        n = n.nextSibling();
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
+
+    // A file that is cut short, like a truncated download, has nothing
+    // after each channel's last programme to give it an end time, so
+    // that one is left out and the grab is reported as failed.
+    bool ok = !xml.hasError();
+    if (!ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Error in %1:%2: %3")
+            .arg(xml.lineNumber()).arg(xml.columnNumber())
+            .arg(xml.errorString()));
+    }
+
+    f.close();
+
+    if (!chanlist.empty())
+        chandata->handleChannels(sourceid, &chanlist);
+
+    QMap<QString, QList<ProgInfo> >::iterator it = pending.begin();
+    for (; it != pending.end(); ++it)
+        handle_programs(sourceid, it.key(), *it, !ok, unchanged, updated);
+
+    if (progcount)
+    {
+        LOG(VB_GENERAL, LOG_INFO,
+            QString("Updated programs: %1 Unchanged programs: %2")
+                    .arg(updated) .arg(unchanged));
     }
 
-    return true;
+    return ok;
 }
@@ -10,8 +10,9 @@
 #include "channelinfo.h"
 
 class ProgInfo;
+class ChannelData;
 class QUrl;
-class QDomElement;
+class QXmlStreamReader;
 
 class XMLTVParser
 {
@@ -19,10 +20,10 @@ class XMLTVParser
     XMLTVParser();
     void lateInit();
 
-    ChannelInfo *parseChannel(QDomElement &element, QUrl &baseUrl);
-    ProgInfo *parseProgram(QDomElement &element);
-    bool parseFile(QString filename, ChannelInfoList *chanlist,
-                   QMap<QString, QList<ProgInfo> > *proglist);
+    ChannelInfo *parseChannel(QXmlStreamReader &xml, QUrl &baseUrl);
+    ProgInfo *parseProgram(QXmlStreamReader &xml);
+    bool parseFile(QString filename, uint sourceid, ChannelData *chandata,
+                   uint &progcount);
 
   private:
     unsigned int current_year;
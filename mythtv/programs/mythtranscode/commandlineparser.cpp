@@ -39,6 +39,10 @@ void MythTranscodeCommandLineParser::LoadArguments(void)
     add(QStringList( QStringList() << "-e" << "--ostream" ), "ostream", "",
             "Output stream type: ps, dvd, ts (Default: ps)", "")
         ->SetGroup("Encoding");
+    add("--smartcut", "smartcut", false,
+            "Lossless cut of MPEG-2 or H.264 to a transport stream, "
+            "re-encoding only the GOPs at the cut points.", "")
+        ->SetGroup("Encoding");
     add("--avf", "avf", false, "Generate libavformat output file.", "")
         ->SetGroup("Encoding");
     add("--hls", "hls", false, "Generate HTTP Live Stream output.", "")
@@ -107,12 +111,19 @@ void MythTranscodeCommandLineParser::LoadArguments(void)
     add("--audiobitrate", "audiobitrate", 64, "Output Audio Bitrate (Kbits)", "")
         ->SetChildOf("avf")
         ->SetChildOf("hls");
+    add("--threads", "threads", 0, "Video encoder threads "
+            "(default: all cores, or the HLS setting for HTTP Live Streams)", "")
+        ->SetChildOf("avf")
+        ->SetChildOf("hls");
     add("--maxsegments", "maxsegments", 0, "Max HTTP Live Stream segments", "")
         ->SetChildOf("hls");
     add("--noaudioonly", "noaudioonly", 0, "Disable Audio-Only HLS Stream", "")
         ->SetChildOf("hls");
     add("--hlsstreamid", "hlsstreamid", -1, "Stream ID to process", "")
         ->SetChildOf("hls");
+    add("--hlsrenditions", "hlsrenditions", "", "Comma separated IDs of "
+            "lower bitrate streams to encode from the same decode", "")
+        ->SetChildOf("hls");
     add(QStringList(QStringList() << "-d" << "--delete" ), "delete", false,
             "Delete original after successful transcoding", "")
         ->SetGroup("Encoding");
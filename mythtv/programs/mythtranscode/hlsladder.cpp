@@ -0,0 +1,336 @@
+#include "hlsladder.h"
+
+#include <cstring>
+
+#include <QFile>
+
+#include "mythlogging.h"
+#include "mythavutil.h"
+#include "avformatwriter.h"
+
+extern "C" {
+#include "libavutil/mem.h"
+#include "libswscale/swscale.h"
+}
+
+#define LOC QString("HLSLadder: ")
+
+HLSLadder::HLSLadder()
+  : m_segmentFrames(0)
+{
+}
+
+/**
+ * Renditions still open here were not finished by Finish(), so the
+ * transcode failed part way.
+ */
+HLSLadder::~HLSLadder()
+{
+    Finish(kHLSStatusErrored, "Transcoding Errored");
+}
+
+/**
+ * Sets up a writer for each of the given streams, which must be queued
+ * renditions of the source of the main stream. Renditions that can't be
+ * produced are removed rather than left queued.
+ *
+ * \param main          The main stream, already initialised for writing.
+ * \param segmentFrames Frames per segment, as used for the main stream.
+ */
+bool HLSLadder::Init(const QList<int> &streamids, HTTPLiveStream *main,
+                     int srcWidth, int srcHeight, float aspect,
+                     int channels, int audioRate, double frameRate,
+                     int segmentFrames, const QString &preset,
+                     const QString &tune)
+{
+    m_segmentFrames = segmentFrames;
+
+    for (int i = 0; i < streamids.size(); ++i)
+    {
+        HTTPLiveStream *hls = new HTTPLiveStream(streamids[i]);
+
+        if ((hls->GetDBStatus() != kHLSStatusQueued) ||
+            (hls->GetSourceFile() != main->GetSourceFile()))
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("Stream %1 is not a queued rendition of stream %2, "
+                        "skipping it").arg(streamids[i])
+                    .arg(main->GetStreamID()));
+            delete hls;
+            continue;
+        }
+
+        // Renditions are never larger than the main stream
+        int width = hls->GetWidth();
+        if (width >= main->GetWidth())
+        {
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Stream %1 would be %2 pixels wide, the main stream "
+                        "is only %3, removing it").arg(streamids[i])
+                    .arg(width).arg(main->GetWidth()));
+            delete hls;
+            HTTPLiveStream::RemoveStream(streamids[i]);
+            continue;
+        }
+
+        // make sure dimensions are valid for MPEG codecs
+        int height = (((int)(1.0 * width / aspect)) + 15) & ~0xF;
+        width = (width + 15) & ~0xF;
+
+        hls->DisableAudioOnly();
+        hls->UpdateStatus(kHLSStatusStarting);
+        hls->UpdateSizeInfo(width, height, srcWidth, srcHeight);
+
+        Rendition *rendition = new Rendition;
+        memset(&rendition->frame, 0, sizeof(rendition->frame));
+        rendition->hls           = hls;
+        rendition->avfw          = NULL;
+        rendition->scontext      = NULL;
+        rendition->segmentFrames = 0;
+        m_renditions.append(rendition);
+
+        if (!hls->InitForWrite() || !hls->AddSegment())
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Unable to start stream %1").arg(streamids[i]));
+            return Abort(streamids.mid(i + 1));
+        }
+
+        uint size = buffersize(FMT_YV12, width, height);
+        unsigned char *buf = (unsigned char *)av_malloc(size);
+        if (!buf)
+            return Abort(streamids.mid(i + 1));
+        init(&rendition->frame, FMT_YV12, buf, width, height, size);
+
+        AVFormatWriter *avfw = new AVFormatWriter();
+        rendition->avfw = avfw;
+
+        avfw->SetContainer("mpegts");
+        avfw->SetVideoCodec("libx264");
+        avfw->SetAudioCodec("aac");
+        avfw->SetVideoBitrate(hls->GetBitrate());
+        avfw->SetWidth(width);
+        avfw->SetHeight(height);
+        avfw->SetAspect(aspect);
+        avfw->SetAudioBitrate(hls->GetAudioBitrate());
+        avfw->SetAudioChannels(channels);
+        avfw->SetAudioFrameRate(audioRate);
+        avfw->SetAudioFormat(FORMAT_S16);
+        avfw->SetFramerate(frameRate);
+        avfw->SetKeyFrameDist(30);
+        avfw->SetFilename(hls->GetCurrentFilename());
+
+        // The renditions are a fraction of the main stream's size, and are
+        // encoded one after the other on the encoder's thread
+        avfw->SetThreadCount(1);
+        avfw->SetEncodingPreset(preset);
+        avfw->SetEncodingTune(tune);
+
+        if (!avfw->Init() || !avfw->OpenFile())
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Unable to open the writer of stream %1")
+                    .arg(streamids[i]));
+            return Abort(streamids.mid(i + 1));
+        }
+
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Stream %1: %2x%3 at %4 kbps from the same decode")
+                .arg(streamids[i]).arg(width).arg(height)
+                .arg(hls->GetBitrate() / 1000));
+    }
+
+    if (m_renditions.isEmpty())
+        return true;
+
+    // Each stream's meta playlist offers all the others, so the player
+    // can adapt whichever one it was given
+    QList<HTTPLiveStream *> streams;
+    streams << main;
+    for (int i = 0; i < m_renditions.size(); ++i)
+        streams << m_renditions[i]->hls;
+
+    for (int i = 0; i < streams.size(); ++i)
+        streams[i]->WriteMetaPlaylist(streams);
+
+    for (int i = 0; i < m_renditions.size(); ++i)
+    {
+        m_renditions[i]->hls->UpdateStatus(kHLSStatusRunning);
+        m_renditions[i]->hls->UpdateStatusMessage("Transcoding");
+    }
+
+    return true;
+}
+
+/**
+ * Scales a frame written to the main stream down to each rendition and
+ * encodes it, starting a new segment first where one is due.  The
+ * timecode is the frame's source timecode, as the main stream's writer
+ * rewrites frame->timecode.
+ */
+void HLSLadder::WriteVideoFrame(const VideoFrame *frame, long long timecode)
+{
+    AVPicture imageIn, imageOut;
+    AVPictureFill(&imageIn, frame);
+
+    // 1080 line video is decoded as 1088, the last 8 lines are padding
+    int bottomBand = (frame->height == 1088) ? 8 : 0;
+
+    for (int i = 0; i < m_renditions.size(); ++i)
+    {
+        Rendition *rendition = m_renditions[i];
+        AVFormatWriter *avfw = rendition->avfw;
+
+        if ((avfw->GetFramesWritten()) &&
+            (rendition->segmentFrames > m_segmentFrames) &&
+            (avfw->NextFrameIsKeyFrame()))
+        {
+            rendition->hls->AddSegment();
+            avfw->ReOpen(rendition->hls->GetCurrentFilename());
+            rendition->segmentFrames = 0;
+        }
+
+        VideoFrame *out = &rendition->frame;
+        AVPictureFill(&imageOut, out);
+
+        rendition->scontext = sws_getCachedContext(rendition->scontext,
+            frame->width, frame->height, FrameTypeToPixelFormat(frame->codec),
+            out->width, out->height, FrameTypeToPixelFormat(out->codec),
+            SWS_FAST_BILINEAR, NULL, NULL, NULL);
+
+        sws_scale(rendition->scontext, imageIn.data, imageIn.linesize, 0,
+                  frame->height - bottomBand,
+                  imageOut.data, imageOut.linesize);
+
+        out->timecode    = timecode;
+        out->frameNumber = frame->frameNumber;
+        out->aspect      = frame->aspect;
+        out->frame_rate  = frame->frame_rate;
+
+        if (avfw->WriteVideoFrame(out) > 0)
+            ++rendition->segmentFrames;
+    }
+}
+
+/**
+ * Encodes a frame of audio for each rendition.
+ *
+ * \param timecodeOffset Timecode offset of the main stream's writer, so the
+ *                       audio of every rendition lines up with its video
+ *                       the same way.
+ */
+void HLSLadder::WriteAudioFrame(unsigned char *buf, int fnum,
+                                long long timecode, long long timecodeOffset)
+{
+    for (int i = 0; i < m_renditions.size(); ++i)
+    {
+        AVFormatWriter *avfw = m_renditions[i]->avfw;
+
+        if ((avfw->GetTimecodeOffset() == -1) && (timecodeOffset != -1))
+            avfw->SetTimecodeOffset(timecodeOffset);
+
+        long long tc = timecode;
+        avfw->WriteAudioFrame(buf, fnum, tc);
+    }
+}
+
+/**
+ * Closes the renditions that have been stopped or removed on their own,
+ * while the main stream carries on.
+ */
+void HLSLadder::CheckStop(void)
+{
+    for (int i = m_renditions.size() - 1; i >= 0; --i)
+    {
+        Rendition *rendition = m_renditions[i];
+
+        HTTPLiveStreamStatus status = rendition->hls->GetDBStatus();
+        if (status == kHLSStatusRunning)
+            continue;
+
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Stream %1 was stopped")
+                .arg(rendition->hls->GetStreamID()));
+
+        if (status == kHLSStatusStopping)
+        {
+            rendition->hls->UpdateStatus(kHLSStatusStopped);
+            rendition->hls->UpdateStatusMessage("Transcoding Stopped");
+        }
+
+        // A removed stream's files are gone, don't write its playlist again
+        QString playlist = rendition->hls->GetPlaylistName();
+
+        m_renditions.removeAt(i);
+        rendition->avfw->CloseFile();
+        Close(rendition);
+
+        if (status == kHLSStatusUndefined)
+            QFile::remove(playlist);
+    }
+}
+
+void HLSLadder::UpdatePercentComplete(int percent)
+{
+    for (int i = 0; i < m_renditions.size(); ++i)
+        m_renditions[i]->hls->UpdatePercentComplete(percent);
+}
+
+/**
+ * Closes every rendition and gives it the final status of the transcode.
+ */
+void HLSLadder::Finish(HTTPLiveStreamStatus status, const QString &message)
+{
+    while (!m_renditions.isEmpty())
+    {
+        Rendition *rendition = m_renditions.takeFirst();
+
+        if (rendition->avfw)
+            rendition->avfw->CloseFile();
+
+        rendition->hls->UpdateStatus(status);
+        rendition->hls->UpdateStatusMessage(message);
+        if (status == kHLSStatusCompleted)
+            rendition->hls->UpdatePercentComplete(100);
+
+        Close(rendition);
+    }
+}
+
+/**
+ * Removes the renditions set up so far and the ones still to be set up,
+ * so that a failed ladder doesn't leave streams queued that no transcode
+ * will ever encode, nor list them in any playlist.
+ *
+ * \param pending The stream ids Init() didn't get to.
+ * \return false, for Init() to return.
+ */
+bool HLSLadder::Abort(const QList<int> &pending)
+{
+    QList<int> streamids = pending;
+
+    while (!m_renditions.isEmpty())
+    {
+        Rendition *rendition = m_renditions.takeFirst();
+        streamids << rendition->hls->GetStreamID();
+        if (rendition->avfw)
+            rendition->avfw->CloseFile();
+        Close(rendition);
+    }
+
+    for (int i = 0; i < streamids.size(); ++i)
+        HTTPLiveStream::RemoveStream(streamids[i]);
+
+    return false;
+}
+
+void HLSLadder::Close(Rendition *rendition)
+{
+    delete rendition->avfw;
+    delete rendition->hls;
+    sws_freeContext(rendition->scontext);
+    av_freep(&rendition->frame.buf);
+    delete rendition;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,63 @@
+#ifndef HLSLADDER_H
+#define HLSLADDER_H
+
+#include <QString>
+#include <QList>
+
+#include "mythframe.h"
+#include "HLS/httplivestream.h"
+
+class AVFormatWriter;
+struct SwsContext;
+
+/**
+ * The lower renditions of an HTTP Live Stream bitrate ladder. Each one is
+ * scaled down from the frames encoded for the main stream and encoded by
+ * an AVFormatWriter of its own, so all the rungs of the ladder share the
+ * single decode of the source instead of each running a mythtranscode.
+ *
+ * Segments are rolled independently, on the first keyframe after the
+ * segment length, and every writer forces keyframes on the same frames,
+ * so the segments of all renditions start on the same picture and players
+ * can switch between them at any segment boundary.
+ */
+class HLSLadder
+{
+  public:
+    HLSLadder();
+   ~HLSLadder();
+
+    bool    Init(const QList<int> &streamids, HTTPLiveStream *main,
+                 int srcWidth, int srcHeight, float aspect,
+                 int channels, int audioRate, double frameRate,
+                 int segmentFrames, const QString &preset,
+                 const QString &tune);
+    bool    isEmpty(void) const { return m_renditions.isEmpty(); }
+
+    void    WriteVideoFrame(const VideoFrame *frame, long long timecode);
+    void    WriteAudioFrame(unsigned char *buf, int fnum, long long timecode,
+                            long long timecodeOffset);
+
+    void    CheckStop(void);
+    void    UpdatePercentComplete(int percent);
+    void    Finish(HTTPLiveStreamStatus status, const QString &message);
+
+  private:
+    typedef struct rendition
+    {
+        HTTPLiveStream *hls;
+        AVFormatWriter *avfw;
+        VideoFrame      frame;
+        SwsContext     *scontext;
+        int             segmentFrames;
+    } Rendition;
+
+    bool    Abort(const QList<int> &pending);
+    void    Close(Rendition *rendition);
+
+    QList<Rendition*>   m_renditions;
+    int                 m_segmentFrames;
+};
+
+#endif
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -22,6 +22,7 @@ using namespace std;
 #include "mythdate.h"
 #include "transcode.h"
 #include "mpeg2fix.h"
+#include "smartcut.h"
 #include "remotefile.h"
 #include "mythtranslation.h"
 #include "loggingserver.h"
@@ -156,6 +157,7 @@ int main(int argc, char *argv[])
     bool useCutlist = false, keyframesonly = false;
     bool build_index = false, fifosync = false;
     bool mpeg2 = false;
+    bool smartcut = false;
     bool fifo_info = false;
     bool cleanCut = false;
     QMap<QString, QString> settingsOverride;
@@ -347,6 +349,8 @@ int main(int argc, char *argv[])
         recorderOptions = cmdline.toString("recopt");
     if (cmdline.toBool("mpeg2"))
         mpeg2 = true;
+    if (cmdline.toBool("smartcut"))
+        smartcut = true;
     if (cmdline.toBool("ostream"))
     {
         if (cmdline.toString("ostream") == "dvd")
@@ -578,6 +582,19 @@ int main(int argc, char *argv[])
 
         if (cmdline.toBool("hlsstreamid"))
             transcode->SetHLSStreamID(cmdline.toInt("hlsstreamid"));
+        if (cmdline.toBool("hlsrenditions"))
+        {
+            QList<int> renditions;
+            QStringList ids = cmdline.toString("hlsrenditions").split(",");
+            for (int i = 0; i < ids.size(); ++i)
+            {
+                bool ok = false;
+                int id = ids[i].toInt(&ok);
+                if (ok)
+                    renditions << id;
+            }
+            transcode->SetHLSRenditions(renditions);
+        }
         if (cmdline.toBool("maxsegments"))
             transcode->SetHLSMaxSegments(cmdline.toInt("maxsegments"));
         if (cmdline.toBool("noaudioonly"))
@@ -594,6 +611,8 @@ int main(int argc, char *argv[])
             transcode->SetCMDBitrate(cmdline.toInt("bitrate") * 1000);
         if (cmdline.toBool("audiobitrate"))
             transcode->SetCMDAudioBitrate(cmdline.toInt("audiobitrate") * 1000);
+        if (cmdline.toBool("threads"))
+            transcode->SetCMDThreads(cmdline.toInt("threads"));
     }
 
     if (showprogress)
@@ -601,7 +620,25 @@ int main(int argc, char *argv[])
     if (!recorderOptions.isEmpty())
         transcode->SetRecorderOptions(recorderOptions);
     int result = 0;
-    if ((!mpeg2 && !build_index) || cmdline.toBool("hls"))
+
+    // The smart cutter places cuts with the recording's duration map,
+    // without one the cutlist is honoured by a full transcode instead
+    if (smartcut && useCutlist && !build_index && !cmdline.toBool("hls"))
+    {
+        if (deleteMap.isEmpty())
+            pginfo->QueryCutList(deleteMap);
+
+        frm_pos_map_t durationMap;
+        pginfo->QueryPositionMap(durationMap, MARK_DURATION_MS);
+        if (!deleteMap.isEmpty() && durationMap.isEmpty())
+        {
+            LOG(VB_GENERAL, LOG_WARNING, "No duration map to cut with, "
+                "transcoding instead of using the smart cutter");
+            smartcut = false;
+        }
+    }
+
+    if ((!mpeg2 && !smartcut && !build_index) || cmdline.toBool("hls"))
     {
         result = transcode->TranscodeFile(infile, outfile,
                                           profilename, useCutlist,
@@ -626,7 +663,52 @@ int main(int argc, char *argv[])
     }
 
     int exitcode = GENERIC_EXIT_OK;
-    if ((result == REENCODE_MPEG2TRANS) || mpeg2 || build_index)
+    if ((result == REENCODE_SMARTCUT) ||
+        (smartcut && !build_index && !cmdline.toBool("hls")))
+    {
+        void (*update_func)(float) = NULL;
+        int (*check_func)() = NULL;
+        if (useCutlist)
+        {
+            LOG(VB_GENERAL, LOG_INFO, "Honoring the cutlist while transcoding");
+            if (deleteMap.isEmpty())
+                pginfo->QueryCutList(deleteMap);
+        }
+        if (jobID >= 0)
+        {
+           glbl_jobID = jobID;
+           update_func = &UpdateJobQueue;
+           check_func = &CheckJobQueue;
+        }
+
+        // The recorder's keyframe index lets the cutter seek over cuts,
+        // and its duration map places them
+        frm_pos_map_t keyframeMap;
+        frm_pos_map_t durationMap;
+        pginfo->QueryPositionMap(keyframeMap, MARK_GOP_BYFRAME);
+        pginfo->QueryPositionMap(durationMap, MARK_DURATION_MS);
+
+        SmartCutter cutter(infile, outfile,
+                           useCutlist ? deleteMap : frm_dir_map_t(),
+                           keyframeMap, durationMap, showprogress,
+                           update_func, check_func);
+        result = cutter.Start();
+        if (result == REENCODE_OK)
+        {
+            cutter.GetKeyframeIndex(posMap, durMap);
+            if (update_index)
+                UpdatePositionMap(posMap, durMap, NULL, pginfo);
+            else
+                UpdatePositionMap(posMap, durMap, outfile + QString(".map"),
+                                  pginfo);
+
+            RecordingInfo recInfo(*pginfo);
+            RecordingFile *recFile = recInfo.GetRecordingFile();
+            recFile->m_containerFormat = formatMPEG2_TS;
+            recFile->Save();
+        }
+    }
+    else if ((result == REENCODE_MPEG2TRANS) || mpeg2 || build_index)
     {
         void (*update_func)(float) = NULL;
         int (*check_func)() = NULL;
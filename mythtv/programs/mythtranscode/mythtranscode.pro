@@ -21,6 +21,8 @@ macx: QMAKE_CFLAGS -= -O3 -O2 -O1 -Os
 # Input
 SOURCES += main.cpp transcode.cpp mpeg2fix.cpp
 SOURCES += audioreencodebuffer.cpp cutter.cpp videodecodebuffer.cpp
+SOURCES += videoscalebuffer.cpp transcodestage.cpp smartcut.cpp
+SOURCES += hlsladder.cpp
 SOURCES += commandlineparser.cpp
 SOURCES += external/replex/element.c external/replex/mpg_common.c
 SOURCES += external/replex/multiplex.c external/replex/pes.c
@@ -28,6 +30,8 @@ SOURCES += external/replex/ringbuffer.c external/replex/ts.c
 
 HEADERS += mpeg2fix.h transcodedefs.h commandlineparser.h
 HEADERS += audioreencodebuffer.h cutter.h videodecodebuffer.h
+HEADERS += videoscalebuffer.h transcodestage.h smartcut.h
+HEADERS += hlsladder.h
 HEADERS += external/replex/element.h external/replex/mpg_common.h
 HEADERS += external/replex/multiplex.h external/replex/pes.h
 HEADERS += external/replex/ringbuffer.h external/replex/ts.h
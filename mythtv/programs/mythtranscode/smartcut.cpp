@@ -0,0 +1,1004 @@
+#include "smartcut.h"
+
+#include <QMutexLocker>
+#include <QDateTime>
+#include <QPair>
+
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythdate.h"
+#include "transcodedefs.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libavutil/opt.h"
+}
+
+#define LOC QString("SmartCut: ")
+
+// Cuts shorter than this are read through rather than seeked over
+static const int kMinSkipSeconds = 10;
+
+SmartCutter::SmartCutter(const QString &inputFile, const QString &outputFile,
+                         const frm_dir_map_t &deleteMap,
+                         const frm_pos_map_t &keyframeMap,
+                         const frm_pos_map_t &durationMap, bool showprogress,
+                         void (*update_func)(float), int (*check_func)())
+  : m_inputFile(inputFile),         m_outputFile(outputFile),
+    m_deleteMap(deleteMap),         m_keyframeMap(keyframeMap),
+    m_durationMap(durationMap),
+    m_showProgress(showprogress),
+    m_updateStatus(update_func),    m_checkAbort(check_func),
+    m_ic(NULL),                     m_oc(NULL),
+    m_videoIndex(-1),
+    m_startPts(0),                  m_frameDuration(1),
+    m_videoDelay(0),
+    m_canSeek(!keyframeMap.isEmpty()),
+    m_seekRange(-1),                m_seekFrom(-1),
+    m_decoder(NULL),                m_encoder(NULL),
+    m_canEncode(false),
+    m_reencodeFrom(0),              m_reencodeEnd(0),
+    m_encodeBase(AV_NOPTS_VALUE),   m_encodeLast(AV_NOPTS_VALUE),
+    m_forceKey(false),              m_frame(NULL),
+    m_framesWritten(0),             m_framesReencoded(0)
+{
+    m_frameRate.num = 0;
+    m_frameRate.den = 1;
+}
+
+SmartCutter::~SmartCutter()
+{
+    FlushGOPs(false);
+    Close();
+}
+
+void SmartCutter::GetKeyframeIndex(frm_pos_map_t &posMap,
+                                   frm_pos_map_t &durMap) const
+{
+    posMap = m_posMap;
+    durMap = m_durMap;
+}
+
+int SmartCutter::Start(void)
+{
+    if (!m_deleteMap.isEmpty() && m_durationMap.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "The recording has no duration map to place the cuts with");
+        return REENCODE_ERROR;
+    }
+
+    if (!OpenInput() || !OpenOutput())
+    {
+        Close();
+        return REENCODE_ERROR;
+    }
+
+    BuildKeepRanges();
+    if (m_ranges.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The cutlist removes everything");
+        Close();
+        return REENCODE_ERROR;
+    }
+
+    m_frame = av_frame_alloc();
+
+    int64_t filesize = avio_size(m_ic->pb);
+    int status_update_time = m_updateStatus ? 20 : 5;
+    QDateTime statustime = MythDate::current();
+    if (m_updateStatus)
+        m_updateStatus(0);
+
+    int result = REENCODE_OK;
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+
+    while (av_read_frame(m_ic, &pkt) >= 0)
+    {
+        if (MythDate::current() > statustime)
+        {
+            if (filesize > 0 && (m_showProgress || m_updateStatus))
+            {
+                float percent_done = 100.0 * avio_tell(m_ic->pb) / filesize;
+                if (m_updateStatus)
+                    m_updateStatus(percent_done);
+                if (m_showProgress)
+                    LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+                            .arg(percent_done, 0, 'f', 1));
+            }
+            if (m_checkAbort && m_checkAbort())
+            {
+                av_packet_unref(&pkt);
+                result = REENCODE_STOPPED;
+                break;
+            }
+            statustime = MythDate::current().addSecs(status_update_time);
+        }
+
+        if (pkt.stream_index >= m_streamMap.size() ||
+            m_streamMap[pkt.stream_index] < 0)
+        {
+            av_packet_unref(&pkt);
+            continue;
+        }
+
+        AVPacket *copy = av_packet_alloc();
+        av_packet_move_ref(copy, &pkt);
+        if (!AddPacket(copy))
+        {
+            result = REENCODE_ERROR;
+            break;
+        }
+    }
+
+    if (result == REENCODE_OK)
+    {
+        if (!m_gops.isEmpty())
+            FinishGOP(m_gops.last());
+        if (!FlushGOPs())
+            result = REENCODE_ERROR;
+    }
+
+    if (result == REENCODE_OK && av_write_trailer(m_oc) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not finish " + m_outputFile);
+        result = REENCODE_ERROR;
+    }
+
+    FlushGOPs(false);
+    Close();
+
+    if (result == REENCODE_OK)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Wrote %1 video frames, %2 of them re-encoded")
+                .arg(m_framesWritten).arg(m_framesReencoded));
+    }
+
+    return result;
+}
+
+bool SmartCutter::OpenInput(void)
+{
+    av_register_all();
+
+    QByteArray ifname = m_inputFile.toLocal8Bit();
+    if (avformat_open_input(&m_ic, ifname.constData(), NULL, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not open " + m_inputFile);
+        return false;
+    }
+
+    if (avformat_find_stream_info(m_ic, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not find stream info in " +
+            m_inputFile);
+        return false;
+    }
+
+    m_videoIndex = av_find_best_stream(m_ic, AVMEDIA_TYPE_VIDEO,
+                                       -1, -1, NULL, 0);
+    if (m_videoIndex < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No video stream in " + m_inputFile);
+        return false;
+    }
+
+    AVStream *vst = m_ic->streams[m_videoIndex];
+    AVCodecID codec_id = vst->codecpar->codec_id;
+    if (codec_id != AV_CODEC_ID_MPEG2VIDEO && codec_id != AV_CODEC_ID_H264)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Only MPEG-2 and H.264 video can be cut losslessly, "
+                    "not %1").arg(avcodec_get_name(codec_id)));
+        return false;
+    }
+
+    m_frameRate = vst->avg_frame_rate;
+    if (m_frameRate.num <= 0 || m_frameRate.den <= 0)
+        m_frameRate = vst->r_frame_rate;
+    if (m_frameRate.num <= 0 || m_frameRate.den <= 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unknown video frame rate");
+        return false;
+    }
+    m_frameDuration = av_rescale_q(1, av_inv_q(m_frameRate), vst->time_base);
+    if (m_frameDuration <= 0)
+        m_frameDuration = 1;
+    if (vst->start_time != AV_NOPTS_VALUE)
+        m_startPts = vst->start_time;
+
+    AVCodec *decoder = avcodec_find_decoder(codec_id);
+    m_decoder = avcodec_alloc_context3(decoder);
+    if (!decoder || !m_decoder ||
+        avcodec_parameters_to_context(m_decoder, vst->codecpar) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not set up the video decoder");
+        return false;
+    }
+    m_decoder->pkt_timebase = vst->time_base;
+    // A GOP cut out of its stream may start at a non-IDR I frame
+    if (codec_id == AV_CODEC_ID_H264)
+        m_decoder->flags2 |= AV_CODEC_FLAG2_SHOW_ALL;
+
+    {
+        QMutexLocker locker(avcodeclock);
+        if (avcodec_open2(m_decoder, decoder, NULL) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Could not open the video decoder");
+            return false;
+        }
+    }
+
+    m_canEncode = (avcodec_find_encoder(codec_id) != NULL);
+    if (!m_canEncode)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("No %1 encoder, cut points will be moved to keyframes")
+                .arg(avcodec_get_name(codec_id)));
+    }
+
+    m_streamMap.fill(-1, m_ic->nb_streams);
+    int nextOutput = 0;
+    for (uint i = 0; i < m_ic->nb_streams; i++)
+    {
+        AVCodecParameters *par = m_ic->streams[i]->codecpar;
+        if ((int)i == m_videoIndex ||
+            (par->codec_type == AVMEDIA_TYPE_AUDIO &&
+             par->codec_id != AV_CODEC_ID_NONE && par->channels > 0))
+        {
+            m_streamMap[i] = nextOutput++;
+        }
+    }
+
+    return true;
+}
+
+bool SmartCutter::OpenOutput(void)
+{
+    QByteArray ofname = m_outputFile.toLocal8Bit();
+    if (avformat_alloc_output_context2(&m_oc, NULL, "mpegts",
+                                       ofname.constData()) < 0 || !m_oc)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not create the output muxer");
+        return false;
+    }
+
+    for (int i = 0; i < m_streamMap.size(); i++)
+    {
+        if (m_streamMap[i] < 0)
+            continue;
+
+        AVStream *ist = m_ic->streams[i];
+        AVStream *ost = avformat_new_stream(m_oc, NULL);
+        if (!ost || avcodec_parameters_copy(ost->codecpar, ist->codecpar) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Could not create output stream");
+            return false;
+        }
+        ost->codecpar->codec_tag = 0;
+        ost->time_base = ist->time_base;
+        ost->disposition = ist->disposition;
+        av_dict_copy(&ost->metadata, ist->metadata, 0);
+    }
+
+    if (!(m_oc->oformat->flags & AVFMT_NOFILE) &&
+        avio_open(&m_oc->pb, ofname.constData(), AVIO_FLAG_WRITE) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not open " + m_outputFile);
+        return false;
+    }
+
+    if (avformat_write_header(m_oc, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not write the output header");
+        return false;
+    }
+
+    m_lastDts.fill(AV_NOPTS_VALUE, m_oc->nb_streams);
+
+    return true;
+}
+
+void SmartCutter::Close(void)
+{
+    CloseEncoder();
+
+    if (m_decoder)
+    {
+        QMutexLocker locker(avcodeclock);
+        avcodec_free_context(&m_decoder);
+    }
+
+    av_frame_free(&m_frame);
+
+    if (m_oc)
+    {
+        if (m_oc->pb && !(m_oc->oformat->flags & AVFMT_NOFILE))
+            avio_closep(&m_oc->pb);
+        avformat_free_context(m_oc);
+        m_oc = NULL;
+    }
+
+    if (m_ic)
+        avformat_close_input(&m_ic);
+}
+
+/**
+ * Turn the cutlist into the ranges of video pts to keep, each with the
+ * offset that closes the gaps the cuts leave behind. A cut covers the
+ * frames from its start mark through its end mark, as in DeleteMap.
+ */
+void SmartCutter::BuildKeepRanges(void)
+{
+    m_ranges.clear();
+
+    bool inCut = (!m_deleteMap.isEmpty() &&
+                  m_deleteMap.begin().value() == MARK_CUT_END);
+    uint64_t keepFrom = 0;
+    QList<QPair<uint64_t, uint64_t> > frames;
+
+    frm_dir_map_t::const_iterator it = m_deleteMap.begin();
+    for (; it != m_deleteMap.end(); ++it)
+    {
+        if (*it == MARK_CUT_START && !inCut)
+        {
+            if (it.key() > keepFrom)
+                frames.append(qMakePair(keepFrom, it.key()));
+            inCut = true;
+        }
+        else if (*it == MARK_CUT_END && inCut)
+        {
+            keepFrom = it.key() + 1;
+            inCut = false;
+        }
+    }
+    if (!inCut)
+        frames.append(qMakePair(keepFrom, (uint64_t)INT64_MAX));
+
+    int64_t kept = 0;
+    for (int i = 0; i < frames.size(); i++)
+    {
+        KeepRange range;
+        range.startFrame = frames[i].first;
+        range.start  = FrameToPts(frames[i].first);
+        range.end    = (frames[i].second == (uint64_t)INT64_MAX) ? INT64_MAX :
+                       FrameToPts(frames[i].second);
+        range.offset = range.start - (m_startPts + kept);
+        if (range.end != INT64_MAX)
+            kept += range.end - range.start;
+        m_ranges.append(range);
+
+        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Keeping frames %1 - %2")
+                .arg(frames[i].first)
+                .arg(range.end == INT64_MAX ? QString("end") :
+                     QString::number(frames[i].second - 1)));
+    }
+}
+
+/**
+ * Returns the video pts of a frame number. The duration map gives the
+ * time of each keyframe, frames between keyframes are spread evenly and
+ * frames after the last one follow at the stream's frame rate. Unlike
+ * counting frames at a constant rate this stays right across soft
+ * telecine, frame rate changes and timestamp discontinuities.
+ */
+int64_t SmartCutter::FrameToPts(uint64_t frame) const
+{
+    AVRational msec = {1, 1000};
+    AVRational time_base = m_ic->streams[m_videoIndex]->time_base;
+
+    uint64_t key1 = 0;
+    int64_t  ms1  = 0;
+
+    frm_pos_map_t::const_iterator upper = m_durationMap.lowerBound(frame);
+    if (upper != m_durationMap.begin())
+    {
+        frm_pos_map_t::const_iterator lower = upper;
+        --lower;
+        key1 = lower.key();
+        ms1  = *lower;
+    }
+
+    if (upper != m_durationMap.end() && upper.key() == (long long)frame)
+        return m_startPts + av_rescale_q(*upper, msec, time_base);
+
+    if (upper == m_durationMap.end())
+    {
+        return m_startPts + av_rescale_q(ms1, msec, time_base) +
+               (int64_t)(frame - key1) * m_frameDuration;
+    }
+
+    int64_t ms = ms1 + (int64_t)((double)(frame - key1) * (*upper - ms1) /
+                                 (upper.key() - key1) + 0.5);
+    return m_startPts + av_rescale_q(ms, msec, time_base);
+}
+
+int SmartCutter::FindRange(int64_t pts) const
+{
+    for (int i = 0; i < m_ranges.size(); i++)
+    {
+        if (pts >= m_ranges[i].start && pts < m_ranges[i].end)
+            return i;
+    }
+    return -1;
+}
+
+bool SmartCutter::AllKept(int64_t first, int64_t last) const
+{
+    int i = FindRange(first);
+    return (i >= 0) && (last < m_ranges[i].end);
+}
+
+bool SmartCutter::AnyKept(int64_t first, int64_t last) const
+{
+    for (int i = 0; i < m_ranges.size(); i++)
+    {
+        if (m_ranges[i].start <= last && m_ranges[i].end > first)
+            return true;
+    }
+    return false;
+}
+
+/// Leading frames follow the keyframe in decode order but are shown
+/// before it, and in an open GOP they refer to the previous GOP.
+bool SmartCutter::IsLead(const GOP *gop, const AVPacket *pkt) const
+{
+    return pkt->stream_index == m_videoIndex &&
+           !(pkt->flags & AV_PKT_FLAG_KEY) &&
+           pkt->pts != AV_NOPTS_VALUE && pkt->pts < gop->keyPts;
+}
+
+bool SmartCutter::AddPacket(AVPacket *pkt)
+{
+    bool isKey = pkt->stream_index == m_videoIndex &&
+                 (pkt->flags & AV_PKT_FLAG_KEY) &&
+                 pkt->pts != AV_NOPTS_VALUE;
+
+    if (isKey && m_seekRange >= 0)
+    {
+        // The keyframe index is in frames and we guessed their pts; if
+        // that put us past the start of the kept range, go back and read
+        // through the cut instead.
+        int range = m_seekRange;
+        m_seekRange = -1;
+        if (pkt->pts > m_ranges[range].start)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                "Skipped too far using the keyframe index, reading instead");
+            m_canSeek = false;
+            av_packet_free(&pkt);
+            return av_seek_frame(m_ic, -1, m_seekFrom,
+                                 AVSEEK_FLAG_BYTE) >= 0;
+        }
+    }
+
+    if (isKey)
+    {
+        if (!m_gops.isEmpty())
+            FinishGOP(m_gops.last());
+
+        // Keep the GOP being processed, the one after it for its leading
+        // frames, and the one being read.
+        if (m_gops.size() >= 2)
+        {
+            GOP *gop = m_gops.takeFirst();
+            bool ok = ProcessGOP(gop, m_gops.first());
+            DeleteGOP(gop);
+            if (!ok)
+            {
+                av_packet_free(&pkt);
+                return false;
+            }
+        }
+
+        int64_t pos = FindSkipPosition(pkt);
+        if (pos >= 0)
+        {
+            if (!FlushGOPs())
+            {
+                av_packet_free(&pkt);
+                return false;
+            }
+
+            m_seekFrom = pkt->pos;
+            av_packet_free(&pkt);
+            if (av_seek_frame(m_ic, -1, pos, AVSEEK_FLAG_BYTE) < 0)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    "Seeking failed, reading through cuts instead");
+                m_canSeek = false;
+                m_seekRange = -1;
+                return av_seek_frame(m_ic, -1, m_seekFrom,
+                                     AVSEEK_FLAG_BYTE) >= 0;
+            }
+            return true;
+        }
+
+        GOP *gop = new GOP;
+        gop->keyPts    = pkt->pts;
+        gop->bodyLast  = pkt->pts;
+        gop->hasLead   = false;
+        gop->leadFirst = 0;
+        gop->leadLast  = 0;
+        gop->copyBody  = false;
+        gop->copyLead  = false;
+        m_gops.append(gop);
+
+        if (pkt->dts != AV_NOPTS_VALUE && pkt->pts >= pkt->dts)
+            m_videoDelay = pkt->pts - pkt->dts;
+    }
+
+    // Nothing before the first keyframe can be used
+    if (m_gops.isEmpty())
+    {
+        av_packet_free(&pkt);
+        return true;
+    }
+
+    m_gops.last()->packets.append(pkt);
+    return true;
+}
+
+/// Called once all of a GOP's packets have been read.
+void SmartCutter::FinishGOP(GOP *gop)
+{
+    for (int i = 0; i < gop->packets.size(); i++)
+    {
+        const AVPacket *pkt = gop->packets[i];
+        if (pkt->stream_index != m_videoIndex || pkt->pts == AV_NOPTS_VALUE)
+            continue;
+
+        if (IsLead(gop, pkt))
+        {
+            if (!gop->hasLead || pkt->pts < gop->leadFirst)
+                gop->leadFirst = pkt->pts;
+            if (!gop->hasLead || pkt->pts > gop->leadLast)
+                gop->leadLast = pkt->pts;
+            gop->hasLead = true;
+        }
+        else if (pkt->pts > gop->bodyLast)
+        {
+            gop->bodyLast = pkt->pts;
+        }
+    }
+
+    // Without an encoder a GOP that is partly kept is kept whole
+    gop->copyBody = m_canEncode ? AllKept(gop->keyPts, gop->bodyLast) :
+                                  AnyKept(gop->keyPts, gop->bodyLast);
+}
+
+/**
+ * Write out one GOP: the packets of other streams that fall inside a kept
+ * range, the video packets if the whole GOP is kept, and a re-encoded
+ * version of the kept frames that could not be copied.
+ */
+bool SmartCutter::ProcessGOP(GOP *gop, GOP *next)
+{
+    // The next GOP's leading frames can be copied only along with what
+    // they refer to on both sides.
+    if (next)
+    {
+        next->copyLead = next->hasLead && gop->copyBody && next->copyBody &&
+            (!m_canEncode || AllKept(next->leadFirst, next->leadLast));
+    }
+
+    AVStream *vst = m_ic->streams[m_videoIndex];
+    for (int i = 0; i < gop->packets.size(); i++)
+    {
+        const AVPacket *pkt = gop->packets[i];
+
+        if (pkt->stream_index == m_videoIndex)
+        {
+            if (IsLead(gop, pkt) ? !gop->copyLead : !gop->copyBody)
+                continue;
+
+            int64_t pts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts :
+                                                         gop->keyPts;
+            if (!WritePacket(pkt, pts))
+                return false;
+        }
+        else
+        {
+            int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+            if (ts == AV_NOPTS_VALUE)
+                continue;
+
+            ts = av_rescale_q(ts, m_ic->streams[pkt->stream_index]->time_base,
+                              vst->time_base);
+            if (FindRange(ts) >= 0 && !WritePacket(pkt, ts))
+                return false;
+        }
+    }
+
+    return !m_canEncode || ReencodeFrames(gop, next);
+}
+
+bool SmartCutter::FlushGOPs(bool process)
+{
+    bool ok = true;
+    while (!m_gops.isEmpty())
+    {
+        GOP *gop = m_gops.takeFirst();
+        if (ok && process)
+            ok = ProcessGOP(gop, m_gops.isEmpty() ? NULL : m_gops.first());
+        DeleteGOP(gop);
+    }
+    return ok;
+}
+
+void SmartCutter::DeleteGOP(GOP *gop)
+{
+    while (!gop->packets.isEmpty())
+    {
+        AVPacket *pkt = gop->packets.takeFirst();
+        av_packet_free(&pkt);
+    }
+    delete gop;
+}
+
+/**
+ * Check whether we are in a cut long enough to jump over with the
+ * recording's keyframe index. Returns the byte position to seek to, or -1
+ * to keep reading.
+ */
+int64_t SmartCutter::FindSkipPosition(const AVPacket *key)
+{
+    if (!m_canSeek || key->pos < 0)
+        return -1;
+
+    int next = 0;
+    while (next < m_ranges.size() && m_ranges[next].end <= key->pts)
+        next++;
+    if (next >= m_ranges.size() || m_ranges[next].start <= key->pts)
+        return -1;
+
+    // Everything still buffered has to be cut as well
+    int64_t buffered = m_gops.isEmpty() ? key->pts : m_gops.first()->keyPts;
+    if (next > 0 && m_ranges[next - 1].end > buffered)
+        return -1;
+
+    // Land a few keyframes early so that the GOP the kept range starts in
+    // and the one before it, for its leading frames, are read.
+    frm_pos_map_t::const_iterator it =
+        m_keyframeMap.lowerBound(m_ranges[next].startFrame);
+    for (int i = 0; i < 3 && it != m_keyframeMap.begin(); i++)
+        --it;
+    if (it == m_keyframeMap.end())
+        return -1;
+
+    AVRational seconds = {1, 1};
+    int64_t target = FrameToPts(it.key());
+    int64_t minSkip = av_rescale_q(kMinSkipSeconds, seconds,
+                                   m_ic->streams[m_videoIndex]->time_base);
+    if (target - key->pts < minSkip || *it <= key->pos)
+        return -1;
+
+    LOG(VB_GENERAL, LOG_DEBUG, LOC +
+        QString("Skipping cut to keyframe %1 at byte %2")
+            .arg(it.key()).arg(*it));
+
+    m_seekRange = next;
+    return *it;
+}
+
+/**
+ * Decode the GOP, and the next GOP's leading frames, and encode the frames
+ * that are kept but were not copied into a closed GOP of their own.
+ */
+bool SmartCutter::ReencodeFrames(GOP *gop, GOP *next)
+{
+    int64_t unitEnd = next ? next->keyPts : gop->bodyLast + m_frameDuration;
+
+    bool wanted;
+    if (gop->copyBody)
+    {
+        wanted = next && next->hasLead && !next->copyLead &&
+                 AnyKept(next->leadFirst, next->leadLast);
+        m_reencodeFrom = gop->bodyLast + 1;
+    }
+    else
+    {
+        wanted = AnyKept(gop->keyPts, unitEnd - 1);
+        m_reencodeFrom = gop->keyPts;
+    }
+    m_reencodeEnd = unitEnd;
+
+    if (!wanted)
+        return true;
+
+    avcodec_flush_buffers(m_decoder);
+
+    // This GOP's own leading frames belong with the previous one
+    for (int i = 0; i < gop->packets.size(); i++)
+    {
+        AVPacket *pkt = gop->packets[i];
+        if (pkt->stream_index == m_videoIndex && !IsLead(gop, pkt) &&
+            DecodePacket(pkt) < 0)
+            return false;
+    }
+
+    if (next && next->hasLead)
+    {
+        int last = 0;
+        for (int i = 0; i < next->packets.size(); i++)
+        {
+            if (IsLead(next, next->packets[i]))
+                last = i;
+        }
+        for (int i = 0; i <= last; i++)
+        {
+            AVPacket *pkt = next->packets[i];
+            if (pkt->stream_index == m_videoIndex && DecodePacket(pkt) < 0)
+                return false;
+        }
+    }
+
+    int ret;
+    while ((ret = DecodePacket(NULL)) > 0)
+        ;
+
+    return ret == 0 && CloseEncoder();
+}
+
+/// Returns 1 if a frame came out, 0 if not, and -1 on an encoding error.
+int SmartCutter::DecodePacket(AVPacket *pkt)
+{
+    AVPacket empty;
+    if (!pkt)
+    {
+        av_init_packet(&empty);
+        empty.data = NULL;
+        empty.size = 0;
+        pkt = &empty;
+    }
+
+    int got_picture = 0;
+    if (avcodec_decode_video2(m_decoder, m_frame, &got_picture, pkt) < 0)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC + "Video decoding error");
+        return 0;
+    }
+    if (!got_picture)
+        return 0;
+
+    bool ok = true;
+    int64_t pts = av_frame_get_best_effort_timestamp(m_frame);
+    if (pts != AV_NOPTS_VALUE && pts >= m_reencodeFrom &&
+        pts < m_reencodeEnd && FindRange(pts) >= 0)
+    {
+        ok = EncodeFrame(m_frame, pts);
+    }
+    av_frame_unref(m_frame);
+
+    return ok ? 1 : -1;
+}
+
+bool SmartCutter::EncodeFrame(AVFrame *frame, int64_t pts)
+{
+    if (!m_encoder && !OpenEncoder(frame))
+        return false;
+
+    if (m_encodeBase == AV_NOPTS_VALUE)
+        m_encodeBase = pts;
+
+    frame->pts = av_rescale_q(pts - m_encodeBase,
+                              m_ic->streams[m_videoIndex]->time_base,
+                              m_encoder->time_base);
+    if (m_encodeLast != AV_NOPTS_VALUE && frame->pts <= m_encodeLast)
+        frame->pts = m_encodeLast + 1;
+    m_encodeLast = frame->pts;
+
+    frame->pict_type = m_forceKey ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+    m_forceKey = false;
+
+    return WriteEncoded(frame) >= 0;
+}
+
+/// Returns 1 if a packet was written, 0 if not, and -1 on error.
+int SmartCutter::WriteEncoded(AVFrame *frame)
+{
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+
+    int got_packet = 0;
+    if (avcodec_encode_video2(m_encoder, &pkt, frame, &got_packet) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Video encoding error");
+        return -1;
+    }
+    if (!got_packet)
+        return 0;
+
+    // Back to the stream's time base. What we encode is not reordered, so
+    // give it the decode delay of the copied frames around it.
+    AVStream *vst = m_ic->streams[m_videoIndex];
+    pkt.pts = m_encodeBase + av_rescale_q(pkt.pts, m_encoder->time_base,
+                                          vst->time_base);
+    pkt.dts = pkt.pts - m_videoDelay;
+    pkt.duration = m_frameDuration;
+    pkt.stream_index = m_videoIndex;
+
+    bool ok = WritePacket(&pkt, pkt.pts);
+    av_packet_unref(&pkt);
+    if (!ok)
+        return -1;
+
+    m_framesReencoded++;
+    return 1;
+}
+
+bool SmartCutter::OpenEncoder(const AVFrame *frame)
+{
+    AVCodecID codec_id = m_ic->streams[m_videoIndex]->codecpar->codec_id;
+    AVCodec *codec = avcodec_find_encoder(codec_id);
+    m_encoder = avcodec_alloc_context3(codec);
+    if (!codec || !m_encoder)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not set up the video encoder");
+        return false;
+    }
+
+    m_encoder->width  = frame->width;
+    m_encoder->height = frame->height;
+    m_encoder->pix_fmt = (AVPixelFormat)frame->format;
+    m_encoder->sample_aspect_ratio = frame->sample_aspect_ratio.num ?
+        frame->sample_aspect_ratio : m_decoder->sample_aspect_ratio;
+    m_encoder->time_base = av_inv_q(m_frameRate);
+    m_encoder->framerate = m_frameRate;
+    m_encoder->color_primaries = frame->color_primaries;
+    m_encoder->color_trc = frame->color_trc;
+    m_encoder->colorspace = frame->colorspace;
+    m_encoder->color_range = frame->color_range;
+
+    // One I frame followed by P frames, nothing referring outside it
+    m_encoder->gop_size = 1000;
+    m_encoder->max_b_frames = 0;
+    m_encoder->flags |= AV_CODEC_FLAG_CLOSED_GOP;
+
+    if (frame->interlaced_frame)
+    {
+        m_encoder->flags |= AV_CODEC_FLAG_INTERLACED_DCT |
+                            AV_CODEC_FLAG_INTERLACED_ME;
+        m_encoder->field_order = frame->top_field_first ? AV_FIELD_TT :
+                                                          AV_FIELD_BB;
+    }
+
+    // Only a second or so is re-encoded at each cut, so spend bits on
+    // making it look like the frames around it.
+    if (codec_id == AV_CODEC_ID_H264)
+    {
+        av_opt_set(m_encoder->priv_data, "preset", "medium", 0);
+        av_opt_set(m_encoder->priv_data, "crf", "16", 0);
+    }
+    else
+    {
+        m_encoder->flags |= AV_CODEC_FLAG_QSCALE;
+        m_encoder->global_quality = FF_QP2LAMBDA * 2;
+    }
+
+    {
+        QMutexLocker locker(avcodeclock);
+        if (avcodec_open2(m_encoder, codec, NULL) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Could not open the video encoder");
+            avcodec_free_context(&m_encoder);
+            return false;
+        }
+    }
+
+    m_encodeBase = AV_NOPTS_VALUE;
+    m_encodeLast = AV_NOPTS_VALUE;
+    m_forceKey = true;
+
+    return true;
+}
+
+/// Drain the encoder so each run of re-encoded frames is complete.
+bool SmartCutter::CloseEncoder(void)
+{
+    if (!m_encoder)
+        return true;
+
+    int ret = 0;
+    if (m_oc)
+    {
+        while ((ret = WriteEncoded(NULL)) > 0)
+            ;
+    }
+
+    QMutexLocker locker(avcodeclock);
+    avcodec_free_context(&m_encoder);
+
+    return ret >= 0;
+}
+
+/**
+ * Write a packet of the input to the output, shifted back by the cuts
+ * before the kept range that videoPts is in.
+ */
+bool SmartCutter::WritePacket(const AVPacket *pkt, int64_t videoPts)
+{
+    int range = FindRange(videoPts);
+    if (range < 0)
+    {
+        // Kept whole for lack of an encoder: use the closest range
+        int64_t best = INT64_MAX;
+        for (int i = 0; i < m_ranges.size(); i++)
+        {
+            int64_t dist = (videoPts < m_ranges[i].start) ?
+                m_ranges[i].start - videoPts : videoPts - m_ranges[i].end;
+            if (dist < best)
+            {
+                best = dist;
+                range = i;
+            }
+        }
+    }
+
+    AVStream *vst = m_ic->streams[m_videoIndex];
+    AVStream *ist = m_ic->streams[pkt->stream_index];
+    int index = m_streamMap[pkt->stream_index];
+    AVStream *ost = m_oc->streams[index];
+    int64_t offset = av_rescale_q(m_ranges[range].offset, vst->time_base,
+                                  ist->time_base);
+
+    AVPacket out;
+    av_init_packet(&out);
+    out.data = NULL;
+    out.size = 0;
+    if (av_packet_ref(&out, pkt) < 0)
+        return false;
+
+    if (out.pts != AV_NOPTS_VALUE)
+        out.pts -= offset;
+    if (out.dts != AV_NOPTS_VALUE)
+        out.dts -= offset;
+    av_packet_rescale_ts(&out, ist->time_base, ost->time_base);
+    out.stream_index = index;
+    out.pos = -1;
+
+    // Around a cut the copied and re-encoded frames can overlap in decode
+    // time; the muxer needs it to keep going up.
+    if (out.dts != AV_NOPTS_VALUE)
+    {
+        if (m_lastDts[index] != AV_NOPTS_VALUE && out.dts <= m_lastDts[index])
+        {
+            out.dts = m_lastDts[index] + 1;
+            if (out.pts != AV_NOPTS_VALUE && out.pts < out.dts)
+                out.pts = out.dts;
+        }
+        m_lastDts[index] = out.dts;
+    }
+
+    if (pkt->stream_index == m_videoIndex)
+    {
+        if (out.flags & AV_PKT_FLAG_KEY)
+        {
+            AVRational msec = {1, 1000};
+            m_posMap[m_framesWritten] = avio_tell(m_oc->pb);
+            m_durMap[m_framesWritten] = av_rescale_q(
+                videoPts - m_ranges[range].offset - m_startPts,
+                vst->time_base, msec);
+        }
+        m_framesWritten++;
+    }
+
+    int ret = av_write_frame(m_oc, &out);
+    av_packet_unref(&out);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not write to " + m_outputFile);
+        return false;
+    }
+
+    return true;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,138 @@
+#ifndef SMARTCUT_H
+#define SMARTCUT_H
+
+#include <stdint.h>
+
+#include <QString>
+#include <QVector>
+#include <QList>
+
+#include "programtypes.h"
+
+extern "C" {
+#include "libavutil/rational.h"
+}
+
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVPacket;
+struct AVFrame;
+
+/**
+ * Lossless cut-list remuxer for MPEG-2 and H.264 transport streams.
+ *
+ * Whole GOPs between the cut points are copied to the output untouched;
+ * only the frames of a GOP that is cut part way through are decoded and
+ * re-encoded, as a short closed GOP of their own. Packets of other
+ * streams are copied when they fall inside a kept range. Long cuts are
+ * skipped over with the recording's keyframe index rather than read.
+ * Cutlist frame numbers are placed in time with the recording's duration
+ * map, as the player does, so a cutlist needs one.
+ *
+ * Without an encoder for the video codec the cut points are moved out to
+ * the nearest keyframes instead.
+ */
+class SmartCutter
+{
+  public:
+    SmartCutter(const QString &inputFile, const QString &outputFile,
+                const frm_dir_map_t &deleteMap,
+                const frm_pos_map_t &keyframeMap,
+                const frm_pos_map_t &durationMap, bool showprogress,
+                void (*update_func)(float) = NULL, int (*check_func)() = NULL);
+    ~SmartCutter();
+
+    int  Start(void);
+    void GetKeyframeIndex(frm_pos_map_t &posMap, frm_pos_map_t &durMap) const;
+
+  private:
+    typedef struct keepRange
+    {
+        uint64_t startFrame;
+        int64_t  start;         // first kept pts, video time base
+        int64_t  end;           // first pts after the range
+        int64_t  offset;        // subtracted from pts in the range
+    } KeepRange;
+
+    typedef struct gop
+    {
+        QList<AVPacket*> packets;  // all streams, in read order
+        int64_t  keyPts;
+        int64_t  bodyLast;      // last pts displayed from keyPts on
+        bool     hasLead;       // frames shown before keyPts
+        int64_t  leadFirst;
+        int64_t  leadLast;
+        bool     copyBody;
+        bool     copyLead;
+    } GOP;
+
+    bool OpenInput(void);
+    bool OpenOutput(void);
+    void Close(void);
+    void BuildKeepRanges(void);
+    int64_t FrameToPts(uint64_t frame) const;
+    int  FindRange(int64_t pts) const;
+    bool AllKept(int64_t first, int64_t last) const;
+    bool AnyKept(int64_t first, int64_t last) const;
+    bool IsLead(const GOP *gop, const AVPacket *pkt) const;
+
+    bool AddPacket(AVPacket *pkt);
+    void FinishGOP(GOP *gop);
+    bool ProcessGOP(GOP *gop, GOP *next);
+    bool FlushGOPs(bool process = true);
+    static void DeleteGOP(GOP *gop);
+    int64_t FindSkipPosition(const AVPacket *key);
+
+    bool ReencodeFrames(GOP *gop, GOP *next);
+    int  DecodePacket(AVPacket *pkt);
+    bool EncodeFrame(AVFrame *frame, int64_t pts);
+    int  WriteEncoded(AVFrame *frame);
+    bool OpenEncoder(const AVFrame *frame);
+    bool CloseEncoder(void);
+    bool WritePacket(const AVPacket *pkt, int64_t videoPts);
+
+  private:
+    QString                 m_inputFile;
+    QString                 m_outputFile;
+    frm_dir_map_t           m_deleteMap;
+    frm_pos_map_t           m_keyframeMap;
+    frm_pos_map_t           m_durationMap;  // frame -> ms, keyframes
+    bool                    m_showProgress;
+    void                  (*m_updateStatus)(float percent_done);
+    int                   (*m_checkAbort)();
+
+    AVFormatContext        *m_ic;
+    AVFormatContext        *m_oc;
+    int                     m_videoIndex;
+    QVector<int>            m_streamMap;    // input -> output, -1 to drop
+    QVector<int64_t>        m_lastDts;      // per output stream
+
+    QVector<KeepRange>      m_ranges;
+    AVRational              m_frameRate;
+    int64_t                 m_startPts;
+    int64_t                 m_frameDuration;
+    int64_t                 m_videoDelay;   // pts - dts of keyframes
+
+    QList<GOP*>             m_gops;
+    bool                    m_canSeek;
+    int                     m_seekRange;    // range a skip aimed for
+    int64_t                 m_seekFrom;     // where to go back to
+
+    AVCodecContext         *m_decoder;
+    AVCodecContext         *m_encoder;
+    bool                    m_canEncode;
+    int64_t                 m_reencodeFrom; // pts window to re-encode
+    int64_t                 m_reencodeEnd;
+    int64_t                 m_encodeBase;   // pts of first re-encoded frame
+    int64_t                 m_encodeLast;
+    bool                    m_forceKey;
+    AVFrame                *m_frame;
+
+    long long               m_framesWritten;
+    long long               m_framesReencoded;
+    frm_pos_map_t           m_posMap;
+    frm_pos_map_t           m_durMap;
+};
+
+#endif
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -10,6 +10,8 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QtAlgorithms>
+#include <QElapsedTimer>
+#include <QThread>
 
 #include "mythconfig.h"
 
@@ -33,6 +35,8 @@
 #include "HLS/httplivestream.h"
 
 #include "videodecodebuffer.h"
+#include "videoscalebuffer.h"
+#include "transcodestage.h"
 #include "cutter.h"
 #include "audioreencodebuffer.h"
 
@@ -63,10 +67,12 @@ Transcode::Transcode(ProgramInfo *pginfo) :
     hlsMode(false),                 hlsStreamID(-1),
     hlsDisableAudioOnly(false),
     hlsMaxSegments(0),
+    hlsLadder(NULL),
     cmdContainer("mpegts"),         cmdAudioCodec("aac"),
     cmdVideoCodec("libx264"),
     cmdWidth(480),                  cmdHeight(0),
-    cmdBitrate(600000),             cmdAudioBitrate(64000)
+    cmdBitrate(600000),             cmdAudioBitrate(64000),
+    cmdThreads(0)
 {
 }
 
@@ -85,6 +91,7 @@ Transcode::~Transcode()
         delete kfa_table;
     if (m_recProfile)
         delete m_recProfile;
+    delete hlsLadder;
 }
 void Transcode::ReencoderAddKFA(long curframe, long lastkey, long num_keyframes)
 {
@@ -208,6 +215,32 @@ static void TranscodeWriteText(void *ptr, unsigned char *buf, int len,
 }
 #endif // CONFIG_LIBMP3LAME
 
+static void log_stage_stats(LogLevel_t level,
+                            const VideoDecodeBuffer *videoBuffer,
+                            const VideoScaleBuffer *scaleBuffer,
+                            const TranscodeStageStats &encodeStats)
+{
+    LOG(VB_GENERAL, level, videoBuffer->GetStats().toString());
+    if (scaleBuffer)
+        LOG(VB_GENERAL, level, scaleBuffer->GetStats().toString());
+    LOG(VB_GENERAL, level, encodeStats.toString());
+}
+
+/// The decode and scale threads use the player, so they are stopped and
+/// joined before the player context is released.
+static void stop_stages(VideoDecodeBuffer *videoBuffer,
+                        VideoScaleBuffer *&scaleBuffer)
+{
+    if (videoBuffer)
+        videoBuffer->stop();
+    if (scaleBuffer)
+    {
+        scaleBuffer->stop();
+        delete scaleBuffer;
+        scaleBuffer = NULL;
+    }
+}
+
 int Transcode::TranscodeFile(const QString &inputname,
                              const QString &outputname,
                              const QString &profileName,
@@ -469,7 +502,7 @@ int Transcode::TranscodeFile(const QString &inputname,
                 hls = new HTTPLiveStream(inputname, newWidth, newHeight,
                                          cmdBitrate,
                                          cmdAudioBitrate, hlsMaxSegments,
-                                         0, 0);
+                                         0, 0, -1, false);
 
                 hlsStreamID = hls->GetStreamID();
                 if (!hls || hlsStreamID == -1)
@@ -490,7 +523,9 @@ int Transcode::TranscodeFile(const QString &inputname,
                 QString("HLS: Using segment size of %1 seconds")
                     .arg(segmentSize));
 
-            if (!hlsDisableAudioOnly)
+            if (hlsDisableAudioOnly)
+                hls->DisableAudioOnly();
+            else
             {
                 audioOnlyBitrate = hls->GetAudioOnlyBitrate();
 
@@ -560,13 +595,19 @@ int Transcode::TranscodeFile(const QString &inputname,
             avfw->SetKeyFrameDist(30);
         }
 
-        int threads    = gCoreContext->GetNumSetting("HTTPLiveStreamThreads", 2);
+        // HLS shares the backend with recordings and playback, a file
+        // transcode gets every core unless told otherwise.
+        int threads    = cmdThreads;
+        if (threads <= 0 && hlsMode)
+            threads    = gCoreContext->GetNumSetting("HTTPLiveStreamThreads", 2);
+        else if (threads <= 0)
+            threads    = QThread::idealThreadCount();
         QString preset = gCoreContext->GetSetting("HTTPLiveStreamPreset", "veryfast");
         QString tune   = gCoreContext->GetSetting("HTTPLiveStreamTune", "film");
 
         LOG(VB_GENERAL, LOG_NOTICE,
-            QString("x264 HLS using: %1 threads, '%2' profile and '%3' tune")
-                .arg(threads).arg(preset).arg(tune));
+            QString("x264 %1 using: %2 threads, '%3' profile and '%4' tune")
+                .arg(hlsMode ? "HLS" : "AVF").arg(threads).arg(preset).arg(tune));
 
         avfw->SetThreadCount(threads);
         avfw->SetEncodingPreset(preset);
@@ -623,6 +664,24 @@ int Transcode::TranscodeFile(const QString &inputname,
 
         arb->m_audioFrameSize = avfw->GetAudioFrameSize() * arb->m_channels * 2;
 
+        // The lower rungs of the ladder are encoded from the same frames
+        if (hls && !hlsRenditions.isEmpty())
+        {
+            hlsLadder = new HLSLadder();
+            if (!hlsLadder->Init(hlsRenditions, hls, video_width, video_height,
+                                 video_aspect, arb->m_channels,
+                                 arb->m_eff_audiorate,
+                                 halfFramerate ? video_frame_rate / 2 :
+                                                 video_frame_rate,
+                                 hlsSegmentSize, preset, tune))
+            {
+                LOG(VB_GENERAL, LOG_ERR, "HLS: Unable to start the lower "
+                    "renditions, continuing with the main stream only");
+                delete hlsLadder;
+                hlsLadder = NULL;
+            }
+        }
+
         GetPlayer()->SetVideoFilters(
             gCoreContext->GetSetting("HTTPLiveStreamFilters", "yadif=1:-1:1"));
     }
@@ -669,6 +728,25 @@ int Transcode::TranscodeFile(const QString &inputname,
             return REENCODE_MPEG2TRANS;
         }
 
+        if (encodingType == "H.264" &&
+            get_int_option(m_recProfile, "transcodelossless"))
+        {
+            // The smart cutter places cuts with the duration map
+            frm_pos_map_t durationMap;
+            if (honorCutList && !deleteMap.isEmpty())
+                m_proginfo->QueryPositionMap(durationMap, MARK_DURATION_MS);
+
+            if (!honorCutList || deleteMap.isEmpty() || !durationMap.isEmpty())
+            {
+                LOG(VB_GENERAL, LOG_NOTICE, "Switching to smart cut remuxer.");
+                SetPlayerContext(NULL);
+                return REENCODE_SMARTCUT;
+            }
+
+            LOG(VB_GENERAL, LOG_NOTICE, "No duration map to cut with, "
+                "transcoding instead of using the smart cut remuxer.");
+        }
+
         // Recorder setup
         if (get_int_option(m_recProfile, "transcodelossless"))
         {
@@ -1088,6 +1166,28 @@ int Transcode::TranscodeFile(const QString &inputname,
         new VideoDecodeBuffer(GetPlayer(), videoOutput, honorCutList);
     MThreadPool::globalInstance()->start(videoBuffer, "VideoDecodeBuffer");
 
+    // The libavformat writer takes any frame it is given, so scale on a
+    // thread of our own and let the decoder and encoder run alongside.
+    VideoScaleBuffer *scaleBuffer = NULL;
+    if (rescale && avfMode && !nonAligned)
+    {
+        scaleBuffer = new VideoScaleBuffer(GetPlayer(), videoBuffer,
+                                           newWidth, newHeight);
+        if (scaleBuffer->Init())
+        {
+            MThreadPool::globalInstance()->start(scaleBuffer,
+                                                 "VideoScaleBuffer");
+        }
+        else
+        {
+            delete scaleBuffer;
+            scaleBuffer = NULL;
+        }
+    }
+
+    TranscodeStageStats encodeStats("encode");
+    QElapsedTimer stageTimer;
+
     QTime flagTime;
     flagTime.start();
 
@@ -1103,9 +1203,14 @@ int Transcode::TranscodeFile(const QString &inputname,
         hls->UpdateStatusMessage("Transcoding");
     }
 
+    stageTimer.start();
     while ((!stopSignalled) &&
-           (lastDecode = videoBuffer->GetFrame(did_ff, is_key)))
+           (lastDecode = scaleBuffer ? scaleBuffer->GetFrame(did_ff, is_key) :
+                                       videoBuffer->GetFrame(did_ff, is_key)))
     {
+        encodeStats.AddStarved(stageTimer.nsecsElapsed());
+        stageTimer.start();
+
         if (first_loop)
         {
             copyaudio = GetPlayer()->GetRawAudioState();
@@ -1255,9 +1360,8 @@ int Transcode::TranscodeFile(const QString &inputname,
                 {
                     av_freep(&frame.buf);
                 }
+                stop_stages(videoBuffer, scaleBuffer);
                 SetPlayerContext(NULL);
-                if (videoBuffer)
-                    videoBuffer->stop();
                 if (hls)
                 {
                     hls->UpdateStatus(kHLSStatusErrored);
@@ -1355,6 +1459,8 @@ int Transcode::TranscodeFile(const QString &inputname,
 #else
         LOG(VB_GENERAL, LOG_ERR,
             "Not compiled with libmp3lame support. Should never get here");
+        stop_stages(videoBuffer, scaleBuffer);
+        SetPlayerContext(NULL);
         return REENCODE_ERROR;
 #endif // CONFIG_LIBMP3LAME
         }
@@ -1391,7 +1497,7 @@ int Transcode::TranscodeFile(const QString &inputname,
                         .arg(newWidth).arg(newHeight));
             }
 
-            if (rescale)
+            if (rescale && !scaleBuffer)
             {
                 AVPictureFill(&imageIn, lastDecode);
                 AVPictureFill(&imageOut, &frame);
@@ -1432,6 +1538,11 @@ int Transcode::TranscodeFile(const QString &inputname,
                             avfw2->WriteAudioFrame(buf, audioFrame, tc);
                         }
 
+                        if (hlsLadder)
+                            hlsLadder->WriteAudioFrame(buf, audioFrame,
+                                ab->m_time - timecodeOffset,
+                                avfw->GetTimecodeOffset());
+
                         ++audioFrame;
                     }
                 }
@@ -1451,9 +1562,8 @@ int Transcode::TranscodeFile(const QString &inputname,
                         {
                             av_freep(&frame.buf);
                         }
+                        stop_stages(videoBuffer, scaleBuffer);
                         SetPlayerContext(NULL);
-                        if (videoBuffer)
-                            videoBuffer->stop();
                         delete ab;
                         delete hls; // HLS isn't actually going to be running here
                         return REENCODE_ERROR;
@@ -1471,6 +1581,8 @@ int Transcode::TranscodeFile(const QString &inputname,
 #else
                 LOG(VB_GENERAL, LOG_ERR,
                     "Not compiled with libmp3lame support");
+                stop_stages(videoBuffer, scaleBuffer);
+                SetPlayerContext(NULL);
                 return REENCODE_ERROR;
 #endif
             }
@@ -1501,13 +1613,26 @@ int Transcode::TranscodeFile(const QString &inputname,
                         hlsSegmentFrames = 0;
                     }
 
-                    if (avfw->WriteVideoFrame(rescale ? &frame : lastDecode) > 0)
+                    VideoFrame *outFrame = rescale ? &frame : lastDecode;
+                    if (scaleBuffer)
+                    {
+                        lastDecode->timecode = frame.timecode;
+                        outFrame = lastDecode;
+                    }
+
+                    // WriteVideoFrame() rewrites the timecode, so keep the
+                    // source one for the ladder's renditions
+                    long long sourceTimecode = outFrame->timecode;
+                    if (avfw->WriteVideoFrame(outFrame) > 0)
                     {
                         lastWrittenTime = frame.timecode + timecodeOffset;
                         if (hls)
                             ++hlsSegmentFrames;
                     }
 
+                    if (hlsLadder)
+                        hlsLadder->WriteVideoFrame(outFrame, sourceTimecode);
+
                 }
             }
 #if CONFIG_LIBMP3LAME
@@ -1536,6 +1661,8 @@ int Transcode::TranscodeFile(const QString &inputname,
                 hls->UpdateStatus(kHLSStatusStopping);
                 stopSignalled = true;
             }
+            else if (hlsLadder)
+                hlsLadder->CheckStop();
 
             statustime = MythDate::current().addSecs(5);
         }
@@ -1552,9 +1679,8 @@ int Transcode::TranscodeFile(const QString &inputname,
                 {
                     av_freep(&frame.buf);
                 }
+                stop_stages(videoBuffer, scaleBuffer);
                 SetPlayerContext(NULL);
-                if (videoBuffer)
-                    videoBuffer->stop();
                 return REENCODE_CUTLIST_CHANGE;
             }
 
@@ -1570,15 +1696,17 @@ int Transcode::TranscodeFile(const QString &inputname,
                     {
                         av_freep(&frame.buf);
                     }
+                    stop_stages(videoBuffer, scaleBuffer);
                     SetPlayerContext(NULL);
-                    if (videoBuffer)
-                        videoBuffer->stop();
                     if (hls)
                     {
                         hls->UpdateStatus(kHLSStatusStopped);
                         hls->UpdateStatusMessage("Transcoding Stopped");
                         delete hls;
                     }
+                    if (hlsLadder)
+                        hlsLadder->Finish(kHLSStatusStopped,
+                                          "Transcoding Stopped");
                     return REENCODE_STOPPED;
                 }
 
@@ -1593,6 +1721,9 @@ int Transcode::TranscodeFile(const QString &inputname,
                 if (hls)
                     hls->UpdatePercentComplete(percentage);
 
+                if (hlsLadder)
+                    hlsLadder->UpdatePercentComplete(percentage);
+
                 if (jobID >= 0)
                     JobQueue::ChangeJobComment(jobID,
                               QObject::tr("%1% Completed @ %2 fps.")
@@ -1602,6 +1733,9 @@ int Transcode::TranscodeFile(const QString &inputname,
                         QString("mythtranscode: %1% Completed @ %2 fps.")
                             .arg(percentage).arg(flagFPS));
 
+                log_stage_stats(LOG_DEBUG, videoBuffer, scaleBuffer,
+                                encodeStats);
+
             }
             curtime = MythDate::current().addSecs(20);
         }
@@ -1609,10 +1743,17 @@ int Transcode::TranscodeFile(const QString &inputname,
         curFrameNum++;
         frame.frameNumber = 1 + (curFrameNum << 1);
 
-        GetPlayer()->DiscardVideoFrame(lastDecode);
+        if (scaleBuffer)
+            scaleBuffer->DoneWithFrame(lastDecode);
+        else
+            GetPlayer()->DiscardVideoFrame(lastDecode);
+
+        encodeStats.AddBusy(stageTimer.nsecsElapsed());
+        stageTimer.start();
     }
 
     sws_freeContext(scontext);
+    log_stage_stats(LOG_INFO, videoBuffer, scaleBuffer, encodeStats);
 
     if (!fifow)
     {
@@ -1667,11 +1808,16 @@ int Transcode::TranscodeFile(const QString &inputname,
         delete hls;
     }
 
-    if (videoBuffer)
+    if (hlsLadder)
     {
-        videoBuffer->stop();
+        if (!stopSignalled)
+            hlsLadder->Finish(kHLSStatusCompleted, "Transcoding Completed");
+        else
+            hlsLadder->Finish(kHLSStatusStopped, "Transcoding Stopped");
     }
 
+    stop_stages(videoBuffer, scaleBuffer);
+
     if (rescale)
     {
         av_freep(&frame.buf);
@@ -3,6 +3,7 @@
 #include "transcodedefs.h"
 #include "programtypes.h"
 #include "playercontext.h"
+#include "hlsladder.h"
 
 class ProgramInfo;
 class NuppelVideoRecorder;
@@ -29,6 +30,8 @@ class Transcode : public QObject
     void SetHLSMode(void) { hlsMode = true; }
     void SetHLSStreamID(int streamid) { hlsStreamID = streamid; }
     void SetHLSMaxSegments(int segments) { hlsMaxSegments = segments; }
+    void SetHLSRenditions(const QList<int> &renditions)
+        { hlsRenditions = renditions; }
     void SetCMDContainer(QString container) { cmdContainer = container; }
     void SetCMDAudioCodec(QString codec) { cmdAudioCodec = codec; }
     void SetCMDVideoCodec(QString codec) { cmdVideoCodec = codec; }
@@ -36,6 +39,7 @@ class Transcode : public QObject
     void SetCMDWidth(int width) { cmdWidth = width; }
     void SetCMDBitrate(int bitrate) { cmdBitrate = bitrate; }
     void SetCMDAudioBitrate(int bitrate) { cmdAudioBitrate = bitrate; }
+    void SetCMDThreads(int threads) { cmdThreads = threads; }
     void DisableAudioOnlyHLS(void) { hlsDisableAudioOnly = true; }
 
   private:
@@ -62,6 +66,8 @@ class Transcode : public QObject
     int                     hlsStreamID;
     bool                    hlsDisableAudioOnly;
     int                     hlsMaxSegments;
+    QList<int>              hlsRenditions;
+    HLSLadder              *hlsLadder;
     QString                 cmdContainer;
     QString                 cmdAudioCodec;
     QString                 cmdVideoCodec;
@@ -69,6 +75,7 @@ class Transcode : public QObject
     int                     cmdHeight;
     int                     cmdBitrate;
     int                     cmdAudioBitrate;
+    int                     cmdThreads;
 };
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
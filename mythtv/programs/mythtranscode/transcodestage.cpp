@@ -0,0 +1,50 @@
+#include "transcodestage.h"
+
+#include <QMutexLocker>
+
+TranscodeStageStats::TranscodeStageStats(const QString &name)
+  : m_name(name),
+    m_frames(0),    m_busy(0),
+    m_starved(0),   m_blocked(0)
+{
+    m_clock.start();
+}
+
+void TranscodeStageStats::AddBusy(qint64 nsecs, int frames)
+{
+    QMutexLocker locker(&m_lock);
+    m_busy += nsecs;
+    m_frames += frames;
+}
+
+void TranscodeStageStats::AddStarved(qint64 nsecs)
+{
+    QMutexLocker locker(&m_lock);
+    m_starved += nsecs;
+}
+
+void TranscodeStageStats::AddBlocked(qint64 nsecs)
+{
+    QMutexLocker locker(&m_lock);
+    m_blocked += nsecs;
+}
+
+QString TranscodeStageStats::toString(void) const
+{
+    QMutexLocker locker(&m_lock);
+
+    double elapsed = m_clock.nsecsElapsed();
+    if (elapsed <= 0)
+        elapsed = 1;
+
+    return QString("%1: %2 frames @ %3 fps, busy %4%, starved %5%, "
+                   "blocked %6%")
+        .arg(m_name, -6)
+        .arg(m_frames)
+        .arg(m_frames * 1e9 / elapsed, 0, 'f', 1)
+        .arg(m_busy * 100 / elapsed, 0, 'f', 0)
+        .arg(m_starved * 100 / elapsed, 0, 'f', 0)
+        .arg(m_blocked * 100 / elapsed, 0, 'f', 0);
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,37 @@
+#ifndef TRANSCODESTAGE_H
+#define TRANSCODESTAGE_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QMutex>
+
+/**
+ * Frame count and time split of one stage of the transcoding pipeline:
+ * how long it spent working, waiting for the stage before it to deliver
+ * a frame and waiting for the stage after it to take one. A stage that
+ * is mostly busy is the bottleneck; one that is mostly starved or
+ * blocked could give its cores to another.
+ */
+class TranscodeStageStats
+{
+  public:
+    explicit TranscodeStageStats(const QString &name);
+
+    void AddBusy(qint64 nsecs, int frames = 1);
+    void AddStarved(qint64 nsecs);
+    void AddBlocked(qint64 nsecs);
+
+    QString toString(void) const;
+
+  private:
+    QString         m_name;
+    QElapsedTimer   m_clock;
+    QMutex mutable  m_lock; // Guards the following...
+    qint64          m_frames;
+    qint64          m_busy;
+    qint64          m_starved;
+    qint64          m_blocked;
+};
+
+#endif
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -3,6 +3,8 @@
 #include "mythplayer.h"
 #include "videooutbase.h"
 
+#include <QElapsedTimer>
+
 #include <chrono> // for milliseconds
 #include <thread> // for sleep_for
 
@@ -11,7 +13,7 @@ VideoDecodeBuffer::VideoDecodeBuffer(MythPlayer *player, VideoOutput *videoout,
   : m_player(player),         m_videoOutput(videoout),
     m_honorCutlist(cutlist),  m_maxFrames(size),
     m_runThread(true),        m_isRunning(false),
-    m_eof(false)
+    m_eof(false),             m_stats("decode")
 {
 
 }
@@ -27,8 +29,10 @@ VideoDecodeBuffer::~VideoDecodeBuffer()
 
 void VideoDecodeBuffer::stop(void)
 {
+    m_queueLock.lock();
     m_runThread = false;
     m_frameWaitCond.wakeAll();
+    m_queueLock.unlock();
 
     while (m_isRunning)
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -37,12 +41,16 @@ void VideoDecodeBuffer::stop(void)
 void VideoDecodeBuffer::run()
 {
     frm_dir_map_t::iterator dm_iter;
+    QElapsedTimer timer;
 
     m_isRunning = true;
     while (m_runThread)
     {
         QMutexLocker locker(&m_queueLock);
 
+        if (!m_runThread)
+            break;
+
         if (m_frameList.size() < m_maxFrames && !m_eof)
         {
             locker.unlock();
@@ -52,8 +60,12 @@ void VideoDecodeBuffer::run()
             tfInfo.didFF = 0;
             tfInfo.isKey = false;
 
-            if (m_player->TranscodeGetNextFrame(dm_iter, tfInfo.didFF,
-                tfInfo.isKey, m_honorCutlist))
+            timer.start();
+            bool gotFrame = m_player->TranscodeGetNextFrame(
+                dm_iter, tfInfo.didFF, tfInfo.isKey, m_honorCutlist);
+            m_stats.AddBusy(timer.nsecsElapsed(), gotFrame ? 1 : 0);
+
+            if (gotFrame)
             {
                 tfInfo.frame = m_videoOutput->GetLastDecodedFrame();
 
@@ -72,7 +84,13 @@ void VideoDecodeBuffer::run()
         }
         else
         {
+            // Only a full queue means the next stage is holding us up,
+            // after EOF we are just idle.
+            bool full = !m_eof;
+            timer.start();
             m_frameWaitCond.wait(locker.mutex());
+            if (full)
+                m_stats.AddBlocked(timer.nsecsElapsed());
         }
     }
     m_isRunning = false;
@@ -84,7 +102,7 @@ VideoFrame *VideoDecodeBuffer::GetFrame(int &didFF, bool &isKey)
 
     if (m_frameList.isEmpty())
     {
-        if (m_eof)
+        if (m_eof || !m_runThread)
             return NULL;
 
         m_frameWaitCond.wait(locker.mutex());
@@ -7,6 +7,7 @@
 #include <QRunnable>
 
 #include "videooutbase.h"
+#include "transcodestage.h"
 
 class MythPlayer;
 class VideoOutput;
@@ -21,6 +22,7 @@ class VideoDecodeBuffer : public QRunnable
     void          stop(void);
     virtual void run();
     VideoFrame *GetFrame(int &didFF, bool &isKey);
+    const TranscodeStageStats &GetStats(void) const { return m_stats; }
 
   private:
     typedef struct decodedFrameInfo
@@ -40,6 +42,7 @@ class VideoDecodeBuffer : public QRunnable
     bool                    m_eof;
     QList<DecodedFrameInfo> m_frameList;
     QWaitCondition          m_frameWaitCond;
+    TranscodeStageStats     m_stats;
 };
 
 #endif
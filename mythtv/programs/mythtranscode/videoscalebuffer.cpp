@@ -0,0 +1,187 @@
+#include "videoscalebuffer.h"
+#include "videodecodebuffer.h"
+
+#include <QElapsedTimer>
+
+#include "mythplayer.h"
+#include "mythavutil.h"
+
+extern "C" {
+#include "libavutil/mem.h"
+#include "libswscale/swscale.h"
+}
+
+#include <chrono> // for milliseconds
+#include <thread> // for sleep_for
+
+VideoScaleBuffer::VideoScaleBuffer(MythPlayer *player,
+                                   VideoDecodeBuffer *source,
+                                   int width, int height, int size)
+  : m_player(player),         m_source(source),
+    m_width(width),           m_height(height),
+    m_maxFrames(size),
+    m_runThread(true),        m_isRunning(false),
+    m_scontext(NULL),
+    m_eof(false),             m_stats("scale")
+{
+    setAutoDelete(false);
+}
+
+VideoScaleBuffer::~VideoScaleBuffer()
+{
+    stop();
+
+    sws_freeContext(m_scontext);
+    while (!m_allFrames.isEmpty())
+    {
+        VideoFrame *frame = m_allFrames.takeFirst();
+        av_freep(&frame->buf);
+        delete frame;
+    }
+}
+
+bool VideoScaleBuffer::Init(void)
+{
+    uint size = buffersize(FMT_YV12, m_width, m_height);
+
+    for (int i = 0; i < m_maxFrames; ++i)
+    {
+        unsigned char *buf = (unsigned char *)av_malloc(size);
+        if (!buf)
+            return false;
+
+        VideoFrame *frame = new VideoFrame;
+        memset(frame, 0, sizeof(*frame));
+        init(frame, FMT_YV12, buf, m_width, m_height, size);
+
+        m_allFrames.append(frame);
+        m_freeFrames.append(frame);
+    }
+
+    return true;
+}
+
+void VideoScaleBuffer::stop(void)
+{
+    // Under the lock, so the scaler can't miss the wakeup between checking
+    // m_runThread and waiting
+    m_queueLock.lock();
+    m_runThread = false;
+    m_frameWaitCond.wakeAll();
+    m_queueLock.unlock();
+
+    while (m_isRunning)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+void VideoScaleBuffer::run()
+{
+    QElapsedTimer timer;
+
+    m_isRunning = true;
+    while (m_runThread)
+    {
+        QMutexLocker locker(&m_queueLock);
+
+        if (!m_runThread)
+            break;
+
+        if (m_eof || m_freeFrames.isEmpty())
+        {
+            bool full = !m_eof;
+            timer.start();
+            m_frameWaitCond.wait(locker.mutex());
+            if (full)
+                m_stats.AddBlocked(timer.nsecsElapsed());
+            continue;
+        }
+
+        VideoFrame *out = m_freeFrames.takeFirst();
+        locker.unlock();
+
+        ScaledFrameInfo tfInfo;
+        tfInfo.frame = out;
+        tfInfo.didFF = 0;
+        tfInfo.isKey = false;
+
+        timer.start();
+        VideoFrame *in = m_source->GetFrame(tfInfo.didFF, tfInfo.isKey);
+        m_stats.AddStarved(timer.nsecsElapsed());
+
+        if (in)
+        {
+            timer.start();
+            Scale(in, out);
+            m_player->DiscardVideoFrame(in);
+            m_stats.AddBusy(timer.nsecsElapsed());
+        }
+
+        locker.relock();
+        if (in)
+        {
+            m_frameList.append(tfInfo);
+        }
+        else
+        {
+            m_freeFrames.prepend(out);
+            m_eof = true;
+        }
+        m_frameWaitCond.wakeAll();
+    }
+    m_isRunning = false;
+}
+
+void VideoScaleBuffer::Scale(const VideoFrame *in, VideoFrame *out)
+{
+    AVPicture imageIn, imageOut;
+    AVPictureFill(&imageIn, in);
+    AVPictureFill(&imageOut, out);
+
+    // 1080 line video is decoded as 1088, the last 8 lines are padding
+    int bottomBand = (in->height == 1088) ? 8 : 0;
+    m_scontext = sws_getCachedContext(m_scontext,
+                     in->width, in->height, FrameTypeToPixelFormat(in->codec),
+                     out->width, out->height, FrameTypeToPixelFormat(out->codec),
+                     SWS_FAST_BILINEAR, NULL, NULL, NULL);
+
+    sws_scale(m_scontext, imageIn.data, imageIn.linesize, 0,
+              in->height - bottomBand, imageOut.data, imageOut.linesize);
+
+    out->timecode    = in->timecode;
+    out->frameNumber = in->frameNumber;
+    out->aspect      = in->aspect;
+    out->frame_rate  = in->frame_rate;
+}
+
+VideoFrame *VideoScaleBuffer::GetFrame(int &didFF, bool &isKey)
+{
+    QMutexLocker locker(&m_queueLock);
+
+    while (m_frameList.isEmpty())
+    {
+        if (m_eof || !m_runThread)
+            return NULL;
+
+        m_frameWaitCond.wait(locker.mutex());
+    }
+
+    ScaledFrameInfo tfInfo = m_frameList.takeFirst();
+    locker.unlock();
+
+    didFF = tfInfo.didFF;
+    isKey = tfInfo.isKey;
+
+    return tfInfo.frame;
+}
+
+void VideoScaleBuffer::DoneWithFrame(VideoFrame *frame)
+{
+    if (!frame)
+        return;
+
+    QMutexLocker locker(&m_queueLock);
+    m_freeFrames.append(frame);
+    m_frameWaitCond.wakeAll();
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,68 @@
+#ifndef VIDEOSCALEBUFFER_H
+#define VIDEOSCALEBUFFER_H
+
+#include <QList>
+#include <QWaitCondition>
+#include <QMutex>
+#include <QRunnable>
+
+#include "mythframe.h"
+#include "transcodestage.h"
+
+class MythPlayer;
+class VideoDecodeBuffer;
+struct SwsContext;
+
+/**
+ * Scaling stage of the transcoding pipeline. Takes decoded frames from a
+ * VideoDecodeBuffer, converts them to YV12 at the output size into a
+ * small pool of frames of its own and hands the decoded frame back to the
+ * player straight away, so the decoder, the scaler and the encoder each
+ * keep a core busy instead of taking turns on one.
+ *
+ * Frames returned by GetFrame() belong to this buffer and must be given
+ * back with DoneWithFrame().
+ */
+class VideoScaleBuffer : public QRunnable
+{
+  public:
+    VideoScaleBuffer(MythPlayer *player, VideoDecodeBuffer *source,
+        int width, int height, int size = 4);
+    virtual ~VideoScaleBuffer();
+
+    bool          Init(void);
+    void          stop(void);
+    virtual void run();
+    VideoFrame *GetFrame(int &didFF, bool &isKey);
+    void        DoneWithFrame(VideoFrame *frame);
+    const TranscodeStageStats &GetStats(void) const { return m_stats; }
+
+  private:
+    typedef struct scaledFrameInfo
+    {
+        VideoFrame *frame;
+        int         didFF;
+        bool        isKey;
+    } ScaledFrameInfo;
+
+    void Scale(const VideoFrame *in, VideoFrame *out);
+
+    MythPlayer * const        m_player;
+    VideoDecodeBuffer * const m_source;
+    int const                 m_width;
+    int const                 m_height;
+    int const                 m_maxFrames;
+    bool volatile             m_runThread;
+    bool volatile             m_isRunning;
+    SwsContext               *m_scontext;   // scaler thread only
+    QList<VideoFrame*>        m_allFrames;
+    QMutex mutable            m_queueLock; // Guards the following...
+    bool                      m_eof;
+    QList<VideoFrame*>        m_freeFrames;
+    QList<ScaledFrameInfo>    m_frameList;
+    QWaitCondition            m_frameWaitCond;
+    TranscodeStageStats       m_stats;
+};
+
+#endif
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
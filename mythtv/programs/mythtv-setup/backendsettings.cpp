@@ -341,6 +341,34 @@ static HostCheckBoxSetting *DisableFirewireReset()
     return hc;
 }
 
+static HostSpinBoxSetting *PreviewGeneratorThreads()
+{
+    HostSpinBoxSetting *hs = new HostSpinBoxSetting("PreviewGeneratorThreads",
+                                                    0, 16, 1);
+    hs->setLabel(QObject::tr("Simultaneous preview generators"));
+    hs->setHelpText(
+        QObject::tr(
+            "The number of preview images this backend will generate at "
+            "once. Set to 0 to use twice the number of processor cores."));
+    hs->setValue(0);
+    return hs;
+}
+
+static HostCheckBoxSetting *PreviewGeneratorInProcess()
+{
+    HostCheckBoxSetting *hc = new HostCheckBoxSetting(
+        "PreviewGeneratorInProcess");
+    hc->setLabel(QObject::tr("Generate previews in the backend"));
+    hc->setHelpText(
+        QObject::tr(
+            "If enabled, preview images are decoded by the backend itself "
+            "instead of by starting mythpreviewgen for each one. This is "
+            "much quicker, but a recording the decoder can not cope with "
+            "may take the backend down with it."));
+    hc->setValue(false);
+    return hc;
+}
+
 static HostTextEditSetting *MiscStatusScript()
 {
     HostTextEditSetting *he = new HostTextEditSetting("MiscStatusScript");
@@ -656,6 +684,22 @@ static GlobalCheckBoxSetting *AutoCommflagWhileRecording()
     return gc;
 };
 
+static GlobalCheckBoxSetting *CommFlagInRecorder()
+{
+    GlobalCheckBoxSetting *gc = new GlobalCheckBoxSetting("CommFlagInRecorder");
+    gc->setLabel(QObject::tr("Detect commercials while recording"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, and Auto Commercial Detection is "
+                                "ON for a digital recording, the recorder "
+                                "looks for blank frames as it writes the "
+                                "file, so the commercial breaks are known as "
+                                "soon as the recording ends. This replaces "
+                                "the flagging job with blank frame detection "
+                                "only; if the backend can not keep up the "
+                                "job runs as usual."));
+    return gc;
+};
+
 static GlobalTextEditSetting *UserJob(uint job_num)
 {
     GlobalTextEditSetting *gc = new GlobalTextEditSetting(QString("UserJob%1").arg(job_num));
@@ -716,6 +760,21 @@ static GlobalTextEditSetting *JobQueueTranscodeCommand()
     return gc;
 };
 
+static GlobalSpinBoxSetting *CommFlagSegments()
+{
+    GlobalSpinBoxSetting *gc = new GlobalSpinBoxSetting("CommFlagSegments",
+                                                        1, 16, 1);
+    gc->setLabel(QObject::tr("Commercial detection segments"));
+    gc->setValue(1);
+    gc->setHelpText(QObject::tr("Completed recordings are split into this "
+                                "many parts, which are analysed for "
+                                "commercials at the same time. Set to 1 to "
+                                "flag in a single pass. Higher values finish "
+                                "sooner on multi-core systems but use more "
+                                "memory."));
+    return gc;
+}
+
 static GlobalTextEditSetting *JobQueueCommFlagCommand()
 {
     GlobalTextEditSetting *gc = new GlobalTextEditSetting("JobQueueCommFlagCommand");
@@ -935,6 +994,8 @@ BackendSettings::BackendSettings() :
     group2->addChild(MiscStatusScript());
     group2->addChild(DisableAutomaticBackup());
     group2->addChild(DisableFirewireReset());
+    group2->addChild(PreviewGeneratorThreads());
+    group2->addChild(PreviewGeneratorInProcess());
     addChild(group2);
 
     GroupSetting* group2a1 = new GroupSetting();
@@ -999,6 +1060,8 @@ BackendSettings::BackendSettings() :
     group6->setLabel(QObject::tr("Job Queue (Global)"));
     group6->addChild(JobsRunOnRecordHost());
     group6->addChild(AutoCommflagWhileRecording());
+    group6->addChild(CommFlagInRecorder());
+    group6->addChild(CommFlagSegments());
     group6->addChild(JobQueueCommFlagCommand());
     group6->addChild(JobQueueTranscodeCommand());
     group6->addChild(AutoTranscodeBeforeAutoCommflag());